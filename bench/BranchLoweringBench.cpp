@@ -0,0 +1,202 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Branches executed by a branch heavy program when conditions are computed as booleans and tested
+// against zero, against comparisons branching directly, short circuits and jump tables. The lowered
+// code is interpreted and every branch the emitter would generate for an instruction is counted.
+const std::string PROGRAM = R"({
+    function classify(c : int) : int {
+        if c >= 97 && c <= 122 || c >= 65 && c <= 90 || c == 95 { return 1; }
+        else if c >= 48 && c <= 57 { return 2; }
+        else if c == 32 || c == 9 || c == 10 { return 3; }
+        return 4;
+    }
+    function step(op : int, acc : int, x : int) : int {
+        if op == 0 { return acc + x; }
+        else if op == 1 { return acc - x; }
+        else if op == 2 { return acc ^ x; }
+        else if op == 3 { return acc * 3 + x; }
+        else if op == 4 { return acc & 1048575; }
+        else if op == 5 { return acc | x; }
+        else if op == 6 { return acc + classify(x & 127); }
+        else { return acc + 1; }
+    }
+    function range(lo : int, hi : int, acc : int) : int {
+        if hi - lo == 1 { return step(lo * 7 & 7, acc, lo) & 1073741823; }
+        let mid : int = (lo + hi) / 2;
+        return range(mid, hi, range(lo, mid, acc));
+    }
+    return range(0, 4000000, 1) & 255;
+})";
+
+class BranchCounts {
+public:
+    uint64_t instructions = 0;
+    uint64_t conditional = 0;
+    uint64_t unconditional = 0;
+    uint64_t indirect = 0;
+};
+
+class Interpreter {
+public:
+    std::unordered_map<std::string, const Backend::Function*> functions;
+    std::unordered_map<std::string, int64_t> globals;
+    BranchCounts counts;
+
+    Interpreter(const Backend::Program &program) {
+        for(const auto &it : program.functions) {
+            this->functions[it.name] = &it;
+        }
+    }
+
+    int64_t run(const Backend::Function &function, const std::vector<int64_t> &arguments) {
+        std::vector<int64_t> vregs(function.vregCount, 0);
+        auto value = [&](const Backend::Operand &operand) {
+            return operand.isVreg() ? vregs[operand.value] : operand.value;
+        };
+        int32_t block = 0;
+        while(true) {
+            const int32_t next = block + 1;
+            for(const auto &it : function.blocks[block].instructions) {
+                this->counts.instructions ++;
+                const int64_t a = value(it.a), b = value(it.b);
+                switch(it.opcode) {
+                    case Backend::Opcode::MOVE: vregs[it.dst] = a; break;
+                    case Backend::Opcode::ADD: vregs[it.dst] = a + b; break;
+                    case Backend::Opcode::SUB: vregs[it.dst] = a - b; break;
+                    case Backend::Opcode::MUL: vregs[it.dst] = a * b; break;
+                    case Backend::Opcode::DIV: vregs[it.dst] = a / b; break;
+                    case Backend::Opcode::MOD: vregs[it.dst] = a % b; break;
+                    case Backend::Opcode::AND: vregs[it.dst] = a & b; break;
+                    case Backend::Opcode::OR: vregs[it.dst] = a | b; break;
+                    case Backend::Opcode::XOR: vregs[it.dst] = a ^ b; break;
+                    case Backend::Opcode::NEG: vregs[it.dst] = -a; break;
+                    case Backend::Opcode::NOT: vregs[it.dst] = ~a; break;
+                    case Backend::Opcode::MUL_ADD: vregs[it.dst] = a * b + value(it.c); break;
+                    case Backend::Opcode::ADD_DIV: vregs[it.dst] = (a + b) / value(it.c); break;
+                    case Backend::Opcode::ADD_MOD: vregs[it.dst] = (a + b) % value(it.c); break;
+                    case Backend::Opcode::MOD_ADD: vregs[it.dst] = a % b + value(it.c); break;
+                    case Backend::Opcode::EQUAL: case Backend::Opcode::NOT_EQUAL: case Backend::Opcode::LESS:
+                    case Backend::Opcode::LESS_EQUAL: case Backend::Opcode::GREATER: case Backend::Opcode::GREATER_EQUAL:
+                        vregs[it.dst] = Backend::evaluateComparison(it.opcode, a, b);
+                        break;
+                    case Backend::Opcode::PARAM: vregs[it.dst] = arguments[it.a.value]; break;
+                    case Backend::Opcode::LOAD_GLOBAL: vregs[it.dst] = this->globals[it.symbol]; break;
+                    case Backend::Opcode::STORE_GLOBAL: this->globals[it.symbol] = a; break;
+                    case Backend::Opcode::CALL: case Backend::Opcode::TAIL_CALL: {
+                        std::vector<int64_t> values;
+                        for(const auto &argument : it.arguments) {
+                            values.push_back(value(argument));
+                        }
+                        const int64_t result = this->run(*this->functions.at(it.symbol), values);
+                        if(it.opcode == Backend::Opcode::TAIL_CALL) {
+                            return result;
+                        }
+                        vregs[it.dst] = result;
+                        break;
+                    }
+                    case Backend::Opcode::JUMP:
+                        this->counts.unconditional += it.target != next;
+                        block = it.target;
+                        break;
+                    case Backend::Opcode::BRANCH: case Backend::Opcode::ADD_BRANCH: {
+                        if(it.opcode == Backend::Opcode::ADD_BRANCH) {
+                            vregs[it.dst] = a + b;
+                        }
+                        const bool holds = it.opcode == Backend::Opcode::BRANCH ? Backend::evaluateComparison(it.condition, a, b)
+                            : Backend::evaluateComparison(it.condition, vregs[it.dst], value(it.c));
+                        if(it.opcode == Backend::Opcode::BRANCH && it.a.isImmediate() && it.b.isImmediate()) {
+                            this->counts.unconditional += (holds ? it.target : it.alternative) != next;
+                        } else {
+                            // A conditional jump to the block which does not follow, then a jump when neither follows
+                            this->counts.conditional ++;
+                            this->counts.unconditional += !holds && it.target != next && it.alternative != next;
+                        }
+                        block = holds ? it.target : it.alternative;
+                        break;
+                    }
+                    case Backend::Opcode::SWITCH: {
+                        this->counts.conditional ++;
+                        const uint64_t index = (uint64_t)(a - b);
+                        this->counts.indirect += index < it.cases.size();
+                        block = index < it.cases.size() ? it.cases[index] : it.alternative;
+                        break;
+                    }
+                    case Backend::Opcode::RETURN:
+                        return a;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+};
+
+int runNative(const Backend::Program &program, const Backend::AllocatorKind allocator, const std::filesystem::path &base, Backend::EmitStats &stats, double &bestMs) {
+    {
+        std::ofstream output(base.string() + ".s");
+        Backend::emitProgram(output, program, allocator, stats);
+    }
+    if(std::system(("gcc -o " + base.string() + " " + base.string() + ".s").c_str()) != 0) {
+        return -1;
+    }
+    int exitCode = -1;
+    bestMs = 1e30;
+    for(int32_t i = 0; i < 3; i ++) {
+        auto start = std::chrono::steady_clock::now();
+        int status = std::system(base.string().c_str());
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        exitCode = WEXITSTATUS(status);
+    }
+    return exitCode;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-branch-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+    for(const bool optimizeBranches : {false, true}) {
+        std::vector<Lexing::Diagnostic> diagnostics;
+        Backend::Optimizations optimizations;
+        optimizations.branches = optimizeBranches;
+        Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+            std::cout << "The program does not compile\n";
+            break;
+        }
+        const std::string name = optimizeBranches ? "direct branches" : "boolean branches";
+
+        Interpreter interpreter(program);
+        const int64_t result = interpreter.run(*interpreter.functions.at(Backend::MAIN_FUNCTION), {}) & 255;
+        const BranchCounts &counts = interpreter.counts;
+        std::cout << name << ": " << counts.instructions << " instructions, " << counts.conditional << " conditional, "
+            << counts.unconditional << " unconditional and " << counts.indirect << " indirect branches executed\n";
+
+        Backend::EmitStats stats;
+        double bestMs = 0;
+        const int exitCode = runNative(program, Backend::AllocatorKind::LINEAR_SCAN, root / (optimizeBranches ? "direct" : "boolean"), stats, bestMs);
+        std::cout << name << ": " << stats.instructions << " machine instructions, runs in " << bestMs << " ms, exit code "
+            << exitCode << (exitCode == result ? "" : " (interpreted result differs)") << "\n";
+    }
+    delete tree;
+    std::filesystem::remove_all(root);
+}
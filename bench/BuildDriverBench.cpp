@@ -0,0 +1,68 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <filesystem>
+
+#include "BuildDriver.h"
+
+// Full, no-op and incremental builds of a synthetic project of 10000 modules in 100 layers,
+// where every module imports up to three modules of the layer before it
+const int32_t MODULES = 10000;
+const int32_t LAYER = 100;
+
+void writeModule(const std::filesystem::path &root, const int32_t index, const int32_t salt = 0, const std::string &extra = "") {
+    std::ofstream file(root / ("m" + std::to_string(index) + ".xcpp"));
+    file << "{\n";
+    const int32_t layer = index / LAYER;
+    std::string calls;
+    if(layer > 0) {
+        for(int32_t i = 0; i < 3; i ++) {
+            const int32_t imported = (layer - 1) * LAYER + (index * 7 + i * 31) % LAYER;
+            file << "    import m" << imported << ";\n";
+            calls += " + f" + std::to_string(imported) + "(a, b)";
+        }
+    }
+    file << "    let v" << index << " : int = " << index << ";\n";
+    file << "    function f" << index << "(a : int, b : int) : int {\n";
+    file << "        let t : int = a * b - " << index + salt << ";\n";
+    file << "        if t > 10 { return t" << calls << "; } else { return a + b; }\n";
+    file << "    }\n" << extra << "}\n";
+}
+
+void build(const std::string &manifest, const size_t threads, const std::string &name) {
+    Build::BuildReport report;
+    std::string error;
+    if(!Build::buildProject(manifest, threads, report, error) || report.failed) {
+        std::cout << name << ": build failed " << error << "\n";
+        return;
+    }
+    std::cout << name << ":\n" << report;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-build-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    std::ofstream manifest(root / "project.manifest");
+    for(int32_t i = 0; i < MODULES; i ++) {
+        writeModule(root, i);
+        manifest << "m" << i << ".xcpp\n";
+    }
+    manifest.close();
+
+    const std::string path = (root / "project.manifest").string();
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    build(path, threads, "full build");
+    build(path, threads, "no-op build");
+
+    // A body change keeps the interface, so dependents stay up to date
+    writeModule(root, 5, 1);
+    build(path, threads, "body change in the first layer");
+
+    // An interface change rebuilds every module that imports the changed one
+    writeModule(root, 5, 1, "    function g(a : int) : int { return a; }\n");
+    build(path, threads, "interface change in the first layer");
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Layout.h"
+
+// Iteration over an array of objects in each layout of one class: fields in declaration order, fields
+// reordered to leave no padding, and one array per field. The loop reads three of the six fields.
+const int64_t OBJECTS = (int64_t)1 << 21;
+
+const std::string FIELDS = R"({
+        alive : bool;
+        x : int;
+        kind : char;
+        y : int;
+        visible : bool;
+        mass : i32;
+    })";
+
+const std::string PROGRAM = "{\n    class Declared [ordered] " + FIELDS + "\n    class Reordered " + FIELDS + "\n    class Columns [soa] " + FIELDS + "\n}\n";
+
+// Sum of x times mass over the objects which are alive, reading every field at its layout's offset
+static int64_t iterate(const unsigned char *data, const Backend::ArrayLayout &array, const int32_t alive, const int32_t x, const int32_t mass) {
+    const unsigned char *aliveBase = data + array.starts[alive], *xBase = data + array.starts[x], *massBase = data + array.starts[mass];
+    const int64_t aliveStride = array.strides[alive], xStride = array.strides[x], massStride = array.strides[mass];
+    int64_t sum = 0;
+    for(int64_t i = 0; i < array.count; i ++) {
+        if(aliveBase[i * aliveStride]) {
+            int64_t value = 0;
+            int32_t weight = 0;
+            std::memcpy(&value, xBase + i * xStride, 8);
+            std::memcpy(&weight, massBase + i * massStride, 4);
+            sum += value * weight;
+        }
+    }
+    return sum;
+}
+
+int main() {
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+    std::map<std::string, Backend::ClassLayout> layouts;
+    std::vector<Lexing::Diagnostic> diagnostics;
+    Backend::layoutClasses(tree, layouts, diagnostics);
+    delete tree;
+    if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+        std::cout << "The classes do not compile\n";
+        return 1;
+    }
+
+    double declaredNs = 0;
+    int64_t expected = 0;
+    for(const std::string name : {"Declared", "Reordered", "Columns"}) {
+        const Backend::ClassLayout &layout = layouts.at(name);
+        const Backend::ArrayLayout array(layout, OBJECTS);
+        const int32_t alive = layout.field("alive"), x = layout.field("x"), mass = layout.field("mass");
+        std::vector<unsigned char> data(array.bytes);
+        for(int64_t i = 0; i < OBJECTS; i ++) {
+            const unsigned char isAlive = i % 4 != 0;
+            const int64_t value = i * 7 - 3;
+            const int32_t weight = (int32_t)(i % 13);
+            data[array.offset(i, alive)] = isAlive;
+            std::memcpy(&data[array.offset(i, x)], &value, 8);
+            std::memcpy(&data[array.offset(i, mass)], &weight, 4);
+        }
+
+        double bestNs = 1e30;
+        int64_t sum = 0;
+        for(int32_t repeat = 0; repeat < 5; repeat ++) {
+            auto start = std::chrono::steady_clock::now();
+            sum = iterate(data.data(), array, alive, x, mass);
+            bestNs = std::min(bestNs, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / OBJECTS);
+        }
+        if(name == "Declared") {
+            declaredNs = bestNs;
+            expected = sum;
+        } else if(sum != expected) {
+            std::cout << "Layout " << name << " reads other values\n";
+            return 1;
+        }
+        std::cout << name << ": " << (double)array.bytes / OBJECTS << " bytes per object, " << bestNs << " ns per object, "
+            << declaredNs / bestNs << "x the declaration order\n";
+    }
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/Evaluate.h"
+#include "Backend/X86Emitter.h"
+
+// A configuration script whose settings are computed by pure functions of constants, run natively with
+// every setting computed when the program starts against settings evaluated while compiling
+const std::string PROGRAM = R"({
+    function fib(n : int) : int {
+        if n < 2 {
+            return n;
+        }
+        return fib(n - 1) + fib(n - 2);
+    }
+    function primesBelow(n : int) : int {
+        let composite : int[20000];
+        let count : int = 0;
+        for let i : int = 2; i < n; i += 1 {
+            if !composite[i] {
+                count += 1;
+                for let j : int = i * i; j < n; j += i {
+                    composite[j] = 1;
+                }
+            }
+        }
+        return count;
+    }
+    function hash(seed : int, rounds : int) : int {
+        let h : int = seed;
+        for let i : int = 0; i < rounds; i += 1 {
+            h = (h * 31 + i) % 1000003;
+        }
+        return h;
+    }
+    let buckets : int = primesBelow(20000);
+    let retries : int = fib(32) % 17;
+    let backoff : int = fib(32) % 1000 + fib(30) % 1000;
+    let salt : int = hash(7, 50000) ^ hash(11, 50000);
+    return (buckets + retries + backoff + salt) & 255;
+})";
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-evaluation-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    for(const bool evaluate : {false, true}) {
+        Lexing::Lexer lexer(PROGRAM);
+        Lexing::Lexer::setupBasicLexer(lexer);
+        lexer.lex();
+        Parsing::Parser parser(lexer.lexed);
+        Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+        Backend::EvaluationStats evaluation;
+        auto start = std::chrono::steady_clock::now();
+        if(evaluate) {
+            Backend::evaluateCalls(tree, evaluation);
+        }
+        const double evaluationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<Lexing::Diagnostic> diagnostics;
+        Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, Backend::Optimizations());
+        delete tree;
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+            std::cout << "The program does not compile\n";
+            break;
+        }
+
+        const std::string base = (root / (evaluate ? "evaluated" : "computed")).string();
+        Backend::EmitStats stats;
+        {
+            std::ofstream output(base + ".s");
+            Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+        }
+        if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+            std::cout << "Assembling failed\n";
+            break;
+        }
+
+        // Best of three runs
+        double bestMs = 1e30;
+        int exitCode = -1;
+        for(int32_t i = 0; i < 3; i ++) {
+            auto runStart = std::chrono::steady_clock::now();
+            int status = std::system(base.c_str());
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count());
+            exitCode = WEXITSTATUS(status);
+        }
+        std::cout << (evaluate ? "evaluated while compiling" : "computed at startup") << ": " << evaluation.evaluatedCalls << " calls replaced, "
+            << evaluation.memoizedCalls << " memoized, " << evaluation.steps << " steps in " << evaluationMs << " ms, run "
+            << bestMs << " ms, exit code " << exitCode << "\n";
+    }
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Runtime/Scheduler.h"
+
+// Script instances waiting on simulated I/O: every instance sends requests over a pipe to a server task
+// which echoes them back over another pipe. Instances share the pipes of their channel, so a hundred
+// thousand of them fit in the descriptor limit, and wait for their reply suspended in the event loop.
+const int32_t ROUNDS = 4;
+const int32_t CHANNELS_PER_LOOP = 1024;
+const size_t MESSAGE_BYTES = 8;
+
+// Loops of at most this many threads keep the pipes below the usual descriptor limits
+const size_t MAX_THREADS = 4;
+
+static std::atomic<int64_t> allocatedBytes(0);
+
+void *operator new(const size_t size) {
+    allocatedBytes += (int64_t)size;
+    if(void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+class Channel {
+public:
+    int requests[2];
+    int replies[2];
+    int64_t messages = 0;
+};
+
+static Runtime::Task instance(Runtime::EventLoop &loop, Channel &channel, int64_t &completed) {
+    for(int32_t i = 0; i < ROUNDS; i ++) {
+        uint64_t message = i;
+        if(co_await loop.write(channel.requests[1], &message, MESSAGE_BYTES) != (ssize_t)MESSAGE_BYTES) {
+            co_return;
+        }
+        if(co_await loop.read(channel.replies[0], &message, MESSAGE_BYTES) != (ssize_t)MESSAGE_BYTES) {
+            co_return;
+        }
+    }
+    completed ++;
+}
+
+// Requests are whole messages, so echoing whatever arrived keeps replies whole too
+static Runtime::Task server(Runtime::EventLoop &loop, Channel &channel) {
+    char buffer[4096];
+    int64_t left = channel.messages * MESSAGE_BYTES;
+    while(left > 0) {
+        const ssize_t count = co_await loop.read(channel.requests[0], buffer, sizeof(buffer));
+        if(count <= 0 || co_await loop.write(channel.replies[1], buffer, count) != count) {
+            co_return;
+        }
+        left -= count;
+    }
+}
+
+// Run instances on one loop, returns the instances which finished every round
+static int64_t runLoop(const int64_t instances, Runtime::SchedulerStats &stats, int64_t &frameBytes) {
+    Runtime::EventLoop loop;
+    std::vector<Channel> channels(std::min<int64_t>(CHANNELS_PER_LOOP, instances));
+    for(auto &it : channels) {
+        if(pipe2(it.requests, O_NONBLOCK) != 0 || pipe2(it.replies, O_NONBLOCK) != 0) {
+            std::cout << "Cannot create pipes\n";
+            return 0;
+        }
+    }
+    int64_t completed = 0;
+    const int64_t before = allocatedBytes;
+    for(int64_t i = 0; i < instances; i ++) {
+        Channel &channel = channels[i % channels.size()];
+        channel.messages += ROUNDS;
+        loop.spawn(instance(loop, channel, completed));
+    }
+    frameBytes = allocatedBytes - before;
+    for(auto &it : channels) {
+        loop.spawn(server(loop, it));
+    }
+    std::string error;
+    if(!loop.run(error)) {
+        std::cout << error << "\n";
+    }
+    for(auto &it : channels) {
+        for(const int fd : {it.requests[0], it.requests[1], it.replies[0], it.replies[1]}) {
+            loop.close(fd);
+        }
+    }
+    stats = loop.stats;
+    return completed;
+}
+
+static void measure(const int64_t instances, const size_t threads) {
+    std::vector<Runtime::SchedulerStats> stats(threads);
+    std::vector<int64_t> completed(threads), frameBytes(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < threads; i ++) {
+        workers.emplace_back([&, i]() {
+            completed[i] = runLoop(instances / threads, stats[i], frameBytes[i]);
+        });
+    }
+    for(auto &it : workers) {
+        it.join();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t done = 0, suspensions = 0, waits = 0, bytes = 0, peak = 0;
+    for(size_t i = 0; i < threads; i ++) {
+        done += completed[i];
+        suspensions += stats[i].suspensions;
+        waits += stats[i].waits;
+        bytes += frameBytes[i];
+        peak += stats[i].peakTasks;
+    }
+    std::cout << instances << " instances on " << threads << " thread(s): " << done << " finished in " << ms << " ms, "
+        << done * ROUNDS / ms / 1000 << " M round trips/s, " << peak << " tasks at once, " << bytes / instances
+        << " bytes per suspended instance, " << suspensions << " suspensions, " << waits << " epoll waits\n";
+}
+
+int main() {
+    for(const int64_t instances : {1000, 10000, 100000}) {
+        measure(instances, 1);
+    }
+    const size_t threads = std::min<size_t>(MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+    for(size_t i = 2; i <= threads; i *= 2) {
+        measure(100000, i);
+    }
+    std::cout << "a blocking thread per instance would reserve 8 MB of stack each\n";
+}
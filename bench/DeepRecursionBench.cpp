@@ -0,0 +1,113 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Recursion 10 million frames deep, run with a process stack far too small to hold it. Calls in tail
+// position take no stack with tail calls on, the others run on the stack the generated main maps.
+const int64_t FRAMES = 10000000;
+
+// Stack limit of the process running the generated code
+const rlim_t NATIVE_STACK_BYTES = 256 * 1024;
+
+const std::string PROGRAM = R"({
+    function depth(n : int) : int {
+        if n == 0 { return 0; }
+        return 1 + depth(n - 1);
+    }
+    function sumTo(n : int, total : int) : int {
+        if n == 0 { return total; }
+        return sumTo(n - 1, total + n);
+    }
+    function isEven(n : int) : bool {
+        if n == 0 { return true; }
+        return isOdd(n - 1);
+    }
+    function isOdd(n : int) : bool {
+        if n == 0 { return false; }
+        return isEven(n - 1);
+    }
+    return )";
+
+const std::pair<std::string, std::string> CASES[] = {
+    {"non tail recursion", "depth(" + std::to_string(FRAMES) + ") & 255;\n}"},
+    {"self tail recursion", "sumTo(" + std::to_string(FRAMES) + ", 0) & 255;\n}"},
+    {"mutual tail recursion", "isEven(" + std::to_string(FRAMES) + ");\n}"}
+};
+
+// Run the program with the small stack, getting its exit code and the most memory it held
+static double run(const std::string &path, int &exitCode, long &maxRssKb) {
+    auto start = std::chrono::steady_clock::now();
+    const pid_t child = fork();
+    if(child == 0) {
+        const rlimit limit = {NATIVE_STACK_BYTES, NATIVE_STACK_BYTES};
+        setrlimit(RLIMIT_STACK, &limit);
+        execl(path.c_str(), path.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    rusage usage = {};
+    wait4(child, &status, 0, &usage);
+    exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    maxRssKb = usage.ru_maxrss;
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-recursion-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    for(const auto &[name, entry] : CASES) {
+        Lexing::Lexer lexer(PROGRAM + entry);
+        Lexing::Lexer::setupBasicLexer(lexer);
+        lexer.lex();
+        Parsing::Parser parser(lexer.lexed);
+        Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+        for(const bool tailCalls : {false, true}) {
+            Backend::Optimizations optimizations;
+            optimizations.tailCalls = tailCalls;
+            std::vector<Lexing::Diagnostic> diagnostics;
+            Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+            if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+                std::cout << "The program does not compile\n";
+                break;
+            }
+
+            const std::string base = (root / (tailCalls ? "tail" : "calls")).string();
+            Backend::EmitStats stats;
+            {
+                std::ofstream output(base + ".s");
+                Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+            }
+            if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+                std::cout << "Assembling failed\n";
+                break;
+            }
+
+            // Best of three runs
+            double bestMs = 1e30;
+            int exitCode = -1;
+            long maxRssKb = 0;
+            for(int32_t i = 0; i < 3; i ++) {
+                bestMs = std::min(bestMs, run(base, exitCode, maxRssKb));
+            }
+            std::cout << name << (tailCalls ? ", tail calls: " : ", calls: ") << bestMs << " ms, " << FRAMES / bestMs / 1000
+                << " M frames/s, " << maxRssKb / 1024 << " MB resident, exit code " << exitCode << "\n";
+        }
+        delete tree;
+    }
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Embedding.h"
+
+// Requests of a service answered by a script: compiled once and called in process for every request,
+// against running the compiler, the assembler and the program for every request as a shell script would
+const int64_t IN_PROCESS_REQUESTS = 1000000;
+const int64_t SHELL_REQUESTS = 20;
+
+const std::string HANDLER = R"({
+    function handle(request : int, tier : int) : int {
+        let score : int = request % 97;
+        for let i : int = 0; i < 16; i += 1 {
+            score = (score * 31 + tier + i) % 1009;
+        }
+        return score;
+    }
+)";
+
+int main() {
+    std::vector<Lexing::Diagnostic> diagnostics;
+    std::string error;
+    Embedding::CompileContext context;
+    auto start = std::chrono::steady_clock::now();
+    auto program = context.compile(HANDLER + "}", diagnostics, error);
+    const double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if(!program) {
+        for(const auto &it : diagnostics) {
+            std::cout << it;
+        }
+        std::cout << error << "\n";
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for(int64_t i = 0; i < IN_PROCESS_REQUESTS; i ++) {
+        int64_t result = 0;
+        program->call("handle", {i, i & 3}, result, error);
+        checksum += result;
+    }
+    const double callMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "compiled once in " << compileMs << " ms, " << IN_PROCESS_REQUESTS << " requests in " << callMs << " ms, "
+        << callMs * 1e6 / IN_PROCESS_REQUESTS << " ns per request, checksum " << checksum << "\n";
+
+    // Every request becomes a program whose exit code is its answer
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-embedding-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const std::string base = (root / "request").string();
+    start = std::chrono::steady_clock::now();
+    int64_t shellChecksum = 0, expected = 0;
+    for(int64_t i = 0; i < SHELL_REQUESTS; i ++) {
+        {
+            std::ofstream output(base + ".xcpp");
+            output << HANDLER << "    return handle(" << i << ", " << (i & 3) << ");\n}\n";
+        }
+        const int status = std::system(("./compiler " + base + ".xcpp --emit-asm " + base + ".s && gcc -o " + base + " " + base + ".s && " + base).c_str());
+        shellChecksum += WEXITSTATUS(status);
+        int64_t result = 0;
+        program->call("handle", {i, i & 3}, result, error);
+        expected += result & 255;
+    }
+    const double shellMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "shelling out: " << SHELL_REQUESTS << " requests in " << shellMs << " ms, " << shellMs / SHELL_REQUESTS
+        << " ms per request, " << (shellChecksum == expected ? "same answers" : "different answers") << "\n";
+    std::filesystem::remove_all(root);
+}
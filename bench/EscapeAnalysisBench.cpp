@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Native cost of short lived local arrays, every one allocated on the heap against the ones escape
+// analysis proves dead at the end of their scope placed in the frame
+const int64_t ITERATIONS = 1000000;
+
+// Arrays declared in every iteration, each one declaration runs once
+const int64_t ARRAYS_PER_ITERATION = 2;
+
+const std::string PROGRAM = R"({
+    function dot(x : int[], y : int[]) : int {
+        let total : int = 0;
+        for let i : int = 0; i < 4; i += 1 {
+            total += x[i] * y[i];
+        }
+        return total;
+    }
+    function window(seed : int) : int {
+        let w : int[4];
+        let v : int = seed;
+        for let i : int = 0; i < 4; i += 1 {
+            v = v * 6364136223846793005 + 1442695040888963407;
+            w[i] = (v / 65536) & 255;
+        }
+        return dot(w, w);
+    }
+    function run(n : int) : int {
+        let total : int = 0;
+        for let i : int = 0; i < n; i += 1 {
+            let pair : int[4];
+            pair[i & 3] = i;
+            total = (total + window(i) + dot(pair, pair)) & 16777215;
+        }
+        return total;
+    }
+    return run()" + std::to_string(ITERATIONS) + R"() & 255;
+})";
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-escape-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+    for(const bool escapes : {false, true}) {
+        Backend::Optimizations optimizations;
+        optimizations.escapes = escapes;
+        std::vector<Lexing::Diagnostic> diagnostics;
+        Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+            std::cout << "The program does not compile\n";
+            break;
+        }
+        int32_t heapSites = 0, frameSites = 0;
+        for(const auto &function : program.functions) {
+            for(const auto &block : function.blocks) {
+                for(const auto &it : block.instructions) {
+                    heapSites += it.opcode == Backend::Opcode::NEW;
+                    frameSites += it.opcode == Backend::Opcode::ALLOCATE;
+                }
+            }
+        }
+
+        const std::string base = (root / (escapes ? "placed" : "heap")).string();
+        Backend::EmitStats stats;
+        {
+            std::ofstream output(base + ".s");
+            Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+        }
+        if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+            std::cout << "Assembling failed\n";
+            break;
+        }
+
+        // Best of three runs, the peak memory of the last one
+        double bestMs = 1e30;
+        int exitCode = -1;
+        long peakKb = 0;
+        for(int32_t i = 0; i < 3; i ++) {
+            auto start = std::chrono::steady_clock::now();
+            const pid_t child = fork();
+            if(child == 0) {
+                execl(base.c_str(), base.c_str(), (char*)nullptr);
+                _exit(127);
+            }
+            int status = 0;
+            struct rusage usage = {};
+            wait4(child, &status, 0, &usage);
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            exitCode = WEXITSTATUS(status);
+            peakKb = usage.ru_maxrss;
+        }
+        // Both declarations run once per iteration and are placed together or not at all, the peak memory shows which
+        const int64_t heapAllocations = heapSites == 0 ? 0 : ITERATIONS * ARRAYS_PER_ITERATION;
+        std::cout << (escapes ? "escape analysis" : "heap arrays") << ": " << heapSites << " heap sites, " << frameSites << " frame sites, "
+            << heapAllocations << " heap allocations, " << bestMs << " ms, " << peakKb / 1024 << " MB peak, exit code " << exitCode << "\n";
+    }
+    delete tree;
+    std::filesystem::remove_all(root);
+}
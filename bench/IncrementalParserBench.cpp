@@ -0,0 +1,99 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <random>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "IncrementalParser.h"
+
+// Measures a full lex and parse of a ~1 MB source against single character edits applied incrementally
+int main() {
+    std::string code = "{\n";
+    std::vector<int32_t> digits;
+    while(code.size() < (1 << 20)) {
+        code += "    a = b + 10 * f(x, 2);\n";
+        digits.push_back((int32_t)code.size() - 4);
+        code += "    if a < 3 { b = b - 1; } else do print(a);\n";
+        code += "    let memo : u32 = a * b;\n";
+    }
+    code += "}\n";
+
+    auto start = std::chrono::steady_clock::now();
+    Parsing::IncrementalParser incremental(code);
+    double fullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::mt19937 rng(42);
+    const int32_t edits = 200;
+    double totalMs = 0, worstMs = 0;
+    for(int32_t i = 0; i < edits; i ++) {
+        int32_t at = digits[rng() % digits.size()];
+        std::string digit(1, (char)('1' + rng() % 9));
+        code.replace(at, 1, digit);
+
+        start = std::chrono::steady_clock::now();
+        incremental.applyEdit(Lexing::TextEdit(at, 1, digit));
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+    }
+
+    // Statement insertions change the token count and shift everything after them
+    double insertMs = 0;
+    for(int32_t i = 0; i < edits; i ++) {
+        int32_t at = (int32_t)code.find('\n', rng() % (code.size() - 4)) + 1;
+        std::string statement = "    c = c + 1;\n";
+        code.insert(at, statement);
+
+        start = std::chrono::steady_clock::now();
+        incremental.applyEdit(Lexing::TextEdit(at, 0, statement));
+        insertMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Strings spanning lines move the lines of the tokens after them, a stray character is a lexer error
+    // until it is removed again
+    for(int32_t i = 0; i < 20; i ++) {
+        int32_t at = (int32_t)code.find('\n', rng() % (code.size() - 4)) + 1;
+        const std::string statement = i % 2 ? "    let s : string = \"two\nlines\";\n" : "    $\n";
+        code.insert(at, statement);
+        incremental.applyEdit(Lexing::TextEdit(at, 0, statement));
+        if(i % 2 == 0 && i % 4 != 0) {
+            code.erase(at, statement.size());
+            incremental.applyEdit(Lexing::TextEdit(at, (int32_t)statement.size(), ""));
+        }
+    }
+
+    // The incrementally maintained tokens, errors and tree have to match the ones made from scratch
+    Parsing::IncrementalParser scratch(code);
+    std::stringstream incrementalOut, scratchOut;
+    for(const auto &it : incremental.getTokens()) {
+        incrementalOut << it.offset << " " << it;
+    }
+    for(const auto &it : scratch.getTokens()) {
+        scratchOut << it.offset << " " << it;
+    }
+    for(const auto &it : incremental.getDiagnostics()) {
+        incrementalOut << it;
+    }
+    for(const auto &it : scratch.getDiagnostics()) {
+        scratchOut << it;
+    }
+    incrementalOut << *incremental.getRoot();
+    scratchOut << *scratch.getRoot();
+    for(auto it : dynamic_cast<Grammar::StatementList*>(incremental.getRoot())->list) {
+        incrementalOut << it->lineNmb << " ";
+    }
+    for(auto it : dynamic_cast<Grammar::StatementList*>(scratch.getRoot())->list) {
+        scratchOut << it->lineNmb << " ";
+    }
+
+    std::cout << "source bytes:          " << code.size() << "\n";
+    std::cout << "full lex + parse:      " << fullMs << " ms\n";
+    std::cout << "single char edit mean: " << totalMs / edits << " ms\n";
+    std::cout << "single char edit max:  " << worstMs << " ms\n";
+    std::cout << "statement insert mean: " << insertMs / edits << " ms\n";
+    std::cout << "matches full reparse:  " << (incrementalOut.str() == scratchOut.str() ? "yes" : "NO") << "\n";
+    return incrementalOut.str() == scratchOut.str() ? 0 : 1;
+}
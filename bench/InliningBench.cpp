@@ -0,0 +1,91 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Native throughput of code made of small function calls, with every call going through call and ret
+// against calls replaced by the body of the callee
+const int64_t ITERATIONS = 20000000;
+
+// Calls made by the source in every iteration, the ones nested in inlined calls included
+const int64_t CALLS_PER_ITERATION = 5;
+
+const std::string PROGRAM = R"({
+    function square(x : int) : int {
+        return x * x;
+    }
+    function clamp(x : int, low : int, high : int) : int {
+        if x < low { return low; }
+        if x > high { return high; }
+        return x;
+    }
+    function mix(a : int, b : int) : int {
+        return (square(a & 1023) ^ b) + clamp(b, 0, 4095);
+    }
+    function run(n : int) : int {
+        let total : int = 0;
+        for let i : int = 0; i < n; i += 1 {
+            total = mix(i, total) & 65535;
+            total += square(i & 7);
+        }
+        return total;
+    }
+    return run()" + std::to_string(ITERATIONS) + R"() & 255;
+})";
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-inlining-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+    for(const bool inlining : {false, true}) {
+        Backend::Optimizations optimizations;
+        optimizations.inlining = inlining;
+        std::vector<Lexing::Diagnostic> diagnostics;
+        Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+            std::cout << "The program does not compile\n";
+            break;
+        }
+
+        const std::string base = (root / (inlining ? "inlined" : "called")).string();
+        Backend::EmitStats stats;
+        {
+            std::ofstream output(base + ".s");
+            Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+        }
+        if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+            std::cout << "Assembling failed\n";
+            break;
+        }
+
+        // Best of three runs
+        double bestMs = 1e30;
+        int exitCode = -1;
+        for(int32_t i = 0; i < 3; i ++) {
+            auto start = std::chrono::steady_clock::now();
+            int status = std::system(base.c_str());
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            exitCode = WEXITSTATUS(status);
+        }
+        std::cout << (inlining ? "inlined calls" : "called functions") << ": " << stats.instructions << " instructions, "
+            << bestMs << " ms, " << CALLS_PER_ITERATION * ITERATIONS / bestMs / 1000 << " M calls/s, exit code " << exitCode << "\n";
+    }
+    delete tree;
+    std::filesystem::remove_all(root);
+}
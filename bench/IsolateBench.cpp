@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "Isolate.h"
+
+// Independent script instances on isolates sharing one compiled program: the host sends every isolate
+// its requests and collects the replies, so each queue has one producer and one consumer
+const int64_t MESSAGES_PER_ISOLATE = 200000;
+const size_t QUEUE_CAPACITY = 1024;
+
+const std::string SOURCE = R"({
+    let limit : int = 1009;
+
+    function score(request : int, tier : int) : int {
+        let value : int = request % 97;
+        for let i : int = 0; i < 64; i += 1 {
+            value = (value * 31 + tier + i) % limit;
+        }
+        return value;
+    }
+
+    function count(request : int) : int {
+        limit += 1;
+        return limit;
+    }
+})";
+
+static double measure(const Embedding::Program &program, const size_t count, const double singleRate) {
+    std::vector<std::unique_ptr<Embedding::Isolate> > isolates;
+    std::string error;
+    for(size_t i = 0; i < count; i ++) {
+        isolates.push_back(Embedding::Isolate::start(program, "score", QUEUE_CAPACITY, error));
+        if(!isolates.back()) {
+            std::cout << error << "\n";
+            return 0;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int64_t> sent(count, 0), received(count, 0);
+    int64_t checksum = 0, done = 0;
+    const int64_t total = MESSAGES_PER_ISOLATE * (int64_t)count;
+    while(done < total) {
+        const int64_t before = done;
+        for(size_t i = 0; i < count; i ++) {
+            Embedding::Message message;
+            while(sent[i] < MESSAGES_PER_ISOLATE) {
+                message.id = sent[i];
+                message.values[0] = sent[i];
+                message.values[1] = sent[i] & 3;
+                if(!isolates[i]->send(message)) {
+                    break;
+                }
+                sent[i] ++;
+            }
+            while(isolates[i]->receive(message)) {
+                checksum += message.values[0];
+                received[i] ++;
+                done ++;
+            }
+        }
+        if(done == before) {
+            std::this_thread::yield();
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t idle = 0, full = 0;
+    for(auto &it : isolates) {
+        it->stop();
+        idle += it->stats.idleYields;
+        full += it->stats.fullYields;
+    }
+    const double rate = total / ms / 1000;
+    std::cout << count << " isolate(s): " << total << " messages in " << ms << " ms, " << rate << " M messages/s, "
+        << (singleRate > 0 ? rate / singleRate : 1.0) << "x one isolate, " << idle << " idle and " << full
+        << " full yields, checksum " << checksum << "\n";
+    return rate;
+}
+
+int main() {
+    std::vector<Lexing::Diagnostic> diagnostics;
+    std::string error;
+    Embedding::CompileContext context;
+    auto program = context.compile(SOURCE, diagnostics, error);
+    if(!program) {
+        for(const auto &it : diagnostics) {
+            std::cout << it;
+        }
+        std::cout << error << "\n";
+        return 1;
+    }
+    // Isolates read the globals the top level statements set
+    int64_t result = 0;
+    if(!program->run(result, error)) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    if(!Embedding::Isolate::start(*program, "count", QUEUE_CAPACITY, error)) {
+        std::cout << "count is not run in isolates: " << error << "\n";
+    }
+
+    // A single isolate sets the rate every other count is compared to
+    const double singleRate = measure(*program, 1, 0);
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for(size_t i = 2; i <= cores; i *= 2) {
+        measure(*program, i, singleRate);
+    }
+    std::cout << cores << " core(s), the host thread shares them with the isolates\n";
+}
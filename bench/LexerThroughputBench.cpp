@@ -0,0 +1,38 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "Lexer.h"
+
+// Lexing throughput on pure ASCII source and on source with UTF-8 identifiers and strings
+double megabytesPerSecond(const std::string &code, size_t &tokens) {
+    Lexing::Lexer lexer(code);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    double best = 0;
+    for(int32_t repeat = 0; repeat < 5; repeat ++) {
+        auto start = std::chrono::steady_clock::now();
+        lexer.lex();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, code.size() / seconds / (1 << 20));
+    }
+    tokens = lexer.lexed.size();
+    return best;
+}
+
+int main() {
+    std::string ascii = "{\n", utf8 = "{\n";
+    while(ascii.size() < (8 << 20)) {
+        ascii += "    let counter : u32 = value * 10 + f(x, \"some text here\");\n";
+        ascii += "    if counter >= 100 { print(counter); } else do total = total - 1;\n";
+        utf8 += "    let z\xc3\xa4hler : u32 = wert * 10 + f(x, \"gr\xc3\xbc\xc3\x9f" "e \xe4\xb8\x96\xe7\x95\x8c\");\n";
+        utf8 += "    if z\xc3\xa4hler >= 100 { print(z\xc3\xa4hler); } else do \xce\xb1 = \xce\xb1 - 1;\n";
+    }
+    ascii += "}\n";
+    utf8 += "}\n";
+
+    size_t asciiTokens = 0, utf8Tokens = 0;
+    double asciiSpeed = megabytesPerSecond(ascii, asciiTokens);
+    double utf8Speed = megabytesPerSecond(utf8, utf8Tokens);
+    std::cout << "pure ASCII: " << asciiSpeed << " MB/s, " << asciiTokens << " tokens\n";
+    std::cout << "UTF-8:      " << utf8Speed << " MB/s, " << utf8Tokens << " tokens\n";
+}
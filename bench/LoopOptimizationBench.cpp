@@ -0,0 +1,90 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Native throughput of loop heavy code lowered straight, with the condition tested at the top and
+// a jump back, against rotated loops with invariant code motion, strength reduction and unrolling
+const int64_t ITERATIONS = 50000000;
+
+const std::string PROGRAM = R"({
+    function kernel(n : int, k : int) : int {
+        let total : int = 0;
+        for let i : int = 0; i < n; i += 1 {
+            let scale : int = k * 7 + (k ^ 5);
+            let base : int = i * 24 + scale;
+            for let j : int = 0; j < 4; j += 1 {
+                total += base ^ j * k;
+            }
+            total &= 1073741823;
+        }
+        return total;
+    }
+    function sum(n : int, k : int) : int {
+        let total : int = 0;
+        let i : int = 0;
+        while i < n {
+            total += i * 3 + k * k;
+            i += 1;
+        }
+        return total;
+    }
+    return kernel()" + std::to_string(ITERATIONS) + R"(, 3) + sum()" + std::to_string(ITERATIONS) + R"(, 5) & 255;
+})";
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-loop-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+    for(const bool optimizeLoops : {false, true}) {
+        Backend::Optimizations optimizations;
+        optimizations.loops = optimizeLoops;
+        std::vector<Lexing::Diagnostic> diagnostics;
+        Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+            std::cout << "The program does not compile\n";
+            break;
+        }
+
+        const std::string base = (root / (optimizeLoops ? "optimized" : "straight")).string();
+        Backend::EmitStats stats;
+        {
+            std::ofstream output(base + ".s");
+            Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+        }
+        if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+            std::cout << "Assembling failed\n";
+            break;
+        }
+
+        // Best of three runs
+        double bestMs = 1e30;
+        int exitCode = -1;
+        for(int32_t i = 0; i < 3; i ++) {
+            auto start = std::chrono::steady_clock::now();
+            int status = std::system(base.c_str());
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            exitCode = WEXITSTATUS(status);
+        }
+        std::cout << (optimizeLoops ? "optimized loops" : "straight loops") << ": " << stats.instructions << " instructions, "
+            << bestMs << " ms, " << 2 * ITERATIONS / bestMs / 1000 << " M outer iterations/s, exit code " << exitCode << "\n";
+    }
+    delete tree;
+    std::filesystem::remove_all(root);
+}
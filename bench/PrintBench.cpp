@@ -0,0 +1,77 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <sys/wait.h>
+
+// Numbers written by a compiled program through the print intrinsic, against the same numbers written
+// through std::cout, both to /dev/null so only formatting and buffering are measured
+const int64_t NUMBERS = 100000000;
+const int64_t CHECKED_NUMBERS = 100000;
+
+static std::string source(const int64_t count) {
+    return "{\n    for let i : int = 0; i < " + std::to_string(count) + "; i += 1 {\n        print(i * 7919 - 400000000);\n    }\n}\n";
+}
+
+// Build a program printing count numbers, returns the path of the executable
+static bool build(const std::string &base, const int64_t count) {
+    {
+        std::ofstream output(base + ".xcpp");
+        output << source(count);
+    }
+    return std::system(("./compiler " + base + ".xcpp --emit-asm " + base + ".s && gcc -o " + base + " " + base + ".s").c_str()) == 0;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-print-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const std::string base = (root / "print").string();
+
+    // The program has to write what std::cout writes
+    if(!build(base, CHECKED_NUMBERS)) {
+        std::cout << "Cannot build the program\n";
+        return 1;
+    }
+    std::ostringstream expected;
+    for(int64_t i = 0; i < CHECKED_NUMBERS; i ++) {
+        expected << i * 7919 - 400000000 << '\n';
+    }
+    std::string printed;
+    if(FILE *pipe = popen(base.c_str(), "r")) {
+        char buffer[1 << 16];
+        size_t count;
+        while((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+            printed.append(buffer, count);
+        }
+        pclose(pipe);
+    }
+    std::cout << CHECKED_NUMBERS << " numbers " << (printed == expected.str() ? "printed as std::cout writes them" : "printed differently") << "\n";
+
+    if(!build(base, NUMBERS)) {
+        std::cout << "Cannot build the program\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const int status = std::system((base + " > /dev/null").c_str());
+    const double printMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "print: " << NUMBERS << " numbers in " << printMs << " ms, " << printMs * 1e6 / NUMBERS << " ns per number"
+        << (WEXITSTATUS(status) == 0 ? "" : ", the program failed") << "\n";
+
+    // std::cout writes to /dev/null through a file buffer while it is measured, the report goes to the terminal
+    std::ofstream null("/dev/null");
+    std::streambuf *terminal = std::cout.rdbuf(null.rdbuf());
+    start = std::chrono::steady_clock::now();
+    for(int64_t i = 0; i < NUMBERS; i ++) {
+        std::cout << i * 7919 - 400000000 << '\n';
+    }
+    std::cout.flush();
+    const double streamMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout.rdbuf(terminal);
+    std::cout << "std::cout: " << NUMBERS << " numbers in " << streamMs << " ms, " << streamMs * 1e6 / NUMBERS << " ns per number, "
+        << streamMs / printMs << "x the time of print\n";
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/Profile.h"
+#include "Backend/X86Emitter.h"
+
+// End to end effect of profile guided optimization on an interpreter loop: the program is built, built
+// again with counters and run once to record its profile, then built a third time using the profile
+const int64_t ROUNDS = 8000;
+
+// Operations of the interpreted program, every round runs each of them
+const int64_t OPERATIONS = 4096;
+
+// Most operations take the last test of a sparse chain and the largest handler, too large to be inlined
+// without knowing it is hot
+const std::string PROGRAM = R"({
+    let ops : int[)" + std::to_string(OPERATIONS) + R"(];
+
+    function fill(seed : int) {
+        let v : int = seed;
+        for let i : int = 0; i < )" + std::to_string(OPERATIONS) + R"(; i += 1 {
+            v = v * 6364136223846793005 + 1442695040888963407;
+            let r : int = ((v / 65536) & 1023) % 100;
+            if r < 1 { ops[i] = 11; }
+            else if r < 2 { ops[i] = 202; }
+            else if r < 4 { ops[i] = 3003; }
+            else if r < 7 { ops[i] = 40004; }
+            else { ops[i] = 500005; }
+        }
+    }
+
+    function scramble(x : int, y : int) : int {
+        let a : int = x * 31 + y;
+        let b : int = (a ^ (a & 4080)) * 17;
+        let c : int = (b & 65535) + (y | 3) * 5;
+        let d : int = (c ^ x) - (a & 255);
+        let e : int = d * 9 + (b & 1023);
+        let f : int = (e & 1048575) ^ (c * 3);
+        let g : int = f + (d & 4095) - (y & 7);
+        return (g ^ (e & 61440)) & 16777215;
+    }
+
+    function step(op : int, x : int, y : int) : int {
+        if op == 11 { return x + y; }
+        else if op == 202 { return x ^ (y * 7); }
+        else if op == 3003 { return x - (y & 15); }
+        else if op == 40004 { return scramble(x, y); }
+        else if op == 500005 { return scramble(x ^ y, y & 255); }
+        return 0;
+    }
+
+    function run(n : int) : int {
+        let total : int = 0;
+        for let round : int = 0; round < n; round += 1 {
+            for let i : int = 0; i < )" + std::to_string(OPERATIONS) + R"(; i += 1 {
+                total += step(ops[i], i, round);
+            }
+        }
+        return total;
+    }
+
+    fill(12345);
+    return run()" + std::to_string(ROUNDS) + R"() % 251;
+})";
+
+// Build the program and run it, the best of three runs when timed
+static bool buildAndRun(const Grammar::Statement *tree, const Backend::Optimizations &optimizations, const std::string &base,
+    const int32_t runs, double &bestMs, int &exitCode) {
+    std::vector<Lexing::Diagnostic> diagnostics;
+    Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+    if(!diagnostics.empty()) {
+        std::cout << "The program does not compile\n";
+        return false;
+    }
+    Backend::EmitStats stats;
+    {
+        std::ofstream output(base + ".s");
+        Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+    }
+    if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+        std::cout << "Assembling failed\n";
+        return false;
+    }
+    bestMs = 1e30;
+    for(int32_t i = 0; i < runs; i ++) {
+        auto start = std::chrono::steady_clock::now();
+        int status = std::system(base.c_str());
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        exitCode = WEXITSTATUS(status);
+    }
+    return true;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-profile-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Lexing::Lexer lexer(PROGRAM);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+    if(!lexer.diagnostics.empty() || !parser.diagnostics.empty()) {
+        std::cout << "The program does not parse\n";
+        delete tree;
+        return 1;
+    }
+
+    double baselineMs = 0, instrumentedMs = 0, guidedMs = 0;
+    int baselineExit = -1, instrumentedExit = -1, guidedExit = -1;
+    Backend::Optimizations instrumented;
+    instrumented.instrument = (root / "run.profile").string();
+    Backend::Profile profile;
+    std::string error;
+    if(buildAndRun(tree, Backend::Optimizations(), (root / "baseline").string(), 3, baselineMs, baselineExit)
+        && buildAndRun(tree, instrumented, (root / "instrumented").string(), 1, instrumentedMs, instrumentedExit)) {
+        if(!Backend::Profile::read(instrumented.instrument, profile, error)) {
+            std::cout << error << "\n";
+        } else {
+            Backend::Optimizations guided;
+            guided.profile = &profile;
+            if(buildAndRun(tree, guided, (root / "guided").string(), 3, guidedMs, guidedExit)) {
+                const double operations = (double)ROUNDS * OPERATIONS;
+                std::cout << "baseline: " << baselineMs << " ms, " << operations / baselineMs / 1000 << " M operations/s, exit code " << baselineExit << "\n";
+                std::cout << "instrumented: " << instrumentedMs << " ms, " << profile.counters.size() << " counters, exit code " << instrumentedExit << "\n";
+                std::cout << "profile guided: " << guidedMs << " ms, " << operations / guidedMs / 1000 << " M operations/s, exit code " << guidedExit << "\n";
+                std::cout << "speedup: " << baselineMs / guidedMs << "x\n";
+            }
+        }
+    }
+    delete tree;
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Code generated with linear scan allocation against every virtual register in a stack slot, for a
+// call heavy recursion and for a function keeping more values live than there are registers
+const std::string CALLS = R"({
+    function mix(a : int, b : int, c : int) : int {
+        let x : int = a * 3 + b * 5 - c;
+        let y : int = (x ^ a) + (b & c) * 7 - (a | 1);
+        let z : int = (x * y & 1048575) + ((x - y) * (a + c) & 127);
+        let w : int = ((z + x) * (y - a) & 65535) + z * 3;
+        return (w ^ x & 1048575) + y - z;
+    }
+    function walk(n : int, seed : int) : int {
+        if n < 2 { return mix(seed, n, seed + 7); }
+        let left : int = walk(n - 1, seed * 3 + 1);
+        let right : int = walk(n - 2, seed + left % 17);
+        return left + right + mix(left, right, n) & 1073741823;
+    }
+    return walk(30, 1) % 256;
+})";
+
+const std::string PRESSURE = R"({
+    function pressure(a : int, b : int, c : int, d : int) : int {
+        let t1 : int = a * b; let t2 : int = b * c; let t3 : int = c * d; let t4 : int = d * a;
+        let t5 : int = t1 + t2; let t6 : int = t2 - t3; let t7 : int = t3 ^ t4; let t8 : int = t4 | t1;
+        let t9 : int = t5 * 3; let t10 : int = t6 * 5; let t11 : int = t7 & 1023; let t12 : int = t8 & 4095;
+        let t13 : int = t9 - a; let t14 : int = t10 + b; let t15 : int = t11 ^ c; let t16 : int = t12 - d;
+        return (t1 + t2 + t3 + t4 + t5 + t6 + t7 + t8 & 1048575) + (t9 ^ t10 ^ t11 ^ t12 & 8191)
+            + (t13 * t14 & 65535) + (t15 - t16 & 127) + (t1 * t16 & 31) + (t8 * t13 & 15);
+    }
+    function loop(n : int, acc : int) : int {
+        if n == 0 { return acc; }
+        return loop(n - 1, acc + pressure(n, acc & 1023, n ^ acc, n & 63) & 1073741823);
+    }
+    function repeat(times : int, acc : int) : int {
+        if times == 0 { return acc; }
+        return repeat(times - 1, loop(40000, acc));
+    }
+    return repeat(200, 1) % 256;
+})";
+
+void measure(const std::string &name, const std::string &code, const std::filesystem::path &root) {
+    Lexing::Lexer lexer(code);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+    std::vector<Lexing::Diagnostic> diagnostics;
+    Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics);
+    delete tree;
+    if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+        std::cout << name << ": does not compile\n";
+        return;
+    }
+
+    const std::pair<Backend::AllocatorKind, std::string> allocators[] = {
+        {Backend::AllocatorKind::STACK_SLOTS, "stack slots"}, {Backend::AllocatorKind::LINEAR_SCAN, "linear scan"}
+    };
+    for(const auto &[allocator, allocatorName] : allocators) {
+        const std::filesystem::path base = root / (name + "-" + std::to_string(allocator));
+        Backend::EmitStats stats;
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ofstream output(base.string() + ".s");
+            Backend::emitProgram(output, program, allocator, stats);
+        }
+        double emitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(std::system(("gcc -o " + base.string() + " " + base.string() + ".s").c_str()) != 0) {
+            std::cout << name << ": assembling failed\n";
+            return;
+        }
+
+        // Best of three runs
+        double bestMs = 1e30;
+        int exitCode = -1;
+        for(int32_t i = 0; i < 3; i ++) {
+            start = std::chrono::steady_clock::now();
+            int status = std::system(base.string().c_str());
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            exitCode = WEXITSTATUS(status);
+        }
+        std::cout << name << " with " << allocatorName << ": " << stats.instructions << " instructions, "
+            << stats.spilledVregs << "/" << stats.vregs << " vregs spilled, " << stats.coalescedMoves << " moves coalesced, "
+            << "emitted in " << emitMs << " ms, runs in " << bestMs << " ms, exit code " << exitCode << "\n";
+    }
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-regalloc-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    measure("calls", CALLS, root);
+    measure("pressure", PRESSURE, root);
+    std::filesystem::remove_all(root);
+}
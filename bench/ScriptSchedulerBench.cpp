@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Embedding.h"
+#include "ScriptScheduler.h"
+#include "Runtime/Scheduler.h"
+
+// Compiled scripts waiting on simulated I/O: every instance writes a byte to the request pipe of its
+// channel and reads the echo of a server task from the reply pipe, suspended in read while the reply is
+// on its way. Instances share the pipes of their channel, as in CoroutineSchedulerBench.
+const int64_t ROUNDS = 4;
+const int32_t CHANNELS_PER_LOOP = 1024;
+const size_t MAX_THREADS = 4;
+
+const std::string SCRIPT = R"({
+    function instance(requests : int, replies : int, rounds : int) : int {
+        let done : int = 0;
+        while done < rounds {
+            if write(requests, done) != 1 do return -1;
+            if read(replies) == -1 do return -1;
+            done += 1;
+        }
+        return done;
+    }
+})";
+
+class Channel {
+public:
+    int requests[2];
+    int replies[2];
+    int64_t messages = 0;
+};
+
+static Runtime::Task server(Runtime::EventLoop &loop, Channel &channel) {
+    char buffer[4096];
+    int64_t left = channel.messages;
+    while(left > 0) {
+        const ssize_t count = co_await loop.read(channel.requests[0], buffer, sizeof(buffer));
+        if(count <= 0 || co_await loop.write(channel.replies[1], buffer, count) != count) {
+            co_return;
+        }
+        left -= count;
+    }
+}
+
+// Run instances on one loop, returns the instances which finished every round
+static int64_t runLoop(const Embedding::Function &function, const int64_t instances, Embedding::ScriptStats &stats) {
+    Runtime::EventLoop loop;
+    Embedding::ScriptScheduler scheduler(loop);
+    std::vector<Channel> channels(std::min<int64_t>(CHANNELS_PER_LOOP, instances));
+    for(auto &it : channels) {
+        if(pipe2(it.requests, O_NONBLOCK) != 0 || pipe2(it.replies, O_NONBLOCK) != 0) {
+            std::cout << "Cannot create pipes\n";
+            return 0;
+        }
+    }
+    std::vector<int64_t> results(instances, 0);
+    std::string error;
+    for(int64_t i = 0; i < instances; i ++) {
+        Channel &channel = channels[i % channels.size()];
+        channel.messages += ROUNDS;
+        if(!scheduler.spawn(function, {channel.requests[1], channel.replies[0], ROUNDS}, results[i], error)) {
+            std::cout << error << "\n";
+            return 0;
+        }
+    }
+    for(auto &it : channels) {
+        loop.spawn(server(loop, it));
+    }
+    if(!loop.run(error)) {
+        std::cout << error << "\n";
+    }
+    for(auto &it : channels) {
+        for(const int fd : {it.requests[0], it.requests[1], it.replies[0], it.replies[1]}) {
+            loop.close(fd);
+        }
+    }
+    stats = scheduler.stats;
+    int64_t completed = 0;
+    for(const auto it : results) {
+        completed += it == ROUNDS;
+    }
+    return completed;
+}
+
+static bool measure(const Embedding::Function &function, const int64_t instances, const size_t threads) {
+    std::vector<Embedding::ScriptStats> stats(threads);
+    std::vector<int64_t> completed(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < threads; i ++) {
+        workers.emplace_back([&, i]() {
+            completed[i] = runLoop(function, instances / threads, stats[i]);
+        });
+    }
+    for(auto &it : workers) {
+        it.join();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t done = 0, suspensions = 0, peak = 0;
+    for(size_t i = 0; i < threads; i ++) {
+        done += completed[i];
+        suspensions += stats[i].suspensions;
+        peak += stats[i].peakSavedBytes;
+    }
+    std::cout << instances << " scripts on " << threads << " thread(s): " << done << " finished in " << ms << " ms, "
+        << done * ROUNDS / ms / 1000 << " M round trips/s, " << suspensions << " suspensions, " << peak / instances
+        << " bytes of stack kept per suspended script\n";
+    return done == instances;
+}
+
+int main() {
+    std::vector<Lexing::Diagnostic> diagnostics;
+    std::string error;
+    Embedding::CompileContext context;
+    auto program = context.compile(SCRIPT, diagnostics, error);
+    if(!program) {
+        for(const auto &it : diagnostics) {
+            std::cout << it;
+        }
+        std::cout << error << "\n";
+        return 1;
+    }
+    const Embedding::Function &function = *program->function("instance");
+
+    bool finished = true;
+    for(const int64_t instances : {1000, 10000, 100000}) {
+        finished = measure(function, instances, 1) && finished;
+    }
+    const size_t threads = std::min<size_t>(MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+    for(size_t i = 2; i <= threads; i *= 2) {
+        finished = measure(function, 100000, i) && finished;
+    }
+    return finished ? 0 : 1;
+}
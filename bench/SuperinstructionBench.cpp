@@ -0,0 +1,141 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/Profile.h"
+#include "Backend/Peephole.h"
+#include "Backend/X86Emitter.h"
+
+// Pairs of dependent instructions the native code, profile guided and sampling tests run, counted with
+// the profile of an instrumented run of each. The most frequent pairs are the superinstructions of
+// fuseInstructions, the report shows the instructions they save and the time of the programs.
+const std::string SUITE = "test-suite/input";
+const std::vector<std::string> PREFIXES = {"NC-", "PGO-", "SP-"};
+const size_t REPORTED_PAIRS = 10;
+
+// Build the program and run it, the best of the runs when timed
+static bool buildAndRun(const Grammar::Statement *tree, const Backend::Optimizations &optimizations, const std::string &base,
+    const int32_t runs, double &bestMs, int64_t &instructions, int &exitCode) {
+    std::vector<Lexing::Diagnostic> diagnostics;
+    Backend::Program program = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+    if(!diagnostics.empty()) {
+        return false;
+    }
+    Backend::EmitStats stats;
+    {
+        std::ofstream output(base + ".s");
+        Backend::emitProgram(output, program, Backend::AllocatorKind::LINEAR_SCAN, stats);
+    }
+    if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+        return false;
+    }
+    instructions = stats.instructions;
+    bestMs = 1e30;
+    for(int32_t i = 0; i < runs; i ++) {
+        auto start = std::chrono::steady_clock::now();
+        const int status = std::system((base + " > /dev/null").c_str());
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        exitCode = WEXITSTATUS(status);
+    }
+    return true;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-superinstruction-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const std::string base = (root / "program").string();
+
+    std::vector<std::filesystem::path> sources;
+    for(const auto &it : std::filesystem::directory_iterator(SUITE)) {
+        const std::string name = it.path().filename().string();
+        if(std::any_of(PREFIXES.begin(), PREFIXES.end(), [&](const std::string &prefix) { return name.rfind(prefix, 0) == 0; })) {
+            sources.push_back(it.path());
+        }
+    }
+    std::sort(sources.begin(), sources.end());
+
+    std::map<std::pair<Backend::Opcode, Backend::Opcode>, int64_t> pairs;
+    int64_t totalBefore = 0, totalAfter = 0;
+    double totalPlainMs = 0, totalFusedMs = 0;
+    for(const auto &path : sources) {
+        std::ifstream input(path);
+        std::stringstream source;
+        source << input.rdbuf();
+        Lexing::Lexer lexer(source.str());
+        Lexing::Lexer::setupBasicLexer(lexer);
+        lexer.lex();
+        Parsing::Parser parser(lexer.lexed);
+        Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+        if(!lexer.diagnostics.empty() || !parser.diagnostics.empty()) {
+            delete tree;
+            continue;
+        }
+
+        // Record the profile, then count with and without superinstructions on the profiled blocks
+        Backend::Optimizations instrumented;
+        instrumented.instrument = base + ".profile";
+        Backend::Profile profile;
+        std::string error;
+        double ms = 0;
+        int64_t instructions = 0;
+        int exitCode = 0;
+        if(!buildAndRun(tree, instrumented, base, 1, ms, instructions, exitCode) || !Backend::Profile::read(instrumented.instrument, profile, error)) {
+            std::cout << path.filename().string() << ": cannot record a profile\n";
+            delete tree;
+            continue;
+        }
+        Backend::Optimizations plain, fused;
+        plain.profile = fused.profile = &profile;
+        plain.peephole = false;
+        std::vector<Lexing::Diagnostic> diagnostics;
+        const Backend::Program before = Backend::lowerProgram(tree, {}, diagnostics, plain);
+        const Backend::Program after = Backend::lowerProgram(tree, {}, diagnostics, fused);
+        for(const auto &it : Backend::countInstructionPairs(before)) {
+            pairs[{it.first, it.second}] += it.count;
+        }
+        const int64_t dispatchesBefore = Backend::countDispatches(before), dispatchesAfter = Backend::countDispatches(after);
+        totalBefore += dispatchesBefore;
+        totalAfter += dispatchesAfter;
+
+        double plainMs = 0, fusedMs = 0;
+        int64_t plainInstructions = 0, fusedInstructions = 0;
+        int plainExit = 0, fusedExit = 0;
+        if(buildAndRun(tree, plain, base, 3, plainMs, plainInstructions, plainExit) && buildAndRun(tree, fused, base, 3, fusedMs, fusedInstructions, fusedExit)) {
+            totalPlainMs += plainMs;
+            totalFusedMs += fusedMs;
+            std::cout << path.filename().string() << ": " << dispatchesBefore << " -> " << dispatchesAfter << " instructions run ("
+                << 100.0 * (dispatchesBefore - dispatchesAfter) / std::max<int64_t>(dispatchesBefore, 1) << "% fewer), "
+                << plainInstructions << " -> " << fusedInstructions << " generated, " << plainMs << " -> " << fusedMs << " ms"
+                << (plainExit == fusedExit ? "" : ", different exit codes") << "\n";
+        }
+        delete tree;
+    }
+
+    std::vector<std::pair<int64_t, std::pair<Backend::Opcode, Backend::Opcode> > > ranked;
+    for(const auto &it : pairs) {
+        ranked.push_back({it.second, it.first});
+    }
+    std::sort(ranked.rbegin(), ranked.rend());
+    std::cout << "most frequent dependent pairs of " << totalBefore << " instructions run:\n";
+    for(size_t i = 0; i < ranked.size() && i < REPORTED_PAIRS; i ++) {
+        std::cout << "    " << Backend::OpcodeName[ranked[i].second.first] << " + " << Backend::OpcodeName[ranked[i].second.second] << ": "
+            << ranked[i].first << " (" << 100.0 * ranked[i].first / std::max<int64_t>(totalBefore, 1) << "%)\n";
+    }
+    std::cout << "superinstructions: " << totalBefore << " -> " << totalAfter << " instructions run, "
+        << 100.0 * (totalBefore - totalAfter) / std::max<int64_t>(totalBefore, 1) << "% fewer dispatches, "
+        << totalPlainMs << " -> " << totalFusedMs << " ms\n";
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include <variant>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+#include "Runtime/Value.h"
+
+// Memory and speed of the tagged runtime value against a variant holding the same types, on an
+// interpreter style loop checking the type of every operand before multiplying, adding and comparing
+const int64_t VALUES = (int64_t)1 << 16;
+const int32_t PASSES = 400;
+
+// Every value but one in 16 is a number, the rest are booleans the loop has to skip
+const int64_t NON_NUMBER_EVERY = 16;
+
+using VariantValue = std::variant<int64_t, bool, char32_t, void*>;
+
+static int64_t allocations = 0;
+
+void *operator new(const size_t size) {
+    allocations ++;
+    if(void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+static int64_t runTagged(const std::vector<Runtime::Value> &values, int64_t &below) {
+    const Runtime::Value three = Runtime::Value::number(3), threshold = Runtime::Value::number(500);
+    Runtime::Value sum = Runtime::Value::number(0), product, isLess;
+    below = 0;
+    for(int32_t pass = 0; pass < PASSES; pass ++) {
+        for(const Runtime::Value &it : values) {
+            if(!Runtime::Value::multiply(it, three, product)) {
+                continue;
+            }
+            Runtime::Value::add(sum, product, sum);
+            Runtime::Value::less(it, threshold, isLess);
+            below += isLess.asBoolean();
+        }
+    }
+    return sum.asNumber();
+}
+
+static int64_t runVariant(const std::vector<VariantValue> &values, int64_t &below) {
+    const VariantValue three = (int64_t)3, threshold = (int64_t)500;
+    VariantValue sum = (int64_t)0;
+    below = 0;
+    for(int32_t pass = 0; pass < PASSES; pass ++) {
+        for(const VariantValue &it : values) {
+            const int64_t *number = std::get_if<int64_t>(&it);
+            if(number == nullptr) {
+                continue;
+            }
+            const VariantValue product = *number * std::get<int64_t>(three);
+            sum = std::get<int64_t>(sum) + std::get<int64_t>(product);
+            const VariantValue isLess = *number < std::get<int64_t>(threshold);
+            below += std::get<bool>(isLess);
+        }
+    }
+    return std::get<int64_t>(sum);
+}
+
+// Best time of three runs of a loop, with the allocations it made
+template<typename Run>
+static double bestMs(const Run &run, int64_t &result, int64_t &allocated) {
+    double best = 1e30;
+    const int64_t before = allocations;
+    for(int32_t repeat = 0; repeat < 3; repeat ++) {
+        auto start = std::chrono::steady_clock::now();
+        result = run();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    allocated = allocations - before;
+    return best;
+}
+
+int main() {
+    std::vector<Runtime::Value> tagged;
+    std::vector<VariantValue> variant;
+    tagged.reserve(VALUES);
+    variant.reserve(VALUES);
+    uint64_t seed = 12345;
+    for(int64_t i = 0; i < VALUES; i ++) {
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+        const int64_t number = (int64_t)(seed >> 33) % 1000;
+        if(i % NON_NUMBER_EVERY == NON_NUMBER_EVERY - 1) {
+            tagged.push_back(Runtime::Value::boolean(number & 1));
+            variant.push_back((bool)(number & 1));
+        } else {
+            tagged.push_back(Runtime::Value::number(number));
+            variant.push_back(number);
+        }
+    }
+
+    int64_t taggedSum = 0, variantSum = 0, taggedBelow = 0, variantBelow = 0, taggedAllocated = 0, variantAllocated = 0;
+    const double taggedMs = bestMs([&]() { return runTagged(tagged, taggedBelow); }, taggedSum, taggedAllocated);
+    const double variantMs = bestMs([&]() { return runVariant(variant, variantBelow); }, variantSum, variantAllocated);
+    if(taggedSum != variantSum || taggedBelow != variantBelow) {
+        std::cout << "The representations disagree: " << taggedSum << " and " << variantSum << "\n";
+        return 1;
+    }
+
+    const double operations = 3.0 * PASSES * (VALUES - VALUES / NON_NUMBER_EVERY);
+    std::cout << "tagged value:  " << sizeof(Runtime::Value) << " bytes per value, " << operations / taggedMs / 1000
+        << " M operations/s, " << taggedAllocated << " allocations\n";
+    std::cout << "std::variant:  " << sizeof(VariantValue) << " bytes per value, " << operations / variantMs / 1000
+        << " M operations/s, " << variantAllocated << " allocations\n";
+    std::cout << "speedup: " << variantMs / taggedMs << "x, checksum " << taggedSum << "\n";
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <filesystem>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/X86Emitter.h"
+
+// Elements per second of element wise array loops run scalar, in SSE2 vector loops and in AVX2 ones.
+// The arrays stay in the level 1 and 2 caches, so the kernels measure computation rather than memory.
+// Their length keeps them from being a multiple of 4 KiB apart, where loads would alias stores.
+const int64_t LENGTH = 1000;
+const int64_t ROUNDS = 200000;
+
+const std::vector<std::pair<std::string, std::string> > KERNELS = {
+    {"add", "x[i] + y[i]"},
+    {"multiply and xor", "(x[i] + k) * y[i] ^ x[i]"},
+};
+
+std::string program(const std::string &kernel) {
+    const std::string length = std::to_string(LENGTH);
+    return R"({
+    let a : int[)" + length + R"(];
+    let b : int[)" + length + R"(];
+    let c : int[)" + length + R"(];
+    function kernel(x : int[], y : int[], z : int[], n : int, k : int) {
+        for let i : int = 0; i < n; i += 1 {
+            z[i] = )" + kernel + R"(;
+        }
+    }
+    function run(rounds : int) : int {
+        for let i : int = 0; i < )" + length + R"(; i += 1 {
+            a[i] = i * 7 + 3;
+            b[i] = i ^ 91;
+        }
+        let checksum : int = 0;
+        for let r : int = 0; r < rounds; r += 1 {
+            kernel(a, b, c, )" + length + R"(, r);
+            checksum += c[r % )" + length + R"(];
+        }
+        return checksum & 255;
+    }
+    return run()" + std::to_string(ROUNDS) + R"();
+})";
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "xcpp-vector-bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    class Mode {
+    public:
+        std::string name;
+        bool vectorize;
+        Backend::VectorIsa isa;
+    };
+    std::vector<Mode> modes = {{"scalar", false, Backend::VectorIsa::SSE2}, {"sse2", true, Backend::VectorIsa::SSE2}};
+    if(__builtin_cpu_supports("avx2")) {
+        modes.push_back({"avx2", true, Backend::VectorIsa::AVX2});
+    }
+
+    for(const auto &[kernelName, kernel] : KERNELS) {
+        Lexing::Lexer lexer(program(kernel));
+        Lexing::Lexer::setupBasicLexer(lexer);
+        lexer.lex();
+        Parsing::Parser parser(lexer.lexed);
+        Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+
+        for(const auto &mode : modes) {
+            Backend::Optimizations optimizations;
+            optimizations.vectorize = mode.vectorize;
+            std::vector<Lexing::Diagnostic> diagnostics;
+            Backend::Program lowered = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+            if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !diagnostics.empty()) {
+                std::cout << "The program does not compile\n";
+                break;
+            }
+
+            const std::string base = (root / mode.name).string();
+            Backend::EmitStats stats;
+            {
+                std::ofstream output(base + ".s");
+                Backend::emitProgram(output, lowered, Backend::AllocatorKind::LINEAR_SCAN, stats, mode.isa);
+            }
+            if(std::system(("gcc -o " + base + " " + base + ".s").c_str()) != 0) {
+                std::cout << "Assembling failed\n";
+                break;
+            }
+
+            // Best of three runs
+            double bestMs = 1e30;
+            int exitCode = -1;
+            for(int32_t i = 0; i < 3; i ++) {
+                auto start = std::chrono::steady_clock::now();
+                int status = std::system(base.c_str());
+                bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                exitCode = WEXITSTATUS(status);
+            }
+            std::cout << kernelName << ", " << mode.name << ": " << stats.vectorLoops << " vector loops, " << bestMs << " ms, "
+                << LENGTH * ROUNDS / bestMs / 1000 << " M elements/s, exit code " << exitCode << "\n";
+        }
+        delete tree;
+    }
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "FuzzTarget.h"
+
+namespace Fuzzing {
+
+double runLexerParser(const uint8_t *data, size_t size) {
+    auto start = std::chrono::steady_clock::now();
+
+    Lexing::Lexer lexer(std::string((const char*)data, size));
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *program = parser.recognizeProgram();
+    delete program;
+
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return size ? ns / size : ns;
+}
+
+double maxNsPerByte() {
+    const char *limit = std::getenv("XCPP_FUZZ_MAX_NS_PER_BYTE");
+    return limit ? std::atof(limit) : DEFAULT_MAX_NS_PER_BYTE;
+}
+
+bool isPathological(size_t size, double nsPerByte) {
+    static const double limit = maxNsPerByte();
+    return size >= MIN_TIMED_INPUT_SIZE && nsPerByte > limit;
+}
+
+};
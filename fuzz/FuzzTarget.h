@@ -0,0 +1,50 @@
+#pragma once
+#ifndef FUZZ_TARGET_H
+#define FUZZ_TARGET_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Fuzzing {
+
+/**
+ * @brief Inputs shorter than this are too fast to time reliably
+ * 
+ */
+const size_t MIN_TIMED_INPUT_SIZE = 256;
+
+/**
+ * @brief Default limit of lexing and parsing time per input byte, error dense input costs a few
+ * microseconds per byte under sanitizers while a quadratic step on a 64 KB input costs far more
+ * 
+ */
+const double DEFAULT_MAX_NS_PER_BYTE = 50000.0;
+
+/**
+ * @brief Lex and parse the input and destroy the tree
+ * 
+ * @param data Source bytes
+ * @param size Number of bytes
+ * @return double Nanoseconds spent per byte
+ */
+double runLexerParser(const uint8_t *data, size_t size);
+
+/**
+ * @brief Read the per byte limit from XCPP_FUZZ_MAX_NS_PER_BYTE
+ * 
+ * @return double Maximal nanoseconds per byte
+ */
+double maxNsPerByte();
+
+/**
+ * @brief Check if an input is slow enough to indicate a superlinear hot spot
+ * 
+ * @param size Number of input bytes
+ * @param nsPerByte Measured time per byte
+ * @return true if the input should be reported
+ */
+bool isPathological(size_t size, double nsPerByte);
+
+};
+
+#endif // FUZZ_TARGET_H
@@ -0,0 +1,14 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "FuzzTarget.h"
+
+// Entry point for clang -fsanitize=fuzzer, slow inputs abort so libFuzzer saves them like crashes
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    double nsPerByte = Fuzzing::runLexerParser(data, size);
+    if(Fuzzing::isPathological(size, nsPerByte)) {
+        std::fprintf(stderr, "Pathological input: %zu bytes at %.0f ns per byte\n", size, nsPerByte);
+        std::abort();
+    }
+    return 0;
+}
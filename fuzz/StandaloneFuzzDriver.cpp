@@ -0,0 +1,203 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <filesystem>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FuzzTarget.h"
+
+// Mutation driver for the same target as LibFuzzerEntry.cpp, needs nothing but the seed files
+// Usage: fuzz [-runs=N] [-seed=N] [-max_len=N] [-artifact_prefix=P] [files or corpus directories...]
+// Files are replayed once, directories seed the mutations (test-suite/input by default)
+
+extern "C" void __sanitizer_set_death_callback(void (*callback)(void)) __attribute__((weak));
+
+namespace {
+
+const std::vector<std::string> dictionary = {
+    "{", "}", "(", ")", "[", "]", ";", ",", ":", "=", "+", "-", "*", "&", "!", "<", ">=", "==", "&&", "||",
+    "if ", "else ", "do ", "let ", "while ", "for ", "return ", "function ", "true", "false",
+    "x", "print", "10", "\"str\"", "'c'", " ", "\n", "\xc3\xa9", "\xff"
+};
+
+std::string currentInput;
+std::string artifactPrefix = "";
+
+// Save the input that is being run when the process dies
+void dumpCurrentInput() {
+    std::string path = artifactPrefix + "crash-input";
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd >= 0) {
+        ssize_t written = write(fd, currentInput.data(), currentInput.size());
+        (void)written;
+        close(fd);
+    }
+    const char message[] = "Input which crashed was written to the crash-input artifact\n";
+    ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)written;
+}
+
+void crashHandler(int signal) {
+    dumpCurrentInput();
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+void writeFile(const std::string &path, const std::string &data) {
+    std::ofstream file(path, std::ios::binary);
+    file << data;
+}
+
+void mutate(std::string &input, const std::vector<std::string> &corpus, std::mt19937 &rng, const size_t maxLen) {
+    auto position = [&]() { return input.empty() ? 0 : rng() % (input.size() + 1); };
+    switch(rng() % 7) {
+        case 0: // Overwrite a byte
+            if(!input.empty()) {
+                input[rng() % input.size()] = (char)(rng() % 256);
+            }
+            break;
+        case 1: // Insert a byte
+            input.insert(position(), 1, (char)(rng() % 256));
+            break;
+        case 2: // Erase a range
+            if(!input.empty()) {
+                size_t at = rng() % input.size();
+                input.erase(at, 1 + rng() % std::min<size_t>(16, input.size() - at));
+            }
+            break;
+        case 3: // Insert a token
+            input.insert(position(), dictionary[rng() % dictionary.size()]);
+            break;
+        case 4: // Splice with another input
+            if(!corpus.empty()) {
+                const std::string &other = corpus[rng() % corpus.size()];
+                size_t from = other.empty() ? 0 : rng() % other.size();
+                input.insert(position(), other.substr(from, rng() % 64));
+            }
+            break;
+        default: // Repeat a chunk, which builds deep nesting and long operator chains
+            if(!input.empty()) {
+                size_t at = rng() % input.size();
+                std::string chunk = input.substr(at, 1 + rng() % 8);
+                size_t times = 1 + rng() % 512;
+                std::string repeated;
+                for(size_t i = 0; i < times; i ++) {
+                    repeated += chunk;
+                }
+                input.insert(at, repeated);
+            }
+            break;
+    }
+    if(input.size() > maxLen) {
+        input.resize(maxLen);
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    size_t runs = 20000, maxLen = 1 << 16;
+    uint32_t seed = 1;
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; i ++) {
+        std::string arg = argv[i];
+        if(arg.rfind("-runs=", 0) == 0) {
+            runs = std::stoull(arg.substr(6));
+        } else if(arg.rfind("-seed=", 0) == 0) {
+            seed = (uint32_t)std::stoul(arg.substr(6));
+        } else if(arg.rfind("-max_len=", 0) == 0) {
+            maxLen = std::stoull(arg.substr(9));
+        } else if(arg.rfind("-artifact_prefix=", 0) == 0) {
+            artifactPrefix = arg.substr(17);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    for(int signal : {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL}) {
+        std::signal(signal, crashHandler);
+    }
+    if(__sanitizer_set_death_callback) {
+        __sanitizer_set_death_callback(dumpCurrentInput);
+    }
+
+    std::vector<std::string> corpus;
+    std::vector<std::string> replay;
+    if(paths.empty()) {
+        paths.push_back("test-suite/input");
+    }
+    for(const auto &path : paths) {
+        if(std::filesystem::is_directory(path)) {
+            for(const auto &entry : std::filesystem::directory_iterator(path)) {
+                corpus.push_back(readFile(entry.path()));
+            }
+        } else {
+            replay.push_back(path);
+        }
+    }
+
+    // Replay mode, as with libFuzzer given files
+    if(!replay.empty()) {
+        for(const auto &path : replay) {
+            currentInput = readFile(path);
+            double nsPerByte = Fuzzing::runLexerParser((const uint8_t*)currentInput.data(), currentInput.size());
+            std::cout << path << ": " << currentInput.size() << " bytes, " << nsPerByte << " ns per byte"
+                << (Fuzzing::isPathological(currentInput.size(), nsPerByte) ? " PATHOLOGICAL" : "") << "\n";
+        }
+        return 0;
+    }
+    if(corpus.empty()) {
+        corpus.push_back("{}");
+    }
+
+    std::mt19937 rng(seed);
+    size_t totalBytes = 0, slowInputs = 0;
+    double worstNsPerByte = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t run = 0; run < runs; run ++) {
+        currentInput = corpus[rng() % corpus.size()];
+        for(size_t steps = 1 + rng() % 4; steps > 0; steps --) {
+            mutate(currentInput, corpus, rng, maxLen);
+        }
+
+        double nsPerByte = Fuzzing::runLexerParser((const uint8_t*)currentInput.data(), currentInput.size());
+        totalBytes += currentInput.size();
+        if(currentInput.size() >= Fuzzing::MIN_TIMED_INPUT_SIZE) {
+            worstNsPerByte = std::max(worstNsPerByte, nsPerByte);
+        }
+        if(Fuzzing::isPathological(currentInput.size(), nsPerByte)) {
+            std::string path = artifactPrefix + "slow-" + std::to_string(slowInputs ++);
+            writeFile(path, currentInput);
+            std::cout << "Pathological input: " << currentInput.size() << " bytes at " << nsPerByte << " ns per byte, saved to " << path << "\n";
+        }
+
+        // Keep some mutants so that later runs build on them
+        if(rng() % 16 == 0) {
+            if(corpus.size() < 1024) {
+                corpus.push_back(currentInput);
+            } else {
+                corpus[rng() % corpus.size()] = currentInput;
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "runs:              " << runs << "\n";
+    std::cout << "throughput:        " << totalBytes / seconds / (1 << 20) << " MB/s\n";
+    std::cout << "worst ns per byte: " << worstNsPerByte << "\n";
+    std::cout << "pathological:      " << slowInputs << "\n";
+    return slowInputs ? 1 : 0;
+}
@@ -1 +1,67 @@
-./compiler $1 > $2
+case "$(basename "$1")" in
+	NC-*)
+		# Native code tests report the output and the exit code of the program built with each register
+		# allocation, and with AVX2 vector loops on processors which have them, then with its calls evaluated
+		# while compiling. Programs read their own source from the standard input.
+		: > $2
+		isa=sse2
+		grep -qw avx2 /proc/cpuinfo 2> /dev/null && isa=avx2
+		for mode in --no-evaluate --naive-codegen "--vector-isa $isa --no-evaluate" ""; do
+			./compiler $1 --emit-asm obj/test.s $mode >> $2 2>&1 && gcc -o obj/test obj/test.s >> $2 2>&1 && ./obj/test < $1 >> $2
+			echo "exit code $?" >> $2
+		done;;
+	PGO-*)
+		# Profile guided tests run the instrumented program, then build with its profile and print the
+		# lowering the counts led to and the exit code of the optimized program
+		./compiler $1 --emit-asm obj/test.s --profile-generate obj/test.profile --no-evaluate > $2 2>&1 && gcc -o obj/test obj/test.s >> $2 2>&1 && ./obj/test
+		echo "exit code $?" >> $2
+		./compiler $1 --emit-ir --profile-use obj/test.profile --no-evaluate >> $2 2>&1
+		./compiler $1 --emit-asm obj/test.s --profile-use obj/test.profile --no-evaluate >> $2 2>&1 && gcc -o obj/test obj/test.s >> $2 2>&1 && ./obj/test
+		echo "exit code $?" >> $2;;
+	SP-*)
+		# Sampled programs report their exit code and the stack most of their samples were taken in
+		./compiler $1 --emit-asm obj/test.s --sample-profile obj/test.samples > $2 2>&1 && gcc -o obj/test obj/test.s >> $2 2>&1 && ./obj/test
+		echo "exit code $?" >> $2
+		./compiler --fold-samples obj/test.samples obj/test.folded >> $2 2>&1 && sort -t' ' -k2 -n obj/test.folded | tail -n 1 | cut -d' ' -f1 >> $2;;
+	LY-*)
+		./compiler $1 --emit-layout > $2 2>&1;;
+	CE-*)
+		# Compile time evaluation tests print the lowering of the evaluated program, then the exit code of
+		# the program built with and without evaluation
+		./compiler $1 --emit-ir > $2 2>&1
+		for mode in "" --no-evaluate; do
+			./compiler $1 --emit-asm obj/test.s $mode >> $2 2>&1 && gcc -o obj/test obj/test.s >> $2 2>&1 && ./obj/test
+			echo "exit code $?" >> $2
+		done;;
+	MS-*)
+		# Module summary tests write the summaries of the modules in test-suite/modules, then check a copy of
+		# the test next to them, which imports them
+		mkdir -p obj/modules
+		for module in test-suite/modules/*.xcpp; do
+			./compiler $module --summary obj/modules/"$(basename $module .xcpp)".xsum > /dev/null 2>&1
+		done
+		cp $1 obj/modules/
+		./compiler obj/modules/"$(basename $1)" > $2 2>&1
+		# A summary which cannot replace its target, here a directory, leaves no partial file behind
+		mkdir -p obj/modules/blocked.xsum
+		./compiler $module --summary obj/modules/blocked.xsum 2>&1 | grep "module summary" >> $2
+		echo "partial files $(ls obj/modules | grep -c '\.tmp$')" >> $2;;
+	BD-*)
+		# Build tests copy the manifest and the modules of test-suite/projects to a fresh directory and build
+		# it, then build it again unchanged and after an edit of the last module of the manifest which keeps
+		# its interface. Timings, threads and stolen tasks depend on the machine and are left out.
+		: > $2
+		rm -rf obj/project
+		mkdir -p obj/project
+		cp test-suite/projects/*.xcpp obj/project/
+		cp $1 obj/project/manifest
+		for step in build rebuild edit; do
+			[ $step = edit ] && echo >> obj/project/"$(grep -v '^#' $1 | tail -n 1)"
+			echo "$step:" >> $2
+			./compiler --build obj/project/manifest -j 4 2>&1 | grep -v '^Wall time\|^Critical path' | sed 's/ on [0-9]* threads .*//' >> $2
+		done;;
+	IR-*)
+		./compiler $1 --emit-ir --no-evaluate > $2 2>&1;;
+	*)
+		./compiler $1 > $2 2>&1;;
+esac
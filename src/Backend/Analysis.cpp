@@ -0,0 +1,187 @@
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+
+namespace Backend {
+
+VregSet::VregSet(const int32_t size) : words((size + 63) / 64, 0) {}
+void VregSet::insert(const int32_t vreg) { this->words[vreg >> 6] |= 1ULL << (vreg & 63); }
+void VregSet::erase(const int32_t vreg) { this->words[vreg >> 6] &= ~(1ULL << (vreg & 63)); }
+bool VregSet::contains(const int32_t vreg) const { return this->words[vreg >> 6] >> (vreg & 63) & 1; }
+
+Liveness computeLiveness(const Function &function) {
+    const size_t blockCount = function.blocks.size();
+    std::vector<VregSet> uses(blockCount, VregSet(function.vregCount)), defs(blockCount, VregSet(function.vregCount));
+    for(size_t b = 0; b < blockCount; b ++) {
+        for(const auto &it : function.blocks[b].instructions) {
+            it.forEachUse([&](const int32_t vreg) {
+                if(!defs[b].contains(vreg)) {
+                    uses[b].insert(vreg);
+                }
+            });
+            if(it.dst >= 0) {
+                defs[b].insert(it.dst);
+            }
+        }
+    }
+
+    // Backward dataflow until nothing changes, visiting blocks in reverse layout order converges fast
+    Liveness liveness;
+    liveness.liveIn.assign(blockCount, VregSet(function.vregCount));
+    liveness.liveOut.assign(blockCount, VregSet(function.vregCount));
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t b = blockCount; b -- > 0;) {
+            VregSet out(function.vregCount);
+            for(const auto succ : function.blocks[b].successors()) {
+                for(size_t w = 0; w < out.words.size(); w ++) {
+                    out.words[w] |= liveness.liveIn[succ].words[w];
+                }
+            }
+            VregSet in(function.vregCount);
+            for(size_t w = 0; w < in.words.size(); w ++) {
+                in.words[w] = uses[b].words[w] | (out.words[w] & ~defs[b].words[w]);
+            }
+            if(in.words != liveness.liveIn[b].words || out.words != liveness.liveOut[b].words) {
+                liveness.liveIn[b] = std::move(in);
+                liveness.liveOut[b] = std::move(out);
+                changed = true;
+            }
+        }
+    }
+    return liveness;
+}
+
+std::vector<std::vector<int32_t> > computePredecessors(const Function &function) {
+    std::vector<std::vector<int32_t> > predecessors(function.blocks.size());
+    for(size_t b = 0; b < function.blocks.size(); b ++) {
+        for(const auto succ : function.blocks[b].successors()) {
+            if(predecessors[succ].empty() || predecessors[succ].back() != (int32_t)b) {
+                predecessors[succ].push_back((int32_t)b);
+            }
+        }
+    }
+    return predecessors;
+}
+
+std::vector<int32_t> computeDominators(const Function &function) {
+    const size_t blockCount = function.blocks.size();
+    std::vector<int32_t> dominators(blockCount, -1);
+    if(blockCount == 0) {
+        return dominators;
+    }
+
+    // Cooper, Harvey and Kennedy over reverse postorder numbers, blocks may be in any layout
+    std::vector<int32_t> postorder, number(blockCount, -1);
+    std::vector<bool> visited(blockCount, false);
+    std::vector<std::pair<int32_t, std::vector<int32_t> > > stack;
+    visited[0] = true;
+    stack.push_back({0, function.blocks[0].successors()});
+    while(!stack.empty()) {
+        auto &[block, successors] = stack.back();
+        if(successors.empty()) {
+            postorder.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        const int32_t next = successors.back();
+        successors.pop_back();
+        if(!visited[next]) {
+            visited[next] = true;
+            stack.push_back({next, function.blocks[next].successors()});
+        }
+    }
+    std::vector<int32_t> order(postorder.rbegin(), postorder.rend());
+    for(size_t i = 0; i < order.size(); i ++) {
+        number[order[i]] = (int32_t)i;
+    }
+
+    const std::vector<std::vector<int32_t> > predecessors = computePredecessors(function);
+    dominators[0] = 0;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t i = 1; i < order.size(); i ++) {
+            const int32_t b = order[i];
+            int32_t dominator = -1;
+            for(auto it : predecessors[b]) {
+                if(dominators[it] < 0) {
+                    continue;
+                }
+                if(dominator < 0) {
+                    dominator = it;
+                    continue;
+                }
+                int32_t other = it;
+                while(dominator != other) {
+                    while(number[dominator] > number[other]) {
+                        dominator = dominators[dominator];
+                    }
+                    while(number[other] > number[dominator]) {
+                        other = dominators[other];
+                    }
+                }
+            }
+            if(dominator != dominators[b]) {
+                dominators[b] = dominator;
+                changed = true;
+            }
+        }
+    }
+    return dominators;
+}
+
+bool dominates(const std::vector<int32_t> &dominators, const int32_t a, int32_t b) {
+    if(dominators[b] < 0) {
+        return false;
+    }
+    while(b != a && b != 0) {
+        b = dominators[b];
+    }
+    return a == b;
+}
+
+Loop::Loop(const int32_t _header, const size_t blockCount) : header(_header), contains(blockCount, false), size(0) {}
+
+std::vector<Loop> findLoops(const Function &function) {
+    const std::vector<int32_t> dominators = computeDominators(function);
+    const std::vector<std::vector<int32_t> > predecessors = computePredecessors(function);
+    std::vector<Loop> loops;
+    for(size_t h = 0; h < function.blocks.size(); h ++) {
+        Loop loop((int32_t)h, function.blocks.size());
+        for(const auto it : predecessors[h]) {
+            if(dominators[it] >= 0 && dominates(dominators, (int32_t)h, it)) {
+                loop.latches.push_back(it);
+            }
+        }
+        if(loop.latches.empty()) {
+            continue;
+        }
+
+        // Walk backwards from the latches, the header stops the walk
+        loop.contains[h] = true;
+        std::vector<int32_t> work = loop.latches;
+        while(!work.empty()) {
+            const int32_t block = work.back();
+            work.pop_back();
+            if(loop.contains[block]) {
+                continue;
+            }
+            loop.contains[block] = true;
+            work.insert(work.end(), predecessors[block].begin(), predecessors[block].end());
+        }
+        loop.size = (int32_t)std::count(loop.contains.begin(), loop.contains.end(), true);
+        loops.push_back(std::move(loop));
+    }
+
+    // A loop nested in another one has fewer blocks
+    std::stable_sort(loops.begin(), loops.end(), [](const Loop &a, const Loop &b) { return a.size < b.size; });
+    return loops;
+}
+
+};
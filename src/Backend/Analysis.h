@@ -0,0 +1,109 @@
+#pragma once
+#ifndef BACKEND_ANALYSIS_H
+#define BACKEND_ANALYSIS_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Set of virtual registers, one bit each
+ * 
+ */
+class VregSet {
+public:
+    std::vector<uint64_t> words;
+
+    VregSet(const int32_t size = 0);
+    void insert(const int32_t vreg);
+    void erase(const int32_t vreg);
+    bool contains(const int32_t vreg) const;
+
+    template <typename F>
+    void forEach(F f) const {
+        for(size_t i = 0; i < this->words.size(); i ++) {
+            for(uint64_t word = this->words[i]; word; word &= word - 1) {
+                f((int32_t)(i * 64 + __builtin_ctzll(word)));
+            }
+        }
+    }
+};
+
+/**
+ * @brief Virtual registers live at the start and at the end of every block
+ * 
+ */
+class Liveness {
+public:
+    std::vector<VregSet> liveIn;
+    std::vector<VregSet> liveOut;
+};
+
+/**
+ * @brief Solve the backward liveness dataflow over the blocks
+ * 
+ * @param function Function to analyze
+ * @return Liveness Live registers of every block
+ */
+Liveness computeLiveness(const Function &function);
+
+/**
+ * @brief Get the predecessors of every block
+ * 
+ */
+std::vector<std::vector<int32_t> > computePredecessors(const Function &function);
+
+/**
+ * @brief Compute the immediate dominator of every block reachable from the entry
+ * 
+ * @param function Function to analyze
+ * @return std::vector<int32_t> Immediate dominator of each block, the entry dominates itself and
+ * unreachable blocks have -1
+ */
+std::vector<int32_t> computeDominators(const Function &function);
+
+/**
+ * @brief Check whether block a dominates block b
+ * 
+ */
+bool dominates(const std::vector<int32_t> &dominators, const int32_t a, int32_t b);
+
+/**
+ * @brief Natural loop, the blocks from which a back edge to the header is reachable without passing
+ * through the header
+ * 
+ */
+class Loop {
+public:
+    int32_t header;
+
+    /**
+     * @brief Sources of the back edges
+     * 
+     */
+    std::vector<int32_t> latches;
+
+    /**
+     * @brief Blocks of the loop, header included
+     * 
+     */
+    std::vector<bool> contains;
+    int32_t size;
+
+    Loop(const int32_t _header = -1, const size_t blockCount = 0);
+};
+
+/**
+ * @brief Find the natural loops of a function, loops sharing a header are merged
+ * 
+ * @param function Function to analyze
+ * @return std::vector<Loop> Loops ordered from the innermost to the outermost
+ */
+std::vector<Loop> findLoops(const Function &function);
+
+};
+
+#endif // BACKEND_ANALYSIS_H
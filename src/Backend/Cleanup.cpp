@@ -0,0 +1,115 @@
+#include <vector>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+#include "Cleanup.h"
+
+namespace Backend {
+
+// Result of an operation on constants, wrapping like the generated code
+static bool fold(const Instruction &instruction, int64_t &result) {
+    if(!instruction.a.isImmediate() || instruction.opcode < Opcode::ADD || instruction.opcode > Opcode::GREATER_EQUAL) {
+        return false;
+    }
+    const bool unary = instruction.opcode == Opcode::NEG || instruction.opcode == Opcode::NOT;
+    if(!unary && !instruction.b.isImmediate()) {
+        return false;
+    }
+    const int64_t a = instruction.a.value, b = instruction.b.value;
+    switch(instruction.opcode) {
+        case Opcode::ADD: result = (int64_t)((uint64_t)a + (uint64_t)b); return true;
+        case Opcode::SUB: result = (int64_t)((uint64_t)a - (uint64_t)b); return true;
+        case Opcode::MUL: result = (int64_t)((uint64_t)a * (uint64_t)b); return true;
+        case Opcode::DIV: case Opcode::MOD:
+            // Division by zero and the one overflowing division trap at run time
+            if(b == 0 || (a == INT64_MIN && b == -1)) {
+                return false;
+            }
+            result = instruction.opcode == Opcode::DIV ? a / b : a % b;
+            return true;
+        case Opcode::AND: result = a & b; return true;
+        case Opcode::OR: result = a | b; return true;
+        case Opcode::XOR: result = a ^ b; return true;
+        case Opcode::NEG: result = (int64_t)(0 - (uint64_t)a); return true;
+        case Opcode::NOT: result = ~a; return true;
+        default: result = evaluateComparison(instruction.opcode, a, b); return true;
+    }
+}
+
+void propagateCopies(Function &function) {
+    std::vector<Operand> known(function.vregCount);
+    for(auto &block : function.blocks) {
+        std::vector<int32_t> tracked;
+        auto replace = [&](Operand &operand) {
+            if(operand.isVreg() && known[operand.value].kind != Operand::Kind::NONE) {
+                operand = known[operand.value];
+            }
+        };
+        for(auto &it : block.instructions) {
+            replace(it.a);
+            replace(it.b);
+            replace(it.c);
+            // The kernel of a VECTOR reads its arguments by register
+            for(auto &argument : it.arguments) {
+                if(it.opcode != Opcode::VECTOR) {
+                    replace(argument);
+                }
+            }
+            int64_t result = 0;
+            if(it.dst >= 0 && fold(it, result)) {
+                it = Instruction(Opcode::MOVE, it.dst, Operand::immediate(result));
+            }
+            if(it.dst < 0) {
+                continue;
+            }
+
+            // A write ends every copy of the register and every copy made from it
+            for(size_t i = 0; i < tracked.size();) {
+                const Operand &value = known[tracked[i]];
+                if(tracked[i] == it.dst || (value.isVreg() && value.value == it.dst)) {
+                    known[tracked[i]] = Operand();
+                    tracked[i] = tracked.back();
+                    tracked.pop_back();
+                } else {
+                    i ++;
+                }
+            }
+            if(it.opcode == Opcode::MOVE && !(it.a.isVreg() && it.a.value == it.dst)) {
+                known[it.dst] = it.a;
+                tracked.push_back(it.dst);
+            }
+        }
+        for(const auto it : tracked) {
+            known[it] = Operand();
+        }
+    }
+}
+
+void eliminateDeadCode(Function &function) {
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        const Liveness liveness = computeLiveness(function);
+        for(size_t b = 0; b < function.blocks.size(); b ++) {
+            auto &instructions = function.blocks[b].instructions;
+            VregSet live = liveness.liveOut[b];
+            for(size_t i = instructions.size(); i -- > 0;) {
+                const Instruction &it = instructions[i];
+                const bool pure = it.isSpeculatable() || it.opcode == Opcode::LOAD_GLOBAL || it.opcode == Opcode::LOAD_ELEMENT
+                    || it.opcode == Opcode::ALLOCATE || it.opcode == Opcode::NEW;
+                if(it.dst >= 0 && !live.contains(it.dst) && pure) {
+                    instructions.erase(instructions.begin() + i);
+                    changed = true;
+                    continue;
+                }
+                if(it.dst >= 0) {
+                    live.erase(it.dst);
+                }
+                it.forEachUse([&](const int32_t vreg) { live.insert(vreg); });
+            }
+        }
+    }
+}
+
+};
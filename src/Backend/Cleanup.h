@@ -0,0 +1,26 @@
+#pragma once
+#ifndef BACKEND_CLEANUP_H
+#define BACKEND_CLEANUP_H
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Within every block, read the source of a copy or the constant a register was set to instead
+ * of the register while neither changes, and fold operations whose operands are all constants
+ * 
+ * @param function Function to rewrite
+ */
+void propagateCopies(Function &function);
+
+/**
+ * @brief Remove computations whose result is never read, repeating until none is left
+ * 
+ * @param function Function to rewrite
+ */
+void eliminateDeadCode(Function &function);
+
+};
+
+#endif // BACKEND_CLEANUP_H
@@ -0,0 +1,151 @@
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "Ir.h"
+#include "ControlFlow.h"
+
+namespace Backend {
+
+void simplifyControlFlow(Function &function) {
+    std::vector<BasicBlock> &blocks = function.blocks;
+    if(blocks.empty()) {
+        return;
+    }
+
+    // Follow blocks holding only a jump, a cycle of them stops after visiting every block
+    auto forward = [&](int32_t block) {
+        for(size_t steps = 0; steps < blocks.size(); steps ++) {
+            const auto &instructions = blocks[block].instructions;
+            if(instructions.size() != 1 || instructions[0].opcode != Opcode::JUMP) {
+                break;
+            }
+            block = instructions[0].target;
+        }
+        return block;
+    };
+    for(auto &block : blocks) {
+        if(block.instructions.empty()) {
+            continue;
+        }
+        Instruction &last = block.instructions.back();
+        if(last.opcode == Opcode::BRANCH) {
+            // Operands set to a constant earlier in the block, like a loop counter tested before entry
+            for(Operand *operand : {&last.a, &last.b}) {
+                for(auto it = block.instructions.rbegin() + 1; operand->isVreg() && it != block.instructions.rend(); it ++) {
+                    if(it->dst == operand->value) {
+                        if(it->opcode == Opcode::MOVE && it->a.isImmediate()) {
+                            *operand = it->a;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        if(last.opcode == Opcode::BRANCH && last.a.isImmediate() && last.b.isImmediate()) {
+            const int32_t taken = evaluateComparison(last.condition, last.a.value, last.b.value) ? last.target : last.alternative;
+            last = Instruction(Opcode::JUMP);
+            last.target = taken;
+        }
+        if(last.opcode == Opcode::JUMP) {
+            last.target = forward(last.target);
+        } else if(last.opcode == Opcode::BRANCH) {
+            last.target = forward(last.target);
+            last.alternative = forward(last.alternative);
+            if(last.target == last.alternative) {
+                const int32_t target = last.target;
+                last = Instruction(Opcode::JUMP);
+                last.target = target;
+            } else if(blocks[last.target].count >= 0 && blocks[last.alternative].count > blocks[last.target].count) {
+                // The target is laid out next, so the more frequent successor becomes it
+                std::swap(last.target, last.alternative);
+                last.condition = invertComparison(last.condition);
+            }
+        } else if(last.opcode == Opcode::SWITCH) {
+            for(auto &it : last.cases) {
+                it = forward(it);
+            }
+            last.alternative = forward(last.alternative);
+        }
+    }
+
+    // A block only reached by a jump continues its predecessor, which then ends like it. Merged blocks
+    // lose their predecessor and are dropped by the layout, so are branches folded above.
+    std::vector<int32_t> predecessors(blocks.size(), 0), reachable = {0};
+    std::vector<bool> isReachable(blocks.size(), false);
+    isReachable[0] = true;
+    while(!reachable.empty()) {
+        const int32_t block = reachable.back();
+        reachable.pop_back();
+        for(const auto it : blocks[block].successors()) {
+            predecessors[it] ++;
+            if(!isReachable[it]) {
+                isReachable[it] = true;
+                reachable.push_back(it);
+            }
+        }
+    }
+    for(size_t i = 0; i < blocks.size(); i ++) {
+        auto &instructions = blocks[i].instructions;
+        while(isReachable[i] && !instructions.empty() && instructions.back().opcode == Opcode::JUMP) {
+            const int32_t next = instructions.back().target;
+            if(next == 0 || next == (int32_t)i || predecessors[next] != 1) {
+                break;
+            }
+            instructions.pop_back();
+            instructions.insert(instructions.end(), blocks[next].instructions.begin(), blocks[next].instructions.end());
+            blocks[next].instructions.clear();
+            predecessors[next] = 0;
+        }
+    }
+
+    // Depth first postorder, successors are visited last to first so the first one ends up next
+    std::vector<int32_t> postorder;
+    std::vector<bool> visited(blocks.size(), false);
+    std::vector<std::pair<int32_t, std::vector<int32_t> > > stack;
+    visited[0] = true;
+    stack.push_back({0, blocks[0].successors()});
+    while(!stack.empty()) {
+        auto &[block, successors] = stack.back();
+        if(successors.empty()) {
+            postorder.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        const int32_t next = successors.back();
+        successors.pop_back();
+        if(!visited[next]) {
+            visited[next] = true;
+            stack.push_back({next, blocks[next].successors()});
+        }
+    }
+    std::reverse(postorder.begin(), postorder.end());
+    // Blocks the profile never saw run go after the others, so the code which runs is packed together
+    std::stable_partition(postorder.begin() + 1, postorder.end(), [&](const int32_t it) { return blocks[it].count != 0; });
+    std::vector<int32_t> index(blocks.size(), -1);
+    for(size_t i = 0; i < postorder.size(); i ++) {
+        index[postorder[i]] = (int32_t)i;
+    }
+
+    std::vector<BasicBlock> laidOut;
+    laidOut.reserve(postorder.size());
+    for(const auto it : postorder) {
+        laidOut.push_back(std::move(blocks[it]));
+        if(laidOut.back().instructions.empty()) {
+            continue;
+        }
+        Instruction &last = laidOut.back().instructions.back();
+        if(last.opcode == Opcode::JUMP || last.opcode == Opcode::BRANCH) {
+            last.target = index[last.target];
+        }
+        if(last.opcode == Opcode::BRANCH || last.opcode == Opcode::SWITCH) {
+            last.alternative = index[last.alternative];
+        }
+        for(auto &target : last.cases) {
+            target = index[target];
+        }
+    }
+    blocks = std::move(laidOut);
+}
+
+};
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef BACKEND_CONTROL_FLOW_H
+#define BACKEND_CONTROL_FLOW_H
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Clean up the blocks left by lowering. Branches with constant operands, directly or through a
+ * move of a constant earlier in their block, become jumps, edges
+ * into blocks which only jump again go straight to the final block, blocks only reached by a jump are
+ * merged into their predecessor and unreachable blocks are removed. The remaining blocks are laid out in reverse postorder, placing the target of a branch
+ * right after it so the common case falls through. With block counts from a profile, a branch makes its
+ * more frequent successor the target and blocks which never ran go last.
+ * 
+ * @param function Function to simplify, the entry block stays first
+ */
+void simplifyControlFlow(Function &function);
+
+};
+
+#endif // BACKEND_CONTROL_FLOW_H
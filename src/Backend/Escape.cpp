@@ -0,0 +1,146 @@
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+#include "Lowering.h"
+#include "Escape.h"
+
+namespace Backend {
+
+// Whether an address in root may outlive the function, holders receives root and the registers it is copied to
+static bool escapes(const Function &function, const int32_t root, const std::vector<std::vector<bool> > &parameterEscapes, VregSet &holders) {
+    holders = VregSet(function.vregCount);
+    holders.insert(root);
+    for(bool changed = true; changed;) {
+        changed = false;
+        for(const auto &block : function.blocks) {
+            for(const auto &it : block.instructions) {
+                if(it.opcode == Opcode::MOVE && it.a.isVreg() && holders.contains((int32_t)it.a.value) && !holders.contains(it.dst)) {
+                    holders.insert(it.dst);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    auto holds = [&](const Operand &operand) { return operand.isVreg() && holders.contains((int32_t)operand.value); };
+    for(const auto &block : function.blocks) {
+        for(const auto &it : block.instructions) {
+            switch(it.opcode) {
+                case Opcode::MOVE:
+                    break;
+                case Opcode::LOAD_ELEMENT:
+                    if(holds(it.b)) {
+                        return true;
+                    }
+                    break;
+                case Opcode::STORE_ELEMENT:
+                    if(holds(it.b) || holds(it.c)) {
+                        return true;
+                    }
+                    break;
+                case Opcode::CALL:
+                    for(size_t i = 0; i < it.arguments.size(); i ++) {
+                        if(holds(it.arguments[i]) && (it.callee < 0 || i >= parameterEscapes[it.callee].size() || parameterEscapes[it.callee][i])) {
+                            return true;
+                        }
+                    }
+                    break;
+                default: {
+                    // Returned, stored, compared or computed with, the address is taken as a value
+                    bool used = false;
+                    it.forEachUse([&](const int32_t vreg) { used |= holders.contains(vreg); });
+                    if(used) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<std::vector<bool> > findEscapingParameters(const Program &program) {
+    std::vector<std::vector<bool> > parameterEscapes;
+    for(const auto &it : program.functions) {
+        parameterEscapes.emplace_back(it.parameterCount, false);
+    }
+    // Parameters are assumed not to escape until a use shows otherwise, so recursive calls settle
+    VregSet holders;
+    for(bool changed = true; changed;) {
+        changed = false;
+        for(size_t f = 0; f < program.functions.size(); f ++) {
+            const Function &function = program.functions[f];
+            if(function.blocks.empty()) {
+                continue;
+            }
+            for(const auto &it : function.blocks[0].instructions) {
+                if(it.opcode != Opcode::PARAM) {
+                    continue;
+                }
+                const size_t index = (size_t)it.a.value;
+                if(index < parameterEscapes[f].size() && !parameterEscapes[f][index] && escapes(function, it.dst, parameterEscapes, holders)) {
+                    parameterEscapes[f][index] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return parameterEscapes;
+}
+
+int32_t placeArrays(Program &program) {
+    const std::vector<std::vector<bool> > parameterEscapes = findEscapingParameters(program);
+    int32_t placed = 0;
+    for(auto &function : program.functions) {
+        // Arrays are placed in the order they were declared
+        std::vector<std::pair<int32_t, int32_t> > sites;
+        for(size_t b = 0; b < function.blocks.size(); b ++) {
+            for(size_t i = 0; i < function.blocks[b].instructions.size(); i ++) {
+                if(function.blocks[b].instructions[i].opcode == Opcode::NEW) {
+                    sites.push_back({(int32_t)b, (int32_t)i});
+                }
+            }
+        }
+        std::sort(sites.begin(), sites.end(), [&](const std::pair<int32_t, int32_t> &x, const std::pair<int32_t, int32_t> &y) {
+            return function.blocks[x.first].instructions[x.second].dst < function.blocks[y.first].instructions[y.second].dst;
+        });
+        if(sites.empty()) {
+            continue;
+        }
+
+        const Liveness liveness = computeLiveness(function);
+        VregSet holders;
+        for(const auto &site : sites) {
+            const auto &instructions = function.blocks[site.first].instructions;
+            Instruction &allocation = function.blocks[site.first].instructions[site.second];
+            const int64_t length = allocation.a.value;
+            if(length > MAX_FRAME_WORDS - function.frameWords || escapes(function, allocation.dst, parameterEscapes, holders)) {
+                continue;
+            }
+            VregSet live = liveness.liveOut[site.first];
+            for(size_t i = instructions.size(); i -- > (size_t)site.second;) {
+                if(instructions[i].dst >= 0) {
+                    live.erase(instructions[i].dst);
+                }
+                instructions[i].forEachUse([&](const int32_t vreg) { live.insert(vreg); });
+            }
+            // An address from the previous run of the allocation would see its words zeroed again
+            bool reused = false;
+            live.forEach([&](const int32_t vreg) { reused |= holders.contains(vreg); });
+            if(reused) {
+                continue;
+            }
+            allocation.opcode = Opcode::ALLOCATE;
+            allocation.b = allocation.a;
+            allocation.a = Operand::immediate(function.frameWords);
+            function.frameWords += length;
+            placed ++;
+        }
+    }
+    return placed;
+}
+
+};
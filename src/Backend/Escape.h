@@ -0,0 +1,35 @@
+#pragma once
+#ifndef BACKEND_ESCAPE_H
+#define BACKEND_ESCAPE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Find the parameters of every function whose address may outlive a call of it. An argument of
+ * a parameter which does not escape is only indexed, copied or passed on to parameters which do not
+ * escape either, so its array may live in the frame of the caller.
+ * 
+ * @param program Program to analyze
+ * @return std::vector<std::vector<bool> > Whether each parameter of each function escapes
+ */
+std::vector<std::vector<bool> > findEscapingParameters(const Program &program);
+
+/**
+ * @brief Turn NEW into ALLOCATE where the address of the array does not escape: it is only indexed,
+ * copied between registers or passed to parameters which do not escape, and no copy of it is still live
+ * when the NEW runs again, so the words can be zeroed and reused. Arrays which would take the frame past
+ * MAX_FRAME_WORDS stay on the heap.
+ * 
+ * @param program Program to transform, after inlining so inlined callees see their caller
+ * @return int32_t Allocations moved to the frame
+ */
+int32_t placeArrays(Program &program);
+
+};
+
+#endif // BACKEND_ESCAPE_H
@@ -0,0 +1,515 @@
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <limits>
+#include <cstdint>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Utf8.h"
+#include "Lowering.h"
+#include "Evaluate.h"
+
+namespace Backend {
+
+// Value of a number, boolean or character literal as the lowering computes it
+static bool literalValue(const Grammar::Expression *expr, int64_t &value) {
+    auto literal = dynamic_cast<const Grammar::LiteralExpression*>(expr);
+    if(!literal) {
+        return false;
+    }
+    const Lexing::Token &token = literal->value;
+    if(token.type == Lexing::TokenType::NUMBER) {
+        size_t length = 0;
+        try {
+            value = std::stoll(token.lexeme, &length);
+        } catch(const std::exception &) {
+            return false;
+        }
+        return length == token.lexeme.size();
+    } else if(token.type == Lexing::TokenType::BOOLEAN) {
+        value = token.lexeme == "true";
+        return true;
+    } else if(token.type == Lexing::TokenType::CHARACTER) {
+        uint32_t codePoint = 0;
+        Lexing::decodeUtf8(token.lexeme.data(), token.lexeme.size(), codePoint);
+        value = codePoint;
+        return true;
+    }
+    return false;
+}
+
+static bool isArrayType(const std::string &type) {
+    return type.find('[') != std::string::npos;
+}
+
+// Variable of a running call, arrays are indexes in Evaluator::arrays
+class Variable {
+public:
+    int64_t value = 0;
+    int32_t array = -1;
+};
+
+// Result of running a statement
+enum Flow {
+    NEXT, RETURNED, FAILED
+};
+
+class Evaluator {
+public:
+    const EvaluationLimits limits;
+    EvaluationStats &stats;
+    std::unordered_map<std::string, const Grammar::FunctionDefinition*> functions;
+    std::unordered_set<std::string> classes;
+
+    // Results of the calls with only scalar arguments which ran to the end
+    std::map<std::pair<const Grammar::FunctionDefinition*, std::vector<int64_t> >, int64_t> results;
+
+    // Calls of the program which could not be evaluated with the whole budget
+    std::map<std::pair<const Grammar::FunctionDefinition*, std::vector<int64_t> >, bool> failures;
+
+    // Arrays of the evaluation, they are only released when it ends
+    std::vector<std::vector<int64_t> > arrays;
+    int64_t words;
+    int64_t steps;
+    int64_t programSteps;
+    int32_t depth;
+
+    // Scopes of the running call, from the outermost one
+    std::vector<std::unordered_map<std::string, Variable> > scopes;
+    int64_t returned;
+
+    Evaluator(EvaluationStats &_stats, const EvaluationLimits &_limits)
+        : limits(_limits), stats(_stats), words(0), steps(0), programSteps(0), depth(0), returned(0) {}
+
+    bool step() {
+        this->steps ++;
+        return this->steps <= this->limits.steps;
+    }
+
+    Variable *findVariable(const std::string &name) {
+        for(auto it = this->scopes.rbegin(); it != this->scopes.rend(); it ++) {
+            auto found = it->find(name);
+            if(found != it->end()) {
+                return &found->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Scalar variable named by a literal, globals are not known
+    Variable *findScalar(const Grammar::Expression *expr) {
+        auto name = dynamic_cast<const Grammar::LiteralExpression*>(expr);
+        if(!name || name->value.type != Lexing::TokenType::NAME) {
+            return nullptr;
+        }
+        Variable *variable = this->findVariable(name->value.lexeme);
+        return variable && variable->array < 0 ? variable : nullptr;
+    }
+
+    // Element of an array variable, nullptr when the index is outside of it
+    int64_t *findElement(const Grammar::IndexExpression *expr) {
+        auto name = dynamic_cast<const Grammar::LiteralExpression*>(expr->array);
+        if(!name || name->value.type != Lexing::TokenType::NAME) {
+            return nullptr;
+        }
+        const Variable *variable = this->findVariable(name->value.lexeme);
+        int64_t index = 0;
+        if(!variable || variable->array < 0 || !this->evaluate(expr->index, index)) {
+            return nullptr;
+        }
+        std::vector<int64_t> &array = this->arrays[variable->array];
+        if(index < 0 || index >= (int64_t)array.size()) {
+            return nullptr;
+        }
+        return &array[index];
+    }
+
+    // Arithmetic wraps around as in the generated code, the divisions which trap there fail
+    static bool apply(const Lexing::TokenType operation, const int64_t a, const int64_t b, int64_t &value) {
+        const uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        switch(operation) {
+            case Lexing::TokenType::PLUS: case Lexing::TokenType::PLUS_EQUAL: value = (int64_t)(x + y); return true;
+            case Lexing::TokenType::MINUS: case Lexing::TokenType::MINUS_EQUAL: value = (int64_t)(x - y); return true;
+            case Lexing::TokenType::STAR: case Lexing::TokenType::STAR_EQUAL: value = (int64_t)(x * y); return true;
+            case Lexing::TokenType::SLASH: case Lexing::TokenType::SLASH_EQUAL:
+            case Lexing::TokenType::MODULO: case Lexing::TokenType::MODULO_EQUAL:
+                if(b == 0 || (a == std::numeric_limits<int64_t>::min() && b == -1)) {
+                    return false;
+                }
+                value = operation == Lexing::TokenType::SLASH || operation == Lexing::TokenType::SLASH_EQUAL ? a / b : a % b;
+                return true;
+            case Lexing::TokenType::AND: case Lexing::TokenType::AND_EQUAL: value = a & b; return true;
+            case Lexing::TokenType::OR: case Lexing::TokenType::OR_EQUAL: value = a | b; return true;
+            case Lexing::TokenType::XOR: case Lexing::TokenType::XOR_EQUAL: value = a ^ b; return true;
+            case Lexing::TokenType::EQUAL_EQUAL: value = a == b; return true;
+            case Lexing::TokenType::BANG_EQUAL: value = a != b; return true;
+            case Lexing::TokenType::LESS: value = a < b; return true;
+            case Lexing::TokenType::LESS_EQUAL: value = a <= b; return true;
+            case Lexing::TokenType::GREATER: value = a > b; return true;
+            case Lexing::TokenType::GREATER_EQUAL: value = a >= b; return true;
+            case Lexing::TokenType::XORXOR: value = (a != 0) ^ (b != 0); return true;
+            case Lexing::TokenType::EQUAL: value = b; return true;
+            default: return false;
+        }
+    }
+
+    // The right side is evaluated first, then the element it is stored to
+    bool assign(const Grammar::BinaryExpression *expr, int64_t &value) {
+        int64_t right = 0;
+        if(!this->evaluate(expr->right, right)) {
+            return false;
+        }
+        int64_t *target = nullptr;
+        if(auto element = dynamic_cast<const Grammar::IndexExpression*>(expr->left)) {
+            target = this->findElement(element);
+        } else if(Variable *variable = this->findScalar(expr->left)) {
+            target = &variable->value;
+        }
+        if(!target || !apply(expr->operation, *target, right, value)) {
+            return false;
+        }
+        *target = value;
+        return true;
+    }
+
+    bool evaluate(const Grammar::Expression *expr, int64_t &value) {
+        if(!this->step()) {
+            return false;
+        }
+        if(auto literal = dynamic_cast<const Grammar::LiteralExpression*>(expr)) {
+            if(literal->value.type != Lexing::TokenType::NAME) {
+                return literalValue(literal, value);
+            }
+            const Variable *variable = this->findScalar(literal);
+            if(!variable) {
+                return false;
+            }
+            value = variable->value;
+            return true;
+        } else if(auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr)) {
+            if(binary->operation >= Lexing::TokenType::PLUS_EQUAL && binary->operation <= Lexing::TokenType::EQUAL) {
+                return this->assign(binary, value);
+            }
+            int64_t a = 0, b = 0;
+            if(!this->evaluate(binary->left, a)) {
+                return false;
+            }
+            // && and || skip their right side when the left one decides
+            if(binary->operation == Lexing::TokenType::ANDAND || binary->operation == Lexing::TokenType::OROR) {
+                if((a != 0) == (binary->operation == Lexing::TokenType::OROR)) {
+                    value = a != 0;
+                    return true;
+                }
+                if(!this->evaluate(binary->right, b)) {
+                    return false;
+                }
+                value = b != 0;
+                return true;
+            }
+            return this->evaluate(binary->right, b) && apply(binary->operation, a, b, value);
+        } else if(auto unary = dynamic_cast<const Grammar::UnaryExpression*>(expr)) {
+            int64_t a = 0;
+            if(!this->evaluate(unary->expr, a)) {
+                return false;
+            }
+            switch(unary->operation) {
+                case Lexing::TokenType::UNARY_PLUS: value = a; return true;
+                case Lexing::TokenType::UNARY_MINUS: value = (int64_t)(0 - (uint64_t)a); return true;
+                case Lexing::TokenType::NOT: value = ~a; return true;
+                case Lexing::TokenType::BANG: value = a == 0; return true;
+                default: return false;
+            }
+        } else if(auto element = dynamic_cast<const Grammar::IndexExpression*>(expr)) {
+            const int64_t *found = this->findElement(element);
+            if(!found) {
+                return false;
+            }
+            value = *found;
+            return true;
+        } else if(auto call = dynamic_cast<const Grammar::FunctionCall*>(expr)) {
+            return this->call(call, value);
+        }
+        return false;
+    }
+
+    // Arguments are evaluated in the caller, array parameters take the array of a variable
+    bool call(const Grammar::FunctionCall *expr, int64_t &value) {
+        auto found = this->functions.find(expr->name);
+        if(found == this->functions.end() || found->second->parameters.size() != expr->parameters.size()) {
+            return false;
+        }
+        const Grammar::FunctionDefinition *definition = found->second;
+        std::vector<Variable> arguments(expr->parameters.size());
+        bool memoized = true;
+        for(size_t i = 0; i < arguments.size(); i ++) {
+            if(isArrayType(definition->parameters[i]->type)) {
+                auto name = dynamic_cast<const Grammar::LiteralExpression*>(expr->parameters[i]);
+                const Variable *variable = name && name->value.type == Lexing::TokenType::NAME ? this->findVariable(name->value.lexeme) : nullptr;
+                if(!variable || variable->array < 0) {
+                    return false;
+                }
+                arguments[i] = *variable;
+                memoized = false;
+            } else if(!this->evaluate(expr->parameters[i], arguments[i].value)) {
+                return false;
+            }
+        }
+        return this->run(definition, arguments, memoized, value);
+    }
+
+    bool run(const Grammar::FunctionDefinition *definition, const std::vector<Variable> &arguments, const bool memoized, int64_t &value) {
+        std::pair<const Grammar::FunctionDefinition*, std::vector<int64_t> > key;
+        if(memoized) {
+            key.first = definition;
+            for(const auto &it : arguments) {
+                key.second.push_back(it.value);
+            }
+            auto known = this->results.find(key);
+            if(known != this->results.end()) {
+                this->stats.memoizedCalls ++;
+                value = known->second;
+                return true;
+            }
+        }
+        if(this->depth >= this->limits.depth) {
+            return false;
+        }
+
+        // The callee only sees its parameters
+        std::vector<std::unordered_map<std::string, Variable> > caller;
+        caller.swap(this->scopes);
+        this->scopes.emplace_back();
+        for(size_t i = 0; i < arguments.size(); i ++) {
+            this->scopes.back()[definition->parameters[i]->name] = arguments[i];
+        }
+        this->depth ++;
+        const Flow flow = this->execute(definition->body);
+        this->depth --;
+        this->scopes.swap(caller);
+        if(flow == Flow::FAILED) {
+            return false;
+        }
+        // Falling off the end returns 0
+        value = flow == Flow::RETURNED ? this->returned : 0;
+        if(memoized) {
+            this->results[key] = value;
+        }
+        return true;
+    }
+
+    // Statements of a loop run while the condition holds, a missing condition always holds
+    Flow loop(const Grammar::Expression *condition, const Grammar::Expression *stepExpr, const Grammar::Statement *body) {
+        while(true) {
+            int64_t holds = 1;
+            if(condition && !this->evaluate(condition, holds)) {
+                return Flow::FAILED;
+            }
+            if(!holds) {
+                return Flow::NEXT;
+            }
+            const Flow flow = this->execute(body);
+            if(flow != Flow::NEXT) {
+                return flow;
+            }
+            int64_t ignored = 0;
+            if(stepExpr && !this->evaluate(stepExpr, ignored)) {
+                return Flow::FAILED;
+            }
+        }
+    }
+
+    Flow execute(const Grammar::Statement *stmt) {
+        if(!this->step()) {
+            return Flow::FAILED;
+        }
+        if(auto list = dynamic_cast<const Grammar::StatementList*>(stmt)) {
+            this->scopes.emplace_back();
+            Flow flow = Flow::NEXT;
+            for(size_t i = 0; flow == Flow::NEXT && i < list->list.size(); i ++) {
+                flow = this->execute(list->list[i]);
+            }
+            this->scopes.pop_back();
+            return flow;
+        } else if(auto decl = dynamic_cast<const Grammar::DeclarationStatement*>(stmt)) {
+            if(this->classes.count(decl->type.substr(0, decl->type.find('[')))) {
+                return Flow::FAILED;
+            }
+            Variable variable;
+            if(isArrayType(decl->type)) {
+                // Arrays are declared as int[length] and start zeroed
+                const size_t open = decl->type.find('[');
+                int64_t length = 0;
+                size_t used = 0;
+                try {
+                    length = std::stoll(decl->type.substr(open + 1, decl->type.size() - open - 2), &used);
+                } catch(const std::exception &) {
+                    return Flow::FAILED;
+                }
+                if(decl->expr || length <= 0 || length > this->limits.words - this->words) {
+                    return Flow::FAILED;
+                }
+                this->words += length;
+                variable.array = (int32_t)this->arrays.size();
+                this->arrays.emplace_back(length, 0);
+            } else if(decl->expr && !this->evaluate(decl->expr, variable.value)) {
+                return Flow::FAILED;
+            }
+            this->scopes.back()[decl->name] = variable;
+            return Flow::NEXT;
+        } else if(auto exprStmt = dynamic_cast<const Grammar::ExpressionStatement*>(stmt)) {
+            int64_t ignored = 0;
+            return this->evaluate(exprStmt->expr, ignored) ? Flow::NEXT : Flow::FAILED;
+        } else if(auto ifStmt = dynamic_cast<const Grammar::IfStatement*>(stmt)) {
+            int64_t holds = 0;
+            if(!this->evaluate(ifStmt->condition, holds)) {
+                return Flow::FAILED;
+            }
+            if(holds) {
+                return this->execute(ifStmt->ifBody);
+            }
+            return ifStmt->elseBody ? this->execute(ifStmt->elseBody) : Flow::NEXT;
+        } else if(auto whileStmt = dynamic_cast<const Grammar::WhileStatement*>(stmt)) {
+            return this->loop(whileStmt->condition, nullptr, whileStmt->body);
+        } else if(auto forStmt = dynamic_cast<const Grammar::ForStatement*>(stmt)) {
+            // Variables declared by the init statement belong to the loop
+            this->scopes.emplace_back();
+            Flow flow = forStmt->init ? this->execute(forStmt->init) : Flow::NEXT;
+            if(flow == Flow::NEXT) {
+                flow = this->loop(forStmt->condition, forStmt->step, forStmt->body);
+            }
+            this->scopes.pop_back();
+            return flow;
+        } else if(auto ret = dynamic_cast<const Grammar::ReturnStatement*>(stmt)) {
+            this->returned = 0;
+            if(ret->expr && !this->evaluate(ret->expr, this->returned)) {
+                return Flow::FAILED;
+            }
+            return Flow::RETURNED;
+        }
+        return Flow::FAILED;
+    }
+
+    // Run a call of the program with the whole budget, the arrays it made are released afterwards
+    bool evaluateCall(const Grammar::FunctionCall *expr, int64_t &value) {
+        auto found = this->functions.find(expr->name);
+        if(found == this->functions.end() || found->second->parameters.size() != expr->parameters.size()) {
+            return false;
+        }
+        std::pair<const Grammar::FunctionDefinition*, std::vector<int64_t> > key;
+        key.first = found->second;
+        for(size_t i = 0; i < expr->parameters.size(); i ++) {
+            int64_t argument = 0;
+            if(isArrayType(found->second->parameters[i]->type) || !literalValue(expr->parameters[i], argument)) {
+                return false;
+            }
+            key.second.push_back(argument);
+        }
+        if(this->failures.count(key) || this->programSteps >= this->limits.programSteps) {
+            this->stats.failedCalls ++;
+            return false;
+        }
+
+        std::vector<Variable> arguments(key.second.size());
+        for(size_t i = 0; i < arguments.size(); i ++) {
+            arguments[i].value = key.second[i];
+        }
+        this->steps = 0;
+        this->words = 0;
+        const bool evaluated = this->run(found->second, arguments, true, value);
+        this->programSteps += this->steps;
+        this->stats.steps += this->steps;
+        this->arrays.clear();
+        if(!evaluated) {
+            this->failures[key] = true;
+            this->stats.failedCalls ++;
+        }
+        return evaluated;
+    }
+
+    // Calls are replaced innermost first, so their callers may see literal arguments
+    void foldExpression(Grammar::Expression *&expr) {
+        if(!expr) {
+            return;
+        }
+        if(auto binary = dynamic_cast<Grammar::BinaryExpression*>(expr)) {
+            this->foldExpression(binary->left);
+            this->foldExpression(binary->right);
+        } else if(auto unary = dynamic_cast<Grammar::UnaryExpression*>(expr)) {
+            this->foldExpression(unary->expr);
+        } else if(auto element = dynamic_cast<Grammar::IndexExpression*>(expr)) {
+            this->foldExpression(element->array);
+            this->foldExpression(element->index);
+        } else if(auto call = dynamic_cast<Grammar::FunctionCall*>(expr)) {
+            for(auto &it : call->parameters) {
+                this->foldExpression(it);
+            }
+            int64_t value = 0;
+            if(this->evaluateCall(call, value)) {
+                // A boolean function may still return any number
+                const bool isBool = this->functions.at(call->name)->returnType == "bool" && (value == 0 || value == 1);
+                const Lexing::Token token(isBool ? Lexing::TokenType::BOOLEAN : Lexing::TokenType::NUMBER,
+                    isBool ? (value ? "true" : "false") : std::to_string(value), call->lineNmb, call->startPos);
+                delete expr;
+                expr = new Grammar::LiteralExpression(token);
+                this->stats.evaluatedCalls ++;
+            }
+        }
+    }
+
+    void foldStatement(Grammar::Statement *stmt) {
+        if(!stmt) {
+            return;
+        }
+        if(auto list = dynamic_cast<Grammar::StatementList*>(stmt)) {
+            for(auto it : list->list) {
+                this->foldStatement(it);
+            }
+        } else if(auto decl = dynamic_cast<Grammar::DeclarationStatement*>(stmt)) {
+            this->foldExpression(decl->expr);
+        } else if(auto exprStmt = dynamic_cast<Grammar::ExpressionStatement*>(stmt)) {
+            this->foldExpression(exprStmt->expr);
+        } else if(auto ifStmt = dynamic_cast<Grammar::IfStatement*>(stmt)) {
+            this->foldExpression(ifStmt->condition);
+            this->foldStatement(ifStmt->ifBody);
+            this->foldStatement(ifStmt->elseBody);
+        } else if(auto whileStmt = dynamic_cast<Grammar::WhileStatement*>(stmt)) {
+            this->foldExpression(whileStmt->condition);
+            this->foldStatement(whileStmt->body);
+        } else if(auto forStmt = dynamic_cast<Grammar::ForStatement*>(stmt)) {
+            this->foldStatement(forStmt->init);
+            this->foldExpression(forStmt->condition);
+            this->foldExpression(forStmt->step);
+            this->foldStatement(forStmt->body);
+        } else if(auto ret = dynamic_cast<Grammar::ReturnStatement*>(stmt)) {
+            this->foldExpression(ret->expr);
+        } else if(auto definition = dynamic_cast<Grammar::FunctionDefinition*>(stmt)) {
+            this->foldStatement(definition->body);
+        }
+    }
+};
+
+int32_t evaluateCalls(Grammar::Statement *program, EvaluationStats &stats, const EvaluationLimits &limits) {
+    auto root = dynamic_cast<Grammar::StatementList*>(program);
+    if(!root) {
+        return 0;
+    }
+    Evaluator evaluator(stats, limits);
+    // The first definition of a name is the one calls are bound to
+    for(const auto stmt : root->list) {
+        if(auto definition = dynamic_cast<const Grammar::FunctionDefinition*>(stmt)) {
+            if(definition->name != MAIN_FUNCTION) {
+                evaluator.functions.emplace(definition->name, definition);
+            }
+        } else if(auto definition = dynamic_cast<const Grammar::ClassDefinition*>(stmt)) {
+            evaluator.classes.insert(definition->name);
+        }
+    }
+    const int32_t before = stats.evaluatedCalls;
+    evaluator.foldStatement(root);
+    return stats.evaluatedCalls - before;
+}
+
+};
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef BACKEND_EVALUATE_H
+#define BACKEND_EVALUATE_H
+
+#include <cstdint>
+
+#include "../Grammar.h"
+
+namespace Backend {
+
+/**
+ * @brief Bounds of the evaluation of one call, a call which goes past any of them is left to run
+ * 
+ */
+class EvaluationLimits {
+public:
+    /**
+     * @brief Statements and expressions the call may run, those of its callees included
+     * 
+     */
+    int64_t steps = (int64_t)1 << 20;
+
+    /**
+     * @brief Steps all the calls of the program may take, so failed calls cannot add up to a slow compilation
+     * 
+     */
+    int64_t programSteps = (int64_t)1 << 23;
+
+    /**
+     * @brief Words the local arrays of the call and its callees may take together
+     * 
+     */
+    int64_t words = (int64_t)1 << 20;
+
+    /**
+     * @brief Nested calls, each of them takes some stack of the compiler
+     * 
+     */
+    int32_t depth = 256;
+};
+
+/**
+ * @brief Counts of evaluateCalls
+ * 
+ */
+class EvaluationStats {
+public:
+    /**
+     * @brief Calls replaced by their result
+     * 
+     */
+    int32_t evaluatedCalls = 0;
+
+    /**
+     * @brief Calls, nested ones included, whose result was known from an earlier one with the same arguments
+     * 
+     */
+    int32_t memoizedCalls = 0;
+
+    /**
+     * @brief Calls with constant arguments which could not be evaluated
+     * 
+     */
+    int32_t failedCalls = 0;
+
+    int64_t steps = 0;
+};
+
+/**
+ * @brief Replace calls of functions of the module whose arguments are literals by a literal of their result.
+ * The calls are run by an interpreter which gives up as soon as the callee touches a global, calls a
+ * function of another module, indexes past an array, divides by zero or goes past the limits, so a call
+ * is only replaced when running it would only compute its result. Calls are replaced innermost first,
+ * so a call whose arguments are such calls is evaluated too. Results are remembered by function and
+ * arguments, calls with arrays as arguments are always run.
+ * 
+ * @param program Top level statement list of the module, without errors
+ * @param stats Counts of the evaluation
+ * @param limits Bounds of every call
+ * @return int32_t Calls replaced
+ */
+int32_t evaluateCalls(Grammar::Statement *program, EvaluationStats &stats, const EvaluationLimits &limits = EvaluationLimits());
+
+};
+
+#endif // BACKEND_EVALUATE_H
@@ -0,0 +1,211 @@
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Lowering.h"
+#include "Inline.h"
+
+namespace Backend {
+
+// Instructions a copy of the function adds to its caller, PARAM only becomes a move and profile counters
+// are left out so an instrumented build inlines like the build using its profile
+static int32_t inlineCost(const Function &function) {
+    int32_t cost = 0;
+    for(const auto &block : function.blocks) {
+        for(const auto &it : block.instructions) {
+            if(it.opcode == Opcode::VECTOR) {
+                return INT32_MAX;
+            }
+            cost += it.opcode != Opcode::PARAM && it.opcode != Opcode::PROFILE_COUNT;
+        }
+    }
+    return cost;
+}
+
+// Functions of the program in an order where every callee comes before its callers, except along cycles
+static void visitCallees(const Program &program, const int32_t function, std::vector<bool> &visited, std::vector<int32_t> &order) {
+    visited[function] = true;
+    for(const auto &block : program.functions[function].blocks) {
+        for(const auto &it : block.instructions) {
+            if(it.opcode == Opcode::CALL && it.callee >= 0 && !visited[it.callee]) {
+                visitCallees(program, it.callee, visited, order);
+            }
+        }
+    }
+    order.push_back(function);
+}
+
+static bool callsItself(const Program &program, const int32_t function) {
+    std::vector<bool> reached(program.functions.size(), false);
+    std::vector<int32_t> stack = {function};
+    while(!stack.empty()) {
+        const int32_t current = stack.back();
+        stack.pop_back();
+        for(const auto &block : program.functions[current].blocks) {
+            for(const auto &it : block.instructions) {
+                if(it.opcode != Opcode::CALL || it.callee < 0) {
+                    continue;
+                }
+                if(it.callee == function) {
+                    return true;
+                }
+                if(!reached[it.callee]) {
+                    reached[it.callee] = true;
+                    stack.push_back(it.callee);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Replace a call by the blocks of its callee. The entry of the copy continues the block of the
+ * call unless it is a loop header. The instructions after the call continue the block of the only
+ * RETURN of the copy or else move to a new block every RETURN jumps to, after moving its value to the
+ * result of the call. Counts of the copied blocks are scaled to the runs of the call.
+ * 
+ * @param caller Function containing the call
+ * @param block Block of the call
+ * @param index Position of the call in its block
+ * @param callee Called function
+ */
+static void inlineCall(Function &caller, const int32_t block, const size_t index, const Function &callee) {
+    const Instruction call = caller.blocks[block].instructions[index];
+    std::vector<Instruction> rest(caller.blocks[block].instructions.begin() + index + 1, caller.blocks[block].instructions.end());
+    caller.blocks[block].instructions.erase(caller.blocks[block].instructions.begin() + index, caller.blocks[block].instructions.end());
+
+    int32_t returns = 0;
+    bool isEntryTarget = false;
+    for(const auto &it : callee.blocks) {
+        const auto successors = it.successors();
+        isEntryTarget |= std::find(successors.begin(), successors.end(), 0) != successors.end();
+        returns += !it.instructions.empty() && it.instructions.back().opcode == Opcode::RETURN;
+    }
+    std::vector<int32_t> blockOf(callee.blocks.size());
+    for(size_t b = 0; b < callee.blocks.size(); b ++) {
+        blockOf[b] = b == 0 && !isEntryTarget ? block : caller.newBlock();
+    }
+    const int32_t continuation = returns == 1 ? -1 : caller.newBlock();
+    if(blockOf[0] != block) {
+        caller.blocks[block].instructions.emplace_back(Opcode::JUMP).target = blockOf[0];
+    }
+    const int64_t calls = caller.blocks[block].count, entries = callee.blocks[0].count;
+    for(size_t b = 0; b < callee.blocks.size(); b ++) {
+        if(blockOf[b] != block) {
+            const int64_t runs = callee.blocks[b].count;
+            caller.blocks[blockOf[b]].count = calls >= 0 && runs >= 0 && entries > 0 ? (int64_t)((double)runs * calls / entries) : -1;
+        }
+    }
+    if(continuation >= 0) {
+        caller.blocks[continuation].count = calls;
+    }
+
+    const int32_t vregBase = caller.vregCount;
+    const int64_t frameBase = caller.frameWords;
+    caller.vregCount += callee.vregCount;
+    caller.frameWords += callee.frameWords;
+    auto rename = [&](Operand &operand) {
+        if(operand.isVreg()) {
+            operand.value += vregBase;
+        }
+    };
+    for(size_t b = 0; b < callee.blocks.size(); b ++) {
+        auto &copy = caller.blocks[blockOf[b]].instructions;
+        for(Instruction it : callee.blocks[b].instructions) {
+            rename(it.a);
+            rename(it.b);
+            rename(it.c);
+            for(auto &argument : it.arguments) {
+                rename(argument);
+            }
+            if(it.dst >= 0) {
+                it.dst += vregBase;
+            }
+            if(it.target >= 0) {
+                it.target = blockOf[it.target];
+            }
+            if(it.alternative >= 0) {
+                it.alternative = blockOf[it.alternative];
+            }
+            for(auto &target : it.cases) {
+                target = blockOf[target];
+            }
+
+            if(it.opcode == Opcode::PARAM) {
+                copy.emplace_back(Opcode::MOVE, it.dst, call.arguments[it.a.value]);
+            } else if(it.opcode == Opcode::RETURN) {
+                if(call.dst >= 0) {
+                    copy.emplace_back(Opcode::MOVE, call.dst, it.a);
+                }
+                if(continuation < 0) {
+                    copy.insert(copy.end(), rest.begin(), rest.end());
+                } else {
+                    copy.emplace_back(Opcode::JUMP).target = continuation;
+                }
+            } else {
+                if(it.opcode == Opcode::ALLOCATE) {
+                    it.a.value += frameBase;
+                }
+                copy.push_back(it);
+            }
+        }
+    }
+    if(continuation >= 0) {
+        caller.blocks[continuation].instructions = std::move(rest);
+    }
+}
+
+int32_t inlineCalls(Program &program) {
+    const int32_t functionCount = (int32_t)program.functions.size();
+    std::vector<bool> visited(functionCount, false), isRecursive(functionCount);
+    std::vector<int32_t> order;
+    for(int32_t i = 0; i < functionCount; i ++) {
+        isRecursive[i] = callsItself(program, i);
+        if(!visited[i]) {
+            visitCallees(program, i, visited, order);
+        }
+    }
+
+    int64_t hottest = 0;
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            hottest = std::max(hottest, block.count);
+        }
+    }
+
+    int32_t inlined = 0;
+    std::vector<int32_t> cost(functionCount, INT32_MAX);
+    for(const auto current : order) {
+        Function &caller = program.functions[current];
+        // Blocks added by inlining are visited too, the calls left in a copied body were too large or recursive
+        for(int32_t b = 0; b < (int32_t)caller.blocks.size(); b ++) {
+            const auto &instructions = caller.blocks[b].instructions;
+            const int64_t runs = caller.blocks[b].count;
+            if(runs == 0) {
+                continue;
+            }
+            const int32_t budget = runs > 0 && runs >= hottest / HOT_CALL_RATIO ? HOT_INLINE_BUDGET : INLINE_BUDGET;
+            for(size_t i = 0; i < instructions.size(); i ++) {
+                const Instruction &it = instructions[i];
+                if(it.opcode != Opcode::CALL || it.callee < 0 || isRecursive[it.callee] || cost[it.callee] > budget) {
+                    continue;
+                }
+                const Function &callee = program.functions[it.callee];
+                if((int32_t)it.arguments.size() != callee.parameterCount || callee.frameWords > MAX_FRAME_WORDS - caller.frameWords) {
+                    continue;
+                }
+                // The block is visited again, it may go on with the copy and the instructions after the call
+                inlineCall(caller, b, i, callee);
+                inlined ++;
+                b --;
+                break;
+            }
+        }
+        cost[current] = inlineCost(caller);
+    }
+    return inlined;
+}
+
+};
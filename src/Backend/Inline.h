@@ -0,0 +1,43 @@
+#pragma once
+#ifndef BACKEND_INLINE_H
+#define BACKEND_INLINE_H
+
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Instructions a function may have, besides reading its parameters, to be inlined
+ * 
+ */
+const int32_t INLINE_BUDGET = 32;
+
+/**
+ * @brief Instructions a function may have to be inlined at a hot call site of a profiled program
+ * 
+ */
+const int32_t HOT_INLINE_BUDGET = 128;
+
+/**
+ * @brief A call site is hot when it runs at least once for this many runs of the most frequent block
+ * of the program
+ * 
+ */
+const int64_t HOT_CALL_RATIO = 100;
+
+/**
+ * @brief Replace calls of small functions of the program by a copy of their body. Callees are done
+ * before their callers, so a function is measured after the calls in it have been inlined. Functions
+ * which may call themselves again are never inlined. With block counts from a profile, hot call sites
+ * take functions up to HOT_INLINE_BUDGET and call sites which never ran are left alone.
+ * 
+ * @param program Program to transform, simplifyControlFlow has to run afterwards on every function
+ * @return int32_t Inlined calls
+ */
+int32_t inlineCalls(Program &program);
+
+};
+
+#endif // BACKEND_INLINE_H
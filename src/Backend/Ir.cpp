@@ -0,0 +1,223 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "Ir.h"
+
+namespace Backend {
+
+bool evaluateComparison(const Opcode condition, const int64_t a, const int64_t b) {
+    switch(condition) {
+        case Opcode::EQUAL: return a == b;
+        case Opcode::NOT_EQUAL: return a != b;
+        case Opcode::LESS: return a < b;
+        case Opcode::LESS_EQUAL: return a <= b;
+        case Opcode::GREATER: return a > b;
+        default: return a >= b;
+    }
+}
+
+Opcode invertComparison(const Opcode condition) {
+    switch(condition) {
+        case Opcode::EQUAL: return Opcode::NOT_EQUAL;
+        case Opcode::NOT_EQUAL: return Opcode::EQUAL;
+        case Opcode::LESS: return Opcode::GREATER_EQUAL;
+        case Opcode::LESS_EQUAL: return Opcode::GREATER;
+        case Opcode::GREATER: return Opcode::LESS_EQUAL;
+        default: return Opcode::LESS;
+    }
+}
+
+Opcode swapComparison(const Opcode condition) {
+    switch(condition) {
+        case Opcode::LESS: return Opcode::GREATER;
+        case Opcode::LESS_EQUAL: return Opcode::GREATER_EQUAL;
+        case Opcode::GREATER: return Opcode::LESS;
+        case Opcode::GREATER_EQUAL: return Opcode::LESS_EQUAL;
+        default: return condition;
+    }
+}
+
+/***********************Operand class***********************/
+Operand::Operand() : kind(Kind::NONE), value(0) {}
+
+Operand Operand::vreg(const int32_t index) {
+    Operand operand;
+    operand.kind = Kind::VREG;
+    operand.value = index;
+    return operand;
+}
+
+Operand Operand::immediate(const int64_t value) {
+    Operand operand;
+    operand.kind = Kind::IMMEDIATE;
+    operand.value = value;
+    return operand;
+}
+
+bool Operand::isVreg() const { return this->kind == Kind::VREG; }
+bool Operand::isImmediate() const { return this->kind == Kind::IMMEDIATE; }
+
+std::ostream& operator <<(std::ostream &os, const Operand &operand) {
+    if(operand.isVreg()) {
+        os << "v" << operand.value;
+    } else if(operand.isImmediate()) {
+        os << operand.value;
+    }
+    return os;
+}
+
+/***********************Instruction class*******************/
+Instruction::Instruction(const Opcode _opcode, const int32_t _dst, const Operand &_a, const Operand &_b)
+    : opcode(_opcode), dst(_dst), a(_a), b(_b), callee(-1), target(-1), alternative(-1), condition(Opcode::NOT_EQUAL), line(-1) {}
+
+bool Instruction::isTerminator() const {
+    return this->opcode == Opcode::JUMP || this->opcode == Opcode::BRANCH || this->opcode == Opcode::SWITCH || this->opcode == Opcode::RETURN
+        || this->opcode == Opcode::TAIL_CALL || this->opcode == Opcode::ADD_BRANCH;
+}
+
+void Instruction::retarget(const int32_t from, const int32_t to) {
+    if(this->target == from) {
+        this->target = to;
+    }
+    if(this->alternative == from) {
+        this->alternative = to;
+    }
+    for(auto &it : this->cases) {
+        if(it == from) {
+            it = to;
+        }
+    }
+}
+
+bool Instruction::isSpeculatable() const {
+    if(this->opcode == Opcode::DIV || this->opcode == Opcode::MOD) {
+        return this->b.isImmediate() && this->b.value != 0 && this->b.value != -1;
+    }
+    return (this->opcode >= Opcode::MOVE && this->opcode <= Opcode::GREATER_EQUAL) || this->opcode == Opcode::ADDRESS || this->opcode == Opcode::MUL_ADD;
+}
+
+std::ostream& operator <<(std::ostream &os, const Instruction &instruction) {
+    if(instruction.dst >= 0) {
+        os << "v" << instruction.dst << " = ";
+    }
+    os << OpcodeName[instruction.opcode];
+    switch(instruction.opcode) {
+        case Opcode::JUMP:
+            os << " b" << instruction.target;
+            break;
+        case Opcode::BRANCH:
+            os << " " << OpcodeName[instruction.condition] << " " << instruction.a << ", " << instruction.b << ", b" << instruction.target << ", b" << instruction.alternative;
+            break;
+        case Opcode::ADD_BRANCH:
+            os << " " << instruction.a << ", " << instruction.b << ", " << OpcodeName[instruction.condition] << " " << instruction.c
+                << ", b" << instruction.target << ", b" << instruction.alternative;
+            break;
+        case Opcode::SWITCH:
+            os << " " << instruction.a << ", " << instruction.b << ", [";
+            for(size_t i = 0; i < instruction.cases.size(); i ++) {
+                os << (i > 0 ? ", b" : "b") << instruction.cases[i];
+            }
+            os << "], b" << instruction.alternative;
+            break;
+        case Opcode::CALL: case Opcode::TAIL_CALL:
+            os << " " << instruction.symbol << "(";
+            for(size_t i = 0; i < instruction.arguments.size(); i ++) {
+                os << (i > 0 ? ", " : "") << instruction.arguments[i];
+            }
+            os << ")";
+            break;
+        case Opcode::LOAD_GLOBAL: case Opcode::ADDRESS:
+            os << " " << instruction.symbol;
+            break;
+        case Opcode::VECTOR:
+            os << " " << OpcodeName[instruction.condition] << " " << instruction.a << ", " << instruction.b << " {\n";
+            for(const auto &it : instruction.kernel) {
+                os << "        " << it << "\n";
+            }
+            os << "    }";
+            break;
+        case Opcode::STORE_GLOBAL:
+            os << " " << instruction.symbol << ", " << instruction.a;
+            break;
+        default:
+            if(instruction.a.kind != Operand::Kind::NONE) {
+                os << " " << instruction.a;
+            }
+            if(instruction.b.kind != Operand::Kind::NONE) {
+                os << ", " << instruction.b;
+            }
+            if(instruction.c.kind != Operand::Kind::NONE) {
+                os << ", " << instruction.c;
+            }
+            if(instruction.d.kind != Operand::Kind::NONE) {
+                os << ", " << instruction.d;
+            }
+    }
+    return os;
+}
+
+/***********************BasicBlock class********************/
+std::vector<int32_t> BasicBlock::successors() const {
+    if(this->instructions.empty()) {
+        return {};
+    }
+    const Instruction &last = this->instructions.back();
+    if(last.opcode == Opcode::JUMP) {
+        return {last.target};
+    } else if(last.opcode == Opcode::BRANCH || last.opcode == Opcode::ADD_BRANCH) {
+        return {last.target, last.alternative};
+    } else if(last.opcode == Opcode::SWITCH) {
+        std::vector<int32_t> successors = last.cases;
+        successors.push_back(last.alternative);
+        return successors;
+    }
+    return {};
+}
+
+/***********************Function class**********************/
+Function::Function(const std::string &_name, const int32_t _parameterCount) : name(_name), parameterCount(_parameterCount), vregCount(0), frameWords(0) {}
+
+int32_t Function::newVreg() {
+    return this->vregCount ++;
+}
+
+int32_t Function::newBlock() {
+    this->blocks.emplace_back();
+    return (int32_t)this->blocks.size() - 1;
+}
+
+std::ostream& operator <<(std::ostream &os, const Function &function) {
+    os << "function " << function.name << "(" << function.parameterCount << ") {\n";
+    for(size_t i = 0; i < function.blocks.size(); i ++) {
+        os << "b" << i;
+        if(function.blocks[i].count >= 0) {
+            os << " (" << function.blocks[i].count << ")";
+        }
+        os << ":\n";
+        for(const auto &it : function.blocks[i].instructions) {
+            os << "    " << it << "\n";
+        }
+    }
+    os << "}\n";
+    return os;
+}
+
+/***********************Program class***********************/
+Global::Global(const std::string &_name, const int64_t _length) : name(_name), length(_length) {}
+
+std::ostream& operator <<(std::ostream &os, const Program &program) {
+    for(const auto &it : program.globals) {
+        os << "global " << it.name;
+        if(it.length > 0) {
+            os << "[" << it.length << "]";
+        }
+        os << "\n";
+    }
+    for(const auto &it : program.functions) {
+        os << it;
+    }
+    return os;
+}
+
+};
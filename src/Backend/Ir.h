@@ -0,0 +1,351 @@
+#pragma once
+#ifndef BACKEND_IR_H
+#define BACKEND_IR_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Backend {
+
+/**
+ * @brief Operations of the lowered form. All values are 64 bit integers, comparisons produce 0 or 1.
+ * 
+ */
+enum Opcode : uint8_t {
+    MOVE, ADD, SUB, MUL, DIV, MOD, AND, OR, XOR, NEG, NOT,
+    EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL,
+    PARAM, LOAD_GLOBAL, STORE_GLOBAL, CALL,
+    ADDRESS, ALLOCATE, NEW, LOAD_ELEMENT, STORE_ELEMENT, VECTOR, PROFILE_COUNT,
+    JUMP, BRANCH, SWITCH, RETURN, TAIL_CALL,
+    MUL_ADD, ADD_DIV, ADD_MOD, ADD_BRANCH, ADD_STORE, MOD_ADD, LOAD_MOD, SUB_LOAD,
+    OPCODE_COUNT
+};
+
+const std::string OpcodeName[Opcode::OPCODE_COUNT] = {
+    "move", "add", "sub", "mul", "div", "mod", "and", "or", "xor", "neg", "not",
+    "eq", "ne", "lt", "le", "gt", "ge",
+    "param", "load", "store", "call",
+    "address", "allocate", "new", "getelem", "setelem", "vector", "count",
+    "jump", "branch", "switch", "return", "tailcall",
+    "muladd", "adddiv", "addmod", "addbranch", "addset", "modadd", "getmod", "subget"
+};
+
+/**
+ * @brief Callee of a CALL to the print intrinsic of the program, which writes its first argument in
+ * decimal followed by the character of its second one to the buffered standard output
+ * 
+ */
+const int32_t PRINT_INTRINSIC = -2;
+
+/**
+ * @brief Callee of a CALL to the read intrinsic, which reads one byte from the descriptor of its argument
+ * and returns it, or -1 at the end of the input or when reading fails
+ * 
+ */
+const int32_t READ_INTRINSIC = -3;
+
+/**
+ * @brief Callee of a CALL to the write intrinsic, which writes the low byte of its second argument to the
+ * descriptor of its first one and returns 1, or -1 when writing fails
+ * 
+ */
+const int32_t WRITE_INTRINSIC = -4;
+
+/**
+ * @brief Evaluate one of the comparison opcodes
+ * 
+ * @param condition EQUAL to GREATER_EQUAL
+ * @param a Left operand
+ * @param b Right operand
+ * @return true The comparison holds
+ */
+bool evaluateComparison(const Opcode condition, const int64_t a, const int64_t b);
+
+/**
+ * @brief Get the comparison which holds exactly when condition fails
+ * 
+ */
+Opcode invertComparison(const Opcode condition);
+
+/**
+ * @brief Get the comparison of the swapped operands, b swapped a holds when a condition b holds
+ * 
+ */
+Opcode swapComparison(const Opcode condition);
+
+/**
+ * @brief Virtual register or immediate operand of an instruction
+ * 
+ */
+class Operand {
+public:
+    enum Kind : uint8_t {
+        NONE, VREG, IMMEDIATE
+    };
+
+    Kind kind;
+    int64_t value;
+
+    Operand();
+    static Operand vreg(const int32_t index);
+    static Operand immediate(const int64_t value);
+    bool isVreg() const;
+    bool isImmediate() const;
+};
+
+std::ostream& operator <<(std::ostream &os, const Operand &operand);
+
+/**
+ * @brief Three address instruction. Virtual registers are not in SSA form, variables keep one
+ * register which is written by every assignment.
+ * 
+ * Arrays are addressed by a register holding the address of their first element, ADDRESS gets it for
+ * a global array and ALLOCATE zeroes the frame words [a, a + b) and gets their address. NEW gets the address
+ * of a zeroed words on the heap, which the collector of the program frees once nothing reaches them.
+ * LOAD_ELEMENT reads element b of the array at a and STORE_ELEMENT writes c to it, indexes are not checked.
+ * 
+ * TAIL_CALL ends a block by returning what the callee returns, the callee reuses the frame of the caller.
+ * 
+ * PROFILE_COUNT adds one to the profile counter a of the program.
+ * 
+ * The superinstructions of fuseInstructions come last: MUL_ADD computes a * b + c with an immediate b,
+ * ADD_DIV and ADD_MOD divide a + b by c. ADD_BRANCH ends a block by writing a + b to dst and branching
+ * like BRANCH on dst condition c. ADD_STORE writes c + d to element b of the array at a, MOD_ADD computes
+ * a % b + c, LOAD_MOD reads element b of the array at a modulo c and SUB_LOAD reads element b - c with an
+ * immediate c.
+ * 
+ */
+class Instruction {
+public:
+    Opcode opcode;
+
+    /**
+     * @brief Defined virtual register or -1
+     * 
+     */
+    int32_t dst;
+    Operand a;
+    Operand b;
+
+    /**
+     * @brief Value written by STORE_ELEMENT, third operand of a superinstruction
+     * 
+     */
+    Operand c;
+
+    /**
+     * @brief Fourth operand of ADD_STORE
+     * 
+     */
+    Operand d;
+
+    /**
+     * @brief Arguments of CALL and TAIL_CALL
+     * 
+     */
+    std::vector<Operand> arguments;
+
+    /**
+     * @brief Callee of CALL and TAIL_CALL or global of LOAD_GLOBAL and STORE_GLOBAL
+     * 
+     */
+    std::string symbol;
+
+    /**
+     * @brief Index in Program::functions of the function a CALL or TAIL_CALL is bound to, -1 for a
+     * function of an imported module and PRINT_INTRINSIC, READ_INTRINSIC or WRITE_INTRINSIC for the intrinsics
+     * 
+     */
+    int32_t callee;
+
+    /**
+     * @brief Block of JUMP, block of BRANCH or ADD_BRANCH taken when the comparison holds
+     * 
+     */
+    int32_t target;
+
+    /**
+     * @brief Block of BRANCH or ADD_BRANCH taken when the comparison fails, block of SWITCH for values without a case
+     * 
+     */
+    int32_t alternative;
+
+    /**
+     * @brief Comparison of a and b deciding a BRANCH, NOT_EQUAL against 0 tests a truth value
+     * 
+     */
+    Opcode condition;
+
+    /**
+     * @brief Blocks of SWITCH, case i is taken when a equals b + i
+     * 
+     */
+    std::vector<int32_t> cases;
+
+    /**
+     * @brief One iteration of a VECTOR loop. The loop counts dst from a while dst condition b holds,
+     * running the kernel on as many consecutive counter values as a vector register has lanes. At least
+     * one iteration is left to the scalar loop which follows. Elements are indexed by the counter, the
+     * other registers the kernel reads but does not define are its arguments.
+     * 
+     */
+    std::vector<Instruction> kernel;
+
+    /**
+     * @brief Line of the statement the instruction was lowered from, as the lexer counts them, -1 for
+     * instructions an optimization made up
+     * 
+     */
+    int32_t line;
+
+    Instruction(const Opcode _opcode, const int32_t _dst = -1, const Operand &_a = Operand(), const Operand &_b = Operand());
+
+    bool isTerminator() const;
+
+    /**
+     * @brief Make a terminator continue at block to wherever it continued at block from
+     * 
+     */
+    void retarget(const int32_t from, const int32_t to);
+
+    /**
+     * @brief Whether the instruction only computes its result and cannot trap, so it may run more
+     * often than written or not at all
+     * 
+     */
+    bool isSpeculatable() const;
+
+    /**
+     * @brief Call f with every virtual register read by the instruction
+     * 
+     */
+    template <typename F>
+    void forEachUse(F f) const {
+        if(this->a.isVreg()) {
+            f((int32_t)this->a.value);
+        }
+        if(this->b.isVreg()) {
+            f((int32_t)this->b.value);
+        }
+        if(this->c.isVreg()) {
+            f((int32_t)this->c.value);
+        }
+        if(this->d.isVreg()) {
+            f((int32_t)this->d.value);
+        }
+        for(const auto &it : this->arguments) {
+            if(it.isVreg()) {
+                f((int32_t)it.value);
+            }
+        }
+    }
+};
+
+std::ostream& operator <<(std::ostream &os, const Instruction &instruction);
+
+class BasicBlock {
+public:
+    std::vector<Instruction> instructions;
+
+    /**
+     * @brief Runs of the block in the profile of the program, -1 when there is none or the block was
+     * made after the profile was applied
+     * 
+     */
+    int64_t count = -1;
+
+    /**
+     * @brief Get the blocks the terminator can jump to
+     * 
+     * @return std::vector<int32_t> Successor blocks
+     */
+    std::vector<int32_t> successors() const;
+};
+
+class Function {
+public:
+    std::string name;
+    int32_t parameterCount;
+    int32_t vregCount;
+
+    /**
+     * @brief Words of the frame taken by the arrays of ALLOCATE
+     * 
+     */
+    int64_t frameWords;
+
+    /**
+     * @brief Blocks in layout order, the first one is the entry and starts with the PARAM instructions
+     * 
+     */
+    std::vector<BasicBlock> blocks;
+
+    Function(const std::string &_name = "", const int32_t _parameterCount = 0);
+    int32_t newVreg();
+    int32_t newBlock();
+};
+
+std::ostream& operator <<(std::ostream &os, const Function &function);
+
+/**
+ * @brief Variable of the top level statement list, it lives in memory
+ * 
+ */
+class Global {
+public:
+    std::string name;
+
+    /**
+     * @brief Elements of an array, 0 for an integer
+     * 
+     */
+    int64_t length;
+
+    Global(const std::string &_name, const int64_t _length = 0);
+};
+
+class Program {
+public:
+    std::vector<Function> functions;
+    std::vector<Global> globals;
+
+    /**
+     * @brief Hash of the blocks when profile counters are placed, see hashLayout
+     * 
+     */
+    uint64_t layoutHash = 0;
+
+    /**
+     * @brief Counters of the PROFILE_COUNT instructions, 0 when the program is not instrumented
+     * 
+     */
+    int64_t profileCounters = 0;
+
+    /**
+     * @brief File the instrumented program writes its counters to when MAIN_FUNCTION returns
+     * 
+     */
+    std::string profilePath;
+
+    /**
+     * @brief File the program writes the samples of its SIGPROF handler to when MAIN_FUNCTION returns,
+     * empty for a program which is not sampled
+     * 
+     */
+    std::string samplePath;
+
+    /**
+     * @brief Source the line table and call frames of the generated code refer to, empty for code without
+     * debug information
+     * 
+     */
+    std::string sourcePath;
+};
+
+std::ostream& operator <<(std::ostream &os, const Program &program);
+
+};
+
+#endif // BACKEND_IR_H
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "Layout.h"
+
+namespace Backend {
+
+static int64_t roundUp(const int64_t value, const int64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool primitiveLayout(const std::string &type, int64_t &size, int64_t &alignment) {
+    static const std::map<std::string, int64_t> sizes = {
+        {"bool", 1}, {"i8", 1}, {"u8", 1}, {"i16", 2}, {"u16", 2}, {"char", 4}, {"i32", 4}, {"u32", 4},
+        {"int", 8}, {"i64", 8}, {"u64", 8}
+    };
+    auto it = sizes.find(type);
+    if(it == sizes.end()) {
+        return false;
+    }
+    size = alignment = it->second;
+    return true;
+}
+
+/***********************FieldLayout class*******************/
+FieldLayout::FieldLayout(const std::string &_name, const std::string &_type, const int64_t _size, const int64_t _alignment)
+    : name(_name), type(_type), offset(0), size(_size), alignment(_alignment) {}
+
+/***********************ClassLayout class*******************/
+ClassLayout::ClassLayout(const std::string &_name) : name(_name), size(0), alignment(1), structOfArrays(false) {}
+
+int64_t ClassLayout::padding() const {
+    int64_t used = 0;
+    for(const auto &it : this->fields) {
+        used += it.size;
+    }
+    return this->size - used;
+}
+
+int32_t ClassLayout::field(const std::string &name) const {
+    for(size_t i = 0; i < this->fields.size(); i ++) {
+        if(this->fields[i].name == name) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+// Fields by decreasing alignment, keeping the declaration order among equal ones
+static std::vector<size_t> placementOrder(const std::vector<FieldLayout> &fields) {
+    std::vector<size_t> order(fields.size());
+    for(size_t i = 0; i < order.size(); i ++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return fields[a].alignment > fields[b].alignment; });
+    return order;
+}
+
+std::ostream& operator <<(std::ostream &os, const ClassLayout &layout) {
+    os << "class " << layout.name << ": " << layout.size << " bytes, alignment " << layout.alignment << ", " << layout.padding() << " bytes of padding";
+    if(layout.structOfArrays) {
+        os << ", arrays by field";
+    }
+    os << "\n";
+    std::vector<const FieldLayout*> fields;
+    for(const auto &it : layout.fields) {
+        fields.push_back(&it);
+    }
+    std::stable_sort(fields.begin(), fields.end(), [](const FieldLayout *a, const FieldLayout *b) { return a->offset < b->offset; });
+    for(const auto it : fields) {
+        os << "    " << it->name << " : " << it->type << " at " << it->offset << ", " << it->size << " bytes\n";
+    }
+    return os;
+}
+
+/***********************ArrayLayout class*******************/
+ArrayLayout::ArrayLayout(const ClassLayout &layout, const int64_t _count) : count(_count), bytes(0),
+    starts(layout.fields.size()), strides(layout.fields.size()) {
+    if(!layout.structOfArrays) {
+        for(size_t i = 0; i < layout.fields.size(); i ++) {
+            this->starts[i] = layout.fields[i].offset;
+            this->strides[i] = layout.size;
+        }
+        this->bytes = layout.size * this->count;
+        return;
+    }
+    // Columns are placed like the fields of an object, so they need no padding between them either
+    for(const auto i : placementOrder(layout.fields)) {
+        this->bytes = roundUp(this->bytes, layout.fields[i].alignment);
+        this->starts[i] = this->bytes;
+        this->strides[i] = layout.fields[i].size;
+        this->bytes += layout.fields[i].size * this->count;
+    }
+}
+
+class ClassLayouter {
+public:
+    std::map<std::string, const Grammar::ClassDefinition*> definitions;
+    std::map<std::string, ClassLayout> &layouts;
+    std::vector<Lexing::Diagnostic> &diagnostics;
+
+    // Classes whose layout is being computed, a class among them contains itself
+    std::vector<std::string> open;
+
+    // Classes with errors, which were reported once
+    std::vector<std::string> failed;
+
+    ClassLayouter(std::map<std::string, ClassLayout> &_layouts, std::vector<Lexing::Diagnostic> &_diagnostics) : layouts(_layouts), diagnostics(_diagnostics) {}
+
+    template <typename... T>
+    void error(const Grammar::ClassDefinition *definition, T... t) {
+        this->diagnostics.push_back(Lexing::Diagnostic::make(definition->lineNmb, 0, t..., "\n"));
+    }
+
+    bool typeLayout(const Grammar::ClassDefinition *definition, const Grammar::DeclarationStatement *field, int64_t &size, int64_t &alignment) {
+        std::string type = field->type;
+        int64_t length = 1;
+        const size_t open = type.find('[');
+        if(open != std::string::npos) {
+            const std::string digits = type.substr(open + 1, type.size() - open - 2);
+            type = type.substr(0, open);
+            length = 0;
+            try {
+                length = digits.empty() ? 0 : std::stoll(digits);
+            } catch(const std::exception &) {
+                length = 0;
+            }
+            if(length <= 0) {
+                this->error(definition, "Field ", field->name, " of class ", definition->name, " needs a positive array length");
+                return false;
+            }
+        }
+        if(!primitiveLayout(type, size, alignment)) {
+            if(!this->definitions.count(type)) {
+                this->error(definition, "Field ", field->name, " of class ", definition->name, " has unknown type ", type);
+                return false;
+            }
+            if(std::find(this->open.begin(), this->open.end(), type) != this->open.end()) {
+                this->error(definition, "Class ", type, " contains itself through field ", field->name, " of class ", definition->name);
+                return false;
+            }
+            if(!this->layout(type)) {
+                return false;
+            }
+            size = this->layouts.at(type).size;
+            alignment = this->layouts.at(type).alignment;
+        }
+        if(size > INT64_MAX / length) {
+            this->error(definition, "Field ", field->name, " of class ", definition->name, " is too large");
+            return false;
+        }
+        size *= length;
+        return true;
+    }
+
+    bool layout(const std::string &name) {
+        if(this->layouts.count(name)) {
+            return true;
+        }
+        if(std::find(this->failed.begin(), this->failed.end(), name) != this->failed.end()) {
+            return false;
+        }
+        const Grammar::ClassDefinition *definition = this->definitions.at(name);
+        ClassLayout layout(name);
+        layout.structOfArrays = definition->hasAttribute(SOA_ATTRIBUTE);
+        for(const auto &it : definition->attributes) {
+            if(it != SOA_ATTRIBUTE && it != ORDERED_ATTRIBUTE) {
+                this->error(definition, "Class ", name, " has unknown attribute ", it);
+            }
+        }
+
+        this->open.push_back(name);
+        bool valid = true;
+        for(const auto field : definition->fields) {
+            int64_t size = 0, alignment = 1;
+            if(layout.field(field->name) >= 0) {
+                this->error(definition, "Field ", field->name, " of class ", name, " is declared twice");
+                valid = false;
+            } else if(this->typeLayout(definition, field, size, alignment)) {
+                layout.fields.emplace_back(field->name, field->type, size, alignment);
+            } else {
+                valid = false;
+            }
+        }
+        this->open.pop_back();
+        if(!valid) {
+            this->failed.push_back(name);
+            return false;
+        }
+
+        std::vector<size_t> order = placementOrder(layout.fields);
+        if(definition->hasAttribute(ORDERED_ATTRIBUTE)) {
+            std::sort(order.begin(), order.end());
+        }
+        int64_t offset = 0;
+        for(const auto i : order) {
+            FieldLayout &field = layout.fields[i];
+            offset = roundUp(offset, field.alignment);
+            field.offset = offset;
+            offset += field.size;
+            layout.alignment = std::max(layout.alignment, field.alignment);
+        }
+        layout.size = roundUp(offset, layout.alignment);
+        this->layouts.emplace(name, layout);
+        return true;
+    }
+};
+
+void layoutClasses(const Grammar::Statement *program, std::map<std::string, ClassLayout> &layouts, std::vector<Lexing::Diagnostic> &diagnostics) {
+    auto root = dynamic_cast<const Grammar::StatementList*>(program);
+    if(!root) {
+        return;
+    }
+    ClassLayouter layouter(layouts, diagnostics);
+    std::vector<std::string> names;
+    for(const auto stmt : root->list) {
+        if(auto definition = dynamic_cast<const Grammar::ClassDefinition*>(stmt)) {
+            int64_t size = 0, alignment = 0;
+            if(primitiveLayout(definition->name, size, alignment)) {
+                layouter.error(definition, "Class ", definition->name, " has the name of a primitive type");
+                continue;
+            }
+            if(layouter.definitions.count(definition->name)) {
+                layouter.error(definition, "Class ", definition->name, " is defined twice");
+                continue;
+            }
+            layouter.definitions[definition->name] = definition;
+            names.push_back(definition->name);
+        }
+    }
+    for(const auto &it : names) {
+        layouter.layout(it);
+    }
+}
+
+};
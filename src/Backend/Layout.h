@@ -0,0 +1,125 @@
+#pragma once
+#ifndef BACKEND_LAYOUT_H
+#define BACKEND_LAYOUT_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdint>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+
+namespace Backend {
+
+/**
+ * @brief Attribute of a class whose fields keep the order they were declared in
+ * 
+ */
+const std::string ORDERED_ATTRIBUTE = "ordered";
+
+/**
+ * @brief Attribute of a class whose arrays keep every field in an array of its own
+ * 
+ */
+const std::string SOA_ATTRIBUTE = "soa";
+
+/**
+ * @brief Bytes and alignment of the primitive types, a type T[N] takes N times the bytes of T
+ * 
+ * @param type Name of the type
+ * @param size Bytes of a value
+ * @param alignment Alignment of a value
+ * @return true The type is primitive
+ */
+bool primitiveLayout(const std::string &type, int64_t &size, int64_t &alignment);
+
+class FieldLayout {
+public:
+    std::string name;
+    std::string type;
+    int64_t offset;
+    int64_t size;
+    int64_t alignment;
+
+    FieldLayout(const std::string &_name, const std::string &_type, const int64_t _size, const int64_t _alignment);
+};
+
+/**
+ * @brief Memory layout of a class. Unless it is ORDERED_ATTRIBUTE, its fields are placed by decreasing
+ * alignment, which leaves no padding but at the end since every alignment is a power of two.
+ * 
+ */
+class ClassLayout {
+public:
+    std::string name;
+    int64_t size;
+    int64_t alignment;
+
+    /**
+     * @brief Fields in declaration order with the offsets they were placed at
+     * 
+     */
+    std::vector<FieldLayout> fields;
+
+    bool structOfArrays;
+
+    ClassLayout(const std::string &_name = "");
+
+    /**
+     * @brief Bytes of an object which belong to no field
+     * 
+     */
+    int64_t padding() const;
+
+    /**
+     * @brief Find a field by name
+     * 
+     * @return int32_t Index in fields, -1 when there is no such field
+     */
+    int32_t field(const std::string &name) const;
+};
+
+std::ostream& operator <<(std::ostream &os, const ClassLayout &layout);
+
+/**
+ * @brief Placement of an array of objects. Objects follow each other at a stride of the size of the class,
+ * or with SOA_ATTRIBUTE every field is a column of its own and the columns follow each other.
+ * 
+ */
+class ArrayLayout {
+public:
+    int64_t count;
+    int64_t bytes;
+
+    /**
+     * @brief Offset of each field of the first object, in declaration order
+     * 
+     */
+    std::vector<int64_t> starts;
+
+    /**
+     * @brief Bytes from a field of one object to the same field of the next one, in declaration order
+     * 
+     */
+    std::vector<int64_t> strides;
+
+    ArrayLayout(const ClassLayout &layout, const int64_t _count);
+
+    int64_t offset(const int64_t index, const int32_t field) const { return this->starts[field] + index * this->strides[field]; }
+};
+
+/**
+ * @brief Lay out every class defined at the top level of a module. Classes may contain each other by
+ * value in any order, but not themselves.
+ * 
+ * @param program Root of the module
+ * @param layouts Layouts by class name
+ * @param diagnostics Unknown types, repeated names and classes which contain themselves
+ */
+void layoutClasses(const Grammar::Statement *program, std::map<std::string, ClassLayout> &layouts, std::vector<Lexing::Diagnostic> &diagnostics);
+
+};
+
+#endif // BACKEND_LAYOUT_H
@@ -0,0 +1,244 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+#include "LinearScan.h"
+
+namespace Backend {
+
+Location::Location() : reg(Register::NO_REGISTER), slot(-1) {}
+bool Location::isRegister() const { return this->reg != Register::NO_REGISTER; }
+
+LiveInterval::LiveInterval() : vreg(-1), start(INT32_MAX), end(-1), spillCost(0), crossesCall(false), registerHint(Register::NO_REGISTER) {}
+
+Allocation::Allocation() : spillSlots(0), spilledIntervals(0) {}
+
+std::vector<LiveInterval> computeLiveIntervals(const Function &function) {
+    const size_t blockCount = function.blocks.size();
+    std::vector<int32_t> firstIndex(blockCount);
+    int32_t index = 0;
+    for(size_t b = 0; b < blockCount; b ++) {
+        firstIndex[b] = index;
+        index += (int32_t)function.blocks[b].instructions.size();
+    }
+    const Liveness liveness = computeLiveness(function);
+    const std::vector<VregSet> &liveIn = liveness.liveIn, &liveOut = liveness.liveOut;
+
+    // Every loop containing a block makes it one deeper
+    std::vector<int32_t> loopDepth(blockCount, 0);
+    for(const auto &loop : findLoops(function)) {
+        for(size_t b = 0; b < blockCount; b ++) {
+            loopDepth[b] += loop.contains[b];
+        }
+    }
+
+    std::vector<LiveInterval> intervals(function.vregCount);
+    for(int32_t i = 0; i < function.vregCount; i ++) {
+        intervals[i].vreg = i;
+    }
+    auto extend = [&](const int32_t vreg, const int32_t position) {
+        intervals[vreg].start = std::min(intervals[vreg].start, position);
+        intervals[vreg].end = std::max(intervals[vreg].end, position);
+    };
+    std::vector<int32_t> calls;
+    for(size_t b = 0; b < blockCount; b ++) {
+        const auto &instructions = function.blocks[b].instructions;
+        if(instructions.empty()) {
+            continue;
+        }
+        const int32_t first = firstIndex[b];
+        const int32_t last = first + (int32_t)instructions.size() - 1;
+        liveIn[b].forEach([&](const int32_t vreg) { extend(vreg, 2 * first); });
+        liveOut[b].forEach([&](const int32_t vreg) { extend(vreg, 2 * last + 1); });
+        const double weight = std::pow(10.0, std::min(loopDepth[b], 6));
+        for(int32_t i = 0; i < (int32_t)instructions.size(); i ++) {
+            const Instruction &instruction = instructions[i];
+            const int32_t position = 2 * (first + i);
+            instruction.forEachUse([&](const int32_t vreg) {
+                extend(vreg, position);
+                intervals[vreg].spillCost += weight;
+            });
+            if(instruction.dst >= 0) {
+                extend(instruction.dst, position + 1);
+                intervals[instruction.dst].spillCost += weight;
+            }
+
+            if(instruction.opcode == Opcode::PARAM && instruction.a.value < 6) {
+                intervals[instruction.dst].registerHint = ARGUMENT_REGISTERS[instruction.a.value];
+            } else if(instruction.opcode >= Opcode::MOVE && instruction.opcode <= Opcode::NOT
+                && instruction.opcode != Opcode::DIV && instruction.opcode != Opcode::MOD) {
+                // Two address instructions need no copy when the result takes the register of an operand
+                if(instruction.a.isVreg()) {
+                    intervals[instruction.dst].vregHints.push_back((int32_t)instruction.a.value);
+                }
+                if(instruction.b.isVreg() && instruction.opcode != Opcode::SUB) {
+                    intervals[instruction.dst].vregHints.push_back((int32_t)instruction.b.value);
+                }
+            } else if(instruction.opcode == Opcode::NEW) {
+                // Allocated by a call into the collected heap
+                calls.push_back(position);
+            } else if(instruction.opcode == Opcode::CALL || instruction.opcode == Opcode::TAIL_CALL) {
+                // Nothing is live after a tail call, so it clobbers no interval
+                if(instruction.opcode == Opcode::CALL) {
+                    calls.push_back(position);
+                }
+                for(size_t k = 0; k < instruction.arguments.size() && k < 6; k ++) {
+                    if(instruction.arguments[k].isVreg()) {
+                        intervals[instruction.arguments[k].value].registerHint = ARGUMENT_REGISTERS[k];
+                    }
+                }
+            }
+        }
+    }
+
+    // Calls are in position order, an interval crosses one if it is live before and after it
+    for(auto &it : intervals) {
+        auto call = std::lower_bound(calls.begin(), calls.end(), it.start);
+        it.crossesCall = call != calls.end() && *call < it.end;
+    }
+    return intervals;
+}
+
+Allocation allocateLinearScan(const Function &function) {
+    std::vector<LiveInterval> intervals = computeLiveIntervals(function);
+    Allocation allocation;
+    allocation.locations.resize(function.vregCount);
+
+    std::vector<int32_t> order;
+    for(const auto &it : intervals) {
+        if(it.end >= 0) {
+            order.push_back(it.vreg);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](const int32_t a, const int32_t b) {
+        return intervals[a].start < intervals[b].start || (intervals[a].start == intervals[b].start && a < b);
+    });
+
+    auto weight = [&](const int32_t vreg) {
+        return intervals[vreg].spillCost / (intervals[vreg].end - intervals[vreg].start + 1);
+    };
+
+    bool isFree[Register::REGISTER_COUNT] = {};
+    for(const auto it : CALLER_SAVED_REGISTERS) {
+        isFree[it] = true;
+    }
+    for(const auto it : CALLEE_SAVED_REGISTERS) {
+        isFree[it] = true;
+    }
+    bool usedCalleeSaved[Register::REGISTER_COUNT] = {};
+    std::vector<int32_t> active, spilledActive, freeSlots;
+
+    // End of the last interval in each slot. An evicted interval started earlier and takes the slot for its
+    // whole lifetime, so it only fits in a slot which was already free at its start.
+    std::vector<int32_t> slotEnd;
+    auto spill = [&](const int32_t vreg) {
+        auto slot = std::find_if(freeSlots.begin(), freeSlots.end(), [&](const int32_t it) { return slotEnd[it] < intervals[vreg].start; });
+        if(slot == freeSlots.end()) {
+            slotEnd.push_back(-1);
+            slot = freeSlots.insert(freeSlots.end(), allocation.spillSlots ++);
+        }
+        allocation.locations[vreg].reg = Register::NO_REGISTER;
+        allocation.locations[vreg].slot = *slot;
+        slotEnd[*slot] = intervals[vreg].end;
+        freeSlots.erase(slot);
+        spilledActive.push_back(vreg);
+        allocation.spilledIntervals ++;
+    };
+
+    for(const auto current : order) {
+        const LiveInterval &interval = intervals[current];
+
+        // Intervals ending before this one starts give back their register or slot
+        for(size_t i = 0; i < active.size();) {
+            if(intervals[active[i]].end < interval.start) {
+                isFree[allocation.locations[active[i]].reg] = true;
+                active[i] = active.back();
+                active.pop_back();
+            } else {
+                i ++;
+            }
+        }
+        for(size_t i = 0; i < spilledActive.size();) {
+            if(intervals[spilledActive[i]].end < interval.start) {
+                freeSlots.push_back(allocation.locations[spilledActive[i]].slot);
+                spilledActive[i] = spilledActive.back();
+                spilledActive.pop_back();
+            } else {
+                i ++;
+            }
+        }
+
+        // Intervals live across a call avoid registers the callee may overwrite
+        std::vector<Register> allowed = CALLEE_SAVED_REGISTERS;
+        if(!interval.crossesCall) {
+            allowed.insert(allowed.begin(), CALLER_SAVED_REGISTERS.begin(), CALLER_SAVED_REGISTERS.end());
+        }
+        auto isAllowed = [&](const Register reg) {
+            return reg != Register::NO_REGISTER && std::find(allowed.begin(), allowed.end(), reg) != allowed.end();
+        };
+
+        Register chosen = Register::NO_REGISTER;
+        for(const auto it : interval.vregHints) {
+            // The source ends here, so both can share the register
+            const Register copied = allocation.locations[it].reg;
+            if(isAllowed(copied) && isFree[copied]) {
+                chosen = copied;
+                break;
+            }
+        }
+        if(chosen == Register::NO_REGISTER && isAllowed(interval.registerHint) && isFree[interval.registerHint]) {
+            chosen = interval.registerHint;
+        }
+        for(size_t i = 0; i < allowed.size() && chosen == Register::NO_REGISTER; i ++) {
+            if(isFree[allowed[i]]) {
+                chosen = allowed[i];
+            }
+        }
+
+        if(chosen == Register::NO_REGISTER) {
+            int32_t victim = -1;
+            for(const auto it : active) {
+                if(isAllowed(allocation.locations[it].reg) && (victim < 0 || weight(it) < weight(victim))) {
+                    victim = it;
+                }
+            }
+            if(victim < 0 || weight(current) <= weight(victim)) {
+                spill(current);
+                continue;
+            }
+            chosen = allocation.locations[victim].reg;
+            active.erase(std::find(active.begin(), active.end(), victim));
+            spill(victim);
+        }
+
+        isFree[chosen] = false;
+        allocation.locations[current].reg = chosen;
+        active.push_back(current);
+        if(std::find(CALLEE_SAVED_REGISTERS.begin(), CALLEE_SAVED_REGISTERS.end(), chosen) != CALLEE_SAVED_REGISTERS.end()) {
+            usedCalleeSaved[chosen] = true;
+        }
+    }
+
+    for(const auto it : CALLEE_SAVED_REGISTERS) {
+        if(usedCalleeSaved[it]) {
+            allocation.calleeSaved.push_back(it);
+        }
+    }
+    return allocation;
+}
+
+Allocation allocateStackSlots(const Function &function) {
+    Allocation allocation;
+    allocation.locations.resize(function.vregCount);
+    for(int32_t i = 0; i < function.vregCount; i ++) {
+        allocation.locations[i].slot = i;
+    }
+    allocation.spillSlots = function.vregCount;
+    allocation.spilledIntervals = function.vregCount;
+    return allocation;
+}
+
+};
@@ -0,0 +1,146 @@
+#pragma once
+#ifndef BACKEND_LINEAR_SCAN_H
+#define BACKEND_LINEAR_SCAN_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief General purpose registers of x86-64 in encoding order
+ * 
+ */
+enum Register : int8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+    REGISTER_COUNT,
+    NO_REGISTER = -1
+};
+
+const std::string RegisterName[Register::REGISTER_COUNT] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+
+const std::string RegisterName32[Register::REGISTER_COUNT] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+
+/**
+ * @brief Integer argument registers of the System V calling convention
+ * 
+ */
+const Register ARGUMENT_REGISTERS[6] = {
+    Register::RDI, Register::RSI, Register::RDX, Register::RCX, Register::R8, Register::R9
+};
+
+/**
+ * @brief Allocatable registers a call may overwrite, the one which passes no argument first. RAX and
+ * R11 are kept as scratch registers of the emitter and RDX for division.
+ * 
+ */
+const std::vector<Register> CALLER_SAVED_REGISTERS = {
+    Register::R10, Register::RSI, Register::RDI, Register::R8, Register::R9, Register::RCX
+};
+
+/**
+ * @brief Allocatable registers preserved across calls, a function saves the ones it uses
+ * 
+ */
+const std::vector<Register> CALLEE_SAVED_REGISTERS = {
+    Register::RBX, Register::R12, Register::R13, Register::R14, Register::R15
+};
+
+/**
+ * @brief Register or stack slot holding a virtual register for its whole lifetime
+ * 
+ */
+class Location {
+public:
+    Register reg;
+    int32_t slot;
+
+    Location();
+    bool isRegister() const;
+};
+
+/**
+ * @brief Range of instruction positions in which a virtual register is live. Instruction i reads its
+ * operands at position 2i and writes its result at 2i + 1.
+ * 
+ */
+class LiveInterval {
+public:
+    int32_t vreg;
+    int32_t start;
+    int32_t end;
+
+    /**
+     * @brief Uses and definitions, weighted by 10 to the power of their loop depth
+     * 
+     */
+    double spillCost;
+
+    /**
+     * @brief Whether a call happens while the interval is live, then only callee saved registers fit
+     * 
+     */
+    bool crossesCall;
+
+    /**
+     * @brief Register which makes a move or an argument transfer unnecessary
+     * 
+     */
+    Register registerHint;
+
+    /**
+     * @brief Virtual registers copied or combined into this one, in order of preference. Taking the
+     * register of one that ends here coalesces the move.
+     * 
+     */
+    std::vector<int32_t> vregHints;
+
+    LiveInterval();
+};
+
+class Allocation {
+public:
+    std::vector<Location> locations;
+    int32_t spillSlots;
+    std::vector<Register> calleeSaved;
+
+    int32_t spilledIntervals;
+
+    Allocation();
+};
+
+/**
+ * @brief Compute the live interval of every virtual register from the liveness of the blocks
+ * 
+ * @param function Function in block layout order
+ * @return std::vector<LiveInterval> Interval of each virtual register, indexed by register
+ */
+std::vector<LiveInterval> computeLiveIntervals(const Function &function);
+
+/**
+ * @brief Assign registers with linear scan. When no register is free, the interval with the smallest
+ * spill cost per position among the active ones and the current one goes to the stack.
+ * 
+ * @param function Function to allocate
+ * @return Allocation Location of every virtual register
+ */
+Allocation allocateLinearScan(const Function &function);
+
+/**
+ * @brief Give every virtual register its own stack slot, as a tree walking code generator does
+ * 
+ * @param function Function to allocate
+ * @return Allocation Location of every virtual register
+ */
+Allocation allocateStackSlots(const Function &function);
+
+};
+
+#endif // BACKEND_LINEAR_SCAN_H
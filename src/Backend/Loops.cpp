@@ -0,0 +1,402 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+#include "Loops.h"
+
+namespace Backend {
+
+// Update by a constant or invariant step of a basic induction variable
+class Induction {
+public:
+    int32_t vreg;
+
+    // Register holding the next value before it is moved into the variable, or the variable itself
+    int32_t temporary;
+    int32_t block;
+
+    // Instruction after which the variable holds its next value
+    size_t update;
+    Opcode opcode;
+    Operand step;
+};
+
+class LoopOptimizer {
+public:
+    Function &function;
+    std::vector<Loop> &loops;
+    size_t current;
+    std::vector<int32_t> definitions;
+    int32_t preheader;
+
+    LoopOptimizer(Function &_function, std::vector<Loop> &_loops, const size_t _current)
+        : function(_function), loops(_loops), current(_current), preheader(-1) {}
+
+    Loop &loop() {
+        return this->loops[this->current];
+    }
+
+    void countDefinitions() {
+        this->definitions.assign(this->function.vregCount, 0);
+        for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+            if(!this->loop().contains[b]) {
+                continue;
+            }
+            for(const auto &it : this->function.blocks[b].instructions) {
+                if(it.dst >= 0) {
+                    this->definitions[it.dst] ++;
+                }
+            }
+        }
+    }
+
+    bool isInvariant(const Operand &operand) const {
+        return !operand.isVreg() || this->definitions[operand.value] == 0;
+    }
+
+    int32_t newBlock() {
+        const int32_t block = this->function.newBlock();
+        for(auto &it : this->loops) {
+            it.contains.push_back(false);
+        }
+        return block;
+    }
+
+    // Instructions placed in the preheader go before its jump into the loop
+    void insertInPreheader(const Instruction &instruction) {
+        auto &instructions = this->function.blocks[this->preheader].instructions;
+        instructions.insert(instructions.end() - 1, instruction);
+    }
+
+    // Give the loop a single block entering it, which only jumps to the header
+    void insertPreheader() {
+        const int32_t header = this->loop().header;
+        const std::vector<std::vector<int32_t> > predecessors = computePredecessors(this->function);
+        std::vector<int32_t> outside;
+        for(const auto it : predecessors[header]) {
+            if(!this->loop().contains[it]) {
+                outside.push_back(it);
+            }
+        }
+        if(outside.size() == 1) {
+            const auto &instructions = this->function.blocks[outside[0]].instructions;
+            if(instructions.back().opcode == Opcode::JUMP) {
+                this->preheader = outside[0];
+                return;
+            }
+        }
+        this->preheader = this->newBlock();
+        this->function.blocks[this->preheader].instructions.push_back(Instruction(Opcode::JUMP));
+        this->function.blocks[this->preheader].instructions.back().target = header;
+        for(const auto it : outside) {
+            this->function.blocks[it].instructions.back().retarget(header, this->preheader);
+        }
+        // The preheader of a nested loop is part of every loop around it
+        for(auto &it : this->loops) {
+            if(&it != &this->loop() && it.contains[header]) {
+                it.contains[this->preheader] = true;
+            }
+        }
+    }
+
+    /**
+     * @brief Move invariant computations to the preheader until no more qualify. The result must not
+     * be live into the header, otherwise the first iteration would see the hoisted value, and it may
+     * only be live after the loop when it is computed on every path leaving it.
+     * 
+     * @return int32_t Number of hoisted instructions
+     */
+    int32_t hoistInvariants() {
+        const Loop &loop = this->loop();
+        bool calls = false;
+        std::vector<std::string> stored;
+        for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+            for(const auto &it : this->function.blocks[b].instructions) {
+                if(loop.contains[b] && it.opcode == Opcode::CALL) {
+                    calls = true;
+                } else if(loop.contains[b] && it.opcode == Opcode::STORE_GLOBAL) {
+                    stored.push_back(it.symbol);
+                }
+            }
+        }
+
+        int32_t hoisted = 0;
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            const Liveness liveness = computeLiveness(this->function);
+            const std::vector<int32_t> dominators = computeDominators(this->function);
+            std::vector<int32_t> exiting, exits;
+            for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+                if(!loop.contains[b] || dominators[b] < 0) {
+                    continue;
+                }
+                for(const auto succ : this->function.blocks[b].successors()) {
+                    if(!loop.contains[succ]) {
+                        exiting.push_back((int32_t)b);
+                        exits.push_back(succ);
+                    }
+                }
+            }
+
+            for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+                if(!loop.contains[b] || dominators[b] < 0) {
+                    continue;
+                }
+                auto &instructions = this->function.blocks[b].instructions;
+                for(size_t i = 0; i < instructions.size();) {
+                    const Instruction &it = instructions[i];
+                    const bool readsMemory = it.opcode == Opcode::LOAD_GLOBAL && !calls
+                        && std::find(stored.begin(), stored.end(), it.symbol) == stored.end();
+                    bool movable = (it.isSpeculatable() || readsMemory) && it.dst >= 0 && this->definitions[it.dst] == 1
+                        && this->isInvariant(it.a) && this->isInvariant(it.b) && !liveness.liveIn[loop.header].contains(it.dst);
+                    for(size_t e = 0; e < exits.size() && movable; e ++) {
+                        movable = !liveness.liveIn[exits[e]].contains(it.dst) || dominates(dominators, (int32_t)b, exiting[e]);
+                    }
+                    if(!movable) {
+                        i ++;
+                        continue;
+                    }
+                    this->definitions[it.dst] = 0;
+                    this->insertInPreheader(it);
+                    instructions.erase(instructions.begin() + i);
+                    hoisted ++;
+                    changed = true;
+                }
+            }
+        }
+        return hoisted;
+    }
+
+    // Variables updated once per iteration as v = v + step, directly or through a temporary of the same block
+    std::vector<Induction> findInductions() {
+        std::vector<Induction> inductions;
+        auto isStep = [&](const Instruction &update, const int32_t vreg, Operand &step) {
+            const bool added = update.opcode == Opcode::ADD || update.opcode == Opcode::SUB;
+            if(added && update.a.isVreg() && update.a.value == vreg && this->isInvariant(update.b)) {
+                step = update.b;
+                return true;
+            } else if(update.opcode == Opcode::ADD && update.b.isVreg() && update.b.value == vreg && this->isInvariant(update.a)) {
+                step = update.a;
+                return true;
+            }
+            return false;
+        };
+        for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+            if(!this->loop().contains[b]) {
+                continue;
+            }
+            const auto &instructions = this->function.blocks[b].instructions;
+            for(size_t i = 0; i < instructions.size(); i ++) {
+                const Instruction &it = instructions[i];
+                if(it.dst < 0 || this->definitions[it.dst] != 1) {
+                    continue;
+                }
+                Induction induction;
+                induction.vreg = it.dst;
+                induction.temporary = it.dst;
+                induction.block = (int32_t)b;
+                induction.update = i;
+                induction.opcode = it.opcode;
+                if(isStep(it, it.dst, induction.step)) {
+                    inductions.push_back(induction);
+                    continue;
+                }
+                if(it.opcode != Opcode::MOVE || !it.a.isVreg()) {
+                    continue;
+                }
+                for(size_t j = 0; j < i; j ++) {
+                    const Instruction &update = instructions[j];
+                    if(update.dst == it.a.value && this->definitions[update.dst] == 1 && isStep(update, it.dst, induction.step)) {
+                        induction.temporary = update.dst;
+                        induction.opcode = update.opcode;
+                        inductions.push_back(induction);
+                    }
+                }
+            }
+        }
+        return inductions;
+    }
+
+    /**
+     * @brief Replace j = i * k of an induction variable i and an invariant k by a register which is
+     * set to i * k before the loop and advanced by step * k wherever i is
+     * 
+     * @return int32_t Number of replaced multiplications
+     */
+    int32_t reduceStrength() {
+        int32_t reduced = 0;
+        // Updates later in a block first, so insertions do not move the ones still to come
+        std::vector<Induction> inductions = this->findInductions();
+        std::sort(inductions.begin(), inductions.end(), [](const Induction &a, const Induction &b) {
+            return a.block > b.block || (a.block == b.block && a.update > b.update);
+        });
+        for(const auto &induction : inductions) {
+            // Products of the variable by each factor, shared by equal multiplications
+            std::vector<std::pair<Operand, int32_t> > products;
+            std::vector<std::pair<int32_t, size_t> > replaced;
+            for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+                if(!this->loop().contains[b]) {
+                    continue;
+                }
+                auto &instructions = this->function.blocks[b].instructions;
+                for(size_t i = 0; i < instructions.size(); i ++) {
+                    Instruction &it = instructions[i];
+                    if(it.opcode != Opcode::MUL) {
+                        continue;
+                    }
+                    Operand factor;
+                    if(it.a.isVreg() && it.a.value == induction.vreg && this->isInvariant(it.b)) {
+                        factor = it.b;
+                    } else if(it.b.isVreg() && it.b.value == induction.vreg && this->isInvariant(it.a)) {
+                        factor = it.a;
+                    } else {
+                        continue;
+                    }
+                    if(factor.isImmediate() && (factor.value == 0 || factor.value == 1)) {
+                        continue;
+                    }
+                    int32_t product = -1;
+                    for(const auto &[known, vreg] : products) {
+                        if(known.kind == factor.kind && known.value == factor.value) {
+                            product = vreg;
+                        }
+                    }
+                    if(product < 0) {
+                        product = this->function.newVreg();
+                        this->definitions.push_back(1);
+                        products.push_back({factor, product});
+                    }
+                    it = Instruction(Opcode::MOVE, it.dst, Operand::vreg(product));
+                    reduced ++;
+                }
+            }
+
+            // Inserting after the update in reverse keeps its position valid
+            for(auto it = products.rbegin(); it != products.rend(); it ++) {
+                const auto &[factor, product] = *it;
+                this->insertInPreheader(Instruction(Opcode::MUL, product, Operand::vreg(induction.vreg), factor));
+                Operand increment;
+                if(induction.step.isImmediate() && factor.isImmediate()) {
+                    increment = Operand::immediate((int64_t)((uint64_t)induction.step.value * (uint64_t)factor.value));
+                } else if(induction.step.isImmediate() && induction.step.value == 1) {
+                    increment = factor;
+                } else {
+                    increment = Operand::vreg(this->function.newVreg());
+                    this->definitions.push_back(0);
+                    this->insertInPreheader(Instruction(Opcode::MUL, (int32_t)increment.value, induction.step, factor));
+                }
+                auto &instructions = this->function.blocks[induction.block].instructions;
+                instructions.insert(instructions.begin() + induction.update + 1,
+                    Instruction(induction.opcode, product, Operand::vreg(product), increment));
+            }
+        }
+        return reduced;
+    }
+
+    // Constant assigned to a register by the last definition before the loop
+    bool entryValue(const int32_t vreg, int64_t &value) const {
+        const auto predecessors = computePredecessors(this->function);
+        int32_t block = this->preheader;
+        for(int32_t steps = 0; steps < 2 && block >= 0; steps ++) {
+            const auto &instructions = this->function.blocks[block].instructions;
+            for(auto it = instructions.rbegin(); it != instructions.rend(); it ++) {
+                if(it->dst == vreg) {
+                    value = it->a.value;
+                    return it->opcode == Opcode::MOVE && it->a.isImmediate();
+                }
+            }
+            block = predecessors[block].size() == 1 ? predecessors[block][0] : -1;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Copy the body of a single block loop into the preheader once per iteration when the trip
+     * count follows from a constant start, an immediate step and a comparison with an immediate
+     * 
+     * @return bool Whether the loop was unrolled
+     */
+    bool unroll() {
+        const Loop &loop = this->loop();
+        if(loop.size != 1) {
+            return false;
+        }
+        auto &body = this->function.blocks[loop.header].instructions;
+        const Instruction &branch = body.back();
+        if(branch.opcode != Opcode::BRANCH || (branch.target == loop.header) == (branch.alternative == loop.header)) {
+            return false;
+        }
+        const bool continueWhenHolds = branch.target == loop.header;
+        const int32_t exit = continueWhenHolds ? branch.alternative : branch.target;
+
+        for(const auto &induction : this->findInductions()) {
+            if(!induction.step.isImmediate()) {
+                continue;
+            }
+            // The comparison reads the variable or the temporary it is updated through
+            const int32_t temporary = induction.temporary;
+            Opcode condition = branch.condition;
+            Operand counter = branch.a, bound = branch.b;
+            if(counter.isImmediate()) {
+                std::swap(counter, bound);
+                condition = swapComparison(condition);
+            }
+            if(!counter.isVreg() || (counter.value != induction.vreg && counter.value != temporary) || !bound.isImmediate()) {
+                continue;
+            }
+            int64_t value = 0;
+            if(!this->entryValue(induction.vreg, value)) {
+                continue;
+            }
+
+            // The body runs once before the first comparison
+            int32_t trips = 1;
+            while(trips <= UNROLL_MAX_TRIPS) {
+                const uint64_t step = (uint64_t)induction.step.value;
+                value = (int64_t)(induction.opcode == Opcode::ADD ? (uint64_t)value + step : (uint64_t)value - step);
+                if(evaluateComparison(condition, value, bound.value) != continueWhenHolds) {
+                    break;
+                }
+                trips ++;
+            }
+            if(trips > UNROLL_MAX_TRIPS || trips * (int32_t)(body.size() - 1) > UNROLL_MAX_INSTRUCTIONS) {
+                return false;
+            }
+
+            std::vector<Instruction> copy(body.begin(), body.end() - 1);
+            auto &instructions = this->function.blocks[this->preheader].instructions;
+            instructions.pop_back();
+            for(int32_t i = 0; i < trips; i ++) {
+                instructions.insert(instructions.end(), copy.begin(), copy.end());
+            }
+            instructions.push_back(Instruction(Opcode::JUMP));
+            instructions.back().target = exit;
+            // The loop block is unreachable now
+            this->function.blocks[loop.header].instructions.clear();
+            return true;
+        }
+        return false;
+    }
+};
+
+void optimizeLoops(Function &function) {
+    std::vector<Loop> loops = findLoops(function);
+    for(size_t i = 0; i < loops.size(); i ++) {
+        if(loops[i].header == 0) {
+            // Nothing runs before the entry block
+            continue;
+        }
+        LoopOptimizer optimizer(function, loops, i);
+        optimizer.insertPreheader();
+        optimizer.countDefinitions();
+        optimizer.hoistInvariants();
+        optimizer.reduceStrength();
+        optimizer.unroll();
+    }
+}
+
+};
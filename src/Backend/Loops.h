@@ -0,0 +1,35 @@
+#pragma once
+#ifndef BACKEND_LOOPS_H
+#define BACKEND_LOOPS_H
+
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Loops running at most this many times are unrolled completely
+ * 
+ */
+const int32_t UNROLL_MAX_TRIPS = 16;
+
+/**
+ * @brief Upper bound of the instructions an unrolled loop turns into
+ * 
+ */
+const int32_t UNROLL_MAX_INSTRUCTIONS = 128;
+
+/**
+ * @brief Optimize the natural loops of a function, innermost first. Every loop gets a preheader which
+ * receives the computations whose operands do not change in the loop. Multiplications of an induction
+ * variable by an invariant become an addition to a register kept at their product, and single block
+ * loops with a constant trip count are unrolled into the preheader.
+ * 
+ * @param function Function to optimize, simplifyControlFlow has to run afterwards to lay it out again
+ */
+void optimizeLoops(Function &function);
+
+};
+
+#endif // BACKEND_LOOPS_H
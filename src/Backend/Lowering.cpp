@@ -0,0 +1,857 @@
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Utf8.h"
+#include "Ir.h"
+#include "ControlFlow.h"
+#include "Loops.h"
+#include "Cleanup.h"
+#include "Inline.h"
+#include "TailCalls.h"
+#include "Vectorize.h"
+#include "Escape.h"
+#include "Peephole.h"
+#include "Profile.h"
+#include "Lowering.h"
+
+namespace Backend {
+
+// Position of the first token of an expression, for diagnostics
+static std::pair<int32_t, int32_t> positionOf(const Grammar::Expression *expr) {
+    if(auto literal = dynamic_cast<const Grammar::LiteralExpression*>(expr)) {
+        return {literal->value.lineNmb, literal->value.startPos};
+    } else if(auto call = dynamic_cast<const Grammar::FunctionCall*>(expr)) {
+        return {call->lineNmb, call->startPos};
+    } else if(auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr)) {
+        return positionOf(binary->left);
+    } else if(auto unary = dynamic_cast<const Grammar::UnaryExpression*>(expr)) {
+        return positionOf(unary->expr);
+    } else if(auto index = dynamic_cast<const Grammar::IndexExpression*>(expr)) {
+        return positionOf(index->array);
+    }
+    return {0, 0};
+}
+
+static bool binaryOpcode(const Lexing::TokenType type, Opcode &opcode) {
+    switch(type) {
+        case Lexing::TokenType::PLUS: case Lexing::TokenType::PLUS_EQUAL: opcode = Opcode::ADD; return true;
+        case Lexing::TokenType::MINUS: case Lexing::TokenType::MINUS_EQUAL: opcode = Opcode::SUB; return true;
+        case Lexing::TokenType::STAR: case Lexing::TokenType::STAR_EQUAL: opcode = Opcode::MUL; return true;
+        case Lexing::TokenType::SLASH: case Lexing::TokenType::SLASH_EQUAL: opcode = Opcode::DIV; return true;
+        case Lexing::TokenType::MODULO: case Lexing::TokenType::MODULO_EQUAL: opcode = Opcode::MOD; return true;
+        case Lexing::TokenType::AND: case Lexing::TokenType::AND_EQUAL: opcode = Opcode::AND; return true;
+        case Lexing::TokenType::OR: case Lexing::TokenType::OR_EQUAL: opcode = Opcode::OR; return true;
+        case Lexing::TokenType::XOR: case Lexing::TokenType::XOR_EQUAL: opcode = Opcode::XOR; return true;
+        case Lexing::TokenType::EQUAL_EQUAL: opcode = Opcode::EQUAL; return true;
+        case Lexing::TokenType::BANG_EQUAL: opcode = Opcode::NOT_EQUAL; return true;
+        case Lexing::TokenType::LESS: opcode = Opcode::LESS; return true;
+        case Lexing::TokenType::LESS_EQUAL: opcode = Opcode::LESS_EQUAL; return true;
+        case Lexing::TokenType::GREATER: opcode = Opcode::GREATER; return true;
+        case Lexing::TokenType::GREATER_EQUAL: opcode = Opcode::GREATER_EQUAL; return true;
+        default: return false;
+    }
+}
+
+// Arrays are declared as int[length], parameters leave the length out and get 0
+static bool arrayLength(const std::string &type, int64_t &length) {
+    const size_t open = type.find('[');
+    if(open == std::string::npos) {
+        return false;
+    }
+    const std::string digits = type.substr(open + 1, type.size() - open - 2);
+    length = 0;
+    if(!digits.empty()) {
+        try {
+            length = std::stoll(digits);
+        } catch(const std::exception &) {
+            length = -1;
+        }
+    }
+    return true;
+}
+
+static bool isAssignment(const Lexing::TokenType type) {
+    return type >= Lexing::TokenType::PLUS_EQUAL && type <= Lexing::TokenType::EQUAL;
+}
+
+static bool isComparison(const Opcode opcode) {
+    return opcode >= Opcode::EQUAL && opcode <= Opcode::GREATER_EQUAL;
+}
+
+// Value of a literal known without lowering it, numbers which do not fit are left to lowerLiteral
+static bool constantValue(const Grammar::Expression *expr, int64_t &value) {
+    auto literal = dynamic_cast<const Grammar::LiteralExpression*>(expr);
+    if(!literal) {
+        return false;
+    }
+    const Lexing::Token &token = literal->value;
+    if(token.type == Lexing::TokenType::NUMBER) {
+        size_t length = 0;
+        try {
+            value = std::stoll(token.lexeme, &length);
+        } catch(const std::exception &) {
+            return false;
+        }
+        return length == token.lexeme.size();
+    } else if(token.type == Lexing::TokenType::BOOLEAN) {
+        value = token.lexeme == "true";
+        return true;
+    } else if(token.type == Lexing::TokenType::CHARACTER) {
+        uint32_t codePoint = 0;
+        Lexing::decodeUtf8(token.lexeme.data(), token.lexeme.size(), codePoint);
+        value = codePoint;
+        return true;
+    }
+    return false;
+}
+
+// Condition of an else if chain which compares a variable with a constant
+static bool caseCondition(const Grammar::Expression *expr, const Lexing::Token *&subject, int64_t &value) {
+    auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr);
+    if(!binary || binary->operation != Lexing::TokenType::EQUAL_EQUAL) {
+        return false;
+    }
+    for(const auto &[variable, constant] : {std::make_pair(binary->left, binary->right), std::make_pair(binary->right, binary->left)}) {
+        auto name = dynamic_cast<const Grammar::LiteralExpression*>(variable);
+        if(name && name->value.type == Lexing::TokenType::NAME && constantValue(constant, value)) {
+            subject = &name->value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Else if chains with at least this many cases spread over at most JUMP_TABLE_DENSITY times as
+// many values become a jump table
+const size_t JUMP_TABLE_MIN_CASES = 4;
+const int64_t JUMP_TABLE_DENSITY = 3;
+const int64_t JUMP_TABLE_MAX_SIZE = 4096;
+
+Optimizations Optimizations::none() {
+    Optimizations optimizations;
+    optimizations.branches = false;
+    optimizations.tailCalls = false;
+    optimizations.inlining = false;
+    optimizations.loops = false;
+    optimizations.vectorize = false;
+    optimizations.escapes = false;
+    optimizations.cleanup = false;
+    optimizations.peephole = false;
+    return optimizations;
+}
+
+class Lowering {
+public:
+    Program program;
+    std::vector<Lexing::Diagnostic> &diagnostics;
+    std::unordered_map<std::string, size_t> functions;
+    std::unordered_set<std::string> externals;
+
+    // Classes of the module, only their layout is known to the backend so far
+    std::unordered_set<std::string> classes;
+
+    // Length of every global, 0 for integers
+    std::unordered_map<std::string, int64_t> globals;
+
+    Function *function;
+    int32_t block;
+
+    // Line of the innermost statement being lowered, every emitted instruction takes it
+    int32_t line;
+    std::vector<std::unordered_map<std::string, int32_t> > scopes;
+
+    // Registers of parameters and locals, every other register is a temporary read once
+    std::unordered_set<int32_t> variables;
+
+    // Registers holding the address of an array
+    std::unordered_set<int32_t> arrays;
+
+    // Declarations of the top level statement list of main are globals
+    bool inMain;
+
+    Optimizations optimizations;
+
+    Lowering(std::vector<Lexing::Diagnostic> &_diagnostics, const Optimizations &_optimizations)
+        : diagnostics(_diagnostics), function(nullptr), block(0), line(-1), inMain(false), optimizations(_optimizations) {}
+
+    template <typename... T>
+    void error(const std::pair<int32_t, int32_t> &position, T... t) {
+        this->diagnostics.push_back(Lexing::Diagnostic::make(position.first, position.second, t..., "\n"));
+    }
+
+    Instruction &emit(const Instruction &instruction) {
+        auto &instructions = this->function->blocks[this->block].instructions;
+        instructions.push_back(instruction);
+        instructions.back().line = this->line;
+        return instructions.back();
+    }
+
+    bool terminated() const {
+        const auto &instructions = this->function->blocks[this->block].instructions;
+        return !instructions.empty() && instructions.back().isTerminator();
+    }
+
+    void jump(const int32_t target) {
+        if(!this->terminated()) {
+            this->emit(Instruction(Opcode::JUMP)).target = target;
+        }
+    }
+
+    void branch(const Opcode condition, const Operand &a, const Operand &b, const int32_t whenTrue, const int32_t whenFalse) {
+        Instruction &instruction = this->emit(Instruction(Opcode::BRANCH, -1, a, b));
+        instruction.condition = condition;
+        instruction.target = whenTrue;
+        instruction.alternative = whenFalse;
+    }
+
+    bool isGlobalScope() const {
+        return this->inMain && this->scopes.size() == 1;
+    }
+
+    const int32_t *findLocal(const std::string &name) const {
+        for(auto it = this->scopes.rbegin(); it != this->scopes.rend(); it ++) {
+            auto found = it->find(name);
+            if(found != it->end()) {
+                return &found->second;
+            }
+        }
+        return nullptr;
+    }
+
+    Operand readVariable(const Lexing::Token &name) {
+        if(const int32_t *local = this->findLocal(name.lexeme)) {
+            return Operand::vreg(*local);
+        }
+        auto global = this->globals.find(name.lexeme);
+        if(global != this->globals.end()) {
+            const int32_t dst = this->function->newVreg();
+            this->emit(Instruction(global->second > 0 ? Opcode::ADDRESS : Opcode::LOAD_GLOBAL, dst)).symbol = name.lexeme;
+            return Operand::vreg(dst);
+        }
+        this->error({name.lineNmb, name.startPos}, "Unknown variable ", name.lexeme);
+        return Operand::immediate(0);
+    }
+
+    // The instruction which just computed a temporary writes the local instead
+    void assignLocal(const int32_t local, const Operand &value) {
+        auto &instructions = this->function->blocks[this->block].instructions;
+        if(value.isVreg() && !this->variables.count(value.value) && !instructions.empty() && instructions.back().dst == value.value) {
+            instructions.back().dst = local;
+        } else {
+            this->emit(Instruction(Opcode::MOVE, local, value));
+        }
+    }
+
+    bool isArray(const Lexing::Token &name) const {
+        if(const int32_t *local = this->findLocal(name.lexeme)) {
+            return this->arrays.count(*local);
+        }
+        auto global = this->globals.find(name.lexeme);
+        return global != this->globals.end() && global->second > 0;
+    }
+
+    Operand writeVariable(const Lexing::Token &name, const Operand &value) {
+        if(this->isArray(name)) {
+            this->error({name.lineNmb, name.startPos}, "Array ", name.lexeme, " cannot be assigned to");
+            return value;
+        }
+        if(const int32_t *local = this->findLocal(name.lexeme)) {
+            this->assignLocal(*local, value);
+            return Operand::vreg(*local);
+        }
+        if(this->globals.count(name.lexeme)) {
+            this->emit(Instruction(Opcode::STORE_GLOBAL, -1, value)).symbol = name.lexeme;
+            return value;
+        }
+        this->error({name.lineNmb, name.startPos}, "Unknown variable ", name.lexeme);
+        return value;
+    }
+
+    Operand lowerLiteral(const Lexing::Token &token) {
+        switch(token.type) {
+            case Lexing::TokenType::NUMBER: {
+                size_t length = 0;
+                int64_t value = 0;
+                try {
+                    value = std::stoll(token.lexeme, &length);
+                } catch(const std::exception &) {
+                    length = 0;
+                }
+                if(length != token.lexeme.size()) {
+                    this->error({token.lineNmb, token.startPos}, "Number ", token.lexeme, " is not a 64 bit integer");
+                }
+                return Operand::immediate(value);
+            }
+            case Lexing::TokenType::BOOLEAN:
+                return Operand::immediate(token.lexeme == "true");
+            case Lexing::TokenType::CHARACTER: {
+                uint32_t codePoint = 0;
+                Lexing::decodeUtf8(token.lexeme.data(), token.lexeme.size(), codePoint);
+                return Operand::immediate(codePoint);
+            }
+            case Lexing::TokenType::NAME:
+                return this->readVariable(token);
+            default:
+                this->error({token.lineNmb, token.startPos}, "The backend does not support ", Lexing::TokenTypeName[token.type], " literals");
+                return Operand::immediate(0);
+        }
+    }
+
+    Operand binary(const Opcode opcode, const Operand &a, const Operand &b) {
+        const int32_t dst = this->function->newVreg();
+        this->emit(Instruction(opcode, dst, a, b));
+        return Operand::vreg(dst);
+    }
+
+    // Address of the array and index of an element, false after reporting why there is none
+    bool lowerElement(const Grammar::IndexExpression *expr, Operand &array, Operand &index) {
+        auto name = dynamic_cast<const Grammar::LiteralExpression*>(expr->array);
+        if(!name || name->value.type != Lexing::TokenType::NAME) {
+            this->error(positionOf(expr->array), "Only arrays can be indexed");
+            return false;
+        }
+        array = this->readVariable(name->value);
+        index = this->lowerExpression(expr->index);
+        if(!this->isArray(name->value)) {
+            if(this->findLocal(name->value.lexeme) || this->globals.count(name->value.lexeme)) {
+                this->error(positionOf(expr->array), "Variable ", name->value.lexeme, " is not an array");
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // Every value of print is written by a call of its own, the last one ends the line
+    void lowerPrint(const Grammar::FunctionCall *call, const std::vector<Operand> &values) {
+        if(values.empty()) {
+            this->error({call->lineNmb, call->startPos}, PRINT_FUNCTION, " takes at least one value");
+            return;
+        }
+        for(size_t i = 0; i < values.size(); i ++) {
+            Instruction instruction(Opcode::CALL, -1);
+            instruction.symbol = PRINT_FUNCTION;
+            instruction.callee = PRINT_INTRINSIC;
+            instruction.arguments = {values[i], Operand::immediate(i + 1 < values.size() ? ' ' : '\n')};
+            this->emit(instruction);
+        }
+    }
+
+    Operand lowerAssignment(const Grammar::BinaryExpression *expr) {
+        if(auto element = dynamic_cast<const Grammar::IndexExpression*>(expr->left)) {
+            Operand value = this->lowerExpression(expr->right);
+            Operand array, index;
+            if(!this->lowerElement(element, array, index)) {
+                return value;
+            }
+            Opcode opcode;
+            if(binaryOpcode(expr->operation, opcode)) {
+                const int32_t old = this->function->newVreg();
+                this->emit(Instruction(Opcode::LOAD_ELEMENT, old, array, index));
+                value = this->binary(opcode, Operand::vreg(old), value);
+            }
+            this->emit(Instruction(Opcode::STORE_ELEMENT, -1, array, index)).c = value;
+            return value;
+        }
+        auto target = dynamic_cast<const Grammar::LiteralExpression*>(expr->left);
+        if(!target || target->value.type != Lexing::TokenType::NAME) {
+            this->error(positionOf(expr->left), "Only variables can be assigned to");
+            return this->lowerExpression(expr->right);
+        }
+        Operand value = this->lowerExpression(expr->right);
+        Opcode opcode;
+        if(binaryOpcode(expr->operation, opcode)) {
+            value = this->binary(opcode, this->readVariable(target->value), value);
+        }
+        return this->writeVariable(target->value, value);
+    }
+
+    Operand lowerExpression(const Grammar::Expression *expr) {
+        if(auto literal = dynamic_cast<const Grammar::LiteralExpression*>(expr)) {
+            return this->lowerLiteral(literal->value);
+        } else if(auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr)) {
+            if(isAssignment(binary->operation)) {
+                return this->lowerAssignment(binary);
+            }
+            if(binary->operation == Lexing::TokenType::ANDAND || binary->operation == Lexing::TokenType::OROR) {
+                // The result starts false and is set on the path where the condition holds
+                const int32_t result = this->function->newVreg();
+                const int32_t holds = this->function->newBlock();
+                const int32_t join = this->function->newBlock();
+                this->emit(Instruction(Opcode::MOVE, result, Operand::immediate(0)));
+                this->lowerCondition(binary, holds, join);
+                this->block = holds;
+                this->emit(Instruction(Opcode::MOVE, result, Operand::immediate(1)));
+                this->jump(join);
+                this->block = join;
+                return Operand::vreg(result);
+            }
+            const Operand a = this->lowerExpression(binary->left);
+            const Operand b = this->lowerExpression(binary->right);
+            Opcode opcode;
+            if(binaryOpcode(binary->operation, opcode)) {
+                return this->binary(opcode, a, b);
+            }
+            if(binary->operation == Lexing::TokenType::XORXOR) {
+                // Both sides always matter, they are normalized to 0 or 1
+                const Operand left = this->binary(Opcode::NOT_EQUAL, a, Operand::immediate(0));
+                const Operand right = this->binary(Opcode::NOT_EQUAL, b, Operand::immediate(0));
+                return this->binary(Opcode::XOR, left, right);
+            }
+            this->error(positionOf(expr), "The backend does not support the operator ", Lexing::TokenTypeName[binary->operation]);
+            return Operand::immediate(0);
+        } else if(auto unary = dynamic_cast<const Grammar::UnaryExpression*>(expr)) {
+            const Operand a = this->lowerExpression(unary->expr);
+            const int32_t dst = this->function->newVreg();
+            switch(unary->operation) {
+                case Lexing::TokenType::UNARY_PLUS:
+                    return a;
+                case Lexing::TokenType::UNARY_MINUS:
+                    this->emit(Instruction(Opcode::NEG, dst, a));
+                    break;
+                case Lexing::TokenType::NOT:
+                    this->emit(Instruction(Opcode::NOT, dst, a));
+                    break;
+                case Lexing::TokenType::BANG:
+                    this->emit(Instruction(Opcode::EQUAL, dst, a, Operand::immediate(0)));
+                    break;
+                default:
+                    this->error(positionOf(expr), "The backend does not support the operator ", Lexing::TokenTypeName[unary->operation]);
+                    return Operand::immediate(0);
+            }
+            return Operand::vreg(dst);
+        } else if(auto element = dynamic_cast<const Grammar::IndexExpression*>(expr)) {
+            Operand array, index;
+            if(!this->lowerElement(element, array, index)) {
+                return Operand::immediate(0);
+            }
+            const int32_t dst = this->function->newVreg();
+            this->emit(Instruction(Opcode::LOAD_ELEMENT, dst, array, index));
+            return Operand::vreg(dst);
+        } else if(auto call = dynamic_cast<const Grammar::FunctionCall*>(expr)) {
+            Instruction instruction(Opcode::CALL, -1);
+            instruction.symbol = call->name;
+            for(const auto it : call->parameters) {
+                instruction.arguments.push_back(this->lowerExpression(it));
+            }
+            // Functions of the module itself take precedence over imported ones
+            auto callee = this->functions.find(call->name);
+            if(callee != this->functions.end()) {
+                instruction.callee = (int32_t)callee->second;
+            } else if(call->name == PRINT_FUNCTION && !this->externals.count(call->name)) {
+                this->lowerPrint(call, instruction.arguments);
+                return Operand::immediate(0);
+            } else if((call->name == READ_FUNCTION || call->name == WRITE_FUNCTION) && !this->externals.count(call->name)) {
+                const bool reading = call->name == READ_FUNCTION;
+                if(instruction.arguments.size() != (reading ? 1 : 2)) {
+                    this->error({call->lineNmb, call->startPos}, call->name, reading ? " takes a descriptor" : " takes a descriptor and a value");
+                    return Operand::immediate(0);
+                }
+                instruction.callee = reading ? READ_INTRINSIC : WRITE_INTRINSIC;
+            } else if(!this->externals.count(call->name)) {
+                this->error({call->lineNmb, call->startPos}, "Unknown function ", call->name);
+                return Operand::immediate(0);
+            }
+            instruction.dst = this->function->newVreg();
+            this->emit(instruction);
+            return Operand::vreg(instruction.dst);
+        }
+        return Operand::immediate(0);
+    }
+
+    /**
+     * @brief Lower a condition as control flow ending in whenTrue or whenFalse. && and || skip their
+     * right side when the left one decides, comparisons branch on their operands without producing
+     * a boolean unless branches are lowered naively.
+     * 
+     */
+    void lowerCondition(const Grammar::Expression *expr, const int32_t whenTrue, const int32_t whenFalse) {
+        auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr);
+        auto unary = dynamic_cast<const Grammar::UnaryExpression*>(expr);
+        Opcode opcode;
+        if(binary && (binary->operation == Lexing::TokenType::ANDAND || binary->operation == Lexing::TokenType::OROR)) {
+            const int32_t right = this->function->newBlock();
+            if(binary->operation == Lexing::TokenType::ANDAND) {
+                this->lowerCondition(binary->left, right, whenFalse);
+            } else {
+                this->lowerCondition(binary->left, whenTrue, right);
+            }
+            this->block = right;
+            this->lowerCondition(binary->right, whenTrue, whenFalse);
+            return;
+        } else if(this->optimizations.branches && binary && binaryOpcode(binary->operation, opcode) && isComparison(opcode)) {
+            const Operand a = this->lowerExpression(binary->left);
+            const Operand b = this->lowerExpression(binary->right);
+            this->branch(opcode, a, b, whenTrue, whenFalse);
+            return;
+        } else if(this->optimizations.branches && unary && unary->operation == Lexing::TokenType::BANG) {
+            this->lowerCondition(unary->expr, whenFalse, whenTrue);
+            return;
+        }
+        this->branch(Opcode::NOT_EQUAL, this->lowerExpression(expr), Operand::immediate(0), whenTrue, whenFalse);
+    }
+
+    /**
+     * @brief Lower an else if chain comparing one variable with distinct constants as a jump table
+     * 
+     * @return true The chain was dense enough and is lowered
+     */
+    bool lowerSwitch(const Grammar::IfStatement *ifStmt) {
+        const Lexing::Token *subject = nullptr;
+        std::vector<std::pair<int64_t, const Grammar::Statement*> > cases;
+        const Grammar::Statement *fallback = ifStmt;
+        while(auto chained = dynamic_cast<const Grammar::IfStatement*>(fallback)) {
+            const Lexing::Token *name = nullptr;
+            int64_t value = 0;
+            if(!caseCondition(chained->condition, name, value) || (subject && name->lexeme != subject->lexeme)) {
+                break;
+            }
+            subject = name;
+            cases.push_back({value, chained->ifBody});
+            fallback = chained->elseBody;
+        }
+
+        std::vector<int64_t> values;
+        for(const auto &it : cases) {
+            values.push_back(it.first);
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        if(values.size() < JUMP_TABLE_MIN_CASES) {
+            return false;
+        }
+        const int64_t low = values.front(), high = values.back();
+        if(high - low >= JUMP_TABLE_MAX_SIZE || high - low + 1 > JUMP_TABLE_DENSITY * (int64_t)values.size()) {
+            return false;
+        }
+        if(!this->findLocal(subject->lexeme) && !this->globals.count(subject->lexeme)) {
+            return false;
+        }
+
+        const Operand value = this->readVariable(*subject);
+        const int32_t defaultBlock = this->function->newBlock();
+        const int32_t joinBlock = fallback ? this->function->newBlock() : defaultBlock;
+        Instruction &dispatch = this->emit(Instruction(Opcode::SWITCH, -1, value, Operand::immediate(low)));
+        dispatch.alternative = defaultBlock;
+        dispatch.cases.assign(high - low + 1, defaultBlock);
+        std::vector<int32_t> bodies;
+        for(const auto &it : cases) {
+            bodies.push_back(this->function->newBlock());
+            // The first of equal cases is the one taken, the others are lowered but unreachable
+            int32_t &target = this->function->blocks[this->block].instructions.back().cases[it.first - low];
+            if(target == defaultBlock) {
+                target = bodies.back();
+            }
+        }
+        for(size_t i = 0; i < cases.size(); i ++) {
+            this->block = bodies[i];
+            this->lowerStatement(cases[i].second);
+            this->jump(joinBlock);
+        }
+        if(fallback) {
+            this->block = defaultBlock;
+            this->lowerStatement(fallback);
+            this->jump(joinBlock);
+        }
+        this->block = joinBlock;
+        return true;
+    }
+
+    /**
+     * @brief Lower a loop whose missing condition always holds. Optimized loops test the condition
+     * before entering and again at the bottom, so every iteration takes one branch. The straight
+     * lowering tests it at the top and jumps back there.
+     * 
+     */
+    void lowerLoop(const Grammar::Expression *condition, const Grammar::Expression *step, const Grammar::Statement *body) {
+        const int32_t bodyBlock = this->function->newBlock();
+        const int32_t exitBlock = this->function->newBlock();
+        auto test = [&](const int32_t whenTrue) {
+            if(condition) {
+                this->lowerCondition(condition, whenTrue, exitBlock);
+            } else {
+                this->jump(whenTrue);
+            }
+        };
+
+        int32_t headerBlock = bodyBlock;
+        if(this->optimizations.loops) {
+            test(bodyBlock);
+        } else {
+            headerBlock = this->function->newBlock();
+            this->jump(headerBlock);
+            this->block = headerBlock;
+            test(bodyBlock);
+        }
+
+        this->block = bodyBlock;
+        this->lowerStatement(body);
+        if(step) {
+            this->lowerExpression(step);
+        }
+        if(!this->optimizations.loops) {
+            this->jump(headerBlock);
+        } else if(!this->terminated()) {
+            // The condition was checked for errors when it was lowered the first time
+            const size_t reported = this->diagnostics.size();
+            test(bodyBlock);
+            this->diagnostics.erase(this->diagnostics.begin() + reported, this->diagnostics.end());
+        }
+        this->block = exitBlock;
+    }
+
+    // Global arrays are zeroed memory, local ones are zeroed on the heap where they are declared until
+    // placeArrays moves them to the frame
+    void lowerArrayDeclaration(const Grammar::DeclarationStatement *decl, const int64_t length) {
+        if(decl->expr) {
+            this->error({decl->nameLineNmb, decl->nameStartPos}, "Array ", decl->name, " cannot be initialized");
+        }
+        if(length <= 0) {
+            this->error({decl->nameLineNmb, decl->nameStartPos}, "Array ", decl->name, " needs a positive length");
+            return;
+        }
+        if(this->isGlobalScope()) {
+            return;
+        }
+        const int32_t variable = this->function->newVreg();
+        this->emit(Instruction(Opcode::NEW, variable, Operand::immediate(length)));
+        this->variables.insert(variable);
+        this->arrays.insert(variable);
+        this->scopes.back()[decl->name] = variable;
+    }
+
+    void lowerStatement(const Grammar::Statement *stmt) {
+        // Code around a nested statement, like the step of a loop after its body, belongs to the enclosing one
+        const int32_t enclosing = this->line;
+        if(stmt->lineNmb >= 0) {
+            this->line = stmt->lineNmb;
+        }
+        this->lowerStatementAt(stmt);
+        this->line = enclosing;
+    }
+
+    void lowerStatementAt(const Grammar::Statement *stmt) {
+        if(auto list = dynamic_cast<const Grammar::StatementList*>(stmt)) {
+            this->scopes.emplace_back();
+            for(const auto it : list->list) {
+                this->lowerStatement(it);
+            }
+            this->scopes.pop_back();
+        } else if(auto decl = dynamic_cast<const Grammar::DeclarationStatement*>(stmt)) {
+            if(this->classes.count(decl->type.substr(0, decl->type.find('[')))) {
+                this->error({decl->nameLineNmb, decl->nameStartPos}, "Variable ", decl->name, " of class ", decl->type, " is not supported by the backend yet");
+                return;
+            }
+            int64_t length = 0;
+            if(arrayLength(decl->type, length)) {
+                this->lowerArrayDeclaration(decl, length);
+                return;
+            }
+            const Operand value = decl->expr ? this->lowerExpression(decl->expr) : Operand::immediate(0);
+            if(this->isGlobalScope()) {
+                this->emit(Instruction(Opcode::STORE_GLOBAL, -1, value)).symbol = decl->name;
+            } else {
+                // The initializer still sees an outer variable of the same name, a temporary becomes the variable
+                int32_t variable = value.isVreg() && !this->variables.count(value.value) ? (int32_t)value.value : -1;
+                if(variable < 0) {
+                    variable = this->function->newVreg();
+                    this->emit(Instruction(Opcode::MOVE, variable, value));
+                }
+                this->variables.insert(variable);
+                this->scopes.back()[decl->name] = variable;
+            }
+        } else if(auto exprStmt = dynamic_cast<const Grammar::ExpressionStatement*>(stmt)) {
+            this->lowerExpression(exprStmt->expr);
+        } else if(auto ifStmt = dynamic_cast<const Grammar::IfStatement*>(stmt)) {
+            if(this->optimizations.branches && this->lowerSwitch(ifStmt)) {
+                return;
+            }
+            const int32_t thenBlock = this->function->newBlock();
+            const int32_t elseBlock = ifStmt->elseBody ? this->function->newBlock() : -1;
+            const int32_t joinBlock = this->function->newBlock();
+            this->lowerCondition(ifStmt->condition, thenBlock, elseBlock >= 0 ? elseBlock : joinBlock);
+
+            this->block = thenBlock;
+            this->lowerStatement(ifStmt->ifBody);
+            this->jump(joinBlock);
+            if(elseBlock >= 0) {
+                this->block = elseBlock;
+                this->lowerStatement(ifStmt->elseBody);
+                this->jump(joinBlock);
+            }
+            this->block = joinBlock;
+        } else if(auto whileStmt = dynamic_cast<const Grammar::WhileStatement*>(stmt)) {
+            this->lowerLoop(whileStmt->condition, nullptr, whileStmt->body);
+        } else if(auto forStmt = dynamic_cast<const Grammar::ForStatement*>(stmt)) {
+            // Variables declared by the init statement belong to the loop
+            this->scopes.emplace_back();
+            if(forStmt->init) {
+                this->lowerStatement(forStmt->init);
+            }
+            this->lowerLoop(forStmt->condition, forStmt->step, forStmt->body);
+            this->scopes.pop_back();
+        } else if(auto ret = dynamic_cast<const Grammar::ReturnStatement*>(stmt)) {
+            const Operand value = ret->expr ? this->lowerExpression(ret->expr) : Operand::immediate(0);
+            this->emit(Instruction(Opcode::RETURN, -1, value));
+            // Statements after a return are unreachable but still checked
+            this->block = this->function->newBlock();
+        } else if(auto definition = dynamic_cast<const Grammar::FunctionDefinition*>(stmt)) {
+            this->error({definition->nameLineNmb, definition->nameStartPos}, "Function ", definition->name, " has to be defined at the top level");
+        } else if(auto definition = dynamic_cast<const Grammar::ClassDefinition*>(stmt)) {
+            this->error({definition->nameLineNmb, definition->nameStartPos}, "Class ", definition->name, " has to be defined at the top level");
+        }
+    }
+
+    void lowerFunction(const Grammar::FunctionDefinition *definition) {
+        this->program.functions.emplace_back(definition->name, (int32_t)definition->parameters.size());
+        this->function = &this->program.functions.back();
+        this->block = this->function->newBlock();
+        this->line = definition->lineNmb;
+        // Registers are numbered per function
+        this->variables.clear();
+        this->arrays.clear();
+        this->inMain = false;
+        this->scopes.emplace_back();
+        for(size_t i = 0; i < definition->parameters.size(); i ++) {
+            const int32_t param = this->function->newVreg();
+            this->emit(Instruction(Opcode::PARAM, param, Operand::immediate(i)));
+            this->scopes.back()[definition->parameters[i]->name] = param;
+            this->variables.insert(param);
+            int64_t length = 0;
+            if(arrayLength(definition->parameters[i]->type, length)) {
+                this->arrays.insert(param);
+            }
+        }
+        this->lowerStatement(definition->body);
+        if(!this->terminated()) {
+            this->emit(Instruction(Opcode::RETURN, -1, Operand::immediate(0)));
+        }
+        this->scopes.pop_back();
+    }
+
+    void lowerMain(const std::vector<const Grammar::Statement*> &statements) {
+        this->program.functions.emplace_back(MAIN_FUNCTION, 0);
+        this->function = &this->program.functions.back();
+        this->block = this->function->newBlock();
+        this->line = -1;
+        // Registers are numbered per function
+        this->variables.clear();
+        this->arrays.clear();
+        this->inMain = true;
+        this->scopes.emplace_back();
+        for(const auto it : statements) {
+            this->lowerStatement(it);
+        }
+        if(!this->terminated()) {
+            this->emit(Instruction(Opcode::RETURN, -1, Operand::immediate(0)));
+        }
+        this->scopes.pop_back();
+    }
+};
+
+Program lowerProgram(const Grammar::Statement *program, const std::vector<std::string> &externals, std::vector<Lexing::Diagnostic> &diagnostics,
+    const Optimizations &optimizations) {
+    Lowering lowering(diagnostics, optimizations);
+    lowering.externals.insert(externals.begin(), externals.end());
+    auto root = dynamic_cast<const Grammar::StatementList*>(program);
+    if(!root) {
+        return lowering.program;
+    }
+
+    // Functions and globals may be used before their definition
+    std::vector<const Grammar::FunctionDefinition*> definitions;
+    std::vector<const Grammar::Statement*> statements;
+    for(const auto stmt : root->list) {
+        if(auto definition = dynamic_cast<const Grammar::FunctionDefinition*>(stmt)) {
+            if(lowering.functions.count(definition->name) || definition->name == MAIN_FUNCTION) {
+                lowering.error({definition->nameLineNmb, definition->nameStartPos}, "Function ", definition->name, " is defined twice");
+                continue;
+            }
+            lowering.functions[definition->name] = definitions.size();
+            definitions.push_back(definition);
+        } else if(auto definition = dynamic_cast<const Grammar::ClassDefinition*>(stmt)) {
+            lowering.classes.insert(definition->name);
+        } else if(!dynamic_cast<const Grammar::ImportStatement*>(stmt)) {
+            if(auto decl = dynamic_cast<const Grammar::DeclarationStatement*>(stmt)) {
+                int64_t length = 0;
+                arrayLength(decl->type, length);
+                if(lowering.globals.emplace(decl->name, std::max<int64_t>(length, 0)).second) {
+                    lowering.program.globals.emplace_back(decl->name, std::max<int64_t>(length, 0));
+                }
+            }
+            statements.push_back(stmt);
+        }
+    }
+
+    // Functions are stored by value, so every one is complete before the next is added
+    lowering.program.functions.reserve(definitions.size() + 1);
+    for(const auto it : definitions) {
+        lowering.lowerFunction(it);
+    }
+    if(!statements.empty()) {
+        lowering.lowerMain(statements);
+    }
+    for(auto &it : lowering.program.functions) {
+        simplifyControlFlow(it);
+    }
+    // Counters are placed and read back on the same blocks, before any optimization depending on them
+    lowering.program.layoutHash = hashLayout(lowering.program);
+    if(!optimizations.instrument.empty()) {
+        instrumentProgram(lowering.program);
+        lowering.program.profilePath = optimizations.instrument;
+    } else if(optimizations.profile && applyProfile(lowering.program, *optimizations.profile) && optimizations.branches) {
+        for(auto &it : lowering.program.functions) {
+            if(orderTestChains(it) > 0) {
+                simplifyControlFlow(it);
+            }
+        }
+    }
+    for(size_t i = 0; i < lowering.program.functions.size(); i ++) {
+        // A function which only called itself in tail position is not recursive afterwards and may be inlined
+        if(optimizations.tailCalls) {
+            eliminateTailRecursion(lowering.program.functions[i], (int32_t)i);
+            simplifyControlFlow(lowering.program.functions[i]);
+        }
+    }
+    // Callees are copied before their loops are transformed, so loops of a caller see the inlined code
+    if(optimizations.inlining && inlineCalls(lowering.program) > 0) {
+        for(auto &it : lowering.program.functions) {
+            simplifyControlFlow(it);
+        }
+    }
+    // Inlined callees bring their arrays along, where they may not escape anymore
+    if(optimizations.escapes) {
+        placeArrays(lowering.program);
+    }
+    for(auto &it : lowering.program.functions) {
+        if(optimizations.loops) {
+            optimizeLoops(it);
+            simplifyControlFlow(it);
+        }
+        // Invariants are hoisted by now, so array addresses and broadcast values are outside the loop
+        if(optimizations.vectorize) {
+            vectorizeLoops(it);
+            simplifyControlFlow(it);
+        }
+        // Unrolled and strength reduced loops leave copies and dead counters behind
+        if(optimizations.cleanup) {
+            propagateCopies(it);
+            eliminateDeadCode(it);
+            simplifyControlFlow(it);
+        }
+        if(optimizations.tailCalls) {
+            markTailCalls(it);
+        }
+        // Superinstructions are made last, no pass knows them
+        if(optimizations.peephole) {
+            fuseInstructions(it);
+        }
+    }
+    return lowering.program;
+}
+
+};
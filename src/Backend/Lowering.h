@@ -0,0 +1,136 @@
+#pragma once
+#ifndef BACKEND_LOWERING_H
+#define BACKEND_LOWERING_H
+
+#include <vector>
+#include <string>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "Ir.h"
+#include "Profile.h"
+
+namespace Backend {
+
+/**
+ * @brief Function which runs the top level statements of a module
+ * 
+ */
+const std::string MAIN_FUNCTION = "main";
+
+/**
+ * @brief Intrinsic writing its arguments separated by spaces and followed by a newline, unless the module
+ * defines or imports a function of its own with the name
+ * 
+ */
+const std::string PRINT_FUNCTION = "print";
+
+/**
+ * @brief Intrinsics reading and writing one byte of a descriptor, see READ_INTRINSIC and WRITE_INTRINSIC.
+ * A module may define or import functions of its own with the names as well.
+ * 
+ */
+const std::string READ_FUNCTION = "read";
+const std::string WRITE_FUNCTION = "write";
+
+/**
+ * @brief Words the local arrays of one function may take on the stack
+ * 
+ */
+const int64_t MAX_FRAME_WORDS = 1 << 17;
+
+/**
+ * @brief Optimizations applied while lowering, all of them are on by default
+ * 
+ */
+class Optimizations {
+public:
+    /**
+     * @brief Branch on comparisons directly and turn dense else if chains into jump tables, otherwise
+     * every condition is computed as a value and tested against zero
+     * 
+     */
+    bool branches = true;
+
+    /**
+     * @brief Turn recursion in tail position into a loop and leave the frame before other calls in tail
+     * position, so they take no stack
+     * 
+     */
+    bool tailCalls = true;
+
+    /**
+     * @brief Replace calls of small functions which do not call themselves by their body
+     * 
+     */
+    bool inlining = true;
+
+    /**
+     * @brief Test loop conditions at the bottom, hoist invariant code, strength reduce induction
+     * variables and unroll small loops with a constant trip count
+     * 
+     */
+    bool loops = true;
+
+    /**
+     * @brief Run loops which only combine the elements at the loop counter on several elements at once
+     * 
+     */
+    bool vectorize = true;
+
+    /**
+     * @brief Place local arrays whose address does not outlive them in the frame, otherwise every local
+     * array is allocated on the heap
+     * 
+     */
+    bool escapes = true;
+
+    /**
+     * @brief Propagate copies and constants within blocks and remove computations nothing reads
+     * 
+     */
+    bool cleanup = true;
+
+    /**
+     * @brief Fuse frequent pairs of dependent instructions into superinstructions, see fuseInstructions
+     * 
+     */
+    bool peephole = true;
+
+    /**
+     * @brief Count the runs of every block, the program writes the counts to this file when
+     * MAIN_FUNCTION returns. Empty for a program without counters.
+     * 
+     */
+    std::string instrument;
+
+    /**
+     * @brief Counts of an instrumented run of the program, used to lay out blocks, to inline hot calls
+     * and to order chains of equality tests. Ignored when it was recorded for another program.
+     * 
+     */
+    const Profile *profile = nullptr;
+
+    /**
+     * @brief Get the straight lowering the optimizations are measured against
+     * 
+     */
+    static Optimizations none();
+};
+
+/**
+ * @brief Lower a parsed module. Every top level function definition becomes a function and the
+ * remaining top level statements become MAIN_FUNCTION, whose declarations are globals.
+ * 
+ * @param program Root of the module
+ * @param externals Functions of imported modules
+ * @param diagnostics Constructs the backend does not support
+ * @param optimizations Optimizations to apply
+ * @return Program Lowered module
+ */
+Program lowerProgram(const Grammar::Statement *program, const std::vector<std::string> &externals, std::vector<Lexing::Diagnostic> &diagnostics,
+    const Optimizations &optimizations = Optimizations());
+
+};
+
+#endif // BACKEND_LOWERING_H
@@ -0,0 +1,161 @@
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Peephole.h"
+
+namespace Backend {
+
+int64_t runsOf(const BasicBlock &block) {
+    return block.count >= 0 ? block.count : 1;
+}
+
+static bool reads(const Instruction &instruction, const int32_t vreg) {
+    bool found = false;
+    instruction.forEachUse([&](const int32_t it) { found |= it == vreg; });
+    return found;
+}
+
+std::vector<InstructionPair> countInstructionPairs(const Program &program) {
+    std::map<std::pair<Opcode, Opcode>, int64_t> counts;
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            for(size_t i = 1; i < block.instructions.size(); i ++) {
+                const Instruction &first = block.instructions[i - 1], &second = block.instructions[i];
+                if(first.dst >= 0 && reads(second, first.dst)) {
+                    counts[{first.opcode, second.opcode}] += runsOf(block);
+                }
+            }
+        }
+    }
+    std::vector<InstructionPair> pairs;
+    for(const auto &it : counts) {
+        pairs.push_back({it.first.first, it.first.second, it.second});
+    }
+    std::stable_sort(pairs.begin(), pairs.end(), [](const InstructionPair &a, const InstructionPair &b) { return a.count > b.count; });
+    return pairs;
+}
+
+int64_t countDispatches(const Program &program) {
+    int64_t dispatches = 0;
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            dispatches += runsOf(block) * (int64_t)block.instructions.size();
+        }
+    }
+    return dispatches;
+}
+
+static bool isVreg(const Operand &operand, const int32_t vreg) {
+    return operand.isVreg() && operand.value == vreg;
+}
+
+// Superinstruction of a pair whose second instruction reads the result of the first, OPCODE_COUNT when there is none
+static Opcode superinstruction(const Instruction &first, const Instruction &second) {
+    if(first.opcode == Opcode::MUL && second.opcode == Opcode::ADD) {
+        // The factor becomes the immediate of a three operand imul or the scale of a lea
+        const Operand &factor = first.a.isImmediate() ? first.a : first.b;
+        const bool scaled = (first.a.isVreg() || first.b.isVreg()) && factor.isImmediate() && factor.value >= INT32_MIN && factor.value <= INT32_MAX;
+        return scaled ? Opcode::MUL_ADD : Opcode::OPCODE_COUNT;
+    }
+    if(first.opcode == Opcode::ADD && (second.opcode == Opcode::DIV || second.opcode == Opcode::MOD)) {
+        // Only the dividend is computed in place
+        return isVreg(second.a, first.dst) ? (second.opcode == Opcode::DIV ? Opcode::ADD_DIV : Opcode::ADD_MOD) : Opcode::OPCODE_COUNT;
+    }
+    if(first.opcode == Opcode::ADD && second.opcode == Opcode::BRANCH) {
+        // The sum is compared with another operand, which reads the same before and after the addition
+        return isVreg(second.a, first.dst) != isVreg(second.b, first.dst) ? Opcode::ADD_BRANCH : Opcode::OPCODE_COUNT;
+    }
+    if(first.opcode == Opcode::ADD && second.opcode == Opcode::STORE_ELEMENT) {
+        return isVreg(second.c, first.dst) ? Opcode::ADD_STORE : Opcode::OPCODE_COUNT;
+    }
+    if(first.opcode == Opcode::MOD && second.opcode == Opcode::ADD) {
+        return Opcode::MOD_ADD;
+    }
+    if(first.opcode == Opcode::LOAD_ELEMENT && second.opcode == Opcode::MOD) {
+        return isVreg(second.a, first.dst) ? Opcode::LOAD_MOD : Opcode::OPCODE_COUNT;
+    }
+    if(first.opcode == Opcode::SUB && second.opcode == Opcode::LOAD_ELEMENT) {
+        // The subtrahend becomes the displacement of the element address
+        const bool displaced = first.b.isImmediate() && first.b.value >= INT32_MIN / 8 && first.b.value <= INT32_MAX / 8;
+        return displaced && isVreg(second.b, first.dst) ? Opcode::SUB_LOAD : Opcode::OPCODE_COUNT;
+    }
+    return Opcode::OPCODE_COUNT;
+}
+
+// The instruction doing both, the result of the first one is gone unless the superinstruction keeps it
+static Instruction fuse(const Opcode opcode, const Instruction &first, const Instruction &second) {
+    Instruction instruction(opcode, second.dst, first.a, first.b);
+    switch(opcode) {
+        case Opcode::MUL_ADD:
+            // Multiplication and addition commute, the factor goes last and the other addend is added
+            if(instruction.a.isImmediate()) {
+                std::swap(instruction.a, instruction.b);
+            }
+            instruction.c = isVreg(second.a, first.dst) ? second.b : second.a;
+            break;
+        case Opcode::MOD_ADD:
+            instruction.c = isVreg(second.a, first.dst) ? second.b : second.a;
+            break;
+        case Opcode::ADD_BRANCH:
+            // The sum is written, then compared on the left
+            instruction.dst = first.dst;
+            instruction.condition = isVreg(second.a, first.dst) ? second.condition : swapComparison(second.condition);
+            instruction.c = isVreg(second.a, first.dst) ? second.b : second.a;
+            instruction.target = second.target;
+            instruction.alternative = second.alternative;
+            break;
+        case Opcode::ADD_STORE:
+            instruction = Instruction(opcode, -1, second.a, second.b);
+            instruction.c = first.a;
+            instruction.d = first.b;
+            break;
+        case Opcode::SUB_LOAD:
+            instruction = Instruction(opcode, second.dst, second.a, first.a);
+            instruction.c = first.b;
+            break;
+        default:
+            instruction.c = second.b;
+    }
+    instruction.line = first.line >= 0 ? first.line : second.line;
+    return instruction;
+}
+
+int32_t fuseInstructions(Function &function) {
+    // A result read by its neighbour only is not needed anywhere else
+    std::vector<int32_t> definitions(function.vregCount, 0), uses(function.vregCount, 0);
+    for(const auto &block : function.blocks) {
+        for(const auto &it : block.instructions) {
+            if(it.dst >= 0) {
+                definitions[it.dst] ++;
+            }
+            it.forEachUse([&](const int32_t vreg) { uses[vreg] ++; });
+        }
+    }
+
+    int32_t fused = 0;
+    for(auto &block : function.blocks) {
+        auto &instructions = block.instructions;
+        for(size_t i = 1; i < instructions.size(); i ++) {
+            const Instruction &first = instructions[i - 1], &second = instructions[i];
+            if(first.dst < 0 || !reads(second, first.dst)) {
+                continue;
+            }
+            const Opcode opcode = superinstruction(first, second);
+            // ADD_BRANCH still writes the sum, the loop counters it is made for are read again by the next iteration
+            const bool kept = opcode == Opcode::ADD_BRANCH;
+            if(opcode == Opcode::OPCODE_COUNT || (!kept && (definitions[first.dst] != 1 || uses[first.dst] != 1))) {
+                continue;
+            }
+            instructions[i - 1] = fuse(opcode, first, second);
+            instructions.erase(instructions.begin() + i);
+            fused ++;
+        }
+    }
+    return fused;
+}
+
+};
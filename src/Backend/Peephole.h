@@ -0,0 +1,67 @@
+#pragma once
+#ifndef BACKEND_PEEPHOLE_H
+#define BACKEND_PEEPHOLE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Two adjacent instructions of a block where the second reads the result of the first
+ * 
+ */
+class InstructionPair {
+public:
+    Opcode first;
+    Opcode second;
+
+    /**
+     * @brief Runs of the blocks the pair is in, see runsOf
+     * 
+     */
+    int64_t count;
+};
+
+/**
+ * @brief Get the runs of a block in the profile, a block without a count is taken to run once
+ * 
+ */
+int64_t runsOf(const BasicBlock &block);
+
+/**
+ * @brief Count the pairs of dependent instructions the program runs, the candidates for superinstructions
+ * 
+ * @param program Lowered program, with the counts of a profile to count the pairs dynamically
+ * @return std::vector<InstructionPair> Every pair of opcodes found, the most frequent first
+ */
+std::vector<InstructionPair> countInstructionPairs(const Program &program);
+
+/**
+ * @brief Count the instructions the program runs, each of them is dispatched to its own code
+ * 
+ * @param program Lowered program, with the counts of a profile to count the instructions dynamically
+ * @return int64_t Instructions of every block times the runs of the block
+ */
+int64_t countDispatches(const Program &program);
+
+/**
+ * @brief Replace pairs of instructions by the superinstruction doing both, when the result of the first
+ * is read by the second only. The pairs are the seven most frequent ones SuperinstructionBench counts on
+ * the native code, profile guided and sampling tests, most frequent first: an addition followed by a
+ * branch on the sum becomes ADD_BRANCH, which still writes the sum since it is mostly a loop counter, an
+ * addition whose sum is stored becomes ADD_STORE, a remainder followed by an addition MOD_ADD, a loaded
+ * element followed by its remainder LOAD_MOD, an index less a constant followed by the load of the element
+ * SUB_LOAD, a multiplication by a constant followed by an addition MUL_ADD and an addition followed by a
+ * division of its result ADD_DIV or ADD_MOD.
+ * 
+ * @param function Function to rewrite, no other pass may run on it afterwards
+ * @return int32_t Superinstructions made
+ */
+int32_t fuseInstructions(Function &function);
+
+};
+
+#endif // BACKEND_PEEPHOLE_H
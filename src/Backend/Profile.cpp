@@ -0,0 +1,183 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+
+#include "../ModuleSummary.h"
+#include "Ir.h"
+#include "Analysis.h"
+#include "Profile.h"
+
+namespace Backend {
+
+/***********************Profile class***********************/
+Profile::Profile() : layoutHash(0) {}
+
+// Words of the file are little endian, as the counters of the instrumented program are in memory
+static uint64_t readWord(const unsigned char *bytes) {
+    uint64_t word = 0;
+    for(int32_t i = 7; i >= 0; i --) {
+        word = word << 8 | bytes[i];
+    }
+    return word;
+}
+
+bool Profile::read(const std::string &path, Profile &profile, std::string &error) {
+    std::ifstream input(path, std::ios::binary);
+    if(!input) {
+        error = "Cannot open profile " + path;
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    const unsigned char *bytes = (const unsigned char*)data.data();
+    if((int64_t)data.size() < PROFILE_HEADER_BYTES || data.compare(0, PROFILE_MAGIC.size(), PROFILE_MAGIC) != 0) {
+        error = "File " + path + " is not a profile of this version";
+        return false;
+    }
+    const uint64_t counters = readWord(bytes + 16);
+    if(counters != (data.size() - PROFILE_HEADER_BYTES) / 8 || (data.size() - PROFILE_HEADER_BYTES) % 8 != 0) {
+        error = "Profile " + path + " has an inconsistent size";
+        return false;
+    }
+    profile.layoutHash = readWord(bytes + 8);
+    profile.counters.resize(counters);
+    for(uint64_t i = 0; i < counters; i ++) {
+        profile.counters[i] = readWord(bytes + PROFILE_HEADER_BYTES + 8 * i);
+    }
+    return true;
+}
+
+uint64_t hashLayout(const Program &program) {
+    std::string layout;
+    for(const auto &function : program.functions) {
+        layout += function.name;
+        layout += '\0';
+        for(const auto &block : function.blocks) {
+            for(const auto &it : block.instructions) {
+                layout += (char)it.opcode;
+            }
+            layout += (char)Opcode::OPCODE_COUNT;
+        }
+    }
+    return Modules::hashBytes(layout);
+}
+
+void instrumentProgram(Program &program) {
+    for(auto &function : program.functions) {
+        for(auto &block : function.blocks) {
+            auto position = block.instructions.begin();
+            while(position != block.instructions.end() && position->opcode == Opcode::PARAM) {
+                position ++;
+            }
+            block.instructions.insert(position, Instruction(Opcode::PROFILE_COUNT, -1, Operand::immediate(program.profileCounters ++)));
+        }
+    }
+}
+
+bool applyProfile(Program &program, const Profile &profile) {
+    size_t blocks = 0;
+    for(const auto &function : program.functions) {
+        blocks += function.blocks.size();
+    }
+    if(profile.layoutHash != program.layoutHash || profile.counters.size() != blocks) {
+        return false;
+    }
+    size_t counter = 0;
+    for(auto &function : program.functions) {
+        for(auto &block : function.blocks) {
+            block.count = (int64_t)std::min<uint64_t>(profile.counters[counter ++], INT64_MAX);
+        }
+    }
+    return true;
+}
+
+// Register, constant and blocks of a block ending in a test of a register against a constant
+static bool equalityTest(const BasicBlock &block, int32_t &vreg, int64_t &constant, int32_t &match, int32_t &next) {
+    if(block.instructions.empty()) {
+        return false;
+    }
+    const Instruction &last = block.instructions.back();
+    if(last.opcode != Opcode::BRANCH || !last.a.isVreg() || !last.b.isImmediate()
+        || (last.condition != Opcode::EQUAL && last.condition != Opcode::NOT_EQUAL)) {
+        return false;
+    }
+    vreg = (int32_t)last.a.value;
+    constant = last.b.value;
+    match = last.condition == Opcode::EQUAL ? last.target : last.alternative;
+    next = last.condition == Opcode::EQUAL ? last.alternative : last.target;
+    return true;
+}
+
+int32_t orderTestChains(Function &function) {
+    std::vector<BasicBlock> &blocks = function.blocks;
+    const auto predecessors = computePredecessors(function);
+    std::vector<bool> inChain(blocks.size(), false);
+    int32_t reordered = 0;
+    for(size_t head = 0; head < blocks.size(); head ++) {
+        int32_t vreg = -1, match = -1, next = -1;
+        int64_t constant = 0;
+        if(inChain[head] || blocks[head].count < 0 || !equalityTest(blocks[head], vreg, constant, match, next)) {
+            continue;
+        }
+        std::vector<int32_t> chain = {(int32_t)head}, matches = {match};
+        std::vector<int64_t> constants = {constant};
+        inChain[head] = true;
+        int32_t other = -1;
+        // Each test after the first is a block of its own, so nothing else runs between the tests
+        for(int32_t current = next; blocks[current].instructions.size() == 1 && predecessors[current].size() == 1 && !inChain[current]
+            && blocks[current].count >= 0;) {
+            int32_t following = -1;
+            if(!equalityTest(blocks[current], other, constant, match, following) || other != vreg
+                || std::find(constants.begin(), constants.end(), constant) != constants.end()) {
+                break;
+            }
+            inChain[current] = true;
+            chain.push_back(current);
+            matches.push_back(match);
+            constants.push_back(constant);
+            next = following;
+            current = following;
+        }
+        const size_t length = chain.size();
+        if(length < 2) {
+            continue;
+        }
+
+        // A test is taken as often as its block runs minus the runs of the next test. The last one is only
+        // known when its case or the block after the chain has no other predecessor.
+        std::vector<int64_t> taken(length, -1);
+        for(size_t i = 0; i + 1 < length; i ++) {
+            taken[i] = std::max<int64_t>(blocks[chain[i]].count - blocks[chain[i + 1]].count, 0);
+        }
+        if(predecessors[matches.back()].size() == 1 && blocks[matches.back()].count >= 0) {
+            taken.back() = std::min(blocks[matches.back()].count, blocks[chain.back()].count);
+        } else if(predecessors[next].size() == 1 && blocks[next].count >= 0) {
+            taken.back() = std::max<int64_t>(blocks[chain.back()].count - blocks[next].count, 0);
+        }
+        std::vector<size_t> order(length);
+        for(size_t i = 0; i < length; i ++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return taken[a] > taken[b]; });
+        if(std::is_sorted(order.begin(), order.end())) {
+            continue;
+        }
+
+        for(size_t i = 0; i < length; i ++) {
+            Instruction &test = blocks[chain[i]].instructions.back();
+            test.condition = Opcode::EQUAL;
+            test.a = Operand::vreg(vreg);
+            test.b = Operand::immediate(constants[order[i]]);
+            test.target = matches[order[i]];
+            test.alternative = i + 1 < length ? chain[i + 1] : next;
+            if(i > 0) {
+                blocks[chain[i]].count = std::max<int64_t>(blocks[chain[i - 1]].count - std::max<int64_t>(taken[order[i - 1]], 0), 0);
+            }
+        }
+        reordered ++;
+    }
+    return reordered;
+}
+
+};
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef BACKEND_PROFILE_H
+#define BACKEND_PROFILE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief First bytes of a profile file
+ * 
+ */
+const std::string PROFILE_MAGIC = "XCPPPRF1";
+
+/**
+ * @brief Bytes of a profile file before its counters: PROFILE_MAGIC, the layout hash and the number of counters
+ * 
+ */
+const int64_t PROFILE_HEADER_BYTES = 24;
+
+/**
+ * @brief Runs of every block of a program, recorded by an instrumented build of it. The file holds the
+ * header and one 64 bit little endian counter per block, in the order of the functions and of their
+ * blocks when the counters were placed.
+ * 
+ */
+class Profile {
+public:
+    uint64_t layoutHash;
+    std::vector<uint64_t> counters;
+
+    Profile();
+
+    /**
+     * @brief Read a profile file
+     *
+     * @param path Path of the profile
+     * @param profile Profile receiving the counters
+     * @param error Reason of the failure
+     * @return true The profile was read
+     */
+    static bool read(const std::string &path, Profile &profile, std::string &error);
+};
+
+/**
+ * @brief Hash of the functions, blocks and opcodes of a program. A profile only applies to a program
+ * lowered to the same blocks as the one it was recorded with.
+ * 
+ * @param program Program before the counters are placed
+ * @return uint64_t Hash of the layout
+ */
+uint64_t hashLayout(const Program &program);
+
+/**
+ * @brief Start every block with a PROFILE_COUNT of its own counter, after the PARAM instructions in the entry
+ * 
+ * @param program Program to instrument, its profileCounters is set
+ */
+void instrumentProgram(Program &program);
+
+/**
+ * @brief Set the count of every block from a profile
+ * 
+ * @param program Program in the state instrumentProgram saw it in
+ * @param profile Profile of the program
+ * @return true The profile was recorded for this program, otherwise counts are left unknown
+ */
+bool applyProfile(Program &program, const Profile &profile);
+
+/**
+ * @brief Reorder chains of equality tests of one register against distinct constants, where each test
+ * but the first is a block of its own only reached from the previous test, so the most frequent case is
+ * tested first. The tests exclude each other, so their order does not change the result.
+ * 
+ * @param function Function with block counts
+ * @return int32_t Reordered chains
+ */
+int32_t orderTestChains(Function &function);
+
+};
+
+#endif // BACKEND_PROFILE_H
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+
+#include "Sampling.h"
+
+namespace Backend {
+
+/***********************SampleProfile class*****************/
+SampleProfile::SampleProfile() : intervalMicroseconds(0), codeBytes(0) {}
+
+// Words of the file are little endian, as the program has them in memory
+static uint64_t readWord(const unsigned char *bytes, const int32_t size) {
+    uint64_t word = 0;
+    for(int32_t i = size - 1; i >= 0; i --) {
+        word = word << 8 | bytes[i];
+    }
+    return word;
+}
+
+bool SampleProfile::read(const std::string &path, SampleProfile &profile, std::string &error) {
+    std::ifstream input(path, std::ios::binary);
+    if(!input) {
+        error = "Cannot open samples " + path;
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    const unsigned char *bytes = (const unsigned char*)data.data();
+    if((int64_t)data.size() < SAMPLE_HEADER_BYTES || data.compare(0, SAMPLE_MAGIC.size(), SAMPLE_MAGIC) != 0) {
+        error = "File " + path + " is not a sample file of this version";
+        return false;
+    }
+    profile.intervalMicroseconds = (int64_t)readWord(bytes + 8, 8);
+    const uint64_t functions = readWord(bytes + 16, 8), lines = readWord(bytes + 24, 8), nameBytes = readWord(bytes + 32, 8);
+    profile.codeBytes = readWord(bytes + 40, 8);
+    const uint64_t words = readWord(bytes + 48, 8);
+    const uint64_t tableBytes = 8 * functions + 8 * lines + nameBytes;
+    if(functions > data.size() || lines > data.size() || nameBytes > data.size() || words > data.size()
+        || data.size() != SAMPLE_HEADER_BYTES + tableBytes + 8 * words) {
+        error = "Sample file " + path + " has an inconsistent size";
+        return false;
+    }
+
+    const unsigned char *position = bytes + SAMPLE_HEADER_BYTES;
+    profile.functionStarts.resize(functions);
+    for(auto &it : profile.functionStarts) {
+        it = readWord(position, 8);
+        position += 8;
+    }
+    profile.lines.resize(lines);
+    for(auto &it : profile.lines) {
+        it = {(uint32_t)readWord(position, 4), (uint32_t)readWord(position + 4, 4)};
+        position += 8;
+    }
+    const char *names = (const char*)position, *namesEnd = names + nameBytes;
+    for(uint64_t i = 0; i < functions; i ++) {
+        const char *end = std::find(names, namesEnd, '\0');
+        if(end == namesEnd) {
+            error = "Sample file " + path + " has a corrupt function name";
+            return false;
+        }
+        profile.functionNames.emplace_back(names, end);
+        names = end + 1;
+    }
+    position += nameBytes;
+
+    profile.samples.clear();
+    for(uint64_t word = 0; word < words;) {
+        const uint64_t depth = readWord(position + 8 * word, 8);
+        if(depth == 0 || depth > (uint64_t)SAMPLE_MAX_DEPTH || word + 1 + depth > words) {
+            error = "Sample file " + path + " has a corrupt sample";
+            return false;
+        }
+        std::vector<uint64_t> frames(depth);
+        for(uint64_t i = 0; i < depth; i ++) {
+            frames[i] = readWord(position + 8 * (word + 1 + i), 8);
+        }
+        profile.samples.push_back(std::move(frames));
+        word += 1 + depth;
+    }
+    return true;
+}
+
+std::string SampleProfile::frameName(const uint64_t offset, const bool isReturnAddress) const {
+    // A return address points after the call, the byte before it still belongs to the call
+    const uint64_t address = isReturnAddress && offset > 0 ? offset - 1 : offset;
+    auto function = std::upper_bound(this->functionStarts.begin(), this->functionStarts.end(), address);
+    if(address >= this->codeBytes || function == this->functionStarts.begin()) {
+        return "[unknown]";
+    }
+    function --;
+    const size_t index = function - this->functionStarts.begin();
+    std::string name = this->functionNames[index];
+
+    // Code before the first line of a function, like its prologue, has no line
+    auto line = std::upper_bound(this->lines.begin(), this->lines.end(), address,
+        [](const uint64_t value, const std::pair<uint32_t, uint32_t> &entry) { return value < entry.first; });
+    if(line != this->lines.begin() && (line - 1)->first >= *function) {
+        name += ":" + std::to_string((line - 1)->second + 1);
+    }
+    return name;
+}
+
+std::map<std::string, int64_t> SampleProfile::fold() const {
+    std::map<std::string, int64_t> stacks;
+    for(const auto &sample : this->samples) {
+        std::string stack;
+        for(size_t i = sample.size(); i -- > 0;) {
+            stack += this->frameName(sample[i], i > 0);
+            if(i > 0) {
+                stack += ";";
+            }
+        }
+        stacks[stack] ++;
+    }
+    return stacks;
+}
+
+void writeFoldedStacks(std::ostream &os, const std::map<std::string, int64_t> &stacks) {
+    for(const auto &it : stacks) {
+        os << it.first << " " << it.second << "\n";
+    }
+}
+
+};
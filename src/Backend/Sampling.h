@@ -0,0 +1,110 @@
+#pragma once
+#ifndef BACKEND_SAMPLING_H
+#define BACKEND_SAMPLING_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdint>
+
+namespace Backend {
+
+/**
+ * @brief First bytes of a sample file
+ * 
+ */
+const std::string SAMPLE_MAGIC = "XCPPSMP1";
+
+/**
+ * @brief Bytes of a sample file before its tables: SAMPLE_MAGIC, the sampling interval, the numbers of
+ * functions, line entries and name bytes, the size of the code and the number of sample words
+ * 
+ */
+const int64_t SAMPLE_HEADER_BYTES = 56;
+
+/**
+ * @brief Processor time between two samples, the timer counts the time of the whole process
+ * 
+ */
+const int64_t SAMPLE_INTERVAL_MICROSECONDS = 1000;
+
+/**
+ * @brief Frames a sample records at most, the innermost ones are kept
+ * 
+ */
+const int32_t SAMPLE_MAX_DEPTH = 64;
+
+/**
+ * @brief Words of the sample buffer of a program, samples which do not fit anymore are dropped
+ * 
+ */
+const int64_t SAMPLE_BUFFER_WORDS = (int64_t)1 << 22;
+
+/**
+ * @brief Samples of a program and the tables mapping its code back to the source. Code is addressed by
+ * its offset from the first function, so the tables hold whatever address the program was loaded at.
+ * 
+ * The file holds the header, the offset of every function, an offset and a line for every line entry as
+ * 32 bit words, the names of the functions ending with a zero byte and padded to 8 bytes, then the
+ * samples. A sample is its number of frames followed by the offset of each frame, the interrupted
+ * instruction first and then the return addresses of its callers.
+ * 
+ */
+class SampleProfile {
+public:
+    int64_t intervalMicroseconds;
+    uint64_t codeBytes;
+    std::vector<std::string> functionNames;
+    std::vector<uint64_t> functionStarts;
+
+    /**
+     * @brief Offset of the first instruction of a source line and the line, as the lexer counts them, in
+     * code order
+     *
+     */
+    std::vector<std::pair<uint32_t, uint32_t> > lines;
+
+    std::vector<std::vector<uint64_t> > samples;
+
+    SampleProfile();
+
+    /**
+     * @brief Read a sample file
+     *
+     * @param path Path of the samples
+     * @param profile Profile receiving the tables and the samples
+     * @param error Reason of the failure
+     * @return true The samples were read
+     */
+    static bool read(const std::string &path, SampleProfile &profile, std::string &error);
+
+    /**
+     * @brief Name a frame as function:line, with lines counted from 1 as editors do
+     *
+     * @param offset Offset of the frame in the code
+     * @param isReturnAddress Whether the offset follows a call, then the line of the call is meant
+     * @return std::string Name of the frame, [unknown] outside of the code
+     */
+    std::string frameName(const uint64_t offset, const bool isReturnAddress) const;
+
+    /**
+     * @brief Count the samples of every distinct stack
+     *
+     * @return std::map<std::string, int64_t> Samples of each stack, its frames from the outermost one
+     * separated by semicolons
+     */
+    std::map<std::string, int64_t> fold() const;
+};
+
+/**
+ * @brief Write folded stacks as flame graph tools read them, one stack and its count per line
+ * 
+ * @param os Stream receiving the stacks
+ * @param stacks Stacks from SampleProfile::fold
+ */
+void writeFoldedStacks(std::ostream &os, const std::map<std::string, int64_t> &stacks);
+
+};
+
+#endif // BACKEND_SAMPLING_H
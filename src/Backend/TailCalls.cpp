@@ -0,0 +1,83 @@
+#include <vector>
+#include <cstdint>
+
+#include "Ir.h"
+#include "TailCalls.h"
+
+namespace Backend {
+
+// Call at the end of a block which returns its result
+static bool isTailCall(const BasicBlock &block) {
+    const auto &instructions = block.instructions;
+    if(instructions.size() < 2) {
+        return false;
+    }
+    const Instruction &call = instructions[instructions.size() - 2];
+    const Instruction &ret = instructions.back();
+    return call.opcode == Opcode::CALL && ret.opcode == Opcode::RETURN && ret.a.isVreg() && ret.a.value == call.dst;
+}
+
+void eliminateTailRecursion(Function &function, const int32_t index) {
+    if(function.frameWords > 0) {
+        return;
+    }
+    std::vector<int32_t> parameters;
+    for(const auto &it : function.blocks[0].instructions) {
+        if(it.opcode == Opcode::PARAM) {
+            parameters.push_back(it.dst);
+        }
+    }
+
+    std::vector<int32_t> tails;
+    for(size_t b = 0; b < function.blocks.size(); b ++) {
+        if(isTailCall(function.blocks[b])) {
+            const Instruction &call = function.blocks[b].instructions[function.blocks[b].instructions.size() - 2];
+            if(call.callee == index && call.arguments.size() == parameters.size()) {
+                tails.push_back((int32_t)b);
+            }
+        }
+    }
+    if(tails.empty()) {
+        return;
+    }
+
+    // The entry only reads the parameters and goes on with the rest of the function, where the calls jump
+    const int32_t start = function.newBlock();
+    auto &entry = function.blocks[0].instructions;
+    function.blocks[start].instructions.assign(entry.begin() + parameters.size(), entry.end());
+    entry.erase(entry.begin() + parameters.size(), entry.end());
+    entry.emplace_back(Opcode::JUMP).target = start;
+
+    for(const auto b : tails) {
+        auto &instructions = function.blocks[b == 0 ? start : b].instructions;
+        const Instruction call = instructions[instructions.size() - 2];
+        instructions.erase(instructions.end() - 2, instructions.end());
+        // Arguments may read parameters, so all of them are read before any parameter is written
+        std::vector<int32_t> values;
+        for(const auto &it : call.arguments) {
+            values.push_back(function.newVreg());
+            instructions.emplace_back(Opcode::MOVE, values.back(), it);
+        }
+        for(size_t i = 0; i < parameters.size(); i ++) {
+            instructions.emplace_back(Opcode::MOVE, parameters[i], Operand::vreg(values[i]));
+        }
+        instructions.emplace_back(Opcode::JUMP).target = start;
+    }
+}
+
+void markTailCalls(Function &function) {
+    if(function.frameWords > 0) {
+        return;
+    }
+    for(auto &block : function.blocks) {
+        if(!isTailCall(block) || block.instructions[block.instructions.size() - 2].arguments.size() > 6) {
+            continue;
+        }
+        block.instructions.pop_back();
+        Instruction &call = block.instructions.back();
+        call.opcode = Opcode::TAIL_CALL;
+        call.dst = -1;
+    }
+}
+
+};
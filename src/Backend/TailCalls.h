@@ -0,0 +1,33 @@
+#pragma once
+#ifndef BACKEND_TAIL_CALLS_H
+#define BACKEND_TAIL_CALLS_H
+
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Turn calls of a function to itself whose result it returns right away into a jump back to its
+ * start, after moving the arguments into the parameters. Functions with arrays in their frame keep their
+ * calls, an argument may be the address of one. Arrays still on the heap stay valid, placeArrays only
+ * moves them to the frame when no address of the previous run is live.
+ * 
+ * @param function Function to transform, simplifyControlFlow has to run afterwards to lay it out again
+ * @param index Index of the function in Program::functions
+ */
+void eliminateTailRecursion(Function &function, const int32_t index);
+
+/**
+ * @brief Turn the remaining calls whose result is returned right away into TAIL_CALL, which leaves the
+ * frame before jumping to the callee, so chains of them run in constant stack space. Calls passing
+ * arguments on the stack and calls from functions with arrays in their frame are kept.
+ * 
+ * @param function Function to transform
+ */
+void markTailCalls(Function &function);
+
+};
+
+#endif // BACKEND_TAIL_CALLS_H
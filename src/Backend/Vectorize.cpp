@@ -0,0 +1,166 @@
+#include <vector>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+#include "Ir.h"
+#include "Analysis.h"
+#include "Vectorize.h"
+
+namespace Backend {
+
+// Operations every lane can do on its own, x86-64 has no 64 bit division of vector lanes
+static bool isLaneOperation(const Opcode opcode) {
+    switch(opcode) {
+        case Opcode::MOVE: case Opcode::ADD: case Opcode::SUB: case Opcode::MUL:
+        case Opcode::AND: case Opcode::OR: case Opcode::XOR: case Opcode::NEG: case Opcode::NOT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Build the VECTOR instruction of a single block loop which ends by adding one to its counter
+ * and comparing it with an invariant bound
+ * 
+ * @param function Function of the loop
+ * @param header Block of the loop
+ * @param liveAtExit Registers read after the loop
+ * @param vector Built instruction
+ * @return bool Whether the loop can run in vector lanes
+ */
+static bool buildVector(const Function &function, const int32_t header, const VregSet &liveAtExit, Instruction &vector) {
+    const auto &body = function.blocks[header].instructions;
+    if(body.size() < 3) {
+        return false;
+    }
+    const Instruction &branch = body.back();
+    const Instruction &update = body[body.size() - 2];
+    const int32_t counter = update.dst;
+    auto isCounter = [&](const Operand &operand) {
+        return operand.isVreg() && operand.value == counter;
+    };
+    if(update.opcode != Opcode::ADD || counter < 0 || !((isCounter(update.a) && update.b.isImmediate() && update.b.value == 1)
+        || (isCounter(update.b) && update.a.isImmediate() && update.a.value == 1))) {
+        return false;
+    }
+
+    // The loop continues while counter condition bound holds
+    Opcode condition = branch.target == header ? branch.condition : invertComparison(branch.condition);
+    Operand bound = branch.b;
+    if(isCounter(branch.b)) {
+        bound = branch.a;
+        condition = swapComparison(condition);
+    } else if(!isCounter(branch.a)) {
+        return false;
+    }
+    if(condition != Opcode::LESS && condition != Opcode::LESS_EQUAL && condition != Opcode::NOT_EQUAL) {
+        return false;
+    }
+
+    std::vector<int32_t> definitions(function.vregCount, 0);
+    for(const auto &it : body) {
+        if(it.dst >= 0) {
+            definitions[it.dst] ++;
+        }
+    }
+    auto isInvariant = [&](const Operand &operand) {
+        return operand.isImmediate() || (operand.isVreg() && definitions[operand.value] == 0);
+    };
+    if(definitions[counter] != 1 || !isInvariant(bound)) {
+        return false;
+    }
+
+    std::vector<bool> isLane(function.vregCount, false);
+    std::set<std::pair<Operand::Kind, int64_t> > broadcasts;
+    std::vector<int32_t> arguments;
+    auto addArgument = [&](const Operand &operand) {
+        if(operand.isVreg() && std::find(arguments.begin(), arguments.end(), operand.value) == arguments.end()) {
+            arguments.push_back((int32_t)operand.value);
+        }
+    };
+    // Lanes were computed earlier in the iteration, invariants are the same in every lane
+    auto isValue = [&](const Operand &operand) {
+        if(operand.isVreg() && isLane[operand.value]) {
+            return true;
+        }
+        if(!isInvariant(operand)) {
+            return false;
+        }
+        broadcasts.insert({operand.kind, operand.value});
+        addArgument(operand);
+        return true;
+    };
+
+    int32_t lanes = 0;
+    bool stores = false;
+    for(size_t i = 0; i + 2 < body.size(); i ++) {
+        const Instruction &it = body[i];
+        if(it.dst >= 0 && (definitions[it.dst] != 1 || liveAtExit.contains(it.dst))) {
+            return false;
+        }
+        if(it.opcode == Opcode::LOAD_ELEMENT || it.opcode == Opcode::STORE_ELEMENT) {
+            if(!it.a.isVreg() || !isInvariant(it.a) || !isCounter(it.b)) {
+                return false;
+            }
+            if(it.opcode == Opcode::STORE_ELEMENT && !isValue(it.c)) {
+                return false;
+            }
+            addArgument(it.a);
+            stores |= it.opcode == Opcode::STORE_ELEMENT;
+        } else if(!isLaneOperation(it.opcode) || !isValue(it.a) || (it.b.kind != Operand::Kind::NONE && !isValue(it.b))) {
+            return false;
+        }
+        if(it.dst >= 0) {
+            isLane[it.dst] = true;
+            // A copy shares the register of its source
+            lanes += it.opcode != Opcode::MOVE;
+        }
+    }
+    if(!stores || lanes + (int32_t)broadcasts.size() > VECTOR_REGISTERS) {
+        return false;
+    }
+
+    vector = Instruction(Opcode::VECTOR, counter, Operand::vreg(counter), bound);
+    vector.condition = condition;
+    vector.kernel.assign(body.begin(), body.end() - 2);
+    for(const auto it : arguments) {
+        vector.arguments.push_back(Operand::vreg(it));
+    }
+    return true;
+}
+
+void vectorizeLoops(Function &function) {
+    const Liveness liveness = computeLiveness(function);
+    const auto predecessors = computePredecessors(function);
+    for(const auto &loop : findLoops(function)) {
+        const int32_t header = loop.header;
+        if(loop.size != 1 || header == 0 || function.blocks[header].instructions.empty()) {
+            continue;
+        }
+        const Instruction &branch = function.blocks[header].instructions.back();
+        if(branch.opcode != Opcode::BRANCH || (branch.target == header) == (branch.alternative == header)) {
+            continue;
+        }
+        const int32_t exit = branch.target == header ? branch.alternative : branch.target;
+        Instruction vector(Opcode::VECTOR);
+        if(!buildVector(function, header, liveness.liveIn[exit], vector)) {
+            continue;
+        }
+
+        // The vector loop runs first and leaves the last iterations to the scalar one
+        const int32_t block = function.newBlock();
+        for(const auto it : predecessors[header]) {
+            if(it != header) {
+                function.blocks[it].instructions.back().retarget(header, block);
+            }
+        }
+        function.blocks[block].instructions.push_back(vector);
+        function.blocks[block].instructions.push_back(Instruction(Opcode::JUMP));
+        function.blocks[block].instructions.back().target = header;
+    }
+}
+
+};
@@ -0,0 +1,30 @@
+#pragma once
+#ifndef BACKEND_VECTORIZE_H
+#define BACKEND_VECTORIZE_H
+
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+/**
+ * @brief Vector registers the lanes and broadcast values of a kernel may take, the emitter keeps two
+ * more as scratch registers
+ * 
+ */
+const int32_t VECTOR_REGISTERS = 14;
+
+/**
+ * @brief Put a VECTOR loop in front of every single block loop whose counter goes up by one and whose
+ * other instructions combine elements at the counter with values which do not change in the loop.
+ * Such a loop carries nothing from one iteration to the next, arrays are either the same or disjoint
+ * so accesses at different indexes never overlap.
+ * 
+ * @param function Function to transform, simplifyControlFlow has to run afterwards to lay it out again
+ */
+void vectorizeLoops(Function &function);
+
+};
+
+#endif // BACKEND_VECTORIZE_H
@@ -0,0 +1,1462 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+
+#include "Ir.h"
+#include "Lowering.h"
+#include "LinearScan.h"
+#include "Vectorize.h"
+#include "Profile.h"
+#include "Sampling.h"
+#include "X86Emitter.h"
+
+namespace Backend {
+
+std::string functionSymbol(const std::string &name) {
+    return "xcpp_" + name;
+}
+
+static std::string globalSymbol(const std::string &name) {
+    return "xcpp_var_" + name;
+}
+
+// Routine or function a CALL or TAIL_CALL goes to
+static std::string calleeLabel(const Instruction &instruction) {
+    switch(instruction.callee) {
+        case PRINT_INTRINSIC: return ".Lprint";
+        case READ_INTRINSIC: return ".Lio_read";
+        case WRITE_INTRINSIC: return ".Lio_write";
+        default: return functionSymbol(instruction.symbol);
+    }
+}
+
+static bool fitsImmediate32(const int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+static const char *conditionSuffix(const Opcode opcode) {
+    switch(opcode) {
+        case Opcode::EQUAL: return "e";
+        case Opcode::NOT_EQUAL: return "ne";
+        case Opcode::LESS: return "l";
+        case Opcode::LESS_EQUAL: return "le";
+        case Opcode::GREATER: return "g";
+        default: return "ge";
+    }
+}
+
+// Where an operand is during one instruction
+class Value {
+public:
+    enum Kind {
+        REG, MEM, IMM
+    };
+
+    Kind kind = Kind::IMM;
+    Register reg = Register::NO_REGISTER;
+    int64_t imm = 0;
+    std::string mem;
+
+    static Value ofRegister(const Register reg) {
+        Value value;
+        value.kind = Kind::REG;
+        value.reg = reg;
+        return value;
+    }
+
+    bool isRegister(const Register other) const {
+        return this->kind == Kind::REG && this->reg == other;
+    }
+
+    bool operator ==(const Value &other) const {
+        return this->kind == other.kind && (this->kind == Kind::REG ? this->reg == other.reg
+            : this->kind == Kind::MEM ? this->mem == other.mem : this->imm == other.imm);
+    }
+
+    std::string text() const {
+        if(this->kind == Kind::REG) {
+            return RegisterName[this->reg];
+        } else if(this->kind == Kind::MEM) {
+            return this->mem;
+        }
+        return std::to_string(this->imm);
+    }
+};
+
+class FunctionEmitter {
+public:
+    std::ostream &os;
+    const Function &function;
+    const Allocation allocation;
+    EmitStats &stats;
+    const VectorIsa isa;
+    std::string symbol;
+    int32_t frameSize;
+    int32_t jumpTables;
+
+    // Loops the emitter makes itself, to zero arrays and to run VECTOR kernels
+    int32_t innerLoops;
+
+    // Line of every .Lline label of the program, labels are only placed when it is given
+    std::vector<int32_t> *lines;
+
+    // Source lines and call frames are described to debuggers and profilers
+    const bool debugInfo;
+
+    FunctionEmitter(std::ostream &_os, const Function &_function, const Allocation &_allocation, EmitStats &_stats, const VectorIsa _isa,
+        std::vector<int32_t> *_lines = nullptr, const bool _debugInfo = false)
+        : os(_os), function(_function), allocation(_allocation), stats(_stats), isa(_isa), symbol(functionSymbol(_function.name)),
+        frameSize(0), jumpTables(0), innerLoops(0), lines(_lines), debugInfo(_debugInfo) {}
+
+    void instruction(const std::string &text) {
+        this->os << "    " << text << "\n";
+        this->stats.instructions ++;
+    }
+
+    // Assembler directive of the debug information, left out without it
+    void debug(const std::string &text) {
+        if(this->debugInfo) {
+            this->os << "    " << text << "\n";
+        }
+    }
+
+    std::string label(const int32_t block) const {
+        return ".L" + this->symbol + "_b" + std::to_string(block);
+    }
+
+    std::string innerLabel() {
+        return ".L" + this->symbol + "_l" + std::to_string(this->innerLoops ++);
+    }
+
+    std::string stackSlot(const int32_t offset) const {
+        std::stringstream text;
+        text << "qword ptr [rbp " << (offset < 0 ? "- " : "+ ") << std::abs(offset) << "]";
+        return text.str();
+    }
+
+    Value ofVreg(const int32_t vreg) const {
+        const Location &location = this->allocation.locations[vreg];
+        if(location.isRegister()) {
+            return Value::ofRegister(location.reg);
+        }
+        Value value;
+        value.kind = Value::Kind::MEM;
+        value.mem = this->stackSlot(-8 * (int32_t)this->allocation.calleeSaved.size() - 8 * (location.slot + 1));
+        return value;
+    }
+
+    Value ofOperand(const Operand &operand) const {
+        if(operand.isVreg()) {
+            return this->ofVreg((int32_t)operand.value);
+        }
+        Value value;
+        value.kind = Value::Kind::IMM;
+        value.imm = operand.value;
+        return value;
+    }
+
+    void move(const Value &dst, const Value &src) {
+        if(dst == src) {
+            return;
+        }
+        if(dst.kind == Value::Kind::REG) {
+            if(src.kind == Value::Kind::IMM && src.imm == 0) {
+                this->instruction("xor " + RegisterName32[dst.reg] + ", " + RegisterName32[dst.reg]);
+            } else if(src.kind == Value::Kind::IMM && !fitsImmediate32(src.imm)) {
+                this->instruction("movabs " + dst.text() + ", " + src.text());
+            } else {
+                this->instruction("mov " + dst.text() + ", " + src.text());
+            }
+        } else if(src.kind == Value::Kind::REG || (src.kind == Value::Kind::IMM && fitsImmediate32(src.imm))) {
+            this->instruction("mov " + dst.text() + ", " + src.text());
+        } else {
+            // Memory to memory goes through R11, RAX may hold a value of a parallel move
+            this->move(Value::ofRegister(Register::R11), src);
+            this->instruction("mov " + dst.text() + ", r11");
+        }
+    }
+
+    // Immediates which do not fit an instruction are loaded into scratch first
+    Value encodable(const Value &value, const Register scratch) {
+        if(value.kind == Value::Kind::IMM && !fitsImmediate32(value.imm)) {
+            this->move(Value::ofRegister(scratch), value);
+            return Value::ofRegister(scratch);
+        }
+        return value;
+    }
+
+    // Moves which happen at the same time, sources are read before any destination is written
+    void parallelMove(std::vector<std::pair<Value, Value> > moves) {
+        for(size_t i = 0; i < moves.size();) {
+            if(moves[i].first == moves[i].second) {
+                this->stats.coalescedMoves ++;
+                moves.erase(moves.begin() + i);
+            } else {
+                i ++;
+            }
+        }
+        while(!moves.empty()) {
+            bool progress = false;
+            for(size_t i = 0; i < moves.size(); i ++) {
+                const Value &dst = moves[i].first;
+                bool blocked = false;
+                for(size_t j = 0; j < moves.size(); j ++) {
+                    blocked |= j != i && dst.kind == Value::Kind::REG && moves[j].second.isRegister(dst.reg);
+                }
+                if(!blocked) {
+                    this->move(dst, moves[i].second);
+                    moves.erase(moves.begin() + i);
+                    progress = true;
+                    break;
+                }
+            }
+            if(!progress) {
+                // Every destination is still read, break the cycle through RAX
+                this->move(Value::ofRegister(Register::RAX), moves[0].second);
+                moves[0].second = Value::ofRegister(Register::RAX);
+            }
+        }
+    }
+
+    void emitPrologue() {
+        this->os << "    .globl " << this->symbol << "\n";
+        this->os << "    .type " << this->symbol << ", @function\n";
+        this->os << this->symbol << ":\n";
+        this->debug(".cfi_startproc");
+        this->instruction("push rbp");
+        this->debug(".cfi_def_cfa_offset 16");
+        this->debug(".cfi_offset rbp, -16");
+        this->instruction("mov rbp, rsp");
+        this->debug(".cfi_def_cfa_register rbp");
+        for(size_t i = 0; i < this->allocation.calleeSaved.size(); i ++) {
+            this->instruction("push " + RegisterName[this->allocation.calleeSaved[i]]);
+            this->debug(".cfi_offset " + RegisterName[this->allocation.calleeSaved[i]] + ", " + std::to_string(-24 - 8 * (int32_t)i));
+        }
+        // Keep the stack 16 byte aligned at calls, arrays are below the spill slots
+        this->frameSize = 8 * (this->allocation.spillSlots + (int32_t)this->function.frameWords);
+        if((8 * this->allocation.calleeSaved.size() + this->frameSize) % 16 != 0) {
+            this->frameSize += 8;
+        }
+        if(this->frameSize > 0) {
+            this->instruction("sub rsp, " + std::to_string(this->frameSize));
+        }
+
+        std::vector<std::pair<Value, Value> > parameters;
+        for(const auto &it : this->function.blocks[0].instructions) {
+            if(it.opcode != Opcode::PARAM) {
+                break;
+            }
+            Value src;
+            if(it.a.value < 6) {
+                src = Value::ofRegister(ARGUMENT_REGISTERS[it.a.value]);
+            } else {
+                src.kind = Value::Kind::MEM;
+                src.mem = this->stackSlot(16 + 8 * ((int32_t)it.a.value - 6));
+            }
+            parameters.push_back({this->ofVreg(it.dst), src});
+        }
+        this->parallelMove(parameters);
+    }
+
+    // Restore the registers of the caller, the return address is on top of the stack afterwards. The frame
+    // is described again by restoreFrame after the ret or jmp which follows.
+    void emitEpilogue() {
+        this->debug(".cfi_remember_state");
+        if(this->frameSize > 0) {
+            this->instruction("lea rsp, [rbp - " + std::to_string(8 * this->allocation.calleeSaved.size()) + "]");
+        }
+        for(auto it = this->allocation.calleeSaved.rbegin(); it != this->allocation.calleeSaved.rend(); it ++) {
+            this->instruction("pop " + RegisterName[*it]);
+        }
+        this->instruction("pop rbp");
+        this->debug(".cfi_def_cfa rsp, 8");
+    }
+
+    // Code after an epilogue is still inside the frame
+    void restoreFrame() {
+        this->debug(".cfi_restore_state");
+    }
+
+    void emitArithmetic(const Instruction &instruction) {
+        const Value dst = this->ofVreg(instruction.dst);
+        Value a = this->ofOperand(instruction.a);
+        Value b = this->ofOperand(instruction.b);
+        const bool commutative = instruction.opcode != Opcode::SUB;
+        if(commutative && dst.kind == Value::Kind::REG && b.isRegister(dst.reg) && !a.isRegister(dst.reg)) {
+            std::swap(a, b);
+        }
+        // Two address form, computed in place when the destination register is not the right operand
+        const Value work = dst.kind == Value::Kind::REG && !b.isRegister(dst.reg) ? dst : Value::ofRegister(Register::RAX);
+        if(instruction.opcode == Opcode::MUL && a.kind != Value::Kind::IMM && b.kind == Value::Kind::IMM && fitsImmediate32(b.imm)) {
+            // Three operand form, the factor needs no copy of a first
+            this->instruction("imul " + work.text() + ", " + a.text() + ", " + b.text());
+            this->move(dst, work);
+            return;
+        }
+        this->move(work, a);
+        b = this->encodable(b, Register::R11);
+        if(instruction.opcode == Opcode::MUL) {
+            this->instruction(b.kind == Value::Kind::IMM ? "imul " + work.text() + ", " + work.text() + ", " + b.text() : "imul " + work.text() + ", " + b.text());
+        } else {
+            this->instruction(OpcodeName[instruction.opcode] + " " + work.text() + ", " + b.text());
+        }
+        this->move(dst, work);
+    }
+
+    // A factor of 1, 2, 4 or 8 is the scale of a lea, any other one the immediate of a three operand imul
+    void emitMultiplyAdd(const Instruction &instruction) {
+        const Value dst = this->ofVreg(instruction.dst);
+        const Value a = this->ofOperand(instruction.a);
+        const int64_t factor = instruction.b.value;
+        Value c = this->ofOperand(instruction.c);
+        const bool scale = factor == 1 || factor == 2 || factor == 4 || factor == 8;
+        if(scale && a.kind == Value::Kind::REG && (c.kind == Value::Kind::REG || (c.kind == Value::Kind::IMM && fitsImmediate32(c.imm)))) {
+            const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+            const std::string scaled = a.text() + (factor > 1 ? "*" + std::to_string(factor) : "");
+            if(c.kind == Value::Kind::REG) {
+                this->instruction("lea " + work.text() + ", [" + c.text() + " + " + scaled + "]");
+            } else {
+                this->instruction("lea " + work.text() + ", [" + scaled + (c.imm < 0 ? " - " : " + ") + std::to_string(std::abs(c.imm)) + "]");
+            }
+            this->move(dst, work);
+            return;
+        }
+        // The product may not overwrite the addend
+        const Value work = dst.kind == Value::Kind::REG && !c.isRegister(dst.reg) ? dst : Value::ofRegister(Register::RAX);
+        this->instruction("imul " + work.text() + ", " + a.text() + ", " + std::to_string(factor));
+        c = this->encodable(c, Register::R11);
+        this->instruction("add " + work.text() + ", " + c.text());
+        this->move(dst, work);
+    }
+
+    // Jump to the target of the terminator when the flags satisfy condition and to its alternative otherwise
+    void emitConditionalJump(const Instruction &instruction, const Opcode condition, const int32_t next) {
+        if(instruction.target == next) {
+            this->instruction(std::string("j") + conditionSuffix(invertComparison(condition)) + " " + this->label(instruction.alternative));
+        } else {
+            this->instruction(std::string("j") + conditionSuffix(condition) + " " + this->label(instruction.target));
+            if(instruction.alternative != next) {
+                this->instruction("jmp " + this->label(instruction.alternative));
+            }
+        }
+    }
+
+    // The sum is compared where it is computed, moving it to its register afterwards keeps the flags
+    void emitAddBranch(const Instruction &instruction, const int32_t next) {
+        const Value dst = this->ofVreg(instruction.dst);
+        Value a = this->ofOperand(instruction.a);
+        Value b = this->ofOperand(instruction.b);
+        const Value c = this->encodable(this->ofOperand(instruction.c), Register::R11);
+        if(dst.kind == Value::Kind::REG && b.isRegister(dst.reg) && !a.isRegister(dst.reg)) {
+            std::swap(a, b);
+        }
+        // Neither the addend nor the compared value may be overwritten before they are read
+        const Value work = dst.kind == Value::Kind::REG && !b.isRegister(dst.reg) && !c.isRegister(dst.reg) ? dst : Value::ofRegister(Register::RAX);
+        this->move(work, a);
+        this->instruction("add " + work.text() + ", " + this->encodable(b, Register::RDX).text());
+        if(c.kind != Value::Kind::IMM || c.imm != 0) {
+            this->instruction("cmp " + work.text() + ", " + c.text());
+        } else if(instruction.condition != Opcode::EQUAL && instruction.condition != Opcode::NOT_EQUAL) {
+            // The addition sets the zero flag, the sign is only right with a test when it overflowed
+            this->instruction("test " + work.text() + ", " + work.text());
+        }
+        this->move(dst, work);
+        this->emitConditionalJump(instruction, instruction.condition, next);
+    }
+
+    void emitInstruction(const Instruction &instruction, const int32_t next) {
+        switch(instruction.opcode) {
+            case Opcode::PARAM:
+                // Moved in by the prologue
+                break;
+            case Opcode::MOVE: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value src = this->ofOperand(instruction.a);
+                if(dst == src) {
+                    this->stats.coalescedMoves ++;
+                }
+                this->move(dst, src);
+                break;
+            }
+            case Opcode::ADD: case Opcode::SUB: case Opcode::MUL: case Opcode::AND: case Opcode::OR: case Opcode::XOR:
+                this->emitArithmetic(instruction);
+                break;
+            case Opcode::NEG: case Opcode::NOT: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+                this->move(work, this->ofOperand(instruction.a));
+                this->instruction(OpcodeName[instruction.opcode] + " " + work.text());
+                this->move(dst, work);
+                break;
+            }
+            case Opcode::DIV: case Opcode::MOD: {
+                this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+                Value divisor = this->ofOperand(instruction.b);
+                if(divisor.kind == Value::Kind::IMM) {
+                    this->move(Value::ofRegister(Register::R11), divisor);
+                    divisor = Value::ofRegister(Register::R11);
+                }
+                this->instruction("cqo");
+                this->instruction("idiv " + divisor.text());
+                this->move(this->ofVreg(instruction.dst), Value::ofRegister(instruction.opcode == Opcode::DIV ? Register::RAX : Register::RDX));
+                break;
+            }
+            case Opcode::MUL_ADD:
+                this->emitMultiplyAdd(instruction);
+                break;
+            case Opcode::ADD_DIV: case Opcode::ADD_MOD: {
+                // The dividend is summed where idiv takes it
+                this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+                this->instruction("add rax, " + this->encodable(this->ofOperand(instruction.b), Register::R11).text());
+                Value divisor = this->ofOperand(instruction.c);
+                if(divisor.kind == Value::Kind::IMM) {
+                    this->move(Value::ofRegister(Register::R11), divisor);
+                    divisor = Value::ofRegister(Register::R11);
+                }
+                this->instruction("cqo");
+                this->instruction("idiv " + divisor.text());
+                this->move(this->ofVreg(instruction.dst), Value::ofRegister(instruction.opcode == Opcode::ADD_DIV ? Register::RAX : Register::RDX));
+                break;
+            }
+            case Opcode::EQUAL: case Opcode::NOT_EQUAL: case Opcode::LESS: case Opcode::LESS_EQUAL: case Opcode::GREATER: case Opcode::GREATER_EQUAL: {
+                Value a = this->ofOperand(instruction.a);
+                Value b = this->ofOperand(instruction.b);
+                if(a.kind == Value::Kind::IMM || (a.kind == Value::Kind::MEM && b.kind == Value::Kind::MEM)) {
+                    this->move(Value::ofRegister(Register::RAX), a);
+                    a = Value::ofRegister(Register::RAX);
+                }
+                b = this->encodable(b, Register::R11);
+                this->instruction("cmp " + a.text() + ", " + b.text());
+                this->instruction(std::string("set") + conditionSuffix(instruction.opcode) + " al");
+                const Value dst = this->ofVreg(instruction.dst);
+                if(dst.kind == Value::Kind::REG) {
+                    this->instruction("movzx " + RegisterName32[dst.reg] + ", al");
+                } else {
+                    this->instruction("movzx eax, al");
+                    this->move(dst, Value::ofRegister(Register::RAX));
+                }
+                break;
+            }
+            case Opcode::LOAD_GLOBAL: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+                this->instruction("mov " + work.text() + ", qword ptr [rip + " + globalSymbol(instruction.symbol) + "]");
+                this->move(dst, work);
+                break;
+            }
+            case Opcode::STORE_GLOBAL: {
+                Value src = this->ofOperand(instruction.a);
+                if(src.kind == Value::Kind::MEM || (src.kind == Value::Kind::IMM && !fitsImmediate32(src.imm))) {
+                    this->move(Value::ofRegister(Register::RAX), src);
+                    src = Value::ofRegister(Register::RAX);
+                }
+                this->instruction("mov qword ptr [rip + " + globalSymbol(instruction.symbol) + "], " + src.text());
+                break;
+            }
+            case Opcode::CALL:
+                this->emitCall(instruction);
+                break;
+            case Opcode::ADDRESS: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+                this->instruction("lea " + work.text() + ", [rip + " + globalSymbol(instruction.symbol) + "]");
+                this->move(dst, work);
+                break;
+            }
+            case Opcode::ALLOCATE:
+                this->emitAllocate(instruction);
+                break;
+            case Opcode::NEW:
+                // Zeroed words from the collected heap, a failed allocation faults at the first access of the array
+                this->move(Value::ofRegister(Register::RDI), this->ofOperand(instruction.a));
+                this->instruction("call .Lheap_new");
+                this->move(this->ofVreg(instruction.dst), Value::ofRegister(Register::RAX));
+                break;
+            case Opcode::LOAD_ELEMENT: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+                this->instruction("mov " + work.text() + ", " + this->element(instruction.a, instruction.b));
+                this->move(dst, work);
+                break;
+            }
+            case Opcode::STORE_ELEMENT: {
+                Value value = this->ofOperand(instruction.c);
+                if(value.kind == Value::Kind::MEM || (value.kind == Value::Kind::IMM && !fitsImmediate32(value.imm))) {
+                    this->move(Value::ofRegister(Register::RDX), value);
+                    value = Value::ofRegister(Register::RDX);
+                }
+                this->instruction("mov " + this->element(instruction.a, instruction.b) + ", " + value.text());
+                break;
+            }
+            case Opcode::VECTOR:
+                this->emitVector(instruction);
+                break;
+            case Opcode::PROFILE_COUNT:
+                this->instruction("add qword ptr [rip + .Lprofile_counters + " + std::to_string(8 * instruction.a.value) + "], 1");
+                break;
+            case Opcode::JUMP:
+                if(instruction.target != next) {
+                    this->instruction("jmp " + this->label(instruction.target));
+                }
+                break;
+            case Opcode::BRANCH: {
+                Opcode condition = instruction.condition;
+                Value a = this->ofOperand(instruction.a);
+                Value b = this->ofOperand(instruction.b);
+                if(a.kind == Value::Kind::IMM && b.kind == Value::Kind::IMM) {
+                    const int32_t taken = evaluateComparison(condition, a.imm, b.imm) ? instruction.target : instruction.alternative;
+                    if(taken != next) {
+                        this->instruction("jmp " + this->label(taken));
+                    }
+                    break;
+                }
+                if(a.kind == Value::Kind::IMM) {
+                    std::swap(a, b);
+                    condition = swapComparison(condition);
+                }
+                if(a.kind == Value::Kind::MEM && b.kind == Value::Kind::MEM) {
+                    this->move(Value::ofRegister(Register::RAX), a);
+                    a = Value::ofRegister(Register::RAX);
+                }
+                b = this->encodable(b, Register::R11);
+                if(a.kind == Value::Kind::REG && b.kind == Value::Kind::IMM && b.imm == 0) {
+                    this->instruction("test " + a.text() + ", " + a.text());
+                } else {
+                    this->instruction("cmp " + a.text() + ", " + b.text());
+                }
+                this->emitConditionalJump(instruction, condition, next);
+                break;
+            }
+            case Opcode::ADD_BRANCH:
+                this->emitAddBranch(instruction, next);
+                break;
+            case Opcode::ADD_STORE: {
+                // The sum is made in RDX, element may take RAX and R11 for the address
+                this->move(Value::ofRegister(Register::RDX), this->ofOperand(instruction.c));
+                this->instruction("add rdx, " + this->encodable(this->ofOperand(instruction.d), Register::R11).text());
+                this->instruction("mov " + this->element(instruction.a, instruction.b) + ", rdx");
+                break;
+            }
+            case Opcode::MOD_ADD: case Opcode::LOAD_MOD: {
+                if(instruction.opcode == Opcode::LOAD_MOD) {
+                    this->instruction("mov rax, " + this->element(instruction.a, instruction.b));
+                } else {
+                    this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+                }
+                Value divisor = this->ofOperand(instruction.opcode == Opcode::LOAD_MOD ? instruction.c : instruction.b);
+                if(divisor.kind == Value::Kind::IMM) {
+                    this->move(Value::ofRegister(Register::R11), divisor);
+                    divisor = Value::ofRegister(Register::R11);
+                }
+                this->instruction("cqo");
+                this->instruction("idiv " + divisor.text());
+                if(instruction.opcode == Opcode::MOD_ADD) {
+                    // The addend is added to the remainder where idiv leaves it
+                    this->instruction("add rdx, " + this->encodable(this->ofOperand(instruction.c), Register::R11).text());
+                }
+                this->move(this->ofVreg(instruction.dst), Value::ofRegister(Register::RDX));
+                break;
+            }
+            case Opcode::SUB_LOAD: {
+                const Value dst = this->ofVreg(instruction.dst);
+                const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+                this->instruction("mov " + work.text() + ", " + this->element(instruction.a, instruction.b, -instruction.c.value));
+                this->move(dst, work);
+                break;
+            }
+            case Opcode::SWITCH:
+                this->emitSwitch(instruction);
+                break;
+            case Opcode::RETURN:
+                this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+                this->emitEpilogue();
+                this->instruction("ret");
+                this->restoreFrame();
+                break;
+            case Opcode::TAIL_CALL: {
+                // The callee returns to the caller of this function
+                std::vector<std::pair<Value, Value> > moves;
+                for(size_t i = 0; i < instruction.arguments.size(); i ++) {
+                    moves.push_back({Value::ofRegister(ARGUMENT_REGISTERS[i]), this->ofOperand(instruction.arguments[i])});
+                }
+                this->parallelMove(moves);
+                this->emitEpilogue();
+                this->instruction("jmp " + calleeLabel(instruction));
+                this->restoreFrame();
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void emitCall(const Instruction &instruction) {
+        const int32_t stackArguments = std::max(0, (int32_t)instruction.arguments.size() - 6);
+        const int32_t padding = stackArguments % 2 ? 8 : 0;
+        if(padding) {
+            this->instruction("sub rsp, 8");
+        }
+        for(int32_t i = (int32_t)instruction.arguments.size() - 1; i >= 6; i --) {
+            const Value argument = this->encodable(this->ofOperand(instruction.arguments[i]), Register::RAX);
+            this->instruction("push " + argument.text());
+        }
+        std::vector<std::pair<Value, Value> > moves;
+        for(size_t i = 0; i < instruction.arguments.size() && i < 6; i ++) {
+            moves.push_back({Value::ofRegister(ARGUMENT_REGISTERS[i]), this->ofOperand(instruction.arguments[i])});
+        }
+        this->parallelMove(moves);
+        this->instruction("call " + calleeLabel(instruction));
+        if(stackArguments + padding / 8 > 0) {
+            this->instruction("add rsp, " + std::to_string(8 * stackArguments + padding));
+        }
+        if(instruction.dst >= 0) {
+            this->move(this->ofVreg(instruction.dst), Value::ofRegister(Register::RAX));
+        }
+    }
+
+    // Memory operand of an element, the array goes through RAX and the index through R11 when they are not in registers.
+    // The element is offset elements after the indexed one, fuseInstructions keeps 8 * offset a displacement.
+    std::string element(const Operand &array, const Operand &index, int64_t offset = 0) {
+        Value base = this->ofOperand(array);
+        if(base.kind != Value::Kind::REG) {
+            this->move(Value::ofRegister(Register::RAX), base);
+            base = Value::ofRegister(Register::RAX);
+        }
+        Value position = this->ofOperand(index);
+        if(position.kind == Value::Kind::IMM) {
+            position.imm += offset;
+            offset = 0;
+        }
+        if(position.kind == Value::Kind::IMM && position.imm >= INT32_MIN / 8 && position.imm <= INT32_MAX / 8) {
+            return "qword ptr [" + base.text() + (position.imm < 0 ? " - " : " + ") + std::to_string(std::abs(8 * position.imm)) + "]";
+        }
+        if(position.kind != Value::Kind::REG) {
+            this->move(Value::ofRegister(Register::R11), position);
+            position = Value::ofRegister(Register::R11);
+        }
+        const std::string displacement = offset == 0 ? "" : (offset < 0 ? " - " : " + ") + std::to_string(std::abs(8 * offset));
+        return "qword ptr [" + base.text() + " + " + position.text() + " * 8" + displacement + "]";
+    }
+
+    // Zero the frame words of the array, then take the address of its first element
+    void emitAllocate(const Instruction &instruction) {
+        const int64_t length = instruction.b.value;
+        const int64_t offset = 8 * ((int64_t)this->allocation.calleeSaved.size() + this->allocation.spillSlots + instruction.a.value + length);
+        const std::string address = "[rbp - " + std::to_string(offset) + "]";
+        if(length <= 8) {
+            for(int64_t i = 0; i < length; i ++) {
+                this->instruction("mov qword ptr [rbp - " + std::to_string(offset - 8 * i) + "], 0");
+            }
+        } else {
+            const std::string loop = this->innerLabel();
+            this->instruction("lea r11, " + address);
+            this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.b));
+            this->os << loop << ":\n";
+            this->instruction("mov qword ptr [r11 + rax * 8 - 8], 0");
+            this->instruction("sub rax, 1");
+            this->instruction("jnz " + loop);
+        }
+        const Value dst = this->ofVreg(instruction.dst);
+        const Value work = dst.kind == Value::Kind::REG ? dst : Value::ofRegister(Register::RAX);
+        this->instruction("lea " + work.text() + ", " + address);
+        this->move(dst, work);
+    }
+
+    /**
+     * @brief Run the kernel on as many elements at once as a vector register holds, RAX counts and R11
+     * is where the vector loop stops. Lanes and broadcast values take the first vector registers, the
+     * last two are scratch registers of multiplications.
+     * 
+     */
+    void emitVector(const Instruction &instruction) {
+        const bool avx = this->isa == VectorIsa::AVX2;
+        const int32_t lanes = VECTOR_LANES[this->isa];
+        const std::string loop = this->innerLabel();
+        const std::string done = loop + "_done";
+        this->stats.vectorLoops ++;
+
+        // Whole vectors of the iterations left, keeping the last one for the scalar loop
+        this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+        this->move(Value::ofRegister(Register::R11), this->ofOperand(instruction.b));
+        if(instruction.condition != Opcode::NOT_EQUAL) {
+            this->instruction("cmp rax, r11");
+            this->instruction(std::string(instruction.condition == Opcode::LESS ? "jge " : "jg ") + done);
+        }
+        this->instruction("sub r11, rax");
+        if(instruction.condition != Opcode::LESS_EQUAL) {
+            this->instruction("sub r11, 1");
+        }
+        this->instruction("and r11, " + std::to_string(-lanes));
+        this->instruction("jz " + done);
+        this->instruction("add r11, rax");
+
+        auto name = [&](const int32_t index) {
+            return (avx ? "ymm" : "xmm") + std::to_string(index);
+        };
+        auto operation = [&](const std::string &mnemonic, const int32_t dst, const int32_t a, const std::string &b) {
+            if(avx) {
+                this->instruction("v" + mnemonic + " " + name(dst) + ", " + name(a) + ", " + b);
+            } else {
+                if(dst != a) {
+                    this->instruction("movdqa " + name(dst) + ", " + name(a));
+                }
+                this->instruction(mnemonic + " " + name(dst) + ", " + b);
+            }
+        };
+        auto combine = [&](const std::string &mnemonic, const int32_t dst, const int32_t a, const int32_t b) {
+            operation(mnemonic, dst, a, name(b));
+        };
+
+        // Values which are the same in every lane are broadcast before the loop
+        std::unordered_map<int32_t, int32_t> registers;
+        std::map<std::pair<Operand::Kind, int64_t>, int32_t> broadcasts;
+        int32_t used = 0;
+        auto broadcast = [&](const Operand &operand) {
+            if((operand.isVreg() && registers.count(operand.value)) || broadcasts.count({operand.kind, operand.value})) {
+                return;
+            }
+            Value value = this->ofOperand(operand);
+            if(value.kind == Value::Kind::IMM) {
+                this->move(Value::ofRegister(Register::RDX), value);
+                value = Value::ofRegister(Register::RDX);
+            }
+            const int32_t index = used ++;
+            broadcasts[{operand.kind, operand.value}] = index;
+            this->instruction((avx ? "vmovq xmm" : "movq xmm") + std::to_string(index) + ", " + value.text());
+            if(avx) {
+                this->instruction("vpbroadcastq " + name(index) + ", xmm" + std::to_string(index));
+            } else {
+                this->instruction("punpcklqdq " + name(index) + ", " + name(index));
+            }
+        };
+        for(const auto &it : instruction.kernel) {
+            if(it.opcode == Opcode::STORE_ELEMENT) {
+                broadcast(it.c);
+            } else if(it.opcode != Opcode::LOAD_ELEMENT) {
+                broadcast(it.a);
+                if(it.b.kind != Operand::Kind::NONE) {
+                    broadcast(it.b);
+                }
+            }
+            if(it.dst >= 0) {
+                // Only marks the lane as defined, registers are handed out again in the loop
+                registers[it.dst] = -1;
+            }
+        }
+        registers.clear();
+        auto of = [&](const Operand &operand) {
+            if(operand.isVreg() && registers.count(operand.value)) {
+                return registers[operand.value];
+            }
+            return broadcasts[{operand.kind, operand.value}];
+        };
+        auto memory = [&](const Operand &array) {
+            Value base = this->ofOperand(array);
+            if(base.kind != Value::Kind::REG) {
+                this->move(Value::ofRegister(Register::RDX), base);
+                base = Value::ofRegister(Register::RDX);
+            }
+            return std::string(avx ? "ymmword" : "xmmword") + " ptr [" + base.text() + " + rax * 8]";
+        };
+
+        this->os << "    .p2align 4\n";
+        this->os << loop << ":\n";
+        const std::string unaligned = avx ? "vmovdqu " : "movdqu ";
+        for(const auto &it : instruction.kernel) {
+            switch(it.opcode) {
+                case Opcode::LOAD_ELEMENT:
+                    registers[it.dst] = used ++;
+                    this->instruction(unaligned + name(registers[it.dst]) + ", " + memory(it.a));
+                    break;
+                case Opcode::STORE_ELEMENT:
+                    this->instruction(unaligned + memory(it.a) + ", " + name(of(it.c)));
+                    break;
+                case Opcode::MOVE:
+                    registers[it.dst] = of(it.a);
+                    break;
+                case Opcode::NEG: case Opcode::NOT: {
+                    const int32_t dst = used ++, a = of(it.a);
+                    if(it.opcode == Opcode::NEG) {
+                        combine("pxor", dst, dst, dst);
+                        combine("psubq", dst, dst, a);
+                    } else {
+                        combine("pcmpeqd", dst, dst, dst);
+                        combine("pxor", dst, dst, a);
+                    }
+                    registers[it.dst] = dst;
+                    break;
+                }
+                case Opcode::MUL: {
+                    // Products of the 32 bit halves, the high half of both is shifted out
+                    const int32_t dst = used ++, a = of(it.a), b = of(it.b);
+                    const int32_t high = VECTOR_REGISTERS, cross = VECTOR_REGISTERS + 1;
+                    combine("pmuludq", dst, a, b);
+                    operation("psrlq", high, a, "32");
+                    combine("pmuludq", high, high, b);
+                    operation("psrlq", cross, b, "32");
+                    combine("pmuludq", cross, cross, a);
+                    combine("paddq", high, high, cross);
+                    operation("psllq", high, high, "32");
+                    combine("paddq", dst, dst, high);
+                    registers[it.dst] = dst;
+                    break;
+                }
+                default: {
+                    const int32_t dst = used ++;
+                    const std::string mnemonic = it.opcode == Opcode::ADD ? "paddq" : it.opcode == Opcode::SUB ? "psubq"
+                        : it.opcode == Opcode::AND ? "pand" : it.opcode == Opcode::OR ? "por" : "pxor";
+                    combine(mnemonic, dst, of(it.a), of(it.b));
+                    registers[it.dst] = dst;
+                    break;
+                }
+            }
+        }
+        this->instruction("add rax, " + std::to_string(lanes));
+        this->instruction("cmp rax, r11");
+        this->instruction("jne " + loop);
+        if(avx) {
+            // Later SSE code would pay for the upper halves of the registers
+            this->instruction("vzeroupper");
+        }
+        this->os << done << ":\n";
+        this->move(this->ofVreg(instruction.dst), Value::ofRegister(Register::RAX));
+    }
+
+    // Bounds check the case index, then jump through a table of offsets relative to the table
+    void emitSwitch(const Instruction &instruction) {
+        this->move(Value::ofRegister(Register::RAX), this->ofOperand(instruction.a));
+        if(instruction.b.value != 0) {
+            const Value low = this->encodable(this->ofOperand(instruction.b), Register::R11);
+            this->instruction("sub rax, " + low.text());
+        }
+        this->instruction("cmp rax, " + std::to_string(instruction.cases.size()));
+        this->instruction("jae " + this->label(instruction.alternative));
+        const std::string table = ".L" + this->symbol + "_t" + std::to_string(this->jumpTables ++);
+        this->instruction("lea r11, [rip + " + table + "]");
+        this->instruction("movsxd rax, dword ptr [r11 + rax * 4]");
+        this->instruction("add rax, r11");
+        this->instruction("jmp rax");
+        this->os << "    .section .rodata\n";
+        this->os << "    .p2align 2\n";
+        this->os << table << ":\n";
+        for(const auto it : instruction.cases) {
+            this->os << "    .long " << this->label(it) << " - " << table << "\n";
+        }
+        this->os << "    .text\n";
+    }
+
+    // Lines of the line table count from 1, the lexer counts from 0
+    void emitLocation(const int32_t line) {
+        this->debug(".loc 1 " + std::to_string(line + 1));
+    }
+
+    void emit() {
+        // The prologue belongs to the first line of the function
+        int32_t located = -1;
+        for(size_t b = 0; b < this->function.blocks.size() && located < 0; b ++) {
+            for(const auto &it : this->function.blocks[b].instructions) {
+                if(it.line >= 0) {
+                    located = it.line;
+                    this->emitLocation(located);
+                    break;
+                }
+            }
+        }
+        this->emitPrologue();
+        int32_t line = -1;
+        for(size_t b = 0; b < this->function.blocks.size(); b ++) {
+            this->os << this->label(b) << ":\n";
+            for(const auto &it : this->function.blocks[b].instructions) {
+                // Instructions without a line continue the one before them
+                if(this->lines && it.line >= 0 && it.line != line) {
+                    this->os << ".Lline" << this->lines->size() << ":\n";
+                    this->lines->push_back(it.line);
+                    line = it.line;
+                }
+                if(it.line >= 0 && it.line != located) {
+                    this->emitLocation(it.line);
+                    located = it.line;
+                }
+                this->emitInstruction(it, (int32_t)b + 1);
+            }
+        }
+        this->debug(".cfi_endproc");
+        this->os << "    .size " << this->symbol << ", . - " << this->symbol << "\n";
+    }
+};
+
+static bool usesPrint(const Program &program) {
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            for(const auto &it : block.instructions) {
+                if(it.opcode == Opcode::CALL && it.callee == PRINT_INTRINSIC) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static bool usesIo(const Program &program) {
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            for(const auto &it : block.instructions) {
+                const bool call = it.opcode == Opcode::CALL || it.opcode == Opcode::TAIL_CALL;
+                if(call && (it.callee == READ_INTRINSIC || it.callee == WRITE_INTRINSIC)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static bool allocates(const Program &program) {
+    for(const auto &function : program.functions) {
+        for(const auto &block : function.blocks) {
+            for(const auto &it : block.instructions) {
+                if(it.opcode == Opcode::NEW) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Map the stack, make its bottom inaccessible and call MAIN_FUNCTION with the stack pointer at its top
+static void emitEntry(std::ostream &os, const Program &program, const bool prints, const bool collects) {
+    const std::string reserve = std::to_string(STACK_RESERVE_BYTES);
+    std::vector<std::string> lines = {
+        "push rbp", "mov rbp, rsp", "push rbx", "sub rsp, 8",
+        // mmap(NULL, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)
+        "xor edi, edi", "movabs rsi, " + reserve, "mov edx, 3", "mov ecx, 0x4022", "mov r8, -1", "xor r9d, r9d",
+        "call mmap@PLT", "cmp rax, -1", "je .Lmain_run",
+        // mprotect(stack, guard, PROT_NONE)
+        "mov rbx, rax", "mov rdi, rax", "mov esi, " + std::to_string(STACK_GUARD_BYTES), "xor edx, edx", "call mprotect@PLT",
+        "movabs rax, " + reserve, "lea rsp, [rbx + rax]",
+        ".Lmain_run:"
+    };
+    if(collects) {
+        // The collector scans the frames of the program up to here
+        lines.push_back("mov qword ptr [rip + .Lheap_stack_top], rsp");
+    }
+    const bool sampled = !program.samplePath.empty();
+    if(sampled) {
+        lines.insert(lines.end(), {
+            // Frames of the program are below the stack pointer of this call
+            "mov qword ptr [rip + .Lsample_stack_top], rsp",
+            // sigaction(SIGPROF, &action, NULL), then setitimer(ITIMER_PROF, &timer, NULL)
+            "mov edi, 27", "lea rsi, [rip + .Lsample_action]", "xor edx, edx", "call sigaction@PLT",
+            "mov edi, 2", "lea rsi, [rip + .Lsample_timer]", "xor edx, edx", "call setitimer@PLT"
+        });
+    }
+    lines.push_back("call " + functionSymbol(MAIN_FUNCTION));
+    const bool keepsResult = program.profileCounters > 0 || sampled || prints;
+    if(keepsResult) {
+        // The result is kept in rbx and the descriptor of the open file below it
+        lines.insert(lines.end(), {"lea rsp, [rbp - 16]", "mov ebx, eax"});
+    }
+    if(prints) {
+        lines.push_back("call .Lprint_flush");
+    }
+    if(program.profileCounters > 0) {
+        const std::string bytes = std::to_string(PROFILE_HEADER_BYTES + 8 * program.profileCounters);
+        lines.insert(lines.end(), {
+            // open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+            "lea rdi, [rip + .Lprofile_path]", "mov esi, 0x241", "mov edx, 0x1a4", "call open@PLT",
+            "test eax, eax", "js .Lprofile_done", "mov dword ptr [rbp - 16], eax",
+            // write(fd, profile, bytes), then close(fd)
+            "mov edi, eax", "lea rsi, [rip + .Lprofile]", "movabs rdx, " + bytes, "call write@PLT",
+            "mov edi, dword ptr [rbp - 16]", "call close@PLT",
+            ".Lprofile_done:"
+        });
+    }
+    if(sampled) {
+        lines.insert(lines.end(), {
+            // setitimer(ITIMER_PROF, &stop, NULL), no sample changes the buffer while it is written
+            "mov edi, 2", "lea rsi, [rip + .Lsample_stop]", "xor edx, edx", "call setitimer@PLT",
+            "lea rdi, [rip + .Lsample_path]", "mov esi, 0x241", "mov edx, 0x1a4", "call open@PLT",
+            "test eax, eax", "js .Lsample_done", "mov dword ptr [rbp - 16], eax",
+            // The header and the tables, then the samples
+            "mov edi, eax", "lea rsi, [rip + .Lsamples]", "mov rdx, qword ptr [rip + .Lsample_table_bytes]", "call write@PLT",
+            "mov edi, dword ptr [rbp - 16]", "lea rsi, [rip + .Lsample_buffer]", "mov rdx, qword ptr [rip + .Lsamples + 48]",
+            "shl rdx, 3", "call write@PLT",
+            "mov edi, dword ptr [rbp - 16]", "call close@PLT",
+            ".Lsample_done:"
+        });
+    }
+    if(keepsResult) {
+        lines.push_back("mov eax, ebx");
+    }
+    lines.insert(lines.end(), {"lea rsp, [rbp - 8]", "pop rbx", "pop rbp", "ret"});
+    os << "    .globl main\n";
+    os << "    .type main, @function\n";
+    os << "main:\n";
+    for(const auto &it : lines) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+}
+
+// Path quoted for a directive, quotes and backslashes are escaped
+static std::string quote(const std::string &path) {
+    std::string quoted = "\"";
+    for(const char c : path) {
+        quoted += (c == '"' || c == '\\' ? "\\" : "") + std::string(1, c);
+    }
+    return quoted + "\"";
+}
+
+// String directive of a path
+static void emitPath(std::ostream &os, const std::string &path) {
+    os << "    .asciz " << quote(path) << "\n";
+}
+
+/**
+ * @brief Emit the routines of print and their buffer. A value is formatted two digits at a time from a
+ * table of digit pairs, dividing by 100 with a multiplication, into the red zone and copied to the buffer
+ * in three words. The buffer is written out when it may not hold another value and when MAIN_FUNCTION
+ * returns.
+ * 
+ * @param os Stream receiving the assembly
+ */
+static void emitPrinter(std::ostream &os) {
+    const std::string print[] = {
+        // rdi holds the value and sil the character following it
+        "mov rax, qword ptr [rip + .Lprint_length]", "cmp rax, " + std::to_string(PRINT_BUFFER_BYTES - 32), "jbe .Lprint_format",
+        "push rdi", "push rsi", "sub rsp, 8", "call .Lprint_flush", "add rsp, 8", "pop rsi", "pop rdi", "xor eax, eax",
+        ".Lprint_format:",
+        "lea r8, [rip + .Lprint_buffer]", "add r8, rax", "mov rcx, rdi", "test rdi, rdi", "jns .Lprint_unsigned",
+        "mov byte ptr [r8], 45", "inc r8", "neg rcx",
+        // Digits are written backwards ending at r9, the magnitude of INT64_MIN is right as an unsigned number
+        ".Lprint_unsigned:",
+        "lea r10, [rsp - 8]", "mov r9, r10", "lea r11, [rip + .Lprint_pairs]", "movabs rdi, 0x28f5c28f5c28f5c3",
+        ".Lprint_pair:",
+        "cmp rcx, 100", "jb .Lprint_last",
+        "mov rax, rcx", "shr rax, 2", "mul rdi", "shr rdx, 2", "imul rax, rdx, 100", "sub rcx, rax",
+        "movzx eax, word ptr [r11 + 2 * rcx]", "sub r10, 2", "mov word ptr [r10], ax", "mov rcx, rdx",
+        "jmp .Lprint_pair",
+        ".Lprint_last:",
+        "cmp rcx, 10", "jb .Lprint_digit",
+        "movzx eax, word ptr [r11 + 2 * rcx]", "sub r10, 2", "mov word ptr [r10], ax", "jmp .Lprint_copy",
+        ".Lprint_digit:",
+        "add ecx, 48", "dec r10", "mov byte ptr [r10], cl",
+        // At most 20 digits, the bytes copied past them are overwritten by the next value
+        ".Lprint_copy:",
+        "mov rax, qword ptr [r10]", "mov qword ptr [r8], rax", "mov rax, qword ptr [r10 + 8]", "mov qword ptr [r8 + 8], rax",
+        "mov rax, qword ptr [r10 + 16]", "mov qword ptr [r8 + 16], rax",
+        "sub r9, r10", "add r8, r9", "mov byte ptr [r8], sil", "inc r8",
+        "lea rax, [rip + .Lprint_buffer]", "sub r8, rax", "mov qword ptr [rip + .Lprint_length], r8",
+        "ret"
+    };
+    const std::string flush[] = {
+        // write(1, buffer + written, length - written) until everything is written or writing fails
+        "push rbx", "xor ebx, ebx",
+        ".Lprint_flush_write:",
+        "mov rdx, qword ptr [rip + .Lprint_length]", "sub rdx, rbx", "jle .Lprint_flush_done",
+        "mov edi, 1", "lea rsi, [rip + .Lprint_buffer]", "add rsi, rbx", "call write@PLT",
+        "test rax, rax", "jle .Lprint_flush_done", "add rbx, rax", "jmp .Lprint_flush_write",
+        ".Lprint_flush_done:",
+        "mov qword ptr [rip + .Lprint_length], 0", "pop rbx", "ret"
+    };
+    os << ".Lprint:\n";
+    for(const auto &it : print) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+    os << "    .globl " << PRINT_FLUSH_SYMBOL << "\n";
+    os << "    .type " << PRINT_FLUSH_SYMBOL << ", @function\n";
+    os << PRINT_FLUSH_SYMBOL << ":\n";
+    os << ".Lprint_flush:\n";
+    for(const auto &it : flush) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+
+    os << "    .section .rodata\n";
+    os << ".Lprint_pairs:\n";
+    for(int32_t i = 0; i < 100; i += 10) {
+        os << "    .ascii \"";
+        for(int32_t j = i; j < i + 10; j ++) {
+            os << (char)('0' + j / 10) << (char)('0' + j % 10);
+        }
+        os << "\"\n";
+    }
+    os << "    .bss\n";
+    os << "    .align 8\n";
+    os << ".Lprint_length:\n";
+    os << "    .zero 8\n";
+    os << ".Lprint_buffer:\n";
+    os << "    .zero " << PRINT_BUFFER_BYTES << "\n";
+    os << "    .text\n";
+}
+
+/**
+ * @brief Emit the routines of read and write. They tail call the function IO_HOOK_SYMBOL points to when a
+ * host set it, and read or write one byte in their frame with libc otherwise. write flushes what print
+ * collected before it writes to the standard output, so the output keeps its order.
+ * 
+ * @param os Stream receiving the assembly
+ * @param prints Whether the program has the routines of print
+ */
+static void emitIo(std::ostream &os, const bool prints) {
+    const std::vector<std::string> read = {
+        // rdi holds the descriptor
+        "mov rax, qword ptr [rip + .Lio_hook]", "test rax, rax", "jz .Lio_read_libc",
+        "mov rsi, rdi", "xor edi, edi", "xor edx, edx", "jmp rax",
+        // read(fd, frame, 1)
+        ".Lio_read_libc:",
+        "sub rsp, 24", "mov rsi, rsp", "mov edx, 1", "call read@PLT",
+        "cmp rax, 1", "jne .Lio_read_failed", "movzx eax, byte ptr [rsp]", "add rsp, 24", "ret",
+        ".Lio_read_failed:",
+        "mov rax, -1", "add rsp, 24", "ret"
+    };
+    std::vector<std::string> write;
+    if(prints) {
+        write = {
+            "cmp rdi, 1", "jne .Lio_write_start",
+            "push rdi", "push rsi", "sub rsp, 8", "call .Lprint_flush", "add rsp, 8", "pop rsi", "pop rdi",
+            ".Lio_write_start:"
+        };
+    }
+    write.insert(write.end(), {
+        // rdi holds the descriptor and rsi the value
+        "mov rax, qword ptr [rip + .Lio_hook]", "test rax, rax", "jz .Lio_write_libc",
+        "mov rdx, rsi", "mov rsi, rdi", "mov edi, 1", "jmp rax",
+        // write(fd, frame, 1)
+        ".Lio_write_libc:",
+        "sub rsp, 24", "mov byte ptr [rsp], sil", "mov rsi, rsp", "mov edx, 1", "call write@PLT",
+        "cmp rax, 1", "je .Lio_write_done", "mov rax, -1",
+        ".Lio_write_done:",
+        "add rsp, 24", "ret"
+    });
+    os << ".Lio_read:\n";
+    for(const auto &it : read) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+    os << ".Lio_write:\n";
+    for(const auto &it : write) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+
+    os << "    .data\n";
+    os << "    .align 8\n";
+    os << "    .globl " << IO_HOOK_SYMBOL << "\n";
+    os << "    .type " << IO_HOOK_SYMBOL << ", @object\n";
+    os << IO_HOOK_SYMBOL << ":\n";
+    os << ".Lio_hook:\n";
+    os << "    .quad 0\n";
+    os << "    .text\n";
+}
+
+/**
+ * @brief Emit the heap NEW allocates arrays from. An array is a header of its length and its mark followed
+ * by its words, allocated with calloc and recorded in a table. Once the program allocated as many bytes as
+ * survived the last collection, or HEAP_MIN_BYTES, the table is sorted by address and the arrays which
+ * some word of the stack, of the globals or of a marked array points into are marked, the others are
+ * freed. Values are not typed, so roots are conservative: a number which happens to be an address keeps
+ * its array alive, but an array is never freed while it is reachable. Values live across NEW are in the
+ * frames or in callee saved registers, which the collector pushes before it scans the stack.
+ * 
+ * The stack is scanned from the collector up to HEAP_STACK_TOP_SYMBOL, without it nothing is collected.
+ * 
+ * @param os Stream receiving the assembly
+ */
+static void emitCollector(std::ostream &os) {
+    const std::vector<std::string> allocate = {
+        // rdi holds the number of words, the header takes two more
+        "push rbx", "push r12", "sub rsp, 8", "mov r12, rdi", "lea rbx, [8 * rdi + 16]",
+        "mov rax, qword ptr [rip + .Lheap_allocated]", "add rax, rbx", "cmp rax, qword ptr [rip + .Lheap_limit]",
+        "jbe .Lheap_new_record", "call .Lheap_collect",
+        ".Lheap_new_record:",
+        "add qword ptr [rip + .Lheap_allocated], rbx",
+        "mov rax, qword ptr [rip + .Lheap_count]", "cmp rax, qword ptr [rip + .Lheap_capacity]", "jb .Lheap_new_calloc",
+        // realloc(table, 8 * capacity) with the capacity doubled
+        "mov rsi, qword ptr [rip + .Lheap_capacity]", "add rsi, rsi", "mov eax, 1024", "cmp rsi, rax", "cmovb rsi, rax",
+        "mov qword ptr [rip + .Lheap_capacity], rsi", "shl rsi, 3", "mov rdi, qword ptr [rip + .Lheap_table]",
+        "call realloc@PLT", "test rax, rax", "jz .Lheap_new_failed", "mov qword ptr [rip + .Lheap_table], rax",
+        ".Lheap_new_calloc:",
+        "mov rdi, rbx", "mov esi, 1", "call calloc@PLT", "test rax, rax", "jz .Lheap_new_failed",
+        "mov qword ptr [rax], r12",
+        "mov rcx, qword ptr [rip + .Lheap_table]", "mov rdx, qword ptr [rip + .Lheap_count]", "mov qword ptr [rcx + 8 * rdx], rax",
+        "inc rdx", "mov qword ptr [rip + .Lheap_count], rdx", "add rax, 16", "jmp .Lheap_new_done",
+        // The table may not grow, the array is not allocated then
+        ".Lheap_new_failed:",
+        "xor eax, eax",
+        ".Lheap_new_done:",
+        "add rsp, 8", "pop r12", "pop rbx", "ret"
+    };
+    const std::vector<std::string> collect = {
+        "cmp qword ptr [rip + .Lheap_stack_top], 0", "je .Lheap_collect_return",
+        // The registers of the program are scanned with the stack
+        "push rbp", "push rbx", "push r12", "push r13", "push r14", "push r15", "sub rsp, 8",
+        // qsort(table, count, 8, order), then room for every array on the mark stack
+        "mov rdi, qword ptr [rip + .Lheap_table]", "mov rsi, qword ptr [rip + .Lheap_count]", "mov edx, 8",
+        "lea rcx, [rip + .Lheap_order]", "call qsort@PLT",
+        "mov rdi, qword ptr [rip + .Lheap_marks]", "mov rsi, qword ptr [rip + .Lheap_count]", "lea rsi, [8 * rsi + 8]",
+        "call realloc@PLT", "test rax, rax", "jz .Lheap_collect_done", "mov qword ptr [rip + .Lheap_marks], rax",
+        // rbx holds the table, r12 its length, r13 the mark stack and r14 its length
+        "mov rbx, qword ptr [rip + .Lheap_table]", "mov r12, qword ptr [rip + .Lheap_count]", "mov r13, rax", "xor r14d, r14d",
+        "mov rdi, rsp", "mov rsi, qword ptr [rip + .Lheap_stack_top]", "call .Lheap_scan",
+        "lea rdi, [rip + .Lheap_globals]", "lea rsi, [rip + .Lheap_globals_end]", "call .Lheap_scan",
+        ".Lheap_collect_trace:",
+        "test r14, r14", "jz .Lheap_collect_sweep",
+        "dec r14", "mov rax, qword ptr [r13 + 8 * r14]", "lea rdi, [rax + 16]", "mov rsi, qword ptr [rax]", "lea rsi, [rdi + 8 * rsi]",
+        "call .Lheap_scan", "jmp .Lheap_collect_trace",
+        // Marked arrays are kept in address order with their mark cleared, r13 walks the table, r14 counts the
+        // arrays kept and r15 their bytes
+        ".Lheap_collect_sweep:",
+        "xor r13d, r13d", "xor r14d, r14d", "xor r15d, r15d",
+        ".Lheap_collect_next:",
+        "cmp r13, r12", "jae .Lheap_collect_end",
+        "mov rdi, qword ptr [rbx + 8 * r13]", "inc r13", "cmp qword ptr [rdi + 8], 0", "je .Lheap_collect_free",
+        "mov qword ptr [rdi + 8], 0", "mov qword ptr [rbx + 8 * r14], rdi", "inc r14",
+        "mov rax, qword ptr [rdi]", "lea r15, [r15 + 8 * rax + 16]", "jmp .Lheap_collect_next",
+        ".Lheap_collect_free:",
+        "call free@PLT", "jmp .Lheap_collect_next",
+        ".Lheap_collect_end:",
+        "mov qword ptr [rip + .Lheap_count], r14", "mov qword ptr [rip + .Lheap_allocated], 0",
+        "mov eax, " + std::to_string(HEAP_MIN_BYTES), "cmp r15, rax", "cmova rax, r15", "mov qword ptr [rip + .Lheap_limit], rax",
+        ".Lheap_collect_done:",
+        "add rsp, 8", "pop r15", "pop r14", "pop r13", "pop r12", "pop rbx", "pop rbp",
+        ".Lheap_collect_return:",
+        "ret"
+    };
+    const std::vector<std::string> scan = {
+        // Mark the arrays the words [rdi, rsi) point into, the table is searched for the last array at or
+        // below each word
+        "cmp rdi, rsi", "jae .Lheap_scan_return",
+        "mov rax, qword ptr [rdi]", "xor ecx, ecx", "mov rdx, r12",
+        ".Lheap_scan_search:",
+        "cmp rcx, rdx", "jae .Lheap_scan_found",
+        "lea r8, [rcx + rdx]", "shr r8, 1", "cmp qword ptr [rbx + 8 * r8], rax", "ja .Lheap_scan_below",
+        "lea rcx, [r8 + 1]", "jmp .Lheap_scan_search",
+        ".Lheap_scan_below:",
+        "mov rdx, r8", "jmp .Lheap_scan_search",
+        ".Lheap_scan_found:",
+        "test rcx, rcx", "jz .Lheap_scan_next",
+        "mov r8, qword ptr [rbx + 8 * rcx - 8]", "mov r9, qword ptr [r8]", "lea r9, [r8 + 8 * r9 + 16]",
+        "cmp rax, r9", "jae .Lheap_scan_next", "cmp qword ptr [r8 + 8], 0", "jne .Lheap_scan_next",
+        "mov qword ptr [r8 + 8], 1", "mov qword ptr [r13 + 8 * r14], r8", "inc r14",
+        ".Lheap_scan_next:",
+        "add rdi, 8", "jmp .Lheap_scan",
+        ".Lheap_scan_return:",
+        "ret"
+    };
+    const std::vector<std::string> order = {
+        // Comparison of two table entries for qsort
+        "mov rcx, qword ptr [rdi]", "mov rdx, qword ptr [rsi]", "xor eax, eax", "cmp rcx, rdx", "seta al", "sbb eax, 0", "ret"
+    };
+    auto emitRoutine = [&](const std::string &label, const std::vector<std::string> &lines) {
+        os << label << ":\n";
+        for(const auto &it : lines) {
+            os << (it.back() == ':' ? "" : "    ") << it << "\n";
+        }
+        os << "\n";
+    };
+    emitRoutine(".Lheap_new", allocate);
+    emitRoutine(".Lheap_collect", collect);
+    emitRoutine(".Lheap_scan", scan);
+    emitRoutine(".Lheap_order", order);
+
+    os << "    .data\n";
+    os << "    .align 8\n";
+    os << ".Lheap_limit:\n";
+    os << "    .quad " << HEAP_MIN_BYTES << "\n";
+    os << "    .globl " << HEAP_STACK_TOP_SYMBOL << "\n";
+    os << "    .type " << HEAP_STACK_TOP_SYMBOL << ", @object\n";
+    os << HEAP_STACK_TOP_SYMBOL << ":\n";
+    os << ".Lheap_stack_top:\n";
+    os << "    .quad 0\n";
+    os << "    .bss\n";
+    os << "    .align 8\n";
+    os << ".Lheap_allocated:\n";
+    os << "    .zero 8\n";
+    os << ".Lheap_table:\n";
+    os << "    .zero 8\n";
+    os << ".Lheap_count:\n";
+    os << "    .zero 8\n";
+    os << ".Lheap_capacity:\n";
+    os << "    .zero 8\n";
+    os << ".Lheap_marks:\n";
+    os << "    .zero 8\n";
+    os << "    .text\n";
+}
+
+/**
+ * @brief Emit the SIGPROF handler and the data of a sampled program. The handler records the interrupted
+ * instruction and walks the frame pointers to the return addresses of its callers, as long as frames
+ * are on the stack of the program and return addresses are in its code.
+ * 
+ * @param os Stream receiving the assembly
+ * @param program Sampled program
+ * @param lines Line of every .Lline label
+ */
+static void emitSampler(std::ostream &os, const Program &program, const std::vector<int32_t> &lines) {
+    const std::string handler[] = {
+        // rdx holds the ucontext_t of the interrupted code, its rbp, rsp and rip are at 120, 160 and 168
+        "mov rax, qword ptr [rip + .Lsamples + 48]", "cmp rax, " + std::to_string(SAMPLE_BUFFER_WORDS - SAMPLE_MAX_DEPTH - 1),
+        "ja .Lsample_return",
+        "lea r11, [rip + .Lcode_start]", "lea rsi, [rip + .Lsample_buffer]", "lea rsi, [rsi + 8 * rax]",
+        "mov r8, qword ptr [rdx + 168]", "mov r9, qword ptr [rdx + 120]", "mov r10, qword ptr [rdx + 160]",
+        "sub r8, r11", "mov qword ptr [rsi + 8], r8", "mov ecx, 1",
+        ".Lsample_walk:",
+        "cmp ecx, " + std::to_string(SAMPLE_MAX_DEPTH), "jae .Lsample_end",
+        // Each frame is above the previous one and below the first frame of the program
+        "cmp r9, r10", "jb .Lsample_end", "cmp r9, qword ptr [rip + .Lsample_stack_top]", "jae .Lsample_end",
+        "test r9, 7", "jnz .Lsample_end",
+        "mov rdi, qword ptr [r9 + 8]", "sub rdi, r11", "cmp rdi, qword ptr [rip + .Lsamples + 40]", "jae .Lsample_end",
+        "mov qword ptr [rsi + 8 * rcx + 8], rdi", "inc ecx", "lea r10, [r9 + 16]", "mov r9, qword ptr [r9]",
+        "jmp .Lsample_walk",
+        ".Lsample_end:",
+        "mov qword ptr [rsi], rcx", "lea rax, [rax + rcx + 1]", "mov qword ptr [rip + .Lsamples + 48], rax",
+        ".Lsample_return:",
+        "ret"
+    };
+    os << ".Lsample_handler:\n";
+    for(const auto &it : handler) {
+        os << (it.back() == ':' ? "" : "    ") << it << "\n";
+    }
+    os << "\n";
+
+    // Header and tables are written out as they are in memory
+    const std::string interval = std::to_string(SAMPLE_INTERVAL_MICROSECONDS);
+    os << "    .data\n";
+    os << "    .align 8\n";
+    os << ".Lsamples:\n";
+    os << "    .ascii \"" << SAMPLE_MAGIC << "\"\n";
+    os << "    .quad " << interval << "\n";
+    os << "    .quad " << program.functions.size() << "\n";
+    os << "    .quad " << lines.size() << "\n";
+    os << "    .quad .Lsample_names_end - .Lsample_names\n";
+    os << "    .quad .Lcode_end - .Lcode_start\n";
+    os << "    .quad 0\n";
+    for(const auto &it : program.functions) {
+        os << "    .quad " << functionSymbol(it.name) << " - .Lcode_start\n";
+    }
+    for(size_t i = 0; i < lines.size(); i ++) {
+        os << "    .long .Lline" << i << " - .Lcode_start, " << lines[i] << "\n";
+    }
+    os << ".Lsample_names:\n";
+    for(const auto &it : program.functions) {
+        os << "    .asciz \"" << it.name << "\"\n";
+    }
+    os << "    .balign 8\n";
+    os << ".Lsample_names_end:\n";
+    os << ".Lsample_table_bytes:\n";
+    os << "    .quad .Lsample_table_bytes - .Lsamples\n";
+    os << ".Lsample_stack_top:\n";
+    os << "    .quad 0\n";
+    // struct sigaction with SA_SIGINFO | SA_RESTART and an empty mask
+    os << ".Lsample_action:\n";
+    os << "    .quad .Lsample_handler\n";
+    os << "    .zero 128\n";
+    os << "    .long 0x10000004, 0\n";
+    os << "    .quad 0\n";
+    os << ".Lsample_timer:\n";
+    os << "    .quad 0, " << interval << ", 0, " << interval << "\n";
+    os << ".Lsample_stop:\n";
+    os << "    .zero 32\n";
+    os << ".Lsample_path:\n";
+    emitPath(os, program.samplePath);
+    os << "    .bss\n";
+    os << "    .align 8\n";
+    os << ".Lsample_buffer:\n";
+    os << "    .zero " << 8 * SAMPLE_BUFFER_WORDS << "\n";
+}
+
+void emitProgram(std::ostream &os, const Program &program, const AllocatorKind allocator, EmitStats &stats, const VectorIsa isa) {
+    os << "    .intel_syntax noprefix\n";
+    // The assembler turns the .loc and .cfi directives into the line table and call frames of DWARF
+    const bool debugInfo = !program.sourcePath.empty();
+    if(debugInfo) {
+        os << "    .file " << quote(program.sourcePath) << "\n";
+        os << "    .file 1 " << quote(program.sourcePath) << "\n";
+    }
+    os << "    .text\n";
+    // Sampled code is addressed from the first function, which does not depend on where it is loaded
+    const bool sampled = !program.samplePath.empty();
+    std::vector<int32_t> lines;
+    if(sampled) {
+        os << ".Lcode_start:\n";
+    }
+    bool hasMain = false;
+    for(const auto &function : program.functions) {
+        const Allocation allocation = allocator == AllocatorKind::LINEAR_SCAN ? allocateLinearScan(function) : allocateStackSlots(function);
+        stats.vregs += function.vregCount;
+        stats.spilledVregs += allocation.spilledIntervals;
+        FunctionEmitter(os, function, allocation, stats, isa, sampled ? &lines : nullptr, debugInfo).emit();
+        os << "\n";
+        hasMain |= function.name == MAIN_FUNCTION;
+    }
+    if(sampled) {
+        os << ".Lcode_end:\n";
+    }
+    // Line 0 keeps the runtime routines from extending the last line of the source
+    if(debugInfo) {
+        os << "    .loc 1 0\n";
+    }
+    const bool prints = usesPrint(program);
+    const bool collects = allocates(program);
+    if(hasMain) {
+        emitEntry(os, program, prints, collects);
+    }
+    if(prints) {
+        emitPrinter(os);
+    }
+    if(usesIo(program)) {
+        emitIo(os, prints);
+    }
+    if(collects) {
+        emitCollector(os);
+    }
+    if(sampled) {
+        emitSampler(os, program, lines);
+    }
+    if(program.profileCounters > 0) {
+        // Header and counters are written out as they are in memory
+        os << "    .data\n";
+        os << "    .align 8\n";
+        os << ".Lprofile:\n";
+        os << "    .ascii \"" << PROFILE_MAGIC << "\"\n";
+        os << "    .quad " << program.layoutHash << "\n";
+        os << "    .quad " << program.profileCounters << "\n";
+        os << ".Lprofile_counters:\n";
+        os << "    .zero " << 8 * program.profileCounters << "\n";
+        os << ".Lprofile_path:\n";
+        emitPath(os, program.profilePath);
+    }
+    // The globals are roots of the collector
+    if(!program.globals.empty() || collects) {
+        os << "    .bss\n";
+        os << "    .align 8\n";
+        if(collects) {
+            os << ".Lheap_globals:\n";
+        }
+        for(const auto &it : program.globals) {
+            if(it.length > 0) {
+                // Vectors from the start of an array are aligned
+                os << "    .align 32\n";
+            }
+            os << "    .globl " << globalSymbol(it.name) << "\n";
+            os << globalSymbol(it.name) << ":\n";
+            os << "    .zero " << 8 * std::max<int64_t>(it.length, 1) << "\n";
+        }
+        if(collects) {
+            os << ".Lheap_globals_end:\n";
+        }
+    }
+    os << "    .section .note.GNU-stack,\"\",@progbits\n";
+}
+
+};
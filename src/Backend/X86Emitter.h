@@ -0,0 +1,127 @@
+#pragma once
+#ifndef BACKEND_X86_EMITTER_H
+#define BACKEND_X86_EMITTER_H
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "Ir.h"
+
+namespace Backend {
+
+enum AllocatorKind {
+    LINEAR_SCAN, STACK_SLOTS
+};
+
+/**
+ * @brief Instruction set of VECTOR loops, SSE2 is part of every x86-64 processor
+ * 
+ */
+enum VectorIsa {
+    SSE2, AVX2
+};
+
+/**
+ * @brief 64 bit lanes of a vector register of each instruction set
+ * 
+ */
+const int32_t VECTOR_LANES[] = {2, 4};
+
+/**
+ * @brief Address space the program runs its calls in. The pages are mapped when they are first touched, so
+ * deep recursion takes memory as it goes and the stack of the process is left alone.
+ * 
+ */
+const int64_t STACK_RESERVE_BYTES = (int64_t)1 << 34;
+
+/**
+ * @brief Inaccessible bottom of the reserved stack, larger than the largest frame so an overflowing call
+ * faults instead of writing below it
+ * 
+ */
+const int64_t STACK_GUARD_BYTES = (int64_t)1 << 21;
+
+/**
+ * @brief Bytes print collects before they are written to the standard output
+ * 
+ */
+const int64_t PRINT_BUFFER_BYTES = (int64_t)1 << 16;
+
+/**
+ * @brief Symbol of the function writing out what print collected, exported by programs which print so a
+ * host running their functions can flush after a call
+ * 
+ */
+const std::string PRINT_FLUSH_SYMBOL = "xcpp.flush";
+
+/**
+ * @brief Symbol of the word holding the function read and write call, exported by programs which use them.
+ * It is called with 0 for read or 1 for write, the descriptor and the value, and returns what the
+ * intrinsic returns, see READ_INTRINSIC and WRITE_INTRINSIC. While it is 0 they read and write with libc.
+ * 
+ */
+const std::string IO_HOOK_SYMBOL = "xcpp.io";
+
+/**
+ * @brief Bytes of arrays a program allocates before its first collection. Later collections run once it
+ * allocated as many bytes as survived the collection before, or this many when fewer survived.
+ * 
+ */
+const int64_t HEAP_MIN_BYTES = (int64_t)1 << 22;
+
+/**
+ * @brief Symbol of the word holding the top of the stack the collector scans, exported by programs which
+ * allocate arrays. main sets it, a host calling their functions sets it above its call.
+ * 
+ */
+const std::string HEAP_STACK_TOP_SYMBOL = "xcpp.stack_top";
+
+/**
+ * @brief Counts of the generated code
+ * 
+ */
+class EmitStats {
+public:
+    int32_t instructions = 0;
+    int32_t vregs = 0;
+    int32_t spilledVregs = 0;
+
+    /**
+     * @brief Moves left out because the allocator put both sides in one register
+     * 
+     */
+    int32_t coalescedMoves = 0;
+
+    int32_t vectorLoops = 0;
+};
+
+/**
+ * @brief Symbol of a function in the generated code
+ * 
+ * @param name Name of the function in the source
+ * @return std::string Symbol of the function
+ */
+std::string functionSymbol(const std::string &name);
+
+/**
+ * @brief Write x86-64 assembly in Intel syntax for the GNU assembler, following the System V ABI. A
+ * program with MAIN_FUNCTION gets a main which maps a stack of STACK_RESERVE_BYTES and runs it there, or
+ * on the stack of the process when the mapping fails, and writes out what print collected once it returns.
+ * Programs which read or write go through IO_HOOK_SYMBOL, so a host can suspend their calls.
+ * A program which allocates arrays gets a collector freeing the ones it no longer reaches.
+ * An instrumented program writes its profile
+ * counters to its profilePath after MAIN_FUNCTION returns, a sampled one the samples and line table
+ * described by SampleProfile to its samplePath.
+ * 
+ * @param os Stream receiving the assembly
+ * @param program Lowered module
+ * @param allocator Register allocation to use
+ * @param stats Counts of the generated code
+ * @param isa Instruction set of VECTOR loops
+ */
+void emitProgram(std::ostream &os, const Program &program, const AllocatorKind allocator, EmitStats &stats, const VectorIsa isa = VectorIsa::SSE2);
+
+};
+
+#endif // BACKEND_X86_EMITTER_H
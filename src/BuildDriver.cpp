@@ -0,0 +1,327 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "ModuleSummary.h"
+#include "ThreadPool.h"
+#include "BuildDriver.h"
+
+namespace Build {
+
+// Module of the project and its state during one build
+class Unit {
+public:
+    std::string name;
+    std::string path;
+    std::string source;
+
+    // Imports are found by scanning the tokens, without building a tree
+    std::vector<Lexing::Token> imports;
+    std::vector<size_t> importUnits;
+    std::vector<size_t> dependents;
+    std::atomic<size_t> pendingImports;
+
+    bool failed = false;
+    bool compiled = false;
+    uint64_t interfaceHash = 0;
+    double ms = 0;
+    std::vector<Lexing::Diagnostic> diagnostics;
+
+    template <typename... T>
+    void fail(const int32_t lineNmb, const int32_t startPos, T... t) {
+        this->failed = true;
+        this->diagnostics.push_back(Lexing::Diagnostic::make(lineNmb, startPos, t...));
+    }
+};
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class ProjectBuild {
+public:
+    std::vector<std::unique_ptr<Unit> > units;
+    std::string buildDir;
+    ThreadPool pool;
+    std::atomic<size_t> upToDate;
+
+    ProjectBuild(const size_t threads) : pool(threads), upToDate(0) {}
+
+    std::string summaryPath(const Unit &unit) const {
+        return this->buildDir + "/" + unit.name + Modules::SUMMARY_EXTENSION;
+    }
+
+    // Read the source and find the modules imported by the top level statement list
+    void scan(Unit &unit) {
+        const auto start = std::chrono::steady_clock::now();
+        std::ifstream input(unit.path);
+        if(!input) {
+            unit.fail(0, 0, "Cannot read ", unit.path, "\n");
+        } else {
+            std::stringstream buffer;
+            buffer << input.rdbuf();
+            unit.source = buffer.str();
+
+            Lexing::Lexer lexer(unit.source);
+            Lexing::Lexer::setupBasicLexer(lexer);
+            lexer.lex();
+            int32_t depth = 0;
+            for(size_t i = 0; i + 1 < lexer.lexed.size(); i ++) {
+                const Lexing::Token &token = lexer.lexed[i];
+                if(token.type == Lexing::TokenType::L_BRACE) {
+                    depth ++;
+                } else if(token.type == Lexing::TokenType::R_BRACE) {
+                    depth --;
+                } else if(depth == 1 && token.type == Lexing::TokenType::IMPORT && lexer.lexed[i + 1].type == Lexing::TokenType::NAME) {
+                    unit.imports.push_back(lexer.lexed[i + 1]);
+                }
+            }
+        }
+        unit.ms += millisecondsSince(start);
+    }
+
+    // Compile a module whose imports are all finished, then release its dependents
+    void compile(Unit &unit) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<uint64_t> importInterfaces;
+        for(size_t i = 0; i < unit.importUnits.size() && !unit.failed; i ++) {
+            const Unit &imported = *this->units[unit.importUnits[i]];
+            if(imported.failed) {
+                unit.fail(unit.imports[i].lineNmb, unit.imports[i].startPos, "Module ", imported.name, " failed to build\n");
+            }
+            importInterfaces.push_back(imported.interfaceHash);
+        }
+
+        if(!unit.failed) {
+            const uint64_t inputHash = Modules::hashInputs(unit.source, importInterfaces);
+            const std::string path = this->summaryPath(unit);
+            std::string error;
+            const Modules::ModuleSummary *previous = Modules::ModuleSummary::load(path, error);
+            if(previous && previous->inputHash() == inputHash) {
+                unit.interfaceHash = previous->interfaceHash();
+                this->upToDate ++;
+            } else {
+                this->compileSource(unit, inputHash);
+            }
+            delete previous;
+        }
+        unit.ms += millisecondsSince(start);
+
+        for(const auto it : unit.dependents) {
+            Unit &dependent = *this->units[it];
+            if(-- dependent.pendingImports == 0) {
+                this->pool.submit([this, &dependent] { this->compile(dependent); });
+            }
+        }
+    }
+
+    void compileSource(Unit &unit, const uint64_t inputHash) {
+        unit.compiled = true;
+        Lexing::Lexer lexer(unit.source);
+        Lexing::Lexer::setupBasicLexer(lexer);
+        lexer.lex();
+        Parsing::Parser parser(lexer.lexed);
+        Grammar::Statement *program = parser.recognizeProgram();
+
+        std::vector<const Modules::ModuleSummary*> imports;
+        for(const auto it : unit.importUnits) {
+            std::string error;
+            const Modules::ModuleSummary *summary = Modules::ModuleSummary::load(this->summaryPath(*this->units[it]), error);
+            if(summary) {
+                imports.push_back(summary);
+            } else {
+                unit.fail(0, 0, error, "\n");
+            }
+        }
+        unit.diagnostics.insert(unit.diagnostics.end(), lexer.diagnostics.begin(), lexer.diagnostics.end());
+        unit.diagnostics.insert(unit.diagnostics.end(), parser.diagnostics.begin(), parser.diagnostics.end());
+        for(const auto &it : Modules::checkCalls(program, imports)) {
+            unit.diagnostics.push_back(it);
+        }
+        for(auto it : imports) {
+            delete it;
+        }
+
+        unit.failed = !unit.diagnostics.empty();
+        if(!unit.failed) {
+            const std::string path = this->summaryPath(unit);
+            std::string error;
+            const Modules::ModuleSummary *summary = nullptr;
+            if(Modules::writeSummary(path, Modules::collectExports(program), inputHash, error)) {
+                summary = Modules::ModuleSummary::load(path, error);
+            }
+            if(summary) {
+                unit.interfaceHash = summary->interfaceHash();
+            } else {
+                unit.fail(0, 0, error, "\n");
+            }
+            delete summary;
+        }
+        delete program;
+    }
+};
+
+static bool readManifest(const std::string &manifestPath, ProjectBuild &build, std::string &error) {
+    std::ifstream manifest(manifestPath);
+    if(!manifest) {
+        error = "Cannot read manifest " + manifestPath;
+        return false;
+    }
+    const std::filesystem::path root = std::filesystem::path(manifestPath).parent_path();
+    std::unordered_map<std::string, size_t> names;
+    std::string line;
+    while(std::getline(manifest, line)) {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        const size_t last = line.find_last_not_of(" \t\r");
+        const std::filesystem::path source = root / line.substr(first, last - first + 1);
+
+        auto unit = std::make_unique<Unit>();
+        unit->name = source.stem().string();
+        unit->path = source.string();
+        if(!names.emplace(unit->name, build.units.size()).second) {
+            error = "Module " + unit->name + " is listed twice in " + manifestPath;
+            return false;
+        }
+        build.units.push_back(std::move(unit));
+    }
+    build.buildDir = (root / BUILD_DIRECTORY).string();
+    std::error_code failure;
+    std::filesystem::create_directories(build.buildDir, failure);
+    if(failure) {
+        error = "Cannot create " + build.buildDir;
+        return false;
+    }
+    return true;
+}
+
+bool buildProject(const std::string &manifestPath, const size_t threads, BuildReport &report, std::string &error) {
+    const auto start = std::chrono::steady_clock::now();
+    ProjectBuild build(threads);
+    if(!readManifest(manifestPath, build, error)) {
+        return false;
+    }
+    auto &units = build.units;
+
+    for(auto &it : units) {
+        Unit *unit = it.get();
+        build.pool.submit([&build, unit] { build.scan(*unit); });
+    }
+    build.pool.wait();
+
+    // Dependency graph, imports of modules outside the project fail their importer
+    std::unordered_map<std::string, size_t> names;
+    for(size_t i = 0; i < units.size(); i ++) {
+        names[units[i]->name] = i;
+    }
+    for(size_t i = 0; i < units.size(); i ++) {
+        Unit &unit = *units[i];
+        for(const auto &it : unit.imports) {
+            auto found = names.find(it.lexeme);
+            if(found == names.end()) {
+                unit.fail(it.lineNmb, it.startPos, "Cannot import module ", it.lexeme, ", it is not in the manifest\n");
+            } else {
+                unit.importUnits.push_back(found->second);
+                units[found->second]->dependents.push_back(i);
+            }
+        }
+        unit.pendingImports = unit.importUnits.size();
+    }
+
+    // Modules left over by a topological sort are on or behind an import cycle and are never scheduled
+    std::vector<size_t> order;
+    std::vector<size_t> remaining(units.size());
+    for(size_t i = 0; i < units.size(); i ++) {
+        remaining[i] = units[i]->importUnits.size();
+        if(remaining[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for(size_t i = 0; i < order.size(); i ++) {
+        for(const auto it : units[order[i]]->dependents) {
+            if(-- remaining[it] == 0) {
+                order.push_back(it);
+            }
+        }
+    }
+    for(size_t i = 0; i < units.size(); i ++) {
+        if(remaining[i] != 0) {
+            units[i]->fail(0, 0, "Module ", units[i]->name, " is part of or depends on an import cycle\n");
+        }
+    }
+
+    for(auto &it : units) {
+        Unit *unit = it.get();
+        if(unit->importUnits.empty()) {
+            build.pool.submit([&build, unit] { build.compile(*unit); });
+        }
+    }
+    build.pool.wait();
+
+    // Critical path, the chain of imports with the largest total time
+    std::vector<double> finish(units.size(), 0);
+    std::vector<size_t> previous(units.size(), units.size());
+    size_t last = units.size();
+    for(const auto i : order) {
+        double latest = 0;
+        for(const auto it : units[i]->importUnits) {
+            if(finish[it] > latest) {
+                latest = finish[it];
+                previous[i] = it;
+            }
+        }
+        finish[i] = latest + units[i]->ms;
+        if(last == units.size() || finish[i] > finish[last]) {
+            last = i;
+        }
+    }
+    report = BuildReport();
+    if(last != units.size()) {
+        report.criticalPathMs = finish[last];
+        for(size_t i = last; i != units.size(); i = previous[i]) {
+            report.criticalPath.insert(report.criticalPath.begin(), units[i]->name);
+        }
+    }
+
+    report.threads = build.pool.size();
+    report.stolenTasks = build.pool.stolenTasks();
+    report.upToDate = build.upToDate;
+    for(const auto &it : units) {
+        report.workMs += it->ms;
+        report.compiled += it->compiled;
+        if(it->failed) {
+            report.failed ++;
+            report.errors.push_back({it->path, it->diagnostics});
+        }
+    }
+    report.wallMs = millisecondsSince(start);
+    return true;
+}
+
+std::ostream& operator <<(std::ostream &os, const BuildReport &report) {
+    os << "Compiled " << report.compiled << ", up to date " << report.upToDate << ", failed " << report.failed
+        << " modules on " << report.threads << " threads (" << report.stolenTasks << " tasks stolen)\n";
+    os << std::fixed << std::setprecision(2) << "Wall time " << report.wallMs << " ms, work " << report.workMs
+        << " ms, critical path " << report.criticalPathMs << " ms\n";
+    os << "Critical path ";
+    for(size_t i = 0; i < report.criticalPath.size(); i ++) {
+        os << (i > 0 ? " -> " : "") << report.criticalPath[i];
+    }
+    os << "\n";
+    return os;
+}
+
+};
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef BUILD_DRIVER_H
+#define BUILD_DRIVER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Lexer.h"
+
+namespace Build {
+
+/**
+ * @brief Directory next to the manifest which keeps the summaries of the built modules
+ * 
+ */
+const std::string BUILD_DIRECTORY = "xbuild";
+
+/**
+ * @brief Diagnostics of one module
+ * 
+ */
+class ModuleDiagnostics {
+public:
+    std::string path;
+    std::vector<Lexing::Diagnostic> diagnostics;
+};
+
+/**
+ * @brief Outcome and timing of a build
+ * 
+ */
+class BuildReport {
+public:
+    size_t threads = 0;
+    size_t compiled = 0;
+    size_t upToDate = 0;
+    size_t failed = 0;
+    size_t stolenTasks = 0;
+
+    /**
+     * @brief Time from reading the manifest until the last module finished
+     * 
+     */
+    double wallMs = 0;
+
+    /**
+     * @brief Sum of the times spent on every module
+     * 
+     */
+    double workMs = 0;
+
+    /**
+     * @brief Longest chain of imports by time, the lower bound of the build with enough threads
+     * 
+     */
+    double criticalPathMs = 0;
+    std::vector<std::string> criticalPath;
+
+    std::vector<ModuleDiagnostics> errors;
+};
+
+std::ostream& operator <<(std::ostream &os, const BuildReport &report);
+
+/**
+ * @brief Build every module of a project manifest in import order on a work stealing thread pool.
+ * The manifest lists one source path per line, relative to the manifest, and lines starting with
+ * # are comments. A module is named after its file and is only compiled again when its source or
+ * the interface of one of its imports changed.
+ * 
+ * @param manifestPath Path of the manifest
+ * @param threads Number of worker threads
+ * @param report Outcome of the build
+ * @param error Reason why the build could not start
+ * @return true if the build ran and false otherwise
+ */
+bool buildProject(const std::string &manifestPath, const size_t threads, BuildReport &report, std::string &error);
+
+};
+
+#endif // BUILD_DRIVER_H
@@ -0,0 +1,274 @@
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <utility>
+#include <array>
+#include <cstring>
+#include <cerrno>
+#include <dlfcn.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "ModuleSummary.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/Evaluate.h"
+#include "Backend/X86Emitter.h"
+#include "Embedding.h"
+#include "ScriptScheduler.h"
+
+extern char **environ;
+
+namespace Embedding {
+
+// The generated code takes its arguments as the System V ABI passes integers
+template <size_t... I>
+static int64_t invoke(const void *code, const int64_t *arguments, std::index_sequence<I...>) {
+    using Signature = int64_t (*)(decltype((void)I, int64_t())...);
+    return reinterpret_cast<Signature>(const_cast<void*>(code))(arguments[I]...);
+}
+
+template <size_t N>
+static int64_t invokeWith(const void *code, const int64_t *arguments) {
+    return invoke(code, arguments, std::make_index_sequence<N>());
+}
+
+template <size_t... N>
+static const auto &invokers(std::index_sequence<N...>) {
+    static const std::array<int64_t (*)(const void*, const int64_t*), sizeof...(N)> table = {&invokeWith<N>...};
+    return table;
+}
+
+// Whether an instruction may write a global, through the address of a global array, by printing or by
+// allocating from the heap of the program as well
+static bool writesGlobal(const Backend::Instruction &instruction) {
+    if(instruction.opcode == Backend::Opcode::STORE_GLOBAL || instruction.opcode == Backend::Opcode::ADDRESS
+        || instruction.opcode == Backend::Opcode::NEW) {
+        return true;
+    }
+    // The buffer of print is a global of the program as well
+    if(instruction.opcode == Backend::Opcode::CALL && instruction.callee == Backend::PRINT_INTRINSIC) {
+        return true;
+    }
+    for(const auto &it : instruction.kernel) {
+        if(writesGlobal(it)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Functions which write globals themselves or call one which does, until no caller is added
+static std::vector<bool> findGlobalWriters(const Backend::Program &program) {
+    std::vector<bool> writers(program.functions.size(), false);
+    for(size_t i = 0; i < program.functions.size(); i ++) {
+        for(const auto &block : program.functions[i].blocks) {
+            for(const auto &it : block.instructions) {
+                writers[i] = writers[i] || writesGlobal(it);
+            }
+        }
+    }
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t i = 0; i < program.functions.size(); i ++) {
+            for(const auto &block : program.functions[i].blocks) {
+                for(const auto &it : block.instructions) {
+                    const bool call = it.opcode == Backend::Opcode::CALL || it.opcode == Backend::Opcode::TAIL_CALL;
+                    if(!writers[i] && call && it.callee >= 0 && writers[it.callee]) {
+                        writers[i] = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return writers;
+}
+
+// Run a program with arguments and wait for it, without a shell between
+static bool spawn(const std::vector<std::string> &command, std::string &error) {
+    std::vector<char*> argv;
+    for(const auto &it : command) {
+        argv.push_back(const_cast<char*>(it.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid;
+    const int failure = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+    if(failure != 0) {
+        error = "Cannot run " + command[0] + ": " + std::strerror(failure);
+        return false;
+    }
+    int status = 0;
+    while(waitpid(pid, &status, 0) < 0) {
+        if(errno != EINTR) {
+            error = "Cannot wait for " + command[0] + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        error = command[0] + " failed to build the program";
+        return false;
+    }
+    return true;
+}
+
+Program::Program() : library(nullptr), flush(nullptr) {}
+
+Program::~Program() {
+    if(this->library) {
+        dlclose(this->library);
+    }
+}
+
+int32_t Program::parameterCount(const std::string &name) const {
+    auto found = this->functions.find(name);
+    return found == this->functions.end() ? -1 : found->second.parameterCount;
+}
+
+const Function *Program::function(const std::string &name) const {
+    auto found = this->functions.find(name);
+    return found == this->functions.end() ? nullptr : &found->second;
+}
+
+int64_t Program::invoke(const Function &function, const int64_t *arguments) {
+    // The frames of the call are below this one
+    if(function.stackTop) {
+        *function.stackTop = (int64_t)(uintptr_t)__builtin_frame_address(0);
+    }
+    return invokers(std::make_index_sequence<MAX_CALL_ARGUMENTS + 1>())[function.parameterCount](function.code, arguments);
+}
+
+bool Program::call(const std::string &name, const std::vector<int64_t> &arguments, int64_t &result, std::string &error) const {
+    auto found = this->functions.find(name);
+    if(found == this->functions.end()) {
+        error = "The program has no function " + name;
+        return false;
+    }
+    if((size_t)found->second.parameterCount != arguments.size()) {
+        error = "Function " + name + " takes " + std::to_string(found->second.parameterCount) + " arguments, " + std::to_string(arguments.size()) + " were given";
+        return false;
+    }
+    if(arguments.size() > MAX_CALL_ARGUMENTS) {
+        error = "Function " + name + " takes more than " + std::to_string(MAX_CALL_ARGUMENTS) + " arguments";
+        return false;
+    }
+    result = invoke(found->second, arguments.data());
+    if(this->flush) {
+        this->flush();
+    }
+    return true;
+}
+
+bool Program::run(int64_t &result, std::string &error) const {
+    if(!this->functions.count(Backend::MAIN_FUNCTION)) {
+        result = 0;
+        return true;
+    }
+    return this->call(Backend::MAIN_FUNCTION, {}, result, error);
+}
+
+CompileContext::CompileContext(const CompileOptions &_options) : options(_options), compiled(0) {
+    std::string pattern = (std::filesystem::temp_directory_path() / "xcpp-embed-XXXXXX").string();
+    if(mkdtemp(pattern.data())) {
+        this->directory = pattern;
+    }
+}
+
+CompileContext::~CompileContext() {
+    if(!this->directory.empty()) {
+        std::error_code ignored;
+        std::filesystem::remove_all(this->directory, ignored);
+    }
+}
+
+std::unique_ptr<Program> CompileContext::compile(const std::string &source, std::vector<Lexing::Diagnostic> &diagnostics, std::string &error) {
+    Lexing::Lexer lexer(source);
+    Lexing::Lexer::setupBasicLexer(lexer);
+    lexer.lex();
+    Parsing::Parser parser(lexer.lexed);
+    Grammar::Statement *tree = (Grammar::Statement*)parser.recognizeProgram();
+    diagnostics.insert(diagnostics.end(), lexer.diagnostics.begin(), lexer.diagnostics.end());
+    diagnostics.insert(diagnostics.end(), parser.diagnostics.begin(), parser.diagnostics.end());
+    for(const auto it : Modules::collectImports(tree)) {
+        diagnostics.push_back(Lexing::Diagnostic::make(it->lineNmb, it->startPos, "Module ", it->module, " cannot be imported by an embedded program\n"));
+    }
+    if(!diagnostics.empty()) {
+        delete tree;
+        return nullptr;
+    }
+
+    Backend::Optimizations optimizations = this->options.naiveCodegen ? Backend::Optimizations::none() : Backend::Optimizations();
+    if(this->options.evaluate && !this->options.naiveCodegen) {
+        Backend::EvaluationStats evaluationStats;
+        Backend::evaluateCalls(tree, evaluationStats);
+    }
+    Backend::Program lowered = Backend::lowerProgram(tree, {}, diagnostics, optimizations);
+    delete tree;
+    if(!diagnostics.empty()) {
+        return nullptr;
+    }
+
+    if(this->directory.empty()) {
+        error = "Cannot create a directory for the assembler";
+        return nullptr;
+    }
+    // Every program gets its own shared object, loading a path again would give the library loaded before
+    const std::string base = this->directory + "/program" + std::to_string(this->compiled ++);
+    {
+        std::ofstream output(base + ".s");
+        Backend::EmitStats stats;
+        Backend::emitProgram(output, lowered, this->options.naiveCodegen ? Backend::AllocatorKind::STACK_SLOTS : Backend::AllocatorKind::LINEAR_SCAN,
+            stats, this->options.vectorIsa);
+        if(!output) {
+            error = "Cannot write " + base + ".s";
+            return nullptr;
+        }
+    }
+    // Calls between functions of the program bind to them inside the shared object
+    const bool built = spawn({this->options.assembler, "-shared", "-Wl,-Bsymbolic", "-o", base + ".so", base + ".s"}, error);
+    std::unique_ptr<Program> program(new Program());
+    program->library = built ? dlopen((base + ".so").c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+    if(built && !program->library) {
+        error = std::string("Cannot load the program: ") + dlerror();
+    }
+    // The mapping stays when the files are gone
+    std::error_code ignored;
+    std::filesystem::remove(base + ".s", ignored);
+    std::filesystem::remove(base + ".so", ignored);
+    if(!program->library) {
+        return nullptr;
+    }
+
+    // Programs which do not print have no buffer to flush
+    program->flush = reinterpret_cast<void (*)()>(dlsym(program->library, Backend::PRINT_FLUSH_SYMBOL.c_str()));
+    // Reads and writes go through the host, which suspends them in calls of a script scheduler
+    auto ioHook = reinterpret_cast<int64_t (**)(const int64_t, const int64_t, const int64_t)>(dlsym(program->library, Backend::IO_HOOK_SYMBOL.c_str()));
+    if(ioHook) {
+        *ioHook = &scriptIo;
+    }
+    // Nor do programs which do not allocate have a stack to scan
+    int64_t *stackTop = reinterpret_cast<int64_t*>(dlsym(program->library, Backend::HEAP_STACK_TOP_SYMBOL.c_str()));
+    const std::vector<bool> writers = findGlobalWriters(lowered);
+    for(size_t i = 0; i < lowered.functions.size(); i ++) {
+        const Backend::Function &it = lowered.functions[i];
+        Function &function = program->functions[it.name];
+        function.code = dlsym(program->library, Backend::functionSymbol(it.name).c_str());
+        if(!function.code) {
+            error = "The program has no code for function " + it.name;
+            return nullptr;
+        }
+        function.parameterCount = it.parameterCount;
+        function.shareable = !writers[i];
+        function.stackTop = writers[i] ? stackTop : nullptr;
+    }
+    return program;
+}
+
+};
@@ -0,0 +1,179 @@
+#pragma once
+#ifndef EMBEDDING_H
+#define EMBEDDING_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Lexer.h"
+#include "Backend/X86Emitter.h"
+
+namespace Embedding {
+
+/**
+ * @brief Arguments a function of an embedded program can be called with at most
+ * 
+ */
+const size_t MAX_CALL_ARGUMENTS = 16;
+
+/**
+ * @brief Code generation of the programs of a context, the command line options of the compiler
+ * 
+ */
+class CompileOptions {
+public:
+    bool naiveCodegen = false;
+
+    /**
+     * @brief Evaluate calls with literal arguments while compiling, see Backend::evaluateCalls
+     * 
+     */
+    bool evaluate = true;
+
+    Backend::VectorIsa vectorIsa = Backend::VectorIsa::SSE2;
+
+    /**
+     * @brief Assembler and linker turning the generated code into a shared object
+     * 
+     */
+    std::string assembler = "gcc";
+};
+
+/**
+ * @brief Compiled function of a program
+ * 
+ */
+class Function {
+public:
+    const void *code = nullptr;
+    int32_t parameterCount = 0;
+
+    /**
+     * @brief Whether neither the function nor the functions it calls write globals, so several threads
+     * may call it at once
+     * 
+     */
+    bool shareable = true;
+
+    /**
+     * @brief Top of the stack the collector of the program scans, set above every call of a function which
+     * may allocate arrays, nullptr for the others
+     * 
+     */
+    int64_t *stackTop = nullptr;
+};
+
+/**
+ * @brief Native code of a compiled source loaded into the host process. Functions are called on the stack
+ * of the calling thread with integer arguments and return an integer, as the generated code passes them.
+ * 
+ * Globals live in the program and keep their values from one call to the next, running the top level
+ * statements sets them again. Calls from several threads at once are safe as long as they do not write
+ * globals, see Function::shareable. Arrays the functions allocate stay alive while a global of the program
+ * reaches them, one returned to the host may be freed by a later call.
+ * 
+ */
+class Program {
+private:
+    void *library;
+    std::unordered_map<std::string, Function> functions;
+
+    /**
+     * @brief Writes out what print collected, nullptr for a program which does not print
+     * 
+     */
+    void (*flush)();
+
+    friend class CompileContext;
+    Program();
+
+public:
+    ~Program();
+
+    Program(const Program&) = delete;
+    Program& operator =(const Program&) = delete;
+
+    /**
+     * @brief Get the parameters of a function
+     * 
+     * @param name Name of the function in the source
+     * @return int32_t Number of parameters, -1 when the program has no such function
+     */
+    int32_t parameterCount(const std::string &name) const;
+
+    /**
+     * @brief Find a function, to call it without looking it up again
+     * 
+     * @param name Name of the function in the source
+     * @return const Function* The function, nullptr when the program has no such function
+     */
+    const Function *function(const std::string &name) const;
+
+    /**
+     * @brief Call a function found before. What it prints is written out once the buffer of the program
+     * fills, call does so after every call.
+     * 
+     * @param function Function of the program taking at most MAX_CALL_ARGUMENTS arguments
+     * @param arguments One value for every parameter
+     * @return int64_t Value the function returned
+     */
+    static int64_t invoke(const Function &function, const int64_t *arguments);
+
+    /**
+     * @brief Call a function of the program, then write out what it printed
+     * 
+     * @param name Name of the function in the source
+     * @param arguments One value for every parameter, booleans and characters as numbers
+     * @param result Value the function returned
+     * @param error Reason of the failure
+     * @return true The function was called
+     */
+    bool call(const std::string &name, const std::vector<int64_t> &arguments, int64_t &result, std::string &error) const;
+
+    /**
+     * @brief Run the top level statements of the program
+     * 
+     * @param result Value they returned, 0 when they did not return one
+     * @param error Reason of the failure
+     * @return true The statements were run
+     */
+    bool run(int64_t &result, std::string &error) const;
+};
+
+/**
+ * @brief Compiler of sources to programs. A context only holds its options and a directory for the
+ * assembler, the compiler itself keeps no state between sources, so contexts on different threads do not
+ * share anything. One context compiles one source at a time.
+ * 
+ */
+class CompileContext {
+private:
+    CompileOptions options;
+    std::string directory;
+    int64_t compiled;
+
+public:
+    explicit CompileContext(const CompileOptions &_options = CompileOptions());
+    ~CompileContext();
+
+    CompileContext(const CompileContext&) = delete;
+    CompileContext& operator =(const CompileContext&) = delete;
+
+    /**
+     * @brief Compile a source buffer to a program. Sources which import other modules are not supported,
+     * their functions would have to be loaded as well.
+     * 
+     * @param source Text of the module
+     * @param diagnostics Errors of the source, every one found in a single pass
+     * @param error Reason the program could not be built or loaded
+     * @return std::unique_ptr<Program> The program, nullptr when the source has errors or building failed
+     */
+    std::unique_ptr<Program> compile(const std::string &source, std::vector<Lexing::Diagnostic> &diagnostics, std::string &error);
+};
+
+};
+
+#endif // EMBEDDING_H
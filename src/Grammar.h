@@ -4,10 +4,16 @@
 #include "GrammarAst/LiteralExpression.h"
 #include "GrammarAst/BinaryExpression.h"
 #include "GrammarAst/UnaryExpression.h"
+#include "GrammarAst/IndexExpression.h"
 #include "GrammarAst/FunctionCall.h"
 #include "GrammarAst/Statement.h"
 #include "GrammarAst/DeclarationStatement.h"
 #include "GrammarAst/ExpressionStatement.h"
 #include "GrammarAst/IfStatement.h"
+#include "GrammarAst/WhileStatement.h"
+#include "GrammarAst/ForStatement.h"
 #include "GrammarAst/StatementList.h"
-
+#include "GrammarAst/FunctionDefinition.h"
+#include "GrammarAst/ClassDefinition.h"
+#include "GrammarAst/ReturnStatement.h"
+#include "GrammarAst/ImportStatement.h"
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 
 #include "../Parser.h"
 #include "../Lexer.h"
@@ -7,7 +8,9 @@
 namespace Grammar {
 
 BinaryExpression::BinaryExpression(Expression *_left, const Lexing::TokenType &_operation, Expression *_right)
-	: left(_left), operation(_operation), right(_right) {}
+	: left(_left), operation(_operation), right(_right) {
+    this->depth = std::max(this->left->depth, this->right->depth) + 1;
+}
 
 BinaryExpression::~BinaryExpression() {
     delete this->left;
@@ -15,22 +18,22 @@ BinaryExpression::~BinaryExpression() {
 }
 
 std::ostream& BinaryExpression::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Binary expression {" << std::endl;
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
     // Print contents of expression
     os << *(this->left) << std::endl;
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << Lexing::TokenTypeName[this->operation] << std::endl;
 
     os << *(this->right) << std::endl;
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
-    os << Parsing::Parser::getTabIdentation();
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <algorithm>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+ClassDefinition::ClassDefinition(const std::string &_name, const std::vector<DeclarationStatement*> &_fields, const std::vector<std::string> &_attributes,
+    const int32_t &_nameLineNmb, const int32_t &_nameStartPos)
+        : name(_name), fields(_fields), attributes(_attributes), nameLineNmb(_nameLineNmb), nameStartPos(_nameStartPos) {}
+
+ClassDefinition::~ClassDefinition() {
+    for(auto it : this->fields) {
+        delete it;
+    }
+}
+
+bool ClassDefinition::hasAttribute(const std::string &attribute) const {
+    return std::find(this->attributes.begin(), this->attributes.end(), attribute) != this->attributes.end();
+}
+
+std::ostream &ClassDefinition::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "Class definition " << this->name;
+    if(!this->attributes.empty()) {
+        os << " [";
+        for(size_t i = 0; i < this->attributes.size(); i ++) {
+            os << (i > 0 ? ", " : "") << this->attributes[i];
+        }
+        os << "]";
+    }
+    os << " { " << std::endl;
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Fields :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    for(const auto &field : this->fields) {
+        os << *(field) << std::endl;
+    }
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "Statement.h"
+#include "DeclarationStatement.h"
+
+namespace Grammar {
+
+class ClassDefinition final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    std::string name;
+
+    /**
+     * @brief Fields in declaration order, written as declarations without let and initializer
+     * 
+     */
+    std::vector<DeclarationStatement*> fields;
+
+    /**
+     * @brief Names in the square brackets after the name of the class
+     * 
+     */
+    std::vector<std::string> attributes;
+
+    /**
+     * @brief Position of the name token, -1 for a class the parser made without one
+     * 
+     */
+    int32_t nameLineNmb;
+    int32_t nameStartPos;
+
+    ClassDefinition(const std::string &_name, const std::vector<DeclarationStatement*> &_fields, const std::vector<std::string> &_attributes = {},
+        const int32_t &_nameLineNmb = -1, const int32_t &_nameStartPos = -1);
+    ~ClassDefinition();
+
+    bool hasAttribute(const std::string &attribute) const;
+};
+
+};
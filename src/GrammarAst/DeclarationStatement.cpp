@@ -6,20 +6,21 @@
 
 namespace Grammar {
 
-DeclarationStatement::DeclarationStatement(const std::string &_name, const std::string &_type, Expression *_expr) : name(_name), type(_type), expr(_expr) {}
+DeclarationStatement::DeclarationStatement(const std::string &_name, const std::string &_type, Expression *_expr, const int32_t &_nameLineNmb,
+    const int32_t &_nameStartPos) : name(_name), type(_type), expr(_expr), nameLineNmb(_nameLineNmb), nameStartPos(_nameStartPos) {}
 
 DeclarationStatement::~DeclarationStatement() {
     delete this->expr;
 }
 
 std::ostream& DeclarationStatement::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Declaration statement { " << std::endl;
 
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << this->name << " : " << this->type << std::endl;
 
     if(this->expr) {
@@ -28,9 +29,9 @@ std::ostream& DeclarationStatement::hiddenPrint(std::ostream &os) const {
     }
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
+    Parsing::Parser::addTabIdentation(os, -1);
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
@@ -16,7 +16,15 @@ public:
     std::string type;
     Expression *expr;
 
-    DeclarationStatement(const std::string &_name, const std::string &_type = "", Expression *_expr = nullptr);
+    /**
+     * @brief Position of the name token, -1 for a declaration the parser made without one
+     * 
+     */
+    int32_t nameLineNmb;
+    int32_t nameStartPos;
+
+    DeclarationStatement(const std::string &_name, const std::string &_type = "", Expression *_expr = nullptr, const int32_t &_nameLineNmb = -1,
+        const int32_t &_nameStartPos = -1);
     ~DeclarationStatement();
 };
 
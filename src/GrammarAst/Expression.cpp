@@ -5,7 +5,7 @@
 
 namespace Grammar {
 
-Expression::Expression() {}
+Expression::Expression() : depth(1) {}
 
 Expression::~Expression() {}
 
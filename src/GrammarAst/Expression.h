@@ -12,6 +12,8 @@ private:
     virtual std::ostream& hiddenPrint(std::ostream &os) const = 0;
 
 public:
+    // Height of the expression tree, bounded by the parser
+    int32_t depth;
 
 	Expression();
     virtual ~Expression() = 0;
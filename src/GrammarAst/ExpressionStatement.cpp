@@ -13,17 +13,17 @@ ExpressionStatement::~ExpressionStatement() {
 }
 
 std::ostream& ExpressionStatement::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Expression statement { " << std::endl;
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
     // Print recursively the whole expression statement
     os << *(this->expr) << std::endl;
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
-    os << Parsing::Parser::getTabIdentation();
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
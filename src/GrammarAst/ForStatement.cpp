@@ -0,0 +1,57 @@
+#include <iostream>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+ForStatement::ForStatement(Statement *init, Expression *condition, Expression *step, Statement *body)
+        : init(init), condition(condition), step(step), body(body) {}
+
+ForStatement::~ForStatement() {
+    delete this->init;
+    delete this->condition;
+    delete this->step;
+    delete this->body;
+}
+
+std::ostream &ForStatement::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "For statement { " << std::endl;
+
+    // Every part of the header is optional
+    if(this->init) {
+        os << Parsing::Parser::getTabIdentation(os);
+        os << ">Init :" << std::endl;
+        Parsing::Parser::addTabIdentation(os, +1);
+        os << *(this->init) << std::endl;
+        Parsing::Parser::addTabIdentation(os, -1);
+    }
+    if(this->condition) {
+        os << Parsing::Parser::getTabIdentation(os);
+        os << ">Condition :" << std::endl;
+        Parsing::Parser::addTabIdentation(os, +1);
+        os << *(this->condition) << std::endl;
+        Parsing::Parser::addTabIdentation(os, -1);
+    }
+    if(this->step) {
+        os << Parsing::Parser::getTabIdentation(os);
+        os << ">Step :" << std::endl;
+        Parsing::Parser::addTabIdentation(os, +1);
+        os << *(this->step) << std::endl;
+        Parsing::Parser::addTabIdentation(os, -1);
+    }
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Body :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    os << *(this->body) << std::endl;
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <iostream>
+
+#include "Statement.h"
+#include "Expression.h"
+
+namespace Grammar {
+
+class ForStatement final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    /**
+     * @brief Declaration or expression statement run once before the loop, may be null
+     * 
+     */
+    Statement *init;
+
+    /**
+     * @brief Checked before every iteration, a missing condition always holds
+     * 
+     */
+    Expression *condition;
+
+    /**
+     * @brief Evaluated after every iteration, may be null
+     * 
+     */
+    Expression *step;
+    Statement *body;
+
+    ForStatement(Statement *init, Expression *condition, Expression *step, Statement *body);
+    ~ForStatement();
+};
+
+};
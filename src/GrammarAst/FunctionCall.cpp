@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 
 #include "../Lexer.h"
 #include "../Grammar.h"
@@ -6,7 +7,12 @@
 
 namespace Grammar {
 
-FunctionCall::FunctionCall(std::string _name, std::vector<Expression*> &_parameters) : name(_name), parameters(_parameters) {}
+FunctionCall::FunctionCall(std::string _name, std::vector<Expression*> &_parameters, const int32_t &_lineNmb, const int32_t &_startPos)
+        : name(_name), parameters(_parameters), lineNmb(_lineNmb), startPos(_startPos) {
+    for(auto it : this->parameters) {
+        this->depth = std::max(this->depth, it->depth + 1);
+    }
+}
 
 FunctionCall::~FunctionCall() {
     for(auto it : this->parameters) {
@@ -15,10 +21,10 @@ FunctionCall::~FunctionCall() {
 }
 
 std::ostream &FunctionCall::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Function call " << this->name << " {" << std::endl;
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
     // Print all parameters
     for(const auto &param : this->parameters) {
@@ -26,8 +32,8 @@ std::ostream &FunctionCall::hiddenPrint(std::ostream &os) const {
     }
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
-    os << Parsing::Parser::getTabIdentation();
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
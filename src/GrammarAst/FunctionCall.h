@@ -15,8 +15,10 @@ private:
 public:
     std::string name;
     std::vector<Expression*> parameters;
+    int32_t lineNmb;
+    int32_t startPos;
 
-    FunctionCall(std::string _name, std::vector<Expression*> &_parameters);
+    FunctionCall(std::string _name, std::vector<Expression*> &_parameters, const int32_t &_lineNmb = -1, const int32_t &_startPos = -1);
     ~FunctionCall();
 };
 
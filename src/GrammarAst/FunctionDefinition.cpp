@@ -0,0 +1,43 @@
+#include <iostream>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+FunctionDefinition::FunctionDefinition(const std::string &_name, const std::vector<DeclarationStatement*> &_parameters, const std::string &_returnType, Statement *_body,
+    const int32_t &_nameLineNmb, const int32_t &_nameStartPos)
+        : name(_name), parameters(_parameters), returnType(_returnType), body(_body), nameLineNmb(_nameLineNmb), nameStartPos(_nameStartPos) {}
+
+FunctionDefinition::~FunctionDefinition() {
+    for(auto it : this->parameters) {
+        delete it;
+    }
+    delete this->body;
+}
+
+std::ostream &FunctionDefinition::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "Function definition " << this->name << " : " << this->returnType << " { " << std::endl;
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Parameters :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    for(const auto &param : this->parameters) {
+        os << *(param) << std::endl;
+    }
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Body :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    os << *(this->body) << std::endl;
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "Statement.h"
+#include "DeclarationStatement.h"
+
+namespace Grammar {
+
+class FunctionDefinition final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    std::string name;
+    std::vector<DeclarationStatement*> parameters;
+    std::string returnType;
+    Statement *body;
+
+    /**
+     * @brief Position of the name token, -1 for a function the parser made without one
+     * 
+     */
+    int32_t nameLineNmb;
+    int32_t nameStartPos;
+
+    FunctionDefinition(const std::string &_name, const std::vector<DeclarationStatement*> &_parameters, const std::string &_returnType, Statement *_body,
+        const int32_t &_nameLineNmb = -1, const int32_t &_nameStartPos = -1);
+    ~FunctionDefinition();
+};
+
+};
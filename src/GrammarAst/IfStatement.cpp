@@ -16,31 +16,31 @@ IfStatement::~IfStatement() {
 }
 
 std::ostream &IfStatement::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "If statement { " << std::endl;
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << ">Condition :" << std::endl;
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
     os << *(this->condition) << std::endl;
-    Parsing::Parser::addTabIdentation(-1);
+    Parsing::Parser::addTabIdentation(os, -1);
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << ">If-body :" << std::endl;
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
     os << *(this->ifBody) << std::endl;
-    Parsing::Parser::addTabIdentation(-1);
+    Parsing::Parser::addTabIdentation(os, -1);
 
     // Else if not mandatory
     if(this->elseBody) {
-        os << Parsing::Parser::getTabIdentation();
+        os << Parsing::Parser::getTabIdentation(os);
         os << ">Else body :" << std::endl;
-        Parsing::Parser::addTabIdentation(+1);
+        Parsing::Parser::addTabIdentation(os, +1);
         os << *(this->elseBody) << std::endl;
-        Parsing::Parser::addTabIdentation(-1);
+        Parsing::Parser::addTabIdentation(os, -1);
     }
 
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
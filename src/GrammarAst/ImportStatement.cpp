@@ -0,0 +1,20 @@
+#include <iostream>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+ImportStatement::ImportStatement(const std::string &_module, const int32_t &_lineNmb, const int32_t &_startPos)
+        : module(_module), lineNmb(_lineNmb), startPos(_startPos) {}
+
+ImportStatement::~ImportStatement() {}
+
+std::ostream& ImportStatement::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "Import statement " << this->module;
+    return os;
+}
+
+};
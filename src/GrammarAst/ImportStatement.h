@@ -0,0 +1,23 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "Statement.h"
+
+namespace Grammar {
+
+class ImportStatement final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    std::string module;
+    int32_t lineNmb;
+    int32_t startPos;
+
+    ImportStatement(const std::string &_module, const int32_t &_lineNmb = -1, const int32_t &_startPos = -1);
+    ~ImportStatement();
+};
+
+};
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <algorithm>
+
+#include "../Parser.h"
+#include "../Lexer.h"
+#include "Expression.h"
+
+namespace Grammar {
+
+IndexExpression::IndexExpression(Expression *_array, Expression *_index) : array(_array), index(_index) {
+    this->depth = std::max(this->array->depth, this->index->depth) + 1;
+}
+
+IndexExpression::~IndexExpression() {
+    delete this->array;
+    delete this->index;
+}
+
+std::ostream& IndexExpression::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "Index expression {" << std::endl;
+    // Make identation one tab deeper
+    Parsing::Parser::addTabIdentation(os, +1);
+
+    os << *(this->array) << std::endl;
+    os << *(this->index) << std::endl;
+
+    // Return identation to original level
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
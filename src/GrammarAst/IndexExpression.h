@@ -0,0 +1,22 @@
+#pragma once
+
+#include <iostream>
+
+#include "../Lexer.h"
+#include "Expression.h"
+
+namespace Grammar {
+
+class IndexExpression final : public Expression {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    Expression *array;
+    Expression *index;
+
+	IndexExpression(Expression *_array, Expression *_index);
+    ~IndexExpression();
+};
+
+}
@@ -12,7 +12,7 @@ LiteralExpression::~LiteralExpression() {}
 
 std::ostream& LiteralExpression::hiddenPrint(std::ostream &os) const {
     // Print contents
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << this->value.lexeme;
     return os;
 }
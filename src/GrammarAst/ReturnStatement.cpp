@@ -0,0 +1,33 @@
+#include <iostream>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+ReturnStatement::ReturnStatement(Expression *_expr) : expr(_expr) {}
+
+ReturnStatement::~ReturnStatement() {
+    delete this->expr;
+}
+
+std::ostream& ReturnStatement::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "Return statement { " << std::endl;
+    // Make identation one tab deeper
+    Parsing::Parser::addTabIdentation(os, +1);
+
+    // A bare return has no expression
+    if(this->expr) {
+        os << *(this->expr) << std::endl;
+    }
+
+    // Return identation to original level
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iostream>
+
+#include "Statement.h"
+#include "Expression.h"
+
+namespace Grammar {
+
+class ReturnStatement final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    Expression *expr;
+
+    ReturnStatement(Expression *_expr = nullptr);
+    ~ReturnStatement();
+};
+
+};
@@ -6,7 +6,7 @@
 
 namespace Grammar {
 
-Statement::Statement() {}
+Statement::Statement() : lineNmb(-1) {}
 
 Statement::~Statement() {}
 // Overloaded operator << for printing statement to ostream
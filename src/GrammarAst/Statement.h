@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
 
 namespace Grammar {
 
@@ -9,6 +10,11 @@ private:
     virtual std::ostream& hiddenPrint(std::ostream &os) const = 0;
 
 public:
+    /**
+     * @brief Line of the first token of the statement, -1 for a statement the parser made without one
+     * 
+     */
+    int32_t lineNmb;
 
 	Statement();
     virtual ~Statement() = 0;
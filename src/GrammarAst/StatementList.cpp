@@ -16,10 +16,10 @@ StatementList::~StatementList() {
 }
 
 std::ostream &StatementList::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Statement list { " << std::endl;
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
     // Print recursively the whole statement list
     for(const auto &expr : this->list) {
@@ -27,8 +27,8 @@ std::ostream &StatementList::hiddenPrint(std::ostream &os) const {
     }
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
-    os << Parsing::Parser::getTabIdentation();
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
@@ -6,27 +6,29 @@
 
 namespace Grammar {
 
-UnaryExpression::UnaryExpression(const Lexing::TokenType &_operation, Expression *_expr) : operation(_operation), expr(_expr) {}
+UnaryExpression::UnaryExpression(const Lexing::TokenType &_operation, Expression *_expr) : operation(_operation), expr(_expr) {
+    this->depth = this->expr->depth + 1;
+}
 
 UnaryExpression::~UnaryExpression() {
     delete this->expr;
 }
 
 std::ostream& UnaryExpression::hiddenPrint(std::ostream &os) const {
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << "Unary expression {" << std::endl;
     // Make identation one tab deeper
-    Parsing::Parser::addTabIdentation(+1);
+    Parsing::Parser::addTabIdentation(os, +1);
 
     // Print contents of expression
-    os << Parsing::Parser::getTabIdentation();
+    os << Parsing::Parser::getTabIdentation(os);
     os << Lexing::TokenTypeName[this->operation] << std::endl;
 
     os << *(this->expr) << std::endl;
 
     // Return identation to original level
-    Parsing::Parser::addTabIdentation(-1);
-    os << Parsing::Parser::getTabIdentation();
+    Parsing::Parser::addTabIdentation(os, -1);
+    os << Parsing::Parser::getTabIdentation(os);
     os << "}";
     return os;
 }
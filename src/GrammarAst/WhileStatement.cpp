@@ -0,0 +1,37 @@
+#include <iostream>
+
+#include "../Lexer.h"
+#include "../Grammar.h"
+#include "../Parser.h"
+
+namespace Grammar {
+
+WhileStatement::WhileStatement(Expression *condition, Statement *body) : condition(condition), body(body) {}
+
+WhileStatement::~WhileStatement() {
+    delete this->condition;
+    delete this->body;
+}
+
+std::ostream &WhileStatement::hiddenPrint(std::ostream &os) const {
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "While statement { " << std::endl;
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Condition :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    os << *(this->condition) << std::endl;
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << ">Body :" << std::endl;
+    Parsing::Parser::addTabIdentation(os, +1);
+    os << *(this->body) << std::endl;
+    Parsing::Parser::addTabIdentation(os, -1);
+
+    os << Parsing::Parser::getTabIdentation(os);
+    os << "}";
+    return os;
+}
+
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <iostream>
+
+#include "Statement.h"
+#include "Expression.h"
+
+namespace Grammar {
+
+class WhileStatement final : public Statement {
+private:
+    std::ostream& hiddenPrint(std::ostream &os) const;
+
+public:
+    Expression *condition;
+    Statement *body;
+
+    WhileStatement(Expression *condition, Statement *body);
+    ~WhileStatement();
+};
+
+};
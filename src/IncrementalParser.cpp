@@ -0,0 +1,344 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+#include "IncrementalParser.h"
+
+namespace Parsing {
+
+// Statement slots directly nested in a statement, in source order
+static std::vector<Grammar::Statement**> childStatements(Grammar::Statement *stmt) {
+    std::vector<Grammar::Statement**> children;
+    if(auto list = dynamic_cast<Grammar::StatementList*>(stmt)) {
+        for(auto &it : list->list) {
+            children.push_back(&it);
+        }
+    } else if(auto ifStmt = dynamic_cast<Grammar::IfStatement*>(stmt)) {
+        children.push_back(&ifStmt->ifBody);
+        if(ifStmt->elseBody) {
+            children.push_back(&ifStmt->elseBody);
+        }
+    } else if(auto whileStmt = dynamic_cast<Grammar::WhileStatement*>(stmt)) {
+        children.push_back(&whileStmt->body);
+    } else if(auto forStmt = dynamic_cast<Grammar::ForStatement*>(stmt)) {
+        children.push_back(&forStmt->body);
+    } else if(auto function = dynamic_cast<Grammar::FunctionDefinition*>(stmt)) {
+        children.push_back(&function->body);
+    }
+    return children;
+}
+
+// First index in [0, count) for which pred is false, pred has to be true for a prefix of the indexes
+template<typename Predicate>
+static int32_t partitionPoint(const int32_t count, Predicate pred) {
+    int32_t low = 0, high = count;
+    while(low < high) {
+        int32_t middle = low + (high - low) / 2;
+        if(pred(middle)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void IncrementalParser::OffsetTree::assign(const std::vector<int32_t> &starts) {
+    this->tree.assign(starts.size() + 1, 0);
+    for(size_t i = 1; i <= starts.size(); i ++) {
+        this->tree[i] += starts[i - 1] - (i > 1 ? starts[i - 2] : 0);
+        size_t parent = i + (i & -i);
+        if(parent < this->tree.size()) {
+            this->tree[parent] += this->tree[i];
+        }
+    }
+}
+
+std::vector<int32_t> IncrementalParser::OffsetTree::starts() const {
+    if(this->tree.empty()) {
+        return {};
+    }
+    // Undo the building pass to get the differences back, then sum them up
+    std::vector<int32_t> differences = this->tree;
+    for(size_t i = differences.size() - 1; i >= 1; i --) {
+        size_t parent = i + (i & -i);
+        if(parent < differences.size()) {
+            differences[parent] -= differences[i];
+        }
+    }
+    std::vector<int32_t> starts(differences.size() - 1);
+    int32_t sum = 0;
+    for(size_t i = 1; i < differences.size(); i ++) {
+        sum += differences[i];
+        starts[i - 1] = sum;
+    }
+    return starts;
+}
+
+int32_t IncrementalParser::OffsetTree::get(const int32_t index) const {
+    int32_t sum = 0;
+    for(size_t i = index + 1; i > 0; i -= i & -i) {
+        sum += this->tree[i];
+    }
+    return sum;
+}
+
+void IncrementalParser::OffsetTree::shift(const int32_t index, const int32_t delta) {
+    for(size_t i = index + 1; i < this->tree.size(); i += i & -i) {
+        this->tree[i] += delta;
+    }
+}
+
+IncrementalParser::IncrementalParser(const std::string &code) : lexer(code), root(nullptr), linesStale(false) {
+    Lexing::Lexer::setupBasicLexer(this->lexer);
+    this->lexer.lex();
+    this->fullReparse();
+}
+
+IncrementalParser::~IncrementalParser() {
+    delete this->root;
+}
+
+Grammar::Statement *IncrementalParser::getRoot() const {
+    if(this->linesStale) {
+        auto it = this->spans.find(this->root);
+        this->refreshLines(this->root, it != this->spans.end() ? it->second.first : 0);
+        this->linesStale = false;
+    }
+    return this->root;
+}
+
+const std::vector<Lexing::Token> &IncrementalParser::getTokens() const { return this->lexer.lexed; }
+
+std::vector<Lexing::Diagnostic> IncrementalParser::getDiagnostics() const {
+    std::vector<Lexing::Diagnostic> all = this->lexer.diagnostics;
+    all.insert(all.end(), this->diagnostics.begin(), this->diagnostics.end());
+    return all;
+}
+
+void IncrementalParser::fullReparse() {
+    delete this->root;
+    Parser parser(this->lexer.lexed);
+    parser.recordSpans = true;
+    this->root = parser.recognizeProgram();
+    this->spans.clear();
+    this->listStarts.clear();
+    this->recordSpans(this->root, 0, parser.statementSpans);
+    this->diagnostics = std::move(parser.diagnostics);
+    this->linesStale = false;
+}
+
+void IncrementalParser::applyEdit(const Lexing::TextEdit &edit) {
+    // Statements after an edit which adds or removes lines keep their old lines until getRoot
+    const std::string &code = this->lexer.getCode();
+    if(std::count(code.begin() + edit.offset, code.begin() + edit.offset + edit.removedLength, '\n')
+        != std::count(edit.inserted.begin(), edit.inserted.end(), '\n')) {
+        this->linesStale = true;
+    }
+    Lexing::RelexResult relexed = this->lexer.relex(edit);
+    auto rootSpan = this->spans[this->root];
+    if(!this->diagnostics.empty() || !this->reparseWithin(this->root, rootSpan.first, relexed)) {
+        // While there are errors the whole program is parsed again so that all of them stay reported
+        this->fullReparse();
+    }
+}
+
+bool IncrementalParser::reparseWithin(Grammar::Statement *node, const int32_t start, const Lexing::RelexResult &relexed) {
+    const int32_t delta = relexed.newEndToken - relexed.oldEndToken;
+    // Descend into the nested statement containing the whole edit first, on the way back only the
+    // statements on the path grow and only their later siblings move
+    if(auto list = dynamic_cast<Grammar::StatementList*>(node)) {
+        auto &offsets = this->listStarts[list];
+        // Statements of a list are ordered, so only the first one ending after the edit start can contain it
+        int32_t index = partitionPoint((int32_t)list->list.size(), [&](const int32_t i) {
+            return start + offsets.get(i) + this->spans[list->list[i]].second <= relexed.firstToken;
+        });
+        if(index < (int32_t)list->list.size()) {
+            int32_t childStart = start + offsets.get(index);
+            int32_t childEnd = childStart + this->spans[list->list[index]].second;
+            if(childStart <= relexed.firstToken && relexed.oldEndToken <= childEnd
+                && this->reparseWithin(list->list[index], childStart, relexed)) {
+                offsets.shift(index + 1, delta);
+                this->spans[list].second += delta;
+                return true;
+            }
+        }
+        return this->reparseRun(list, start, relexed);
+    }
+
+    auto children = childStatements(node);
+    for(size_t i = 0; i < children.size(); i ++) {
+        auto &span = this->spans[*children[i]];
+        if(start + span.first + span.second <= relexed.firstToken) {
+            continue;
+        }
+        if(start + span.first <= relexed.firstToken && relexed.oldEndToken <= start + span.first + span.second
+            && this->reparseWithin(*children[i], start + span.first, relexed)) {
+            for(size_t j = i + 1; j < children.size(); j ++) {
+                this->spans[*children[j]].first += delta;
+            }
+            this->spans[node].second += delta;
+            return true;
+        }
+        break;
+    }
+    return false;
+}
+
+bool IncrementalParser::reparseRun(Grammar::StatementList *list, const int32_t start, const Lexing::RelexResult &relexed) {
+    const auto &tokens = this->lexer.lexed;
+    const int32_t end = start + this->spans[list].second;
+    // Both braces have to be outside of the edit
+    if(start >= relexed.firstToken || relexed.oldEndToken >= end || tokens[start].type != Lexing::TokenType::L_BRACE) {
+        return false;
+    }
+
+    // Statements of a list cover all tokens between its braces, find the ones touched by the edit
+    auto &offsets = this->listStarts[list];
+    const int32_t count = (int32_t)list->list.size();
+    int32_t first = partitionPoint(count, [&](const int32_t i) {
+        return start + offsets.get(i) + this->spans[list->list[i]].second <= relexed.firstToken;
+    });
+    int32_t last = partitionPoint(count, [&](const int32_t i) { return start + offsets.get(i) < relexed.oldEndToken; }) - 1;
+    if(first > last) {
+        return false;
+    }
+
+    const int32_t delta = relexed.newEndToken - relexed.oldEndToken;
+    const int32_t runBegin = start + offsets.get(first);
+    const int32_t runEnd = start + offsets.get(last) + this->spans[list->list[last]].second + delta;
+
+    // A run with unbalanced braces changed the structure around it
+    int32_t depth = 0;
+    for(int32_t i = runBegin; i < runEnd && depth >= 0; i ++) {
+        if(tokens[i].type == Lexing::TokenType::L_BRACE) {
+            depth ++;
+        } else if(tokens[i].type == Lexing::TokenType::R_BRACE) {
+            depth --;
+        }
+    }
+    if(depth != 0) {
+        return false;
+    }
+
+    std::vector<Lexing::Token> slice(tokens.begin() + runBegin, tokens.begin() + runEnd);
+    slice.push_back(tokens.back());
+    Parser parser(slice);
+    parser.recordSpans = true;
+    std::vector<Grammar::Statement*> fresh;
+    bool failed = false;
+    try {
+        while(!parser.isAtEnd()) {
+            fresh.push_back(parser.recognizeStatement());
+        }
+    } catch(const ParserException &) {
+        failed = true;
+    }
+    if(failed || !parser.diagnostics.empty()) {
+        // Errors are reported by a full parse
+        for(auto it : fresh) {
+            delete it;
+        }
+        return false;
+    }
+
+    for(int32_t i = first; i <= last; i ++) {
+        this->forgetSpans(list->list[i]);
+        delete list->list[i];
+    }
+    if((int32_t)fresh.size() == last - first + 1) {
+        // Same number of statements, only the replaced ones and the ones after them move
+        for(int32_t i = first; i <= last; i ++) {
+            int32_t now = runBegin + parser.statementSpans[fresh[i - first]].first - start;
+            int32_t old = offsets.get(i);
+            offsets.shift(i, now - old);
+            offsets.shift(i + 1, old - now);
+        }
+        offsets.shift(last + 1, delta);
+    } else {
+        std::vector<int32_t> starts = offsets.starts();
+        for(int32_t i = last + 1; i < count; i ++) {
+            starts[i] += delta;
+        }
+        starts.erase(starts.begin() + first, starts.begin() + last + 1);
+        std::vector<int32_t> freshStarts;
+        for(auto it : fresh) {
+            freshStarts.push_back(runBegin + parser.statementSpans[it].first - start);
+        }
+        starts.insert(starts.begin() + first, freshStarts.begin(), freshStarts.end());
+        offsets.assign(starts);
+    }
+    list->list.erase(list->list.begin() + first, list->list.begin() + last + 1);
+    list->list.insert(list->list.begin() + first, fresh.begin(), fresh.end());
+    for(auto it : fresh) {
+        // The parser counted tokens from runBegin
+        this->recordSpans(it, start - runBegin, parser.statementSpans);
+    }
+    this->spans[list].second += delta;
+    return true;
+}
+
+void IncrementalParser::recordSpans(const Grammar::Statement *stmt, const int32_t parentStart,
+    const std::unordered_map<const Grammar::Statement*, std::pair<int32_t, int32_t> > &absolute) {
+    auto it = absolute.find(stmt);
+    auto span = it != absolute.end() ? it->second : std::make_pair(parentStart, parentStart);
+    this->spans[stmt] = {span.first - parentStart, span.second - span.first};
+    auto children = childStatements(const_cast<Grammar::Statement*>(stmt));
+    if(auto list = dynamic_cast<const Grammar::StatementList*>(stmt)) {
+        std::vector<int32_t> starts;
+        for(auto slot : children) {
+            auto child = absolute.find(*slot);
+            starts.push_back(child != absolute.end() ? child->second.first - span.first : 0);
+        }
+        this->listStarts[list].assign(starts);
+    }
+    for(auto slot : children) {
+        this->recordSpans(*slot, span.first, absolute);
+    }
+}
+
+void IncrementalParser::forgetSpans(const Grammar::Statement *stmt) {
+    for(auto slot : childStatements(const_cast<Grammar::Statement*>(stmt))) {
+        this->forgetSpans(*slot);
+    }
+    if(auto list = dynamic_cast<const Grammar::StatementList*>(stmt)) {
+        this->listStarts.erase(list);
+    }
+    this->spans.erase(stmt);
+}
+
+std::vector<int32_t> IncrementalParser::childStarts(const Grammar::Statement *node, const int32_t start) const {
+    std::vector<int32_t> starts;
+    if(auto list = dynamic_cast<const Grammar::StatementList*>(node)) {
+        auto it = this->listStarts.find(list);
+        if(it != this->listStarts.end()) {
+            starts = it->second.starts();
+        }
+    } else {
+        for(auto slot : childStatements(const_cast<Grammar::Statement*>(node))) {
+            auto it = this->spans.find(*slot);
+            starts.push_back(it != this->spans.end() ? it->second.first : 0);
+        }
+    }
+    for(auto &it : starts) {
+        it += start;
+    }
+    return starts;
+}
+
+void IncrementalParser::refreshLines(Grammar::Statement *stmt, const int32_t start) const {
+    if(!stmt) {
+        return;
+    }
+    stmt->lineNmb = this->lexer.lexed[start].lineNmb;
+    auto children = childStatements(stmt);
+    auto starts = this->childStarts(stmt, start);
+    for(size_t i = 0; i < children.size() && i < starts.size(); i ++) {
+        this->refreshLines(*children[i], starts[i]);
+    }
+}
+
+};
@@ -0,0 +1,212 @@
+#pragma once
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <unordered_map>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "Parser.h"
+
+namespace Parsing {
+
+/**
+ * @brief Keeps the tokens and the AST of a source buffer and updates them after text edits,
+ * re-lexing only the edited tokens and re-parsing only the statements around them
+ * 
+ */
+class IncrementalParser {
+private:
+    /**
+     * @brief Lexer owning the current source and token stream
+     * 
+     */
+    Lexing::Lexer lexer;
+
+    /**
+     * @brief Root statement list of the source
+     * 
+     */
+    Grammar::Statement *root;
+
+    /**
+     * @brief Starts of the statements of a list relative to the start of the list, stored as a Fenwick tree
+     * of the differences between neighbours so that moving every statement after an edit is one update
+     * 
+     */
+    class OffsetTree {
+    private:
+        /**
+         * @brief Fenwick tree, one based
+         * 
+         */
+        std::vector<int32_t> tree;
+
+    public:
+        /**
+         * @brief Build the tree from the starts of all statements in one pass
+         * 
+         * @param starts Starts in list order
+         */
+        void assign(const std::vector<int32_t> &starts);
+
+        /**
+         * @brief Get the starts of all statements in one pass
+         * 
+         * @return std::vector<int32_t> Starts in list order
+         */
+        std::vector<int32_t> starts() const;
+
+        /**
+         * @brief Get the start of one statement
+         * 
+         * @param index Index of the statement in the list
+         * @return int32_t Start relative to the list
+         */
+        int32_t get(const int32_t index) const;
+
+        /**
+         * @brief Move the statements from index on
+         * 
+         * @param index Index of the first statement to move
+         * @param delta Change in token count
+         */
+        void shift(const int32_t index, const int32_t delta);
+    };
+
+    /**
+     * @brief First token of every statement relative to the first token of the statement it is nested in,
+     * and its token count. Starts of statements in a list are kept in listStarts instead, so an edit only
+     * updates the statements on the path to it
+     * 
+     */
+    std::unordered_map<const Grammar::Statement*, std::pair<int32_t, int32_t> > spans;
+
+    /**
+     * @brief Starts of the statements of every list
+     * 
+     */
+    std::unordered_map<const Grammar::StatementList*, OffsetTree> listStarts;
+
+    /**
+     * @brief Whether an edit added or removed lines since the lines of the statements were last updated
+     * 
+     */
+    mutable bool linesStale;
+
+    /**
+     * @brief Parser errors of the current tree
+     * 
+     */
+    std::vector<Lexing::Diagnostic> diagnostics;
+
+    /**
+     * @brief Throw away the tree and parse the whole token stream again
+     * 
+     */
+    void fullReparse();
+
+    /**
+     * @brief Re-parse the smallest part of the subtree of node which covers the relexed tokens
+     * 
+     * @param node Statement whose span contains the relexed tokens
+     * @param start First token of node
+     * @param relexed Tokens changed by the last edit
+     * @return true if the tree and the spans inside node were updated and false if an ancestor has to be re-parsed
+     */
+    bool reparseWithin(Grammar::Statement *node, const int32_t start, const Lexing::RelexResult &relexed);
+
+    /**
+     * @brief Re-parse the consecutive statements of a braced list which contain the relexed tokens
+     * 
+     * @param list Statement list whose braces were not touched by the edit
+     * @param start First token of list
+     * @param relexed Tokens changed by the last edit
+     * @return true if the statements were replaced and false otherwise
+     */
+    bool reparseRun(Grammar::StatementList *list, const int32_t start, const Lexing::RelexResult &relexed);
+
+    /**
+     * @brief Store the spans of a statement and all statements nested in it relative to their parents
+     * 
+     * @param stmt Statement to remember
+     * @param parentStart First token of the statement stmt is nested in, counted like in absolute
+     * @param absolute Spans found by the parser
+     */
+    void recordSpans(const Grammar::Statement *stmt, const int32_t parentStart,
+        const std::unordered_map<const Grammar::Statement*, std::pair<int32_t, int32_t> > &absolute);
+
+    /**
+     * @brief Drop the spans of a statement and all statements nested in it
+     * 
+     * @param stmt Statement to forget
+     */
+    void forgetSpans(const Grammar::Statement *stmt);
+
+    /**
+     * @brief Get the first token of every statement directly nested in node
+     * 
+     * @param node Statement to look into
+     * @param start First token of node
+     * @return std::vector<int32_t> First tokens in the order of the children
+     */
+    std::vector<int32_t> childStarts(const Grammar::Statement *node, const int32_t start) const;
+
+    /**
+     * @brief Set the lines of a statement and all statements nested in it from their first tokens
+     * 
+     * @param stmt Statement to update
+     * @param start First token of stmt
+     */
+    void refreshLines(Grammar::Statement *stmt, const int32_t start) const;
+
+public:
+    /**
+     * @brief Lex and parse the whole source once
+     * 
+     * @param code Source to parse
+     */
+    IncrementalParser(const std::string &code);
+
+    /**
+     * @brief Destroy the IncrementalParser object and its tree
+     * 
+     */
+    ~IncrementalParser();
+
+    /**
+     * @brief Apply a text edit and bring the tokens and the tree up to date. The lines of the statements
+     * after the edit are only updated by getRoot
+     * 
+     * @param edit Edit of the source
+     */
+    void applyEdit(const Lexing::TextEdit &edit);
+
+    /**
+     * @brief Get the root of the current tree, updating the lines of its statements if edits moved them
+     * 
+     * @return Grammar::Statement* Root statement list
+     */
+    Grammar::Statement *getRoot() const;
+
+    /**
+     * @brief Get the current token stream
+     * 
+     * @return const std::vector<Lexing::Token>& Tokens ending with END_OF_FILE
+     */
+    const std::vector<Lexing::Token> &getTokens() const;
+
+    /**
+     * @brief Get the lexer and parser errors of the current source
+     * 
+     * @return std::vector<Lexing::Diagnostic> Errors in source order of the passes
+     */
+    std::vector<Lexing::Diagnostic> getDiagnostics() const;
+};
+
+};
+
+#endif // INCREMENTAL_PARSER_H
@@ -0,0 +1,67 @@
+#include <string>
+#include <memory>
+#include <thread>
+
+#include "Isolate.h"
+
+namespace Embedding {
+
+Isolate::Isolate(const Function &_handler, const size_t capacity, Isolate *_next) : handler(_handler), inbox(capacity), outbox(capacity),
+    next(_next), stopping(false) {}
+
+std::unique_ptr<Isolate> Isolate::start(const Program &program, const std::string &handler, const size_t capacity, std::string &error,
+    Isolate *next) {
+    const Function *function = program.function(handler);
+    if(!function) {
+        error = "The program has no function " + handler;
+        return nullptr;
+    }
+    if((size_t)function->parameterCount > MESSAGE_VALUES) {
+        error = "Function " + handler + " takes more than the " + std::to_string(MESSAGE_VALUES) + " values of a message";
+        return nullptr;
+    }
+    if(!function->shareable) {
+        error = "Function " + handler + " writes globals, which every isolate of the program would share";
+        return nullptr;
+    }
+    std::unique_ptr<Isolate> isolate(new Isolate(*function, capacity, next));
+    isolate->thread = std::thread(&Isolate::run, isolate.get());
+    return isolate;
+}
+
+Isolate::~Isolate() {
+    this->stop();
+}
+
+void Isolate::run() {
+    Runtime::SpscQueue<Message> &replies = this->next ? this->next->inbox : this->outbox;
+    Message message;
+    while(true) {
+        if(!this->inbox.pop(message)) {
+            // Messages sent before stopping are in the inbox by the time the flag is seen
+            if(!this->stopping.load(std::memory_order_acquire)) {
+                this->stats.idleYields ++;
+                std::this_thread::yield();
+                continue;
+            }
+            if(!this->inbox.pop(message)) {
+                break;
+            }
+        }
+        message.values[0] = Program::invoke(this->handler, message.values);
+        this->stats.handled ++;
+        while(!replies.push(message) && !this->stopping.load(std::memory_order_acquire)) {
+            this->stats.fullYields ++;
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Isolate::stop() {
+    if(this->thread.joinable()) {
+        this->stopping.store(true, std::memory_order_release);
+        this->thread.join();
+    }
+}
+
+};
@@ -0,0 +1,125 @@
+#pragma once
+#ifndef ISOLATE_H
+#define ISOLATE_H
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "Embedding.h"
+#include "Runtime/SpscQueue.h"
+
+namespace Embedding {
+
+/**
+ * @brief Values a message carries, the arguments of the handler of an isolate
+ * 
+ */
+const size_t MESSAGE_VALUES = 4;
+
+/**
+ * @brief Request to an isolate or its reply. A reply keeps the id and carries the result of the handler
+ * as its first value, the other values stay as they were.
+ * 
+ */
+class Message {
+public:
+    int64_t id = 0;
+    int64_t values[MESSAGE_VALUES] = {};
+};
+
+/**
+ * @brief Work of an isolate
+ * 
+ */
+class IsolateStats {
+public:
+    int64_t handled = 0;
+
+    /**
+     * @brief Times the isolate gave up its core, as its inbox was empty or the queue of its replies full
+     * 
+     */
+    int64_t idleYields = 0;
+    int64_t fullYields = 0;
+};
+
+/**
+ * @brief Instance of a program running on a thread of its own. Every message of its inbox is handed to
+ * one function of the program and its reply is queued, for the host or for the next isolate of a pipeline.
+ * 
+ * Isolates of a program share its code, which is never written, and only run functions which do not
+ * write globals, so the only state of an isolate is its stack and its queues. The queues have a single
+ * producer and a single consumer each: the host sends to an isolate and receives its replies, or the
+ * isolate before it in a pipeline sends to it, and nothing is locked on the way.
+ * 
+ */
+class Isolate {
+private:
+    const Function &handler;
+    Runtime::SpscQueue<Message> inbox;
+    Runtime::SpscQueue<Message> outbox;
+    Isolate *next;
+    std::atomic<bool> stopping;
+    std::thread thread;
+
+    Isolate(const Function &_handler, const size_t capacity, Isolate *_next);
+    void run();
+
+public:
+    /**
+     * @brief Valid once the isolate stopped
+     * 
+     */
+    IsolateStats stats;
+
+    /**
+     * @brief Start an isolate
+     * 
+     * @param program Program outliving the isolate
+     * @param handler Function taking at most MESSAGE_VALUES arguments and writing no globals
+     * @param capacity Messages the inbox and the outbox hold at least
+     * @param error Reason the handler cannot run in an isolate
+     * @param next Isolate receiving the replies instead of the host, which must not send to it then.
+     * It has to stop after this one.
+     * @return std::unique_ptr<Isolate> The running isolate, nullptr on failure
+     */
+    static std::unique_ptr<Isolate> start(const Program &program, const std::string &handler, const size_t capacity,
+        std::string &error, Isolate *next = nullptr);
+
+    /**
+     * @brief Stop the isolate, see stop
+     * 
+     */
+    ~Isolate();
+
+    Isolate(const Isolate&) = delete;
+    Isolate& operator =(const Isolate&) = delete;
+
+    /**
+     * @brief Queue a message, called by the host only
+     * 
+     * @return false The inbox is full
+     */
+    bool send(const Message &message) { return this->inbox.push(message); }
+
+    /**
+     * @brief Take the oldest reply, called by the host only
+     * 
+     * @return false No reply is waiting
+     */
+    bool receive(Message &reply) { return this->outbox.pop(reply); }
+
+    /**
+     * @brief Let the isolate handle the messages sent so far and wait for its thread. Replies which do
+     * not fit in the outbox any more are dropped, the ones queued can still be received.
+     * 
+     */
+    void stop();
+};
+
+};
+
+#endif // ISOLATE_H
@@ -2,8 +2,11 @@
 #include <utility>
 #include <string>
 #include <iomanip>
+#include <algorithm>
+#include <iterator>
 
 #include "Lexer.h"
+#include "Utf8.h"
 
 namespace Lexing {
 
@@ -28,20 +31,7 @@ int32_t typeOfChar(const char c) {
     } else if(isSeparator(c)) {
         return 4; // Separator
     }
-    LexerError("Unknown type of char ", c, "\n");
-    return -1;
-}
-
-template <typename... T>
-void LexerErrorPrint(T... t) {
-    (std::cerr << ... << t) << "\n";
-}
-
-template <typename... T>
-void LexerError(T... t) {
-    std::cerr << "There was an error while parsing " << "\n";
-    LexerErrorPrint(t...);
-    exit(0);
+    return 0; // Unknown
 }
 
 /***********************LexerTrie class**********************/
@@ -58,11 +48,11 @@ LexerTrie::Node::~Node() {
 }
 
 void LexerTrie::advance(Node *&curr, const char c) const {
-    if(!curr || !curr->nxt[(int32_t)c]) {
+    if(!curr || !curr->nxt[(unsigned char)c]) {
         curr = nullptr;
         return;
     }
-    curr = curr->nxt[(int32_t)c];
+    curr = curr->nxt[(unsigned char)c];
 }
 
 LexerTrie::LexerTrie() {root = new Node();}
@@ -77,11 +67,11 @@ LexerTrie::~LexerTrie() {delete root;}
 void LexerTrie::addWord(const std::string &toAdd, const TokenType &type) {
     auto currNode = this->root;
     for(auto &it : toAdd) {
-        if(currNode->nxt[(int32_t)it]) {
-            currNode = currNode->nxt[(int32_t)it];
+        if(currNode->nxt[(unsigned char)it]) {
+            currNode = currNode->nxt[(unsigned char)it];
         } else {
-            currNode->nxt[(int32_t)it] = new Node();
-            currNode = currNode->nxt[(int32_t)it];
+            currNode->nxt[(unsigned char)it] = new Node();
+            currNode = currNode->nxt[(unsigned char)it];
         }
     }
     currNode->type = type;
@@ -90,7 +80,7 @@ void LexerTrie::addWord(const std::string &toAdd, const TokenType &type) {
 TokenType LexerTrie::findWord(const std::string &toFind) const {
     auto currNode = this->root;
     for(auto &it : toFind) {
-        currNode = currNode->nxt[(int32_t)it];
+        currNode = currNode->nxt[(unsigned char)it];
         if(!currNode) {return NAME;}
     }
     return currNode->type;
@@ -98,10 +88,22 @@ TokenType LexerTrie::findWord(const std::string &toFind) const {
 
 /***********************Token class*************************/
 Token::Token() {}
-Token::Token(const TokenType &_type, const std::string &_lexeme, const int32_t &_lineNmb, const int32_t &_startPos)
-            : type(_type), lexeme(_lexeme), lineNmb(_lineNmb), startPos(_startPos) {}
+Token::Token(const TokenType &_type, const std::string &_lexeme, const int32_t &_lineNmb, const int32_t &_startPos, const int32_t &_offset)
+            : type(_type), lexeme(_lexeme), lineNmb(_lineNmb), startPos(_startPos), offset(_offset) {}
 Token::~Token() {}
 
+/***********************Diagnostic class********************/
+Diagnostic::Diagnostic(const int32_t &_lineNmb, const int32_t &_startPos, const std::string &_message)
+            : lineNmb(_lineNmb), startPos(_startPos), message(_message) {}
+
+std::ostream& operator <<(std::ostream &os, const Diagnostic &diagnostic) {
+    return os << "There was an error at line " << diagnostic.lineNmb << ", position " << diagnostic.startPos << "\n" << diagnostic.message << "\n";
+}
+
+/***********************TextEdit class**********************/
+TextEdit::TextEdit(const int32_t &_offset, const int32_t &_removedLength, const std::string &_inserted)
+            : offset(_offset), removedLength(_removedLength), inserted(_inserted) {}
+
 std::ostream& operator <<(std::ostream &os, const Token &token) {
     return os << token.lineNmb << ", " << std::setw(7) << token.startPos << "| " << std::setw(15) << token.lexeme << "| " << std::setw(15) << TokenTypeName[token.type] << "\n";
 }
@@ -124,8 +126,8 @@ void transformToMatchingUnary(Token &token) {
 }
 
 /***********************Lexer class ************************/
-Lexer::Lexer() : code(), codePtr(0), lineNmb(0), charNmb(0), lexTrie() {}
-Lexer::Lexer(std::string code) : code(code), codePtr(0), lineNmb(0), charNmb(0), lexTrie() {}
+Lexer::Lexer() : code(), codePtr(0), lineNmb(0), charNmb(0), asciiOnly(true), lexTrie() {}
+Lexer::Lexer(std::string code) : code(code), codePtr(0), lineNmb(0), charNmb(0), asciiOnly(true), lexTrie() {}
 Lexer::~Lexer() {}
 
 char Lexer::peek() const { return code[codePtr]; }
@@ -133,12 +135,21 @@ char Lexer::advance() {
     if(code[codePtr] == '\n') {
         this->lineNmb ++;
         this->charNmb = 0;
-    } else {
+    } else if((code[codePtr] & 0xC0) != 0x80) {
+        // Positions count code points, so continuation bytes do not move them
         this->charNmb ++;
     }
     return this->code[codePtr ++];
 }
 bool Lexer::isAtEnd() const { return codePtr == (int32_t)code.size(); }
+int32_t Lexer::peekCodePoint(uint32_t &codePoint) const {
+    return decodeUtf8(this->code.data() + codePtr, this->code.size() - codePtr, codePoint);
+}
+
+template <typename... T>
+void Lexer::error(T... t) {
+    this->diagnostics.push_back(Diagnostic::make(this->lineNmb, this->charNmb, t...));
+}
 
 void Lexer::addWord(const std::string &toAdd, const TokenType &type) {
     lexTrie.addWord(toAdd, type);
@@ -148,7 +159,7 @@ Token Lexer::recognizeOperator() {
     LexerTrie::Node *currentNode = lexTrie.root;
     while(!this->isAtEnd()) {
         char current = this->peek();
-        if(!currentNode->nxt[(int32_t)current]) {
+        if(!currentNode->nxt[(unsigned char)current]) {
             break;
         }
         this->lexTrie.advance(currentNode, current);
@@ -176,7 +187,21 @@ Token Lexer::recognizeWord() {
     while(!this->isAtEnd()) {
         char current = this->peek();
         if(!isLetter(current) && !isDigit(current)) {
-            break;
+            if(this->asciiOnly || (unsigned char)current < 0x80) {
+                break;
+            }
+            // Names continue with non-ASCII letters, keywords never contain them
+            uint32_t codePoint;
+            int32_t length = this->peekCodePoint(codePoint);
+            if(!length || !isIdentifierCodePoint(codePoint)) {
+                break;
+            }
+            nameValue.append(this->code, this->codePtr, length);
+            currentNode = nullptr;
+            for(int32_t i = 0; i < length; i ++) {
+                this->advance();
+            }
+            continue;
         }
         nameValue.push_back(current);
         this->lexTrie.advance(currentNode, current);
@@ -184,25 +209,33 @@ Token Lexer::recognizeWord() {
     }
     if(!currentNode || currentNode->type == TokenType::NAME) {
         return Token(TokenType::NAME, nameValue);
+    } else if(currentNode->type == TokenType::BOOLEAN) {
+        // Literals keep their spelling, it is their value
+        return Token(TokenType::BOOLEAN, nameValue);
     } else {
         return Token(currentNode->type);
     }
 }
 
 Token Lexer::recognizeString() {
-    std::string stringValue = "";
     this->advance();
-    while(!this->isAtEnd()) {
-        char current = this->peek();
-        if(current == '"') {
-            this->advance();
-            break;
-        }
-        stringValue.push_back(current);
+    // Strings have no escapes, so the closing quote can be searched for in bulk
+    size_t end = this->code.find('"', this->codePtr);
+    const bool closed = end != std::string::npos;
+    if(!closed) {
+        end = this->code.size();
+    }
+    std::string stringValue = this->code.substr(this->codePtr, end - this->codePtr);
+    if(!this->asciiOnly && !isAscii(stringValue.data(), stringValue.size()) && !isValidUtf8(stringValue.data(), stringValue.size())) {
+        this->error("Invalid UTF-8 in string literal \n");
+    }
+    while(this->codePtr < (int32_t)end) {
         this->advance();
     }
-    if(this->isAtEnd()) {
-        LexerError("String literal not closed \n");
+    if(closed) {
+        this->advance();
+    } else {
+        this->error("String literal not closed \n");
     }
     return Token(TokenType::STRING, stringValue);
 }
@@ -211,45 +244,195 @@ Token Lexer::recognizeChar() {
     std::string charValue = "";
     this->advance();
     if(this->isAtEnd()) {
-        LexerError("Char not closed \n");
+        this->error("Char not closed \n");
+        return Token(TokenType::CHARACTER, charValue);
+    }
+    // A char literal holds one code point
+    uint32_t codePoint;
+    int32_t length = this->asciiOnly ? 1 : this->peekCodePoint(codePoint);
+    if(!length) {
+        this->error("Invalid UTF-8 in char literal \n");
+        length = 1;
+    }
+    for(int32_t i = 0; i < length; i ++) {
+        charValue.push_back(this->advance());
     }
-    charValue.push_back(this->advance());
     if(this->isAtEnd() || this->peek() != '\'') {
-        LexerError("Char not closed \n");
+        this->error("Char not closed \n");
+        return Token(TokenType::CHARACTER, charValue);
     }
     this->advance();
     return Token(TokenType::CHARACTER, charValue);
 }
 
-void Lexer::lex() {
-    this->lexed.resize(0);
-    while(!this->isAtEnd()) {
-        char currentChar = this->peek(); int32_t startPos = this->charNmb;
-
-        Token currentToken;
-        if(isWhitespace(currentChar)) {
+bool Lexer::lexToken(Token &token) {
+    while(true) {
+        while(!this->isAtEnd() && isWhitespace(this->peek())) {
             this->advance();
-            continue;
-        } if(isOperator(currentChar) || isSeparator(currentChar) || isBracket(currentChar)) {
-            currentToken = this->recognizeOperator();
+        }
+        if(this->isAtEnd()) {
+            return false;
+        }
+
+        // Tokens such as strings may span lines, a token is placed where it starts
+        char currentChar = this->peek();
+        int32_t startLine = this->lineNmb, startPos = this->charNmb, offset = this->codePtr;
+        if(isOperator(currentChar) || isSeparator(currentChar) || isBracket(currentChar)) {
+            token = this->recognizeOperator();
         } else if(isDigit(currentChar)) {
-            currentToken = this->recognizeNumber();
+            token = this->recognizeNumber();
         } else if(isLetter(currentChar)) {
-            currentToken = this->recognizeWord();
+            token = this->recognizeWord();
         } else if(currentChar == '"') {
-            currentToken = this->recognizeString();
+            token = this->recognizeString();
         } else if(currentChar == '\'') {
-            currentToken = this->recognizeChar();
+            token = this->recognizeChar();
+        } else if(!this->asciiOnly && (unsigned char)currentChar >= 0x80) {
+            // Multibyte sequences are decoded only when the source is not all ASCII
+            uint32_t codePoint;
+            int32_t length = this->peekCodePoint(codePoint);
+            if(length && isIdentifierStartCodePoint(codePoint)) {
+                token = this->recognizeWord();
+            } else {
+                if(length) {
+                    this->error("Lexing error: Found character ", this->code.substr(this->codePtr, length), "\n");
+                } else {
+                    this->error("Lexing error: Invalid UTF-8 sequence\n");
+                }
+                for(int32_t i = 0; i < std::max(length, 1); i ++) {
+                    this->advance();
+                }
+                continue;
+            }
         } else {
-            LexerError("Lexing error: Found character ", currentChar, " at ", this->lineNmb, " ", this->charNmb, "\n");
+            // Report the character and continue lexing after it, the position is the one of the diagnostic so
+            // that it moves with the edits of relex
+            this->error("Lexing error: Found character ", currentChar, "\n");
+            this->advance();
+            continue;
         }
-        currentToken.lineNmb = this->lineNmb;
-        currentToken.startPos = startPos;
+        token.lineNmb = startLine;
+        token.startPos = startPos;
+        token.offset = offset;
+        return true;
+    }
+}
+
+void Lexer::lex() {
+    this->codePtr = 0;
+    this->lineNmb = 0;
+    this->charNmb = 0;
+    this->lexed.resize(0);
+    this->diagnostics.clear();
+    this->asciiOnly = isAscii(this->code.data(), this->code.size());
+
+    Token currentToken;
+    while(this->lexToken(currentToken)) {
         this->lexed.push_back(currentToken);
     }
-    this->lexed.push_back(Token(TokenType::END_OF_FILE, "", -1, -1));
+    this->lexed.push_back(Token(TokenType::END_OF_FILE, "", -1, -1, (int32_t)this->code.size()));
+}
+
+RelexResult Lexer::relex(const TextEdit &edit) {
+    const int32_t eofIndex = (int32_t)this->lexed.size() - 1;
+    const int32_t oldEditEnd = edit.offset + edit.removedLength;
+    const int32_t newEditEnd = edit.offset + (int32_t)edit.inserted.size();
+    const int32_t delta = newEditEnd - oldEditEnd;
+
+    // The last token starting before the edit can grow into it, so lexing resumes at its start
+    auto firstAfter = std::lower_bound(this->lexed.begin(), this->lexed.end() - 1, edit.offset,
+        [](const Token &token, const int32_t offset) { return token.offset < offset; });
+    int32_t first = (int32_t)(firstAfter - this->lexed.begin());
+    if(first > 0) {
+        first --;
+        this->codePtr = this->lexed[first].offset;
+        this->lineNmb = this->lexed[first].lineNmb;
+        this->charNmb = this->lexed[first].startPos;
+    } else {
+        this->codePtr = 0;
+        this->lineNmb = 0;
+        this->charNmb = 0;
+    }
+
+    this->code.replace(edit.offset, edit.removedLength, edit.inserted);
+    this->asciiOnly = this->asciiOnly && isAscii(edit.inserted.data(), edit.inserted.size());
+
+    // Errors found from here on replace the old ones of the relexed text
+    const std::pair<int32_t, int32_t> relexStart = {this->lineNmb, this->charNmb};
+    std::vector<Diagnostic> oldDiagnostics = std::move(this->diagnostics);
+    this->diagnostics.clear();
+
+    // Lex until a token starts where an old token past the edit started, the rest of the stream is unchanged from there
+    std::vector<Token> fresh;
+    Token currentToken;
+    int32_t resync = first;
+    bool synced = false;
+    while(this->lexToken(currentToken)) {
+        if(currentToken.offset >= newEditEnd) {
+            while(resync < eofIndex && (this->lexed[resync].offset < oldEditEnd || this->lexed[resync].offset + delta < currentToken.offset)) {
+                resync ++;
+            }
+            if(resync < eofIndex && this->lexed[resync].offset + delta == currentToken.offset) {
+                synced = true;
+                break;
+            }
+        }
+        fresh.push_back(currentToken);
+    }
+
+    std::vector<Diagnostic> diagnostics;
+    for(auto &it : oldDiagnostics) {
+        if(std::make_pair(it.lineNmb, it.startPos) < relexStart) {
+            diagnostics.push_back(std::move(it));
+        }
+    }
+    diagnostics.insert(diagnostics.end(), std::make_move_iterator(this->diagnostics.begin()), std::make_move_iterator(this->diagnostics.end()));
+
+    if(synced) {
+        // Reused tokens and errors only move, those on the resync line also change column
+        const int32_t oldLine = this->lexed[resync].lineNmb;
+        const int32_t lineDelta = currentToken.lineNmb - oldLine;
+        const int32_t charDelta = currentToken.startPos - this->lexed[resync].startPos;
+        for(auto &it : oldDiagnostics) {
+            if(std::make_pair(it.lineNmb, it.startPos) >= std::make_pair(oldLine, this->lexed[resync].startPos)) {
+                if(it.lineNmb == oldLine) {
+                    it.startPos += charDelta;
+                }
+                it.lineNmb += lineDelta;
+                diagnostics.push_back(std::move(it));
+            }
+        }
+        for(int32_t i = resync; i < eofIndex && (delta != 0 || lineDelta != 0 || this->lexed[i].lineNmb == oldLine); i ++) {
+            if(this->lexed[i].lineNmb == oldLine) {
+                this->lexed[i].startPos += charDelta;
+            }
+            this->lexed[i].lineNmb += lineDelta;
+            this->lexed[i].offset += delta;
+        }
+    } else {
+        resync = eofIndex;
+    }
+    this->diagnostics = std::move(diagnostics);
+    this->lexed[eofIndex].offset = (int32_t)this->code.size();
+
+    // Splice the fresh tokens in, moving the tail of the stream at most once
+    const int32_t common = std::min((int32_t)fresh.size(), resync - first);
+    std::move(fresh.begin(), fresh.begin() + common, this->lexed.begin() + first);
+    if((int32_t)fresh.size() > common) {
+        this->lexed.insert(this->lexed.begin() + first + common, std::make_move_iterator(fresh.begin() + common), std::make_move_iterator(fresh.end()));
+    } else {
+        this->lexed.erase(this->lexed.begin() + first + common, this->lexed.begin() + resync);
+    }
+
+    RelexResult result;
+    result.firstToken = first;
+    result.oldEndToken = resync;
+    result.newEndToken = first + (int32_t)fresh.size();
+    return result;
 }
 
+const std::string &Lexer::getCode() const { return this->code; }
+
 void Lexer::printLexed() const {
     std::ios init(NULL);
     init.copyfmt(std::cout);
@@ -264,14 +447,14 @@ void Lexer::setupBasicLexer(Lexer &lexer) {
         //Keywords
         {"else", TokenType::ELSE}, {"function", TokenType::FUNCTION}, {"function", TokenType::FUNCTION},
         {"for", TokenType::FOR}, {"if", TokenType::IF}, {"return", TokenType::RETURN}, {"while", TokenType::WHILE},
-        {"do", TokenType::DO}, {"let", TokenType::VAR},
+        {"do", TokenType::DO}, {"let", TokenType::VAR}, {"import", TokenType::IMPORT}, {"class", TokenType::CLASS},
         //Operators
         {"+", TokenType::PLUS}, {"-", TokenType::MINUS}, {"*", TokenType::STAR}, {"/", TokenType::SLASH}, {"%", TokenType::MODULO}, //'Constant' operators
         {"|", TokenType::OR}, {"&", TokenType::AND}, {"^", TokenType::XOR}, {"~", TokenType::NOT}, //'Constant' bitwise operators
         {"+=", TokenType::PLUS_EQUAL}, {"-=", TokenType::MINUS_EQUAL}, {"*=", TokenType::STAR_EQUAL}, {"/=", TokenType::SLASH_EQUAL}, {"%=", TokenType::MODULO_EQUAL},
         {"|=", TokenType::OR_EQUAL}, {"&=", TokenType::AND_EQUAL}, {"^=", TokenType::XOR_EQUAL}, {"=", TokenType::EQUAL}, //'Nonconstant' operators
         //Boolean operators
-        {"!", TokenType::BANG}, {"!", TokenType::BANG_EQUAL}, {"==", TokenType::EQUAL_EQUAL}, {"<", TokenType::LESS}, {"<=", TokenType::LESS_EQUAL},
+        {"!", TokenType::BANG}, {"!=", TokenType::BANG_EQUAL}, {"==", TokenType::EQUAL_EQUAL}, {"<", TokenType::LESS}, {"<=", TokenType::LESS_EQUAL},
         {">", TokenType::GREATER}, {">=", TokenType::GREATER_EQUAL}, {"||", TokenType::OROR}, {"&&", TokenType::ANDAND}, {"^^", TokenType::XORXOR}, {",", TokenType::COMMA},
         //Separators
         {";", TokenType::SEMICOLON}, {".", TokenType::DOT}, {":", TokenType::COLON}, {"?", TokenType::COLON},
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <utility>
 #include <string>
+#include <sstream>
 
 namespace Lexing {
 
@@ -14,7 +15,7 @@ namespace Lexing {
 const int32_t ASCII_SIZE = 256;
 enum TokenType {
     //Keywords
-    ELSE, FUNCTION, FOR, IF, RETURN, VAR, WHILE, DO,
+    ELSE, FUNCTION, FOR, IF, RETURN, VAR, WHILE, DO, IMPORT, CLASS,
     //Operators
     PLUS, MINUS, STAR, SLASH, MODULO, OR, AND, XOR, NOT,
     PLUS_EQUAL, MINUS_EQUAL, STAR_EQUAL, SLASH_EQUAL, MODULO_EQUAL, OR_EQUAL, AND_EQUAL, XOR_EQUAL, EQUAL,
@@ -33,7 +34,7 @@ enum TokenType {
 };
 
 const std::string TokenTypeName[TokenType::size] = {
-    "else", "function", "for", "if", "return", "let", "while", "do",
+    "else", "function", "for", "if", "return", "let", "while", "do", "import", "class",
     "+", "-", "*", "/", "%", "|", "&", "^", "~",
     "+=", "-=", "*=", "/=", "%=", "|=", "&=", "^=", "=",
     "!", "!=", "==", "<", "<=", ">", ">=", "||", "&&", "^^",
@@ -45,7 +46,7 @@ const std::string TokenTypeName[TokenType::size] = {
 };
 
 const int32_t precedence[TokenType::size] = {
-    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
     12, 12, 10, 10, 10, 26, 22, 24, 7,
     35, 35, 35, 35, 35, 35, 35, 35, 35,
     7, 20, 20, 18, 18, 18, 18, 32, 28, 30,
@@ -56,9 +57,6 @@ const int32_t precedence[TokenType::size] = {
     -1,
 };
 
-template <typename... T>
-void LexerError(T... t);
-
 bool isDigit(const char c);
 bool isSmallLetter(const char c);
 bool isBigLetter(const char c);
@@ -99,14 +97,55 @@ public:
     std::string lexeme;
     int32_t lineNmb;
     int32_t startPos;
+    int32_t offset;
 
 	Token();
-    Token(const TokenType &_type, const std::string &_lexeme = "", const int32_t &_lineNmb = 0, const int32_t &_startPos = 0);
+    Token(const TokenType &_type, const std::string &_lexeme = "", const int32_t &_lineNmb = 0, const int32_t &_startPos = 0, const int32_t &_offset = 0);
     ~Token();
 };
 
+// Replace removedLength bytes at offset with inserted
+class TextEdit {
+public:
+
+    int32_t offset;
+    int32_t removedLength;
+    std::string inserted;
+
+    TextEdit(const int32_t &_offset, const int32_t &_removedLength, const std::string &_inserted);
+};
+
+// Tokens [firstToken, oldEndToken) of the previous stream were replaced by [firstToken, newEndToken)
+class RelexResult {
+public:
+
+    int32_t firstToken;
+    int32_t oldEndToken;
+    int32_t newEndToken;
+};
+
 std::ostream& operator <<(std::ostream &os, const Token &token);
 
+// Error found while lexing or parsing, reported without stopping the compilation
+class Diagnostic {
+public:
+
+    int32_t lineNmb;
+    int32_t startPos;
+    std::string message;
+
+    Diagnostic(const int32_t &_lineNmb, const int32_t &_startPos, const std::string &_message);
+
+    template <typename... T>
+    static Diagnostic make(const int32_t &lineNmb, const int32_t &startPos, T... t) {
+        std::stringstream message;
+        (message << ... << t);
+        return Diagnostic(lineNmb, startPos, message.str());
+    }
+};
+
+std::ostream& operator <<(std::ostream &os, const Diagnostic &diagnostic);
+
 void transformToMatchingUnary(Token &token);
 bool canBeUnaryOperator(const Token &token);
 
@@ -117,26 +156,35 @@ private:
     int32_t codePtr;
     int32_t lineNmb;
     int32_t charNmb;
+    bool asciiOnly;
     LexerTrie lexTrie;
 
     char peek() const;
     char advance();
     bool isAtEnd() const;
+    int32_t peekCodePoint(uint32_t &codePoint) const;
     Token recognizeOperator();
     Token recognizeNumber();
     Token recognizeWord();
     Token recognizeString();
     Token recognizeChar();
+    bool lexToken(Token &token);
+
+    template <typename... T>
+    void error(T... t);
 
 public:
 
     std::vector<Token> lexed;
+    std::vector<Diagnostic> diagnostics;
 
 	Lexer();
     Lexer(std::string code);
     ~Lexer();
     void addWord(const std::string &toAdd, const TokenType &type);
     void lex();
+    RelexResult relex(const TextEdit &edit);
+    const std::string &getCode() const;
     void printLexed() const;
 
 	static void setupBasicLexer(Lexer &lexer);
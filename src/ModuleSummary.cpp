@@ -0,0 +1,326 @@
+#include <vector>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Lexer.h"
+#include "Grammar.h"
+#include "ModuleSummary.h"
+
+namespace Modules {
+
+/***********************ModuleSummary class*****************/
+ModuleSummary::ModuleSummary() : mapping(nullptr), mappingSize(0), header(nullptr), declarations(nullptr), parameters(nullptr), strings(nullptr) {}
+
+ModuleSummary::~ModuleSummary() {
+    if(this->mapping) {
+        munmap(this->mapping, this->mappingSize);
+    }
+}
+
+ModuleSummary *ModuleSummary::load(const std::string &path, std::string &error) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error = "Cannot open module summary " + path;
+        return nullptr;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SummaryHeader)) {
+        close(fd);
+        error = "Module summary " + path + " is truncated";
+        return nullptr;
+    }
+    void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        error = "Cannot map module summary " + path;
+        return nullptr;
+    }
+
+    ModuleSummary *summary = new ModuleSummary();
+    summary->mapping = mapping;
+    summary->mappingSize = info.st_size;
+    summary->header = (const SummaryHeader*)mapping;
+
+    // Validate the layout once, so lookups need no bounds checks
+    const SummaryHeader &header = *summary->header;
+    const uint64_t expectedSize = sizeof(SummaryHeader) + (uint64_t)header.declarationCount * sizeof(SummaryDeclaration)
+        + (uint64_t)header.parameterCount * sizeof(SummaryString) + header.stringsSize;
+    if(std::memcmp(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC)) != 0 || header.version != SUMMARY_VERSION) {
+        error = "File " + path + " is not a module summary of this version";
+        delete summary;
+        return nullptr;
+    }
+    if(expectedSize != (uint64_t)info.st_size) {
+        error = "Module summary " + path + " has an inconsistent size";
+        delete summary;
+        return nullptr;
+    }
+    summary->declarations = (const SummaryDeclaration*)(summary->header + 1);
+    summary->parameters = (const SummaryString*)(summary->declarations + header.declarationCount);
+    summary->strings = (const char*)(summary->parameters + header.parameterCount);
+
+    auto inStrings = [&](const SummaryString &ref) {
+        return (uint64_t)ref.offset + ref.length <= header.stringsSize;
+    };
+    for(uint32_t i = 0; i < header.declarationCount; i ++) {
+        const SummaryDeclaration &decl = summary->declarations[i];
+        if(!inStrings(decl.name) || !inStrings(decl.type) || (uint64_t)decl.firstParameter + decl.arity > header.parameterCount
+            || (i > 0 && summary->string(summary->declarations[i - 1].name) > summary->string(decl.name))) {
+            error = "Module summary " + path + " has a corrupt declaration";
+            delete summary;
+            return nullptr;
+        }
+    }
+    for(uint32_t i = 0; i < header.parameterCount; i ++) {
+        if(!inStrings(summary->parameters[i])) {
+            error = "Module summary " + path + " has a corrupt parameter";
+            delete summary;
+            return nullptr;
+        }
+    }
+    return summary;
+}
+
+uint64_t ModuleSummary::inputHash() const { return this->header->inputHash; }
+
+uint64_t ModuleSummary::interfaceHash() const {
+    return hashBytes(std::string_view((const char*)(this->header + 1), this->mappingSize - sizeof(SummaryHeader)));
+}
+uint32_t ModuleSummary::declarationCount() const { return this->header->declarationCount; }
+const SummaryDeclaration &ModuleSummary::declaration(const uint32_t index) const { return this->declarations[index]; }
+
+const SummaryDeclaration *ModuleSummary::find(std::string_view name) const {
+    const SummaryDeclaration *end = this->declarations + this->header->declarationCount;
+    const SummaryDeclaration *it = std::lower_bound(this->declarations, end, name,
+        [&](const SummaryDeclaration &decl, std::string_view value) { return this->string(decl.name) < value; });
+    if(it == end || this->string(it->name) != name) {
+        return nullptr;
+    }
+    return it;
+}
+
+std::string_view ModuleSummary::parameterType(const SummaryDeclaration &decl, const uint32_t index) const {
+    return this->string(this->parameters[decl.firstParameter + index]);
+}
+
+std::string_view ModuleSummary::string(const SummaryString &ref) const {
+    return std::string_view(this->strings + ref.offset, ref.length);
+}
+
+/***********************Writing summaries*******************/
+uint64_t hashBytes(std::string_view data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for(const char c : data) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashInputs(std::string_view source, const std::vector<uint64_t> &importInterfaces) {
+    uint64_t hash = hashBytes(source);
+    for(const auto it : importInterfaces) {
+        hash = (hash ^ it) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::vector<ExportedDeclaration> collectExports(const Grammar::Statement *program) {
+    std::vector<ExportedDeclaration> exports;
+    auto list = dynamic_cast<const Grammar::StatementList*>(program);
+    if(!list) {
+        return exports;
+    }
+    for(const auto stmt : list->list) {
+        if(auto decl = dynamic_cast<const Grammar::DeclarationStatement*>(stmt)) {
+            exports.push_back({DeclarationKind::VARIABLE, decl->name, decl->type, {}});
+        } else if(auto function = dynamic_cast<const Grammar::FunctionDefinition*>(stmt)) {
+            ExportedDeclaration exported = {DeclarationKind::FUNCTION, function->name, function->returnType, {}};
+            for(const auto param : function->parameters) {
+                exported.parameterTypes.push_back(param->type);
+            }
+            exports.push_back(exported);
+        }
+    }
+    return exports;
+}
+
+std::vector<const Grammar::ImportStatement*> collectImports(const Grammar::Statement *program) {
+    std::vector<const Grammar::ImportStatement*> imports;
+    if(auto list = dynamic_cast<const Grammar::StatementList*>(program)) {
+        for(const auto stmt : list->list) {
+            if(auto import = dynamic_cast<const Grammar::ImportStatement*>(stmt)) {
+                imports.push_back(import);
+            }
+        }
+    }
+    return imports;
+}
+
+bool writeSummary(const std::string &path, std::vector<ExportedDeclaration> exports, const uint64_t inputHash, std::string &error) {
+    // Later declarations of a name shadow earlier ones
+    std::stable_sort(exports.begin(), exports.end(), [](const ExportedDeclaration &a, const ExportedDeclaration &b) { return a.name < b.name; });
+    std::vector<ExportedDeclaration> unique;
+    for(auto &it : exports) {
+        if(!unique.empty() && unique.back().name == it.name) {
+            unique.back() = std::move(it);
+        } else {
+            unique.push_back(std::move(it));
+        }
+    }
+
+    // Equal strings such as type names are stored once
+    std::string strings;
+    std::unordered_map<std::string, SummaryString> interned;
+    auto intern = [&](const std::string &value) {
+        auto found = interned.find(value);
+        if(found != interned.end()) {
+            return found->second;
+        }
+        SummaryString ref = {(uint32_t)strings.size(), (uint32_t)value.size()};
+        strings += value;
+        interned[value] = ref;
+        return ref;
+    };
+
+    std::vector<SummaryDeclaration> declarations;
+    std::vector<SummaryString> parameters;
+    for(const auto &it : unique) {
+        SummaryDeclaration decl;
+        decl.name = intern(it.name);
+        decl.type = intern(it.type);
+        decl.firstParameter = (uint32_t)parameters.size();
+        decl.arity = (uint16_t)it.parameterTypes.size();
+        decl.kind = it.kind;
+        decl.reserved = 0;
+        for(const auto &type : it.parameterTypes) {
+            parameters.push_back(intern(type));
+        }
+        declarations.push_back(decl);
+    }
+
+    SummaryHeader header;
+    std::memcpy(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC));
+    header.version = SUMMARY_VERSION;
+    header.inputHash = inputHash;
+    header.declarationCount = (uint32_t)declarations.size();
+    header.parameterCount = (uint32_t)parameters.size();
+    header.stringsSize = (uint32_t)strings.size();
+    header.reserved = 0;
+
+    // Write next to the target and rename, so readers never map a partial file. The partial file is removed
+    // when either fails, closing flushes it so a full disk is noticed before the rename.
+    const std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)declarations.data(), declarations.size() * sizeof(SummaryDeclaration));
+    file.write((const char*)parameters.data(), parameters.size() * sizeof(SummaryString));
+    file.write(strings.data(), strings.size());
+    file.close();
+    if(!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        error = "Cannot write module summary " + path;
+        return false;
+    }
+    return true;
+}
+
+/***********************Checking calls**********************/
+static void forEachCall(const Grammar::Expression *expr, const std::function<void(const Grammar::FunctionCall*)> &visit) {
+    if(auto binary = dynamic_cast<const Grammar::BinaryExpression*>(expr)) {
+        forEachCall(binary->left, visit);
+        forEachCall(binary->right, visit);
+    } else if(auto unary = dynamic_cast<const Grammar::UnaryExpression*>(expr)) {
+        forEachCall(unary->expr, visit);
+    } else if(auto index = dynamic_cast<const Grammar::IndexExpression*>(expr)) {
+        forEachCall(index->array, visit);
+        forEachCall(index->index, visit);
+    } else if(auto call = dynamic_cast<const Grammar::FunctionCall*>(expr)) {
+        visit(call);
+        for(const auto param : call->parameters) {
+            forEachCall(param, visit);
+        }
+    }
+}
+
+static void forEachCall(const Grammar::Statement *stmt, const std::function<void(const Grammar::FunctionCall*)> &visit) {
+    if(!stmt) {
+        return;
+    }
+    if(auto list = dynamic_cast<const Grammar::StatementList*>(stmt)) {
+        for(const auto it : list->list) {
+            forEachCall(it, visit);
+        }
+    } else if(auto exprStmt = dynamic_cast<const Grammar::ExpressionStatement*>(stmt)) {
+        forEachCall(exprStmt->expr, visit);
+    } else if(auto decl = dynamic_cast<const Grammar::DeclarationStatement*>(stmt)) {
+        if(decl->expr) {
+            forEachCall(decl->expr, visit);
+        }
+    } else if(auto ifStmt = dynamic_cast<const Grammar::IfStatement*>(stmt)) {
+        forEachCall(ifStmt->condition, visit);
+        forEachCall(ifStmt->ifBody, visit);
+        forEachCall(ifStmt->elseBody, visit);
+    } else if(auto whileStmt = dynamic_cast<const Grammar::WhileStatement*>(stmt)) {
+        forEachCall(whileStmt->condition, visit);
+        forEachCall(whileStmt->body, visit);
+    } else if(auto forStmt = dynamic_cast<const Grammar::ForStatement*>(stmt)) {
+        forEachCall(forStmt->init, visit);
+        forEachCall(forStmt->condition, visit);
+        forEachCall(forStmt->step, visit);
+        forEachCall(forStmt->body, visit);
+    } else if(auto ret = dynamic_cast<const Grammar::ReturnStatement*>(stmt)) {
+        if(ret->expr) {
+            forEachCall(ret->expr, visit);
+        }
+    } else if(auto function = dynamic_cast<const Grammar::FunctionDefinition*>(stmt)) {
+        forEachCall(function->body, visit);
+    }
+}
+
+std::vector<Lexing::Diagnostic> checkCalls(const Grammar::Statement *program, const std::vector<const ModuleSummary*> &imports) {
+    // Functions of the module itself take precedence over imported ones
+    std::unordered_map<std::string, size_t> localArity;
+    for(const auto &it : collectExports(program)) {
+        if(it.kind == DeclarationKind::FUNCTION) {
+            localArity[it.name] = it.parameterTypes.size();
+        }
+    }
+
+    std::vector<Lexing::Diagnostic> diagnostics;
+    forEachCall(program, [&](const Grammar::FunctionCall *call) {
+        size_t arity;
+        auto local = localArity.find(call->name);
+        if(local != localArity.end()) {
+            arity = local->second;
+        } else {
+            const SummaryDeclaration *imported = nullptr;
+            for(const auto summary : imports) {
+                if((imported = summary->find(call->name))) {
+                    break;
+                }
+            }
+            if(!imported || imported->kind != DeclarationKind::FUNCTION) {
+                return;
+            }
+            arity = imported->arity;
+        }
+        if(arity != call->parameters.size()) {
+            diagnostics.push_back(Lexing::Diagnostic::make(call->lineNmb, call->startPos,
+                "Function ", call->name, " expects ", arity, " arguments but was called with ", call->parameters.size(), "\n"));
+        }
+    });
+    return diagnostics;
+}
+
+};
@@ -0,0 +1,227 @@
+#pragma once
+#ifndef MODULE_SUMMARY_H
+#define MODULE_SUMMARY_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "Lexer.h"
+#include "Grammar.h"
+
+namespace Modules {
+
+/**
+ * @brief Kinds of declarations a module exports
+ * 
+ */
+enum DeclarationKind : uint8_t {
+    VARIABLE, FUNCTION
+};
+
+/**
+ * @brief Declaration exported by the top level statement list of a module
+ * 
+ */
+class ExportedDeclaration {
+public:
+    DeclarationKind kind;
+    std::string name;
+    std::string type;
+    std::vector<std::string> parameterTypes;
+};
+
+/**
+ * @brief Reference to a string in the string table of a summary file
+ * 
+ */
+class SummaryString {
+public:
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief Fixed size record of one declaration, records are sorted by name
+ * 
+ */
+class SummaryDeclaration {
+public:
+    SummaryString name;
+    SummaryString type;
+    uint32_t firstParameter;
+    uint16_t arity;
+    uint8_t kind;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Header of a summary file, which is followed by the declaration records, the parameter
+ * types of all functions and the string table. All fields are little endian.
+ * 
+ */
+class SummaryHeader {
+public:
+    char magic[4];
+    uint32_t version;
+    uint64_t inputHash;
+    uint32_t declarationCount;
+    uint32_t parameterCount;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SummaryString) == 8 && sizeof(SummaryDeclaration) == 24 && sizeof(SummaryHeader) == 32, "Summary records must not have padding");
+
+const char SUMMARY_MAGIC[4] = {'X', 'S', 'U', 'M'};
+const uint32_t SUMMARY_VERSION = 1;
+
+/**
+ * @brief Extension of summary files, which are searched next to the importing source
+ * 
+ */
+const std::string SUMMARY_EXTENSION = ".xsum";
+
+/**
+ * @brief Read only view of a memory mapped summary file
+ * 
+ */
+class ModuleSummary {
+private:
+    void *mapping;
+    size_t mappingSize;
+    const SummaryHeader *header;
+    const SummaryDeclaration *declarations;
+    const SummaryString *parameters;
+    const char *strings;
+
+    ModuleSummary();
+
+public:
+    /**
+     * @brief Map a summary file and check that all its records are in bounds
+     * 
+     * @param path Path of the summary
+     * @param error Reason of the failure
+     * @return ModuleSummary* Loaded summary or nullptr
+     */
+    static ModuleSummary *load(const std::string &path, std::string &error);
+
+    /**
+     * @brief Unmap the summary file
+     * 
+     */
+    ~ModuleSummary();
+
+    /**
+     * @brief Get the hash of the inputs the summary was written from
+     * 
+     * @return uint64_t Hash of the source and of the interfaces of its imports
+     */
+    uint64_t inputHash() const;
+
+    /**
+     * @brief Hash the exported declarations, which only changes when dependents have to be rebuilt
+     * 
+     * @return uint64_t Hash of everything after the header
+     */
+    uint64_t interfaceHash() const;
+
+    /**
+     * @brief Get the number of exported declarations
+     * 
+     * @return uint32_t Number of declarations
+     */
+    uint32_t declarationCount() const;
+
+    /**
+     * @brief Get a declaration record
+     * 
+     * @param index Index of the declaration in name order
+     * @return const SummaryDeclaration& Declaration record
+     */
+    const SummaryDeclaration &declaration(const uint32_t index) const;
+
+    /**
+     * @brief Binary search a declaration by name
+     * 
+     * @param name Name of the declaration
+     * @return const SummaryDeclaration* Declaration record or nullptr
+     */
+    const SummaryDeclaration *find(std::string_view name) const;
+
+    /**
+     * @brief Get the type of a function parameter
+     * 
+     * @param decl Function declaration
+     * @param index Index of the parameter
+     * @return std::string_view Parameter type
+     */
+    std::string_view parameterType(const SummaryDeclaration &decl, const uint32_t index) const;
+
+    /**
+     * @brief Get a string from the string table
+     * 
+     * @param ref Reference to the string
+     * @return std::string_view Referenced string
+     */
+    std::string_view string(const SummaryString &ref) const;
+};
+
+/**
+ * @brief FNV-1a hash of a byte buffer
+ * 
+ * @param data Bytes to hash
+ * @return uint64_t Hash value
+ */
+uint64_t hashBytes(std::string_view data);
+
+/**
+ * @brief Hash of a module source together with the interfaces it was checked against
+ * 
+ * @param source Source of the module
+ * @param importInterfaces Interface hashes of the imported modules in import order
+ * @return uint64_t Hash of the inputs
+ */
+uint64_t hashInputs(std::string_view source, const std::vector<uint64_t> &importInterfaces);
+
+/**
+ * @brief Collect the variables and functions declared by the top level statement list
+ * 
+ * @param program Root of the module
+ * @return std::vector<ExportedDeclaration> Exported declarations in source order
+ */
+std::vector<ExportedDeclaration> collectExports(const Grammar::Statement *program);
+
+/**
+ * @brief Collect the modules imported by the top level statement list
+ * 
+ * @param program Root of the module
+ * @return std::vector<const Grammar::ImportStatement*> Import statements in source order
+ */
+std::vector<const Grammar::ImportStatement*> collectImports(const Grammar::Statement *program);
+
+/**
+ * @brief Write a summary file
+ * 
+ * @param path Path of the summary
+ * @param exports Declarations to write
+ * @param inputHash Hash of the inputs of the module
+ * @param error Reason of the failure
+ * @return true if the summary was written and false otherwise
+ */
+bool writeSummary(const std::string &path, std::vector<ExportedDeclaration> exports, const uint64_t inputHash, std::string &error);
+
+/**
+ * @brief Check the calls of a module against the functions it defines and imports
+ * 
+ * @param program Root of the module
+ * @param imports Summaries of the imported modules
+ * @return std::vector<Lexing::Diagnostic> Calls with the wrong number of arguments
+ */
+std::vector<Lexing::Diagnostic> checkCalls(const Grammar::Statement *program, const std::vector<const ModuleSummary*> &imports);
+
+};
+
+#endif // MODULE_SUMMARY_H
@@ -1,5 +1,6 @@
 #include <vector>
 #include <stack>
+#include <iostream>
 
 #include "Lexer.h"
 #include "Grammar.h"
@@ -9,24 +10,39 @@ namespace Parsing {
 
 #define HARD_MATCH(tokenType) \
     if(!this->match(tokenType)) { \
-        ParserError("Unexpected token \n", this->peek(), "\n when expecting ", Lexing::TokenTypeName[tokenType], "\n"); \
+        ParserError(this->peek(), "Unexpected token \n", this->peek(), "\n when expecting ", Lexing::TokenTypeName[tokenType], "\n"); \
     }
 
-template <typename... T> 
-void ParserErrorPrint(T... t) {
-    (std::cerr << ... << t) << "\n";
-}
+ParserException::ParserException(const Lexing::Diagnostic &_diagnostic) : diagnostic(_diagnostic) {}
 
 template <typename... T> 
-void ParserError(T... t) {
-    std::cerr << "There was an error while parsing " << "\n";
-    ParserErrorPrint(t...);
-    exit(0);
+void ParserError(const Lexing::Token &at, T... t) {
+    throw ParserException(Lexing::Diagnostic::make(at.lineNmb, at.startPos, t...));
 }
 
-int32_t Parser::tabIdentation = 0;
+// Counts recognizers on the call stack for as long as it is alive
+class NestingGuard {
+public:
+    Parser &parser;
 
-Parser::Parser(const std::vector<Lexing::Token> &_tokens) : tokens(_tokens), codePtr(0) {}
+    NestingGuard(Parser &_parser) : parser(_parser) {
+        if(this->parser.nestingDepth >= MAX_NESTING_DEPTH) {
+            ParserError(this->parser.peek(), "Nesting deeper than ", MAX_NESTING_DEPTH, " levels \n");
+        }
+        this->parser.nestingDepth ++;
+    }
+    ~NestingGuard() {
+        this->parser.nestingDepth --;
+    }
+};
+
+// Slot of every stream holding the identation of the tree printed to it
+static int identationSlot() {
+    static const int slot = std::ios_base::xalloc();
+    return slot;
+}
+
+Parser::Parser(const std::vector<Lexing::Token> &_tokens) : tokens(_tokens), codePtr(0), nestingDepth(0), recordSpans(false) {}
 Parser::~Parser() {}
 
 Lexing::Token Parser::peek() const {
@@ -45,17 +61,27 @@ bool Parser::match(const Lexing::TokenType type) {
 }
 //TODO: Add hardmatch function or macro
 
+Grammar::Statement *Parser::recordSpan(Grammar::Statement *stmt, const int32_t begin) {
+    if(stmt) {
+        stmt->lineNmb = this->tokens[begin].lineNmb;
+    }
+    if(this->recordSpans) {
+        this->statementSpans[stmt] = {begin, this->codePtr};
+    }
+    return stmt;
+}
+
 bool Parser::isAtEnd() const {
     return this->peek().type == Lexing::TokenType::END_OF_FILE;
 }
 
-void Parser::addTabIdentation(const int32_t deltaTabs) {
-    Parser::tabIdentation += deltaTabs;
+void Parser::addTabIdentation(std::ostream &os, const int32_t deltaTabs) {
+    os.iword(identationSlot()) += deltaTabs;
 }
 
-std::string Parser::getTabIdentation() {
+std::string Parser::getTabIdentation(std::ostream &os) {
     std::string ret = "";
-    for(int32_t i = 0; i < Parser::tabIdentation; i ++) {
+    for(long i = 0; i < os.iword(identationSlot()); i ++) {
         ret += ",  ";
     }
     return ret;
@@ -64,175 +90,233 @@ std::string Parser::getTabIdentation() {
 Grammar::Expression *Parser::recognizeFunctionCall() {
     std::vector<Grammar::Expression*> parameters;
     // We know that the next character is a name;
-    std::string name = this->advance().lexeme;
+    Lexing::Token nameToken = this->advance();
+    std::string name = nameToken.lexeme;
 
     this->match(Lexing::TokenType::L_PAREN);
 
-    while(true) {
-        auto currentToken = this->peek();
+    try {
+        while(true) {
+            auto currentToken = this->peek();
 
-        if(currentToken.type == Lexing::TokenType::R_PAREN) {
-            this->advance();
-            // We have found the end of function call parsing.
-            break;
-        } else if(!isStartOfExpression(currentToken)) {
-            ParserError("Unexpected token in function call parameter parsing", "\n", currentToken, "\n");
-        } else /*Start of expression*/ {
-            parameters.push_back(this->recognizeExpression());
-            if(this->isAtEnd()) {
-                ParserError("Unexpected end of input", "\n");
-            }
-            if(this->match(Lexing::TokenType::COMMA)) {
-                // Everything is okay, we are expecting the next expression
-                continue;
-            } else if(this->match(Lexing::TokenType::R_PAREN)) {
+            if(currentToken.type == Lexing::TokenType::R_PAREN) {
+                this->advance();
                 // We have found the end of function call parsing.
                 break;
-            } else {
-                ParserError("Unexpected token in function call parameter separation: ", "\n", currentToken, "\n");
+            } else if(!isStartOfExpression(currentToken)) {
+                ParserError(currentToken, "Unexpected token in function call parameter parsing", "\n", currentToken, "\n");
+            } else /*Start of expression*/ {
+                parameters.push_back(this->recognizeExpression());
+                if(this->isAtEnd()) {
+                    ParserError(this->peek(), "Unexpected end of input", "\n");
+                }
+                if(this->match(Lexing::TokenType::COMMA)) {
+                    // Everything is okay, we are expecting the next expression
+                    continue;
+                } else if(this->match(Lexing::TokenType::R_PAREN)) {
+                    // We have found the end of function call parsing.
+                    break;
+                } else {
+                    ParserError(currentToken, "Unexpected token in function call parameter separation: ", "\n", currentToken, "\n");
+                }
             }
         }
-    }   
+    } catch(const ParserException &) {
+        for(auto it : parameters) {
+            delete it;
+        }
+        throw;
+    }
 
-    return new Grammar::FunctionCall(name, parameters);
+    Grammar::Expression *call = new Grammar::FunctionCall(name, parameters, nameToken.lineNmb, nameToken.startPos);
+    if(call->depth > MAX_EXPRESSION_DEPTH) {
+        delete call;
+        ParserError(this->peek(), "Expression deeper than ", MAX_EXPRESSION_DEPTH, " levels \n");
+    }
+    return call;
 }
 
 void Parser::combineTop(std::stack<Grammar::Expression* > &expStack, std::stack<Lexing::Token> &opStack) const {
     // TODO find a place for this function
     if(expStack.size() < 2 && opStack.size() < 1) {
-        ParserError("Not enough operators and operands to combine expressions in AST ", "\n");
+        ParserError(this->peek(), "Not enough operators and operands to combine expressions in AST ", "\n");
     }
     if(opStack.size() < 1) {
-        ParserError("Not enough operators in stack", "\n");
+        ParserError(this->peek(), "Not enough operators in stack", "\n");
     }
     auto op = opStack.top(); opStack.pop();
     if(Lexing::precedence[(int32_t)op.type] == -1) {
-        ParserError("Trying to combine top with ", op, "\n");
+        ParserError(this->peek(), "Trying to combine top with ", op, "\n");
     }
     if(Lexing::precedence[op.type] == 7) { // These are the unary operations TODO
         if(expStack.size() < 1) {
-            ParserError("Not enough operands for operator ", "\n", op, "\n");
+            ParserError(this->peek(), "Not enough operands for operator ", "\n", op, "\n");
         }
         Grammar::Expression *exp;
         exp = expStack.top(); expStack.pop();
         Grammar::Expression *now = new Grammar::UnaryExpression(op.type, exp);                 
         expStack.push(now);
+        if(now->depth > MAX_EXPRESSION_DEPTH) {
+            ParserError(this->peek(), "Expression deeper than ", MAX_EXPRESSION_DEPTH, " levels \n");
+        }
     } else {
         if(expStack.size() < 2) {
-            ParserError("Not enough operands for operator ", "\n", op, "\n");
+            ParserError(this->peek(), "Not enough operands for operator ", "\n", op, "\n");
         }
         Grammar::Expression *l, *r;
         l = expStack.top(); expStack.pop();
         r = expStack.top(); expStack.pop();
         Grammar::Expression *now = new Grammar::BinaryExpression(r, op.type, l);                 
         expStack.push(now);
+        if(now->depth > MAX_EXPRESSION_DEPTH) {
+            ParserError(this->peek(), "Expression deeper than ", MAX_EXPRESSION_DEPTH, " levels \n");
+        }
     }
 }
 
 Grammar::Expression *Parser::recognizeExpression() { 
+    NestingGuard guard(*this);
     std::stack<Grammar::Expression*> expStack; 
     std::stack<Lexing::Token> opStack; 
     bool canBeUnary = true;
     int32_t cntL_PAREN = 0; 
 
-    while(true) {
-        if(this->isAtEnd()) {
-            ParserError("Unexpected EOF, while parsing expression", "\n");
-        }
-        auto currentToken = this->peek();
-
-        if(isEndOfExpression(currentToken)) {
-            // Note codePtr shouldn't be advanced
-            break;
-        }
-
-        this->advance();
-
-        if(Lexing::precedence[(int32_t)currentToken.type] != -1) {
-            if(canBeUnary && canBeUnaryOperator(currentToken)) {
-                // We can and have to transform this operator token to its matching unary token
-                transformToMatchingUnary(currentToken);
+    try {
+        while(true) {
+            if(this->isAtEnd()) {
+                ParserError(this->peek(), "Unexpected EOF, while parsing expression", "\n");
             }
+            auto currentToken = this->peek();
 
-            // We pop all operators with Lexing::precedence less than the current
-            while(!opStack.empty() && opStack.top().type != Lexing::TokenType::L_PAREN
-                && ((Lexing::precedence[opStack.top().type] < Lexing::precedence[currentToken.type]) 
-                || (Lexing::precedence[opStack.top().type] == Lexing::precedence[currentToken.type] 
-                    && Lexing::precedence[currentToken.type] % 2 == 0))) { // Left associative
-                this->combineTop(expStack, opStack);
-            } 
-            opStack.push(currentToken);
-
-            // After a unary operator we can have another one, e.g. --x
-            canBeUnary = true;
-
-            // We have to continue, so we dont make canBeUnary to false;
-            continue; 
-        } else if(currentToken.type == Lexing::TokenType::L_PAREN) {
-            opStack.push(currentToken);
-        
-            // Number of nested L_PARENs should increase
-            cntL_PAREN ++;
-
-            // After a L_PAREN an unary operator can follow
-            canBeUnary = true;
-
-            // We have to continue, so we dont make canBeUnary to false;
-            continue; 
-        } else if(currentToken.type == Lexing::TokenType::R_PAREN) {
-            if(cntL_PAREN == 0) { // Same as separator case
-                // This has to be a function call R_PAREN, so we should break
-                this->codePtr --;
+            if(isEndOfExpression(currentToken)) {
+                // Note codePtr shouldn't be advanced
                 break;
             }
 
-            // Pop top of operation stack while we haven't found the matching L_PAREN
-            while(!opStack.empty() && opStack.top().type != Lexing::TokenType::L_PAREN) {
-                this->combineTop(expStack, opStack);
-            }
-
-            if(opStack.empty()) {
-                ParserError("No matching left paranthesis ", "\n");
-            }  
+            this->advance();
 
-            opStack.pop();
+            if(Lexing::precedence[(int32_t)currentToken.type] != -1) {
+                if(canBeUnary && canBeUnaryOperator(currentToken)) {
+                    // We can and have to transform this operator token to its matching unary token
+                    transformToMatchingUnary(currentToken);
+                }
+
+                // We pop all operators with Lexing::precedence less than the current
+                while(!opStack.empty() && opStack.top().type != Lexing::TokenType::L_PAREN
+                    && ((Lexing::precedence[opStack.top().type] < Lexing::precedence[currentToken.type]) 
+                    || (Lexing::precedence[opStack.top().type] == Lexing::precedence[currentToken.type] 
+                        && Lexing::precedence[currentToken.type] % 2 == 0))) { // Left associative
+                    this->combineTop(expStack, opStack);
+                } 
+                opStack.push(currentToken);
+
+                // After a unary operator we can have another one, e.g. --x
+                canBeUnary = true;
+
+                // We have to continue, so we dont make canBeUnary to false;
+                continue; 
+            } else if(currentToken.type == Lexing::TokenType::L_PAREN) {
+                opStack.push(currentToken);
+        
+                // Number of nested L_PARENs should increase
+                cntL_PAREN ++;
+
+                // After a L_PAREN an unary operator can follow
+                canBeUnary = true;
+
+                // We have to continue, so we dont make canBeUnary to false;
+                continue; 
+            } else if(currentToken.type == Lexing::TokenType::R_PAREN) {
+                if(cntL_PAREN == 0) { // Same as separator case
+                    // This has to be a function call R_PAREN, so we should break
+                    this->codePtr --;
+                    break;
+                }
+
+                // Pop top of operation stack while we haven't found the matching L_PAREN
+                while(!opStack.empty() && opStack.top().type != Lexing::TokenType::L_PAREN) {
+                    this->combineTop(expStack, opStack);
+                }
+
+                if(opStack.empty()) {
+                    ParserError(this->peek(), "No matching left paranthesis ", "\n");
+                }  
+
+                opStack.pop();
             
-            // Number of nested L_PARENs should decrease
-            cntL_PAREN --;
-        } else if(currentToken.type >= Lexing::TokenType::CHARACTER && currentToken.type < Lexing::TokenType::STRING) {
-            expStack.push(new Grammar::LiteralExpression(currentToken));
-        } else if(currentToken.type == Lexing::TokenType::NAME) {
-            if(!this->isAtEnd() && this->peek().type == Lexing::TokenType::L_PAREN) {
-                // If this is a function call;
-                this->codePtr --;
-                Grammar::Expression *now = this->recognizeFunctionCall();
-                expStack.push(now);
-            } else {
-                // Else if it is a variable name
+                // Number of nested L_PARENs should decrease
+                cntL_PAREN --;
+            } else if(currentToken.type >= Lexing::TokenType::CHARACTER && currentToken.type <= Lexing::TokenType::STRING) {
                 expStack.push(new Grammar::LiteralExpression(currentToken));
+            } else if(currentToken.type == Lexing::TokenType::NAME) {
+                if(!this->isAtEnd() && this->peek().type == Lexing::TokenType::L_PAREN) {
+                    // If this is a function call;
+                    this->codePtr --;
+                    Grammar::Expression *now = this->recognizeFunctionCall();
+                    expStack.push(now);
+                } else if(this->match(Lexing::TokenType::L_SQUARE_BRACKET)) {
+                    // An element of an array
+                    Grammar::Expression *array = new Grammar::LiteralExpression(currentToken);
+                    Grammar::Expression *index = nullptr;
+                    try {
+                        index = this->recognizeExpression();
+                        HARD_MATCH(Lexing::TokenType::R_SQUARE_BRACKET);
+                    } catch(const ParserException &) {
+                        delete array;
+                        delete index;
+                        throw;
+                    }
+                    expStack.push(new Grammar::IndexExpression(array, index));
+                } else {
+                    // Else if it is a variable name
+                    expStack.push(new Grammar::LiteralExpression(currentToken));
+                }
+            } else {
+                ParserError(currentToken, "Unexpected token in expression parsing: ", Lexing::TokenTypeName[currentToken.type], "\n");
             }
-        } else {
-            ParserError("Unexpected token in expression parsing: ", Lexing::TokenTypeName[currentToken.type], "\n");
+
+            // Next operator cannot be unary
+            canBeUnary = false;
         }
 
-        // Next operator cannot be unary
-        canBeUnary = false;
+        // Pop all operations from the stack
+        while(!opStack.empty()) {
+            this->combineTop(expStack, opStack);
+        }
+    
+        if(expStack.size() > 1) {
+            // If there are too many expressions in the stack
+            ParserError(this->peek(), "Not enough operators in stack. \n"); 
+        }
+        if(expStack.size() == 0) {
+            // If there is no expression in the stack
+            ParserError(this->peek(), "Empty expression. \n");
+        }
+        return expStack.top();
+    } catch(const ParserException &) {
+        // Free the operands recognized so far
+        while(!expStack.empty()) {
+            delete expStack.top();
+            expStack.pop();
+        }
+        throw;
     }
+}
 
-    // Pop all operations from the stack
-    while(!opStack.empty()) {
-        this->combineTop(expStack, opStack);
-    }
-    
-    if(expStack.size() > 1) {
-        // If there are too many expressions in the stack
-        ParserError("Not enough operators in stack. \n"); 
+std::string Parser::recognizeType() {
+    if(this->peek().type != Lexing::TokenType::NAME) {
+        ParserError(this->peek(), "Unexpected token \n", this->peek(), "when expecting type ");
     }
-    if(expStack.size() == 0) {
-        // If there is no expression in the stack
-        ParserError("Empty expression. \n");
+    std::string type = this->advance().lexeme;
+    if(this->match(Lexing::TokenType::L_SQUARE_BRACKET)) {
+        type += "[";
+        if(this->peek().type == Lexing::TokenType::NUMBER) {
+            type += this->advance().lexeme;
+        }
+        HARD_MATCH(Lexing::TokenType::R_SQUARE_BRACKET);
+        type += "]";
     }
-    return expStack.top();
+    return type;
 }
 
 Grammar::Statement *Parser::recognizeDeclarationStatement() {
@@ -242,15 +326,16 @@ Grammar::Statement *Parser::recognizeDeclarationStatement() {
     Grammar::Expression *expr = nullptr;
 
     if(this->peek().type != Lexing::TokenType::NAME) {
-        ParserError("Unexpected token in variable declaration \n", this->peek(), "when expecting variable name ");
+        ParserError(this->peek(), "Unexpected token in variable declaration \n", this->peek(), "when expecting variable name ");
     } 
-    name = this->advance().lexeme;
+    const Lexing::Token nameToken = this->advance();
+    name = nameToken.lexeme;
 
     if(this->match(Lexing::TokenType::COLON)) {
         if(this->peek().type != Lexing::TokenType::NAME) {
-            ParserError("Unexpected token in variable declaration \n", this->peek(), "when expecting variable type ");
+            ParserError(this->peek(), "Unexpected token in variable declaration \n", this->peek(), "when expecting variable type ");
         } 
-        type = this->advance().lexeme;        
+        type = this->recognizeType();
 
         if(isSeparatorToken(this->peek())) {
             // All is good we are ready to return to continue
@@ -259,21 +344,31 @@ Grammar::Statement *Parser::recognizeDeclarationStatement() {
             HARD_MATCH(Lexing::TokenType::EQUAL);
             expr = this->recognizeExpression();
             if(!isSeparatorToken(this->peek())) {
-                ParserError("Unexpected token in variable declaration \n", this->peek(), "when expecting variable declaration termination");
+                delete expr;
+                ParserError(this->peek(), "Unexpected token in variable declaration \n", this->peek(), "when expecting variable declaration termination");
             }
             this->advance();
         }
     } else {
-        ParserError("TODO - variable declaration cannot deduce variable type from expression type");
+        ParserError(this->peek(), "TODO - variable declaration cannot deduce variable type from expression type");
     }
 
-    return new Grammar::DeclarationStatement(name, type, expr);
+    return new Grammar::DeclarationStatement(name, type, expr, nameToken.lineNmb, nameToken.startPos);
 }
 
 Grammar::Statement *Parser::recognizeExpressionStatement() {
-    Grammar::Expression *expr = this->recognizeExpression();
-
-    HARD_MATCH(Lexing::TokenType::SEMICOLON);
+    Grammar::Expression *expr = nullptr;
+    try {
+        expr = this->recognizeExpression();
+
+        HARD_MATCH(Lexing::TokenType::SEMICOLON);
+    } catch(const ParserException &exception) {
+        // Report the error and continue with the next statement
+        delete expr;
+        this->diagnostics.push_back(exception.diagnostic);
+        this->synchronize();
+        return nullptr;
+    }
 
     return new Grammar::ExpressionStatement(expr);
 }
@@ -282,20 +377,203 @@ Grammar::Statement *Parser::recognizeIfStatement() {
     HARD_MATCH(Lexing::TokenType::IF);
     // Recognize condition
     Grammar::Expression *condition = this->recognizeExpression();
-    // Recognize if-body
-    Grammar::Statement *ifBody = this->recognizeStatementList();
+    Grammar::Statement *ifBody = nullptr;
     Grammar::Statement *elseBody = nullptr;
 
-    if(this->match(Lexing::TokenType::ELSE)) {
-        elseBody = this->recognizeStatement();
+    try {
+        // Recognize if-body
+        ifBody = this->recognizeStatementList();
+
+        if(this->match(Lexing::TokenType::ELSE)) {
+            elseBody = this->recognizeStatement();
+        }
+    } catch(const ParserException &) {
+        delete condition;
+        delete ifBody;
+        throw;
     }
 
     return new Grammar::IfStatement(condition, ifBody, elseBody);
 }
 
+Grammar::Statement *Parser::recognizeWhileStatement() {
+    HARD_MATCH(Lexing::TokenType::WHILE);
+    Grammar::Expression *condition = this->recognizeExpression();
+    Grammar::Statement *body = nullptr;
+
+    try {
+        body = this->recognizeStatementList();
+    } catch(const ParserException &) {
+        delete condition;
+        throw;
+    }
+
+    return new Grammar::WhileStatement(condition, body);
+}
+
+Grammar::Statement *Parser::recognizeForStatement() {
+    HARD_MATCH(Lexing::TokenType::FOR);
+    Grammar::Statement *init = nullptr;
+    Grammar::Expression *condition = nullptr;
+    Grammar::Expression *step = nullptr;
+    Grammar::Statement *body = nullptr;
+
+    try {
+        if(this->peek().type == Lexing::TokenType::VAR) {
+            init = this->recognizeDeclarationStatement();
+        } else if(!this->match(Lexing::TokenType::SEMICOLON)) {
+            init = new Grammar::ExpressionStatement(this->recognizeExpression());
+            HARD_MATCH(Lexing::TokenType::SEMICOLON);
+        }
+
+        if(!this->match(Lexing::TokenType::SEMICOLON)) {
+            condition = this->recognizeExpression();
+            HARD_MATCH(Lexing::TokenType::SEMICOLON);
+        }
+
+        // The step ends where the body starts
+        if(!isStartOfStatementList(this->peek())) {
+            step = this->recognizeExpression();
+        }
+
+        body = this->recognizeStatementList();
+    } catch(const ParserException &) {
+        delete init;
+        delete condition;
+        delete step;
+        throw;
+    }
+
+    return new Grammar::ForStatement(init, condition, step, body);
+}
+
+Grammar::Statement *Parser::recognizeFunctionDefinition() {
+    HARD_MATCH(Lexing::TokenType::FUNCTION);
+    if(this->peek().type != Lexing::TokenType::NAME) {
+        ParserError(this->peek(), "Unexpected token in function definition \n", this->peek(), "when expecting function name ");
+    }
+    const Lexing::Token nameToken = this->advance();
+    const std::string name = nameToken.lexeme;
+    std::vector<Grammar::DeclarationStatement*> parameters;
+    std::string returnType = "";
+    Grammar::Statement *body = nullptr;
+
+    try {
+        HARD_MATCH(Lexing::TokenType::L_PAREN);
+        while(!this->match(Lexing::TokenType::R_PAREN)) {
+            if(!parameters.empty()) {
+                HARD_MATCH(Lexing::TokenType::COMMA);
+            }
+            // Parameters are written as declarations without let and initializer
+            if(this->peek().type != Lexing::TokenType::NAME) {
+                ParserError(this->peek(), "Unexpected token in function definition \n", this->peek(), "when expecting parameter name ");
+            }
+            const Lexing::Token parameterName = this->advance();
+            HARD_MATCH(Lexing::TokenType::COLON);
+            if(this->peek().type != Lexing::TokenType::NAME) {
+                ParserError(this->peek(), "Unexpected token in function definition \n", this->peek(), "when expecting parameter type ");
+            }
+            parameters.push_back(new Grammar::DeclarationStatement(parameterName.lexeme, this->recognizeType(), nullptr, parameterName.lineNmb, parameterName.startPos));
+        }
+
+        if(this->match(Lexing::TokenType::COLON)) {
+            if(this->peek().type != Lexing::TokenType::NAME) {
+                ParserError(this->peek(), "Unexpected token in function definition \n", this->peek(), "when expecting return type ");
+            }
+            returnType = this->advance().lexeme;
+        }
+
+        body = this->recognizeStatementList();
+    } catch(const ParserException &) {
+        for(auto it : parameters) {
+            delete it;
+        }
+        throw;
+    }
+
+    return new Grammar::FunctionDefinition(name, parameters, returnType, body, nameToken.lineNmb, nameToken.startPos);
+}
+
+Grammar::Statement *Parser::recognizeClassDefinition() {
+    HARD_MATCH(Lexing::TokenType::CLASS);
+    if(this->peek().type != Lexing::TokenType::NAME) {
+        ParserError(this->peek(), "Unexpected token in class definition \n", this->peek(), "when expecting class name ");
+    }
+    const Lexing::Token nameToken = this->advance();
+    const std::string name = nameToken.lexeme;
+    std::vector<Grammar::DeclarationStatement*> fields;
+    std::vector<std::string> attributes;
+
+    try {
+        if(this->match(Lexing::TokenType::L_SQUARE_BRACKET)) {
+            while(!this->match(Lexing::TokenType::R_SQUARE_BRACKET)) {
+                if(!attributes.empty()) {
+                    HARD_MATCH(Lexing::TokenType::COMMA);
+                }
+                if(this->peek().type != Lexing::TokenType::NAME) {
+                    ParserError(this->peek(), "Unexpected token in class definition \n", this->peek(), "when expecting class attribute ");
+                }
+                attributes.push_back(this->advance().lexeme);
+            }
+        }
+
+        HARD_MATCH(Lexing::TokenType::L_BRACE);
+        while(!this->match(Lexing::TokenType::R_BRACE)) {
+            // Fields are written as parameters, each one ended by a semicolon
+            if(this->peek().type != Lexing::TokenType::NAME) {
+                ParserError(this->peek(), "Unexpected token in class definition \n", this->peek(), "when expecting field name ");
+            }
+            const Lexing::Token fieldName = this->advance();
+            HARD_MATCH(Lexing::TokenType::COLON);
+            if(this->peek().type != Lexing::TokenType::NAME) {
+                ParserError(this->peek(), "Unexpected token in class definition \n", this->peek(), "when expecting field type ");
+            }
+            fields.push_back(new Grammar::DeclarationStatement(fieldName.lexeme, this->recognizeType(), nullptr, fieldName.lineNmb, fieldName.startPos));
+            HARD_MATCH(Lexing::TokenType::SEMICOLON);
+        }
+    } catch(const ParserException &) {
+        for(auto it : fields) {
+            delete it;
+        }
+        throw;
+    }
+
+    return new Grammar::ClassDefinition(name, fields, attributes, nameToken.lineNmb, nameToken.startPos);
+}
+
+Grammar::Statement *Parser::recognizeReturnStatement() {
+    HARD_MATCH(Lexing::TokenType::RETURN);
+    if(this->match(Lexing::TokenType::SEMICOLON)) {
+        return new Grammar::ReturnStatement();
+    }
+
+    Grammar::Expression *expr = this->recognizeExpression();
+    if(!this->match(Lexing::TokenType::SEMICOLON)) {
+        delete expr;
+        ParserError(this->peek(), "Unexpected token \n", this->peek(), "\n when expecting ", Lexing::TokenTypeName[Lexing::TokenType::SEMICOLON], "\n");
+    }
+    return new Grammar::ReturnStatement(expr);
+}
+
+Grammar::Statement *Parser::recognizeImportStatement() {
+    HARD_MATCH(Lexing::TokenType::IMPORT);
+    if(this->peek().type != Lexing::TokenType::NAME) {
+        ParserError(this->peek(), "Unexpected token in import \n", this->peek(), "when expecting module name ");
+    }
+    const Lexing::Token &moduleToken = this->advance();
+    HARD_MATCH(Lexing::TokenType::SEMICOLON);
+    return new Grammar::ImportStatement(moduleToken.lexeme, moduleToken.lineNmb, moduleToken.startPos);
+}
+
 Grammar::Statement *Parser::recognizeStatementList() {
+    const int32_t begin = this->codePtr;
     if(this->match(Lexing::TokenType::DO)) {
-        return new Grammar::StatementList({this->recognizeStatement()});
+        Grammar::Statement *stmt = this->recognizeStatement();
+        if(!stmt) {
+            // The statement had errors which were already reported
+            return this->recordSpan(new Grammar::StatementList(), begin);
+        }
+        return this->recordSpan(new Grammar::StatementList({stmt}), begin);
     }
 
     HARD_MATCH(Lexing::TokenType::L_BRACE);
@@ -304,46 +582,110 @@ Grammar::Statement *Parser::recognizeStatementList() {
 
     while(true) {
         if(this->isAtEnd()) {
-            ParserError("Unexpected EOF, while parsing statement list \n");
+            // Keep what was recognized so far
+            this->diagnostics.push_back(Lexing::Diagnostic::make(this->peek().lineNmb, this->peek().startPos, "Unexpected EOF, while parsing statement list \n"));
+            break;
         }
-        Lexing::Token currentToken = this->peek();
 
         if(this->match(Lexing::TokenType::R_BRACE)) {
             // If we can match } we should exit and advance
             break;
-        } else {
-            list.push_back(this->recognizeStatement());
+        }
+
+        try {
+            Grammar::Statement *stmt = this->recognizeStatement();
+            if(stmt) {
+                list.push_back(stmt);
+            }
+        } catch(const ParserException &exception) {
+            // Drop the statement, report the error and continue with the next one
+            this->diagnostics.push_back(exception.diagnostic);
+            this->synchronize();
         }
     }
 
-    return new Grammar::StatementList(list);
+    return this->recordSpan(new Grammar::StatementList(list), begin);
+}
+
+Grammar::Statement *Parser::recognizeProgram() {
+    Grammar::Statement *program = nullptr;
+    try {
+        program = this->recognizeStatementList();
+    } catch(const ParserException &exception) {
+        this->diagnostics.push_back(exception.diagnostic);
+        return new Grammar::StatementList();
+    }
+    if(!this->isAtEnd()) {
+        this->diagnostics.push_back(Lexing::Diagnostic::make(this->peek().lineNmb, this->peek().startPos,
+            "Unexpected token after the end of the program \n", this->peek()));
+    }
+    return program;
 }
 
 Grammar::Statement *Parser::recognizeStatement() {
+    NestingGuard guard(*this);
     if(this->isAtEnd()) {
-        ParserError("Unexpected EOF, while parsing statement \n");
+        ParserError(this->peek(), "Unexpected EOF, while parsing statement \n");
     }
+    const int32_t begin = this->codePtr;
     Lexing::Token currentToken = this->peek();
     if(currentToken.type == Lexing::TokenType::IF) {
         // We have to recognize if
-        return this->recognizeIfStatement();
+        return this->recordSpan(this->recognizeIfStatement(), begin);
+    } else if(currentToken.type == Lexing::TokenType::WHILE) {
+        return this->recordSpan(this->recognizeWhileStatement(), begin);
+    } else if(currentToken.type == Lexing::TokenType::FOR) {
+        return this->recordSpan(this->recognizeForStatement(), begin);
     } else if(currentToken.type == Lexing::TokenType::VAR) {
-        return this->recognizeDeclarationStatement();
+        return this->recordSpan(this->recognizeDeclarationStatement(), begin);
+    } else if(currentToken.type == Lexing::TokenType::FUNCTION) {
+        return this->recordSpan(this->recognizeFunctionDefinition(), begin);
+    } else if(currentToken.type == Lexing::TokenType::CLASS) {
+        return this->recordSpan(this->recognizeClassDefinition(), begin);
+    } else if(currentToken.type == Lexing::TokenType::RETURN) {
+        return this->recordSpan(this->recognizeReturnStatement(), begin);
+    } else if(currentToken.type == Lexing::TokenType::IMPORT) {
+        return this->recordSpan(this->recognizeImportStatement(), begin);
     } else if(isStartOfStatementList(currentToken)) {
         return this->recognizeStatementList();
     } else {
         if(!isStartOfExpression(currentToken)) {
             // We are expecting an expression, but this is not the start of one
-            ParserError("Unexpected token \n", currentToken, "\n while expecting start of expression \n");
+            ParserError(this->peek(), "Unexpected token \n", currentToken, "\n while expecting start of expression \n");
             return nullptr;
         } else {
             // We need to recognize the expression
-            return this->recognizeExpressionStatement();
+            return this->recordSpan(this->recognizeExpressionStatement(), begin);
         }
     }
     return nullptr;
 }
 
+void Parser::synchronize() {
+    int32_t depth = 0;
+    while(!this->isAtEnd()) {
+        Lexing::TokenType type = this->peek().type;
+        if(type == Lexing::TokenType::SEMICOLON && depth == 0) {
+            this->advance();
+            return;
+        } else if(type == Lexing::TokenType::L_BRACE) {
+            depth ++;
+        } else if(type == Lexing::TokenType::R_BRACE) {
+            if(depth == 0) {
+                // This closes the statement list we are recovering in
+                return;
+            }
+            depth --;
+            if(depth == 0) {
+                // A nested block ends the broken statement
+                this->advance();
+                return;
+            }
+        }
+        this->advance();
+    }
+}
+
 bool isSeparatorToken(const Lexing::Token &token) {
     return token.type == Lexing::TokenType::COMMA || token.type == Lexing::TokenType::SEMICOLON;
 }
@@ -355,7 +697,8 @@ bool isStartOfExpression(const Lexing::Token &token) {
 }
 
 bool isEndOfExpression(const Lexing::Token &token) {
-    return isSeparatorToken(token) || token.type == Lexing::TokenType::L_BRACE || token.type == Lexing::TokenType::DO;
+    return isSeparatorToken(token) || token.type == Lexing::TokenType::L_BRACE || token.type == Lexing::TokenType::DO
+        || token.type == Lexing::TokenType::R_SQUARE_BRACKET;
 }
 
 bool isStartOfStatementList(const Lexing::Token &token) {
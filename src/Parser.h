@@ -4,6 +4,8 @@
 
 #include <vector>
 #include <stack>
+#include <utility>
+#include <unordered_map>
 #include "Lexer.h"
 
 #include "Grammar.h"
@@ -11,12 +13,36 @@
 namespace Parsing {
 
 /**
- * @brief Print the parameters given and exit
+ * @brief Maximal number of nested statements and expressions, deeper input is reported instead of exhausting the stack
  * 
+ */
+const int32_t MAX_NESTING_DEPTH = 256;
+
+/**
+ * @brief Maximal height of an expression tree
+ * 
+ */
+const int32_t MAX_EXPRESSION_DEPTH = 1024;
+
+/**
+ * @brief Thrown when a construct cannot be recognized, caught at the nearest synchronization point
+ * 
+ */
+class ParserException {
+public:
+    Lexing::Diagnostic diagnostic;
+
+    ParserException(const Lexing::Diagnostic &_diagnostic);
+};
+
+/**
+ * @brief Throw a ParserException with the parameters given as message
+ * 
+ * @param at Token at which the error was found
  * @param T 
  */
 template <typename... T> 
-void ParserError(T... t);
+[[noreturn]] void ParserError(const Lexing::Token &at, T... t);
 
 /**
  * @brief Parser class which generates AST from the input Tokens
@@ -36,6 +62,45 @@ public:
      * 
      */
     int32_t codePtr;
+
+    /**
+     * @brief Number of statements and expressions currently being recognized
+     * 
+     */
+    int32_t nestingDepth;
+
+    /**
+     * @brief Whether statementSpans should be filled while parsing
+     * 
+     */
+    bool recordSpans;
+
+    /**
+     * @brief Token range [first, second) of every recognized statement
+     * 
+     */
+    std::unordered_map<const Grammar::Statement*, std::pair<int32_t, int32_t> > statementSpans;
+
+    /**
+     * @brief Errors recovered from while parsing
+     * 
+     */
+    std::vector<Lexing::Diagnostic> diagnostics;
+
+    /**
+     * @brief Skip tokens until after the next ; or before the next } which closes the current statement list
+     * 
+     */
+    void synchronize();
+
+    /**
+     * @brief Set the line of a statement and remember the tokens it was recognized from if recordSpans is set
+     * 
+     * @param stmt Recognized statement
+     * @param begin Index of the first token of the statement
+     * @return Grammar::Statement* The same statement
+     */
+    Grammar::Statement *recordSpan(Grammar::Statement *stmt, const int32_t begin);
     
     /**
      * @brief Look at next token in code
@@ -96,10 +161,18 @@ public:
      */
     Grammar::Expression *recognizeFunctionCall();
 
+    /**
+     * @brief Recognize a type name, an array type is followed by its length in square brackets which
+     * is left out for parameters
+     * 
+     * @return std::string Recognized type, e.g. int or int[8]
+     */
+    std::string recognizeType();
+
     /**
      * @brief Recognize expression statement starting from the parser pointer
      * 
-     * @return Grammar::Statement* Recognized statement
+     * @return Grammar::Statement* Recognized statement or nullptr if the expression had errors
      */
     Grammar::Statement *recognizeExpressionStatement();
 
@@ -117,6 +190,49 @@ public:
      */
     Grammar::Statement *recognizeIfStatement();
 
+    /**
+     * @brief Recognize while statement starting from the parser pointer
+     * 
+     * @return Grammar::Statement* Recognized while statement
+     */
+    Grammar::Statement *recognizeWhileStatement();
+
+    /**
+     * @brief Recognize for statement starting from the parser pointer, its header is
+     * init; condition; step without parentheses and every part may be left out
+     * 
+     * @return Grammar::Statement* Recognized for statement
+     */
+    Grammar::Statement *recognizeForStatement();
+
+    /**
+     * @brief Recognize function definition starting from the parser pointer
+     * 
+     * @return Grammar::Statement* Recognized function definition
+     */
+    Grammar::Statement *recognizeFunctionDefinition();
+
+    /**
+     * @brief Recognize class definition starting from the parser pointer
+     * 
+     * @return Grammar::Statement* Recognized class definition
+     */
+    Grammar::Statement *recognizeClassDefinition();
+
+    /**
+     * @brief Recognize return statement starting from the parser pointer
+     * 
+     * @return Grammar::Statement* Recognized return statement
+     */
+    Grammar::Statement *recognizeReturnStatement();
+
+    /**
+     * @brief Recognize import statement starting from the parser pointer
+     * 
+     * @return Grammar::Statement* Recognized import statement
+     */
+    Grammar::Statement *recognizeImportStatement();
+
     /**
      * @brief Recognize statement list starting from the parser pointer starting with a L_BRACE and ending at a R_BRACE
      * 
@@ -124,6 +240,13 @@ public:
      */
     Grammar::Statement *recognizeStatementList();
 
+    /**
+     * @brief Recognize the statement list of a whole program, errors are collected in diagnostics
+     * 
+     * @return Grammar::Statement* Recognized statement list, partial if there were errors
+     */
+    Grammar::Statement *recognizeProgram();
+
     /**
      * @brief Recognize statement - this is the general statement recognition
      *  
@@ -132,26 +255,22 @@ public:
     Grammar::Statement *recognizeStatement();
 
 public:
-    // TODO: move to a different location
-    /**
-     * @brief Tab identation of the current recursive printing of expression
-     * 
-     */
-    static int32_t tabIdentation;
-
     /**
-     * @brief Change tab identation
+     * @brief Change the tab identation of the tree printed to a stream. The identation is kept by the
+     * stream, so trees printed to different streams at once do not share it.
      * 
+     * @param os Stream the tree is printed to
      * @param deltaTabs Amount of tab identation to add
      */
-    static void addTabIdentation(const int32_t deltaTabs = 0);
+    static void addTabIdentation(std::ostream &os, const int32_t deltaTabs = 0);
 
     /**
-     * @brief Get the Tab Identation value
+     * @brief Get the Tab Identation value of a stream
      * 
+     * @param os Stream the tree is printed to
      * @return std::string Tab Identation string
      */
-    static std::string getTabIdentation();
+    static std::string getTabIdentation(std::ostream &os);
 
     /**
      * @brief Construct a new Parser object
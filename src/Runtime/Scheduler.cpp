@@ -0,0 +1,212 @@
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <exception>
+#include <coroutine>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "Scheduler.h"
+
+namespace Runtime {
+
+Task Task::promise_type::get_return_object() {
+    return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+// Scripts report their errors as values, an exception escaping a task is a bug of the host
+void Task::promise_type::unhandled_exception() {
+    std::terminate();
+}
+
+Task::Task(const std::coroutine_handle<promise_type> _handle) : handle(_handle) {}
+
+Task::Task(Task &&other) : handle(other.handle) {
+    other.handle = nullptr;
+}
+
+Task::~Task() {
+    if(this->handle) {
+        this->handle.destroy();
+    }
+}
+
+Waiter::Waiter(EventLoop &_loop, const int _fd) : loop(_loop), fd(_fd), result(0) {}
+
+ReadCall::ReadCall(EventLoop &_loop, const int _fd, void *_buffer, const size_t _size)
+    : Waiter(_loop, _fd), buffer(_buffer), size(_size) {}
+
+bool ReadCall::attempt() {
+    while(true) {
+        const ssize_t count = ::read(this->fd, this->buffer, this->size);
+        if(count >= 0) {
+            this->result = count;
+            return true;
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+        } else if(errno != EINTR) {
+            this->result = -errno;
+            return true;
+        }
+    }
+}
+
+bool ReadCall::await_ready() {
+    return this->attempt();
+}
+
+void ReadCall::await_suspend(std::coroutine_handle<> _handle) {
+    this->handle = _handle;
+    this->loop.park(*this, true);
+}
+
+WriteCall::WriteCall(EventLoop &_loop, const int _fd, const void *_data, const size_t _size)
+    : Waiter(_loop, _fd), data(_data), size(_size) {}
+
+bool WriteCall::attempt() {
+    while((size_t)this->result < this->size) {
+        const ssize_t count = ::write(this->fd, (const char*)this->data + this->result, this->size - this->result);
+        if(count >= 0) {
+            this->result += count;
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+        } else if(errno != EINTR) {
+            this->result = -errno;
+            return true;
+        }
+    }
+    return true;
+}
+
+bool WriteCall::await_ready() {
+    return this->attempt();
+}
+
+void WriteCall::await_suspend(std::coroutine_handle<> _handle) {
+    this->handle = _handle;
+    this->loop.park(*this, false);
+}
+
+EventLoop::EventLoop() : epollFd(epoll_create1(EPOLL_CLOEXEC)), tasks(0), parked(0) {}
+
+EventLoop::~EventLoop() {
+    // Tasks which did not finish are suspended at their start or in an I/O call
+    for(auto it : this->ready) {
+        it.destroy();
+    }
+    for(auto &it : this->watches) {
+        for(auto waiter : it.second.readers) {
+            waiter->handle.destroy();
+        }
+        for(auto waiter : it.second.writers) {
+            waiter->handle.destroy();
+        }
+    }
+    if(this->epollFd >= 0) {
+        ::close(this->epollFd);
+    }
+}
+
+void EventLoop::spawn(Task task) {
+    this->ready.push_back(task.handle);
+    task.handle = nullptr;
+    this->tasks ++;
+    this->stats.spawned ++;
+    this->stats.peakTasks = std::max(this->stats.peakTasks, this->tasks);
+}
+
+void EventLoop::park(Waiter &waiter, const bool reading) {
+    auto found = this->watches.find(waiter.fd);
+    if(found == this->watches.end()) {
+        // A descriptor the loop watches stays registered for both directions until it is closed
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = waiter.fd;
+        if(epoll_ctl(this->epollFd, EPOLL_CTL_ADD, waiter.fd, &event) != 0) {
+            waiter.result = -errno;
+            this->ready.push_back(waiter.handle);
+            return;
+        }
+        found = this->watches.emplace(waiter.fd, Watch()).first;
+    }
+    (reading ? found->second.readers : found->second.writers).push_back(&waiter);
+    this->parked ++;
+    this->stats.suspensions ++;
+}
+
+// Calls are retried in the order they suspended until one still has to wait, edge triggered readiness is
+// only reported again once the descriptor stopped being ready
+void EventLoop::retry(std::deque<Waiter*> &waiters) {
+    while(!waiters.empty() && waiters.front()->attempt()) {
+        this->ready.push_back(waiters.front()->handle);
+        waiters.pop_front();
+        this->parked --;
+    }
+}
+
+void EventLoop::close(const int fd) {
+    auto found = this->watches.find(fd);
+    if(found != this->watches.end()) {
+        epoll_ctl(this->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        this->watches.erase(found);
+    }
+    ::close(fd);
+}
+
+bool EventLoop::run(std::string &error) {
+    if(this->epollFd < 0) {
+        error = std::string("Cannot create an epoll instance: ") + std::strerror(errno);
+        return false;
+    }
+    std::vector<epoll_event> events(EVENTS_PER_WAIT);
+    while(this->tasks > 0) {
+        while(!this->ready.empty()) {
+            std::coroutine_handle<> handle = this->ready.front();
+            this->ready.pop_front();
+            this->stats.resumes ++;
+            handle.resume();
+            if(handle.done()) {
+                handle.destroy();
+                this->tasks --;
+            }
+        }
+        if(this->tasks == 0) {
+            break;
+        }
+        if(this->parked == 0) {
+            error = "Tasks are suspended without waiting for a descriptor";
+            return false;
+        }
+
+        const int count = epoll_wait(this->epollFd, events.data(), (int)events.size(), -1);
+        this->stats.waits ++;
+        if(count < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            error = std::string("Waiting for descriptors failed: ") + std::strerror(errno);
+            return false;
+        }
+        this->stats.events += count;
+        for(int i = 0; i < count; i ++) {
+            auto found = this->watches.find(events[i].data.fd);
+            if(found == this->watches.end()) {
+                continue;
+            }
+            // Errors and hang ups finish the calls of both directions
+            const uint32_t happened = events[i].events;
+            if(happened & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                this->retry(found->second.readers);
+            }
+            if(happened & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                this->retry(found->second.writers);
+            }
+        }
+    }
+    return true;
+}
+
+};
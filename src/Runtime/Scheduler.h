@@ -0,0 +1,218 @@
+#pragma once
+#ifndef RUNTIME_SCHEDULER_H
+#define RUNTIME_SCHEDULER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <coroutine>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace Runtime {
+
+/**
+ * @brief Readiness events one wait of an event loop takes at most
+ * 
+ */
+const int32_t EVENTS_PER_WAIT = 256;
+
+class EventLoop;
+
+/**
+ * @brief Stackless C++ coroutine of the host. Its frame only holds the locals which live across a
+ * suspension, it starts when an event loop runs it and its frame is released when it returns.
+ * 
+ * Compiled scripts run in tasks of Embedding::ScriptScheduler, which suspends them in their reads and writes.
+ * 
+ */
+class Task {
+public:
+    class promise_type {
+    public:
+        Task get_return_object();
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(const std::coroutine_handle<promise_type> _handle);
+    Task(Task &&other);
+    ~Task();
+
+    Task(const Task&) = delete;
+    Task& operator =(const Task&) = delete;
+};
+
+/**
+ * @brief I/O call a task is suspended in, the event loop retries it when its descriptor becomes ready
+ * 
+ */
+class Waiter {
+public:
+    EventLoop &loop;
+    int fd;
+    std::coroutine_handle<> handle;
+
+    /**
+     * @brief Bytes transferred, or -errno once the call failed
+     * 
+     */
+    ssize_t result;
+
+    Waiter(EventLoop &_loop, const int _fd);
+    virtual ~Waiter() {}
+
+    /**
+     * @brief Try the call without blocking
+     * 
+     * @return true The call finished, successfully or not
+     * @return false The descriptor is not ready
+     */
+    virtual bool attempt() = 0;
+};
+
+/**
+ * @brief Read of at most size bytes, finished by the first read which does not have to wait
+ * 
+ */
+class ReadCall final : public Waiter {
+public:
+    void *buffer;
+    size_t size;
+
+    ReadCall(EventLoop &_loop, const int _fd, void *_buffer, const size_t _size);
+    bool attempt();
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> _handle);
+    ssize_t await_resume() const { return this->result; }
+};
+
+/**
+ * @brief Write of all size bytes, which may take several writes
+ * 
+ */
+class WriteCall final : public Waiter {
+public:
+    const void *data;
+    size_t size;
+
+    WriteCall(EventLoop &_loop, const int _fd, const void *_data, const size_t _size);
+    bool attempt();
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> _handle);
+    ssize_t await_resume() const { return this->result; }
+};
+
+/**
+ * @brief Work of an event loop
+ * 
+ */
+class SchedulerStats {
+public:
+    int64_t spawned = 0;
+    int64_t resumes = 0;
+
+    /**
+     * @brief I/O calls which had to wait for their descriptor
+     * 
+     */
+    int64_t suspensions = 0;
+
+    /**
+     * @brief Calls of epoll_wait and the readiness events they returned
+     * 
+     */
+    int64_t waits = 0;
+    int64_t events = 0;
+
+    /**
+     * @brief Most tasks alive at once
+     * 
+     */
+    int64_t peakTasks = 0;
+};
+
+/**
+ * @brief Scheduler of the tasks of one thread. Ready tasks run in the order they became ready until they
+ * finish or suspend in an I/O call, then the loop waits on epoll for the descriptors the suspended calls
+ * need and retries them in the order they suspended. Descriptors are registered edge triggered once, so a
+ * suspension costs no system call besides the failed attempt.
+ * 
+ * Descriptors have to be non blocking and closed through close, so a reused number is registered again.
+ * A loop belongs to the thread running it, more threads run a loop each.
+ * 
+ */
+class EventLoop {
+private:
+    class Watch {
+    public:
+        std::deque<Waiter*> readers;
+        std::deque<Waiter*> writers;
+    };
+
+    int epollFd;
+    std::deque<std::coroutine_handle<> > ready;
+    std::unordered_map<int, Watch> watches;
+    int64_t tasks;
+    int64_t parked;
+
+    void retry(std::deque<Waiter*> &waiters);
+
+public:
+    SchedulerStats stats;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator =(const EventLoop&) = delete;
+
+    /**
+     * @brief Queue a task, the loop owns it from now on
+     * 
+     */
+    void spawn(Task task);
+
+    /**
+     * @brief Read from a descriptor, suspending the task until some bytes or the end of the input arrive
+     * 
+     * @return ReadCall Awaitable giving the bytes read, 0 at the end of the input or -errno
+     */
+    ReadCall read(const int fd, void *buffer, const size_t size) { return ReadCall(*this, fd, buffer, size); }
+
+    /**
+     * @brief Write to a descriptor, suspending the task until every byte is written
+     * 
+     * @return WriteCall Awaitable giving the bytes written or -errno
+     */
+    WriteCall write(const int fd, const void *data, const size_t size) { return WriteCall(*this, fd, data, size); }
+
+    /**
+     * @brief Suspend a call until its descriptor is ready, see Waiter
+     * 
+     */
+    void park(Waiter &waiter, const bool reading);
+
+    /**
+     * @brief Close a descriptor no task waits on anymore
+     * 
+     */
+    void close(const int fd);
+
+    /**
+     * @brief Run the tasks until every one of them returned
+     * 
+     * @param error Reason of the failure
+     * @return true Every task returned
+     */
+    bool run(std::string &error);
+};
+
+};
+
+#endif // RUNTIME_SCHEDULER_H
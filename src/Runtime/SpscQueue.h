@@ -0,0 +1,100 @@
+#pragma once
+#ifndef RUNTIME_SPSC_QUEUE_H
+#define RUNTIME_SPSC_QUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace Runtime {
+
+/**
+ * @brief Bytes of a cache line, the indexes of the two ends of a queue are kept on different lines
+ * 
+ */
+const size_t CACHE_LINE_BYTES = 64;
+
+/**
+ * @brief Bounded queue between one producing and one consuming thread, without locks. Each end writes
+ * only its own index and keeps a copy of the other one, which it reads again only when the queue looks
+ * full or empty, so the ends share a cache line once per lap rather than once per element.
+ * 
+ */
+template <typename T>
+class SpscQueue {
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    /**
+     * @brief Next slot the consumer reads, and its copy of tail
+     * 
+     */
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> head;
+    size_t cachedTail;
+
+    /**
+     * @brief Next slot the producer writes, and its copy of head
+     * 
+     */
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> tail;
+    size_t cachedHead;
+
+public:
+    /**
+     * @brief Make an empty queue
+     * 
+     * @param capacity Elements the queue holds at least, rounded up to a power of two
+     */
+    explicit SpscQueue(const size_t capacity) : head(0), cachedTail(0), tail(0), cachedHead(0) {
+        size_t size = 1;
+        while(size < capacity) {
+            size *= 2;
+        }
+        this->slots.resize(size);
+        this->mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator =(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an element, called by the producer only
+     * 
+     * @return false The queue is full
+     */
+    bool push(const T &value) {
+        const size_t position = this->tail.load(std::memory_order_relaxed);
+        if(position - this->cachedHead == this->slots.size()) {
+            this->cachedHead = this->head.load(std::memory_order_acquire);
+            if(position - this->cachedHead == this->slots.size()) {
+                return false;
+            }
+        }
+        this->slots[position & this->mask] = value;
+        this->tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest element, called by the consumer only
+     * 
+     * @return false The queue is empty
+     */
+    bool pop(T &value) {
+        const size_t position = this->head.load(std::memory_order_relaxed);
+        if(position == this->cachedTail) {
+            this->cachedTail = this->tail.load(std::memory_order_acquire);
+            if(position == this->cachedTail) {
+                return false;
+            }
+        }
+        value = this->slots[position & this->mask];
+        this->head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+};
+
+#endif // RUNTIME_SPSC_QUEUE_H
@@ -0,0 +1,46 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "Value.h"
+
+namespace Runtime {
+
+// UTF-8 bytes of a code point, code points beyond Unicode are written as the replacement character
+static std::string encodeUtf8(uint32_t codePoint) {
+    if(codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        codePoint = 0xFFFD;
+    }
+    std::string bytes;
+    if(codePoint < 0x80) {
+        bytes += (char)codePoint;
+    } else if(codePoint < 0x800) {
+        bytes += (char)(0xC0 | codePoint >> 6);
+        bytes += (char)(0x80 | (codePoint & 0x3F));
+    } else if(codePoint < 0x10000) {
+        bytes += (char)(0xE0 | codePoint >> 12);
+        bytes += (char)(0x80 | (codePoint >> 6 & 0x3F));
+        bytes += (char)(0x80 | (codePoint & 0x3F));
+    } else {
+        bytes += (char)(0xF0 | codePoint >> 18);
+        bytes += (char)(0x80 | (codePoint >> 12 & 0x3F));
+        bytes += (char)(0x80 | (codePoint >> 6 & 0x3F));
+        bytes += (char)(0x80 | (codePoint & 0x3F));
+    }
+    return bytes;
+}
+
+std::ostream& operator <<(std::ostream &os, const Value &value) {
+    switch(value.type()) {
+        case Type::NUMBER:
+            return os << value.asNumber();
+        case Type::BOOLEAN:
+            return os << (value.asBoolean() ? "true" : "false");
+        case Type::CHARACTER:
+            return os << "'" << encodeUtf8(value.asCharacter()) << "'";
+        default:
+            return os << value.asPointer();
+    }
+}
+
+};
@@ -0,0 +1,162 @@
+#pragma once
+#ifndef RUNTIME_VALUE_H
+#define RUNTIME_VALUE_H
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+namespace Runtime {
+
+enum Type : uint8_t {
+    NUMBER, BOOLEAN, CHARACTER, POINTER,
+    TYPE_COUNT
+};
+
+const std::string TypeName[Type::TYPE_COUNT] = {
+    "number", "boolean", "character", "pointer"
+};
+
+/**
+ * @brief Smallest and largest number a Value holds, arithmetic wraps around at 63 bits
+ * 
+ */
+const int64_t MIN_NUMBER = -((int64_t)1 << 62);
+const int64_t MAX_NUMBER = ((int64_t)1 << 62) - 1;
+
+/**
+ * @brief Value of the dynamically typed runtime in one 64 bit word, so values are copied in a register
+ * and never need the heap.
+ * 
+ * A number keeps its value shifted left by one with the lowest bit clear, so numbers add, subtract and
+ * compare without being untagged. Every other value sets the lowest bit and keeps its type in the two
+ * bits above it: booleans and characters keep their payload above these three bits, pointers are 8
+ * byte aligned and keep their address in the other bits.
+ * 
+ * Value is a standalone library, it is not the representation of compiled code nor part of the ABI of
+ * embedded programs: the generated code keeps every value as an untagged 64 bit integer. Only
+ * ValueRepresentationBench uses it.
+ * 
+ */
+class Value {
+private:
+    static const uint64_t TAG_BITS = 7;
+    static const uint64_t BOOLEAN_TAG = 1;
+    static const uint64_t CHARACTER_TAG = 3;
+    static const uint64_t POINTER_TAG = 5;
+
+    uint64_t bits;
+
+    explicit constexpr Value(const uint64_t _bits) : bits(_bits) {}
+
+public:
+    /**
+     * @brief The number 0
+     * 
+     */
+    constexpr Value() : bits(0) {}
+
+    static constexpr Value number(const int64_t value) { return Value((uint64_t)value << 1); }
+    static constexpr Value boolean(const bool value) { return Value((uint64_t)value << 3 | BOOLEAN_TAG); }
+    static constexpr Value character(const uint32_t codePoint) { return Value((uint64_t)codePoint << 3 | CHARACTER_TAG); }
+
+    /**
+     * @brief Tag a pointer, which has to be 8 byte aligned
+     * 
+     */
+    static Value pointer(const void *address) { return Value((uint64_t)(uintptr_t)address | POINTER_TAG); }
+
+    constexpr Type type() const { return this->bits & 1 ? (Type)((this->bits >> 1 & 3) + 1) : Type::NUMBER; }
+    constexpr bool isNumber() const { return (this->bits & 1) == 0; }
+
+    constexpr int64_t asNumber() const { return (int64_t)this->bits >> 1; }
+    constexpr bool asBoolean() const { return (this->bits >> 3) != 0; }
+    constexpr uint32_t asCharacter() const { return (uint32_t)(this->bits >> 3); }
+    void *asPointer() const { return (void*)(uintptr_t)(this->bits & ~TAG_BITS); }
+
+    /**
+     * @brief Get the word of the value, equal words are equal values
+     * 
+     */
+    constexpr uint64_t raw() const { return this->bits; }
+
+    /**
+     * @brief Add two numbers, wrapping around at 63 bits
+     * 
+     * @param a Left operand
+     * @param b Right operand
+     * @param result Sum, left alone on failure
+     * @return true Both operands are numbers
+     */
+    static bool add(const Value a, const Value b, Value &result) {
+        if((a.bits | b.bits) & 1) {
+            return false;
+        }
+        result.bits = a.bits + b.bits;
+        return true;
+    }
+
+    static bool subtract(const Value a, const Value b, Value &result) {
+        if((a.bits | b.bits) & 1) {
+            return false;
+        }
+        result.bits = a.bits - b.bits;
+        return true;
+    }
+
+    static bool multiply(const Value a, const Value b, Value &result) {
+        if((a.bits | b.bits) & 1) {
+            return false;
+        }
+        // One operand keeps its tag, so the product is already shifted
+        result.bits = (uint64_t)a.asNumber() * b.bits;
+        return true;
+    }
+
+    /**
+     * @brief Divide two numbers, rounding toward zero
+     * 
+     * @return true Both operands are numbers and the divisor is not 0
+     */
+    static bool divide(const Value a, const Value b, Value &result) {
+        if(((a.bits | b.bits) & 1) || b.bits == 0) {
+            return false;
+        }
+        // Only MIN_NUMBER / -1 leaves the range, it wraps around like the other operations
+        result = Value::number(a.asNumber() / b.asNumber());
+        return true;
+    }
+
+    static bool remainder(const Value a, const Value b, Value &result) {
+        if(((a.bits | b.bits) & 1) || b.bits == 0) {
+            return false;
+        }
+        result = Value::number(a.asNumber() % b.asNumber());
+        return true;
+    }
+
+    /**
+     * @brief Compare two numbers
+     * 
+     * @param result Boolean which holds when a is less than b
+     * @return true Both operands are numbers
+     */
+    static bool less(const Value a, const Value b, Value &result) {
+        if((a.bits | b.bits) & 1) {
+            return false;
+        }
+        result = Value::boolean((int64_t)a.bits < (int64_t)b.bits);
+        return true;
+    }
+
+    constexpr bool operator ==(const Value &other) const { return this->bits == other.bits; }
+    constexpr bool operator !=(const Value &other) const { return this->bits != other.bits; }
+};
+
+static_assert(sizeof(Value) == 8, "A value has to fit in a register");
+
+std::ostream& operator <<(std::ostream &os, const Value &value);
+
+};
+
+#endif // RUNTIME_VALUE_H
@@ -0,0 +1,208 @@
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "Embedding.h"
+#include "Runtime/Scheduler.h"
+#include "ScriptScheduler.h"
+
+// Save the callee saved registers on the current stack and its stack pointer in save, then continue
+// where the stack pointer load was saved
+asm(R"(
+    .intel_syntax noprefix
+    .text
+    .p2align 4
+    .globl embedding_switch_stack
+    .hidden embedding_switch_stack
+    .type embedding_switch_stack, @function
+embedding_switch_stack:
+    push rbp
+    push rbx
+    push r12
+    push r13
+    push r14
+    push r15
+    mov qword ptr [rdi], rsp
+    mov rsp, rsi
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop rbx
+    pop rbp
+    ret
+    .size embedding_switch_stack, . - embedding_switch_stack
+    .att_syntax prefix
+)");
+
+extern "C" void embedding_switch_stack(void **save, void *load);
+
+namespace Embedding {
+
+// Words embedding_switch_stack pops before it returns
+const int32_t SWITCH_FRAME_WORDS = 6;
+
+const size_t GUARD_BYTES = 4096;
+
+class ScriptCall {
+public:
+    const Function &function;
+    int64_t arguments[MAX_CALL_ARGUMENTS];
+    int64_t &result;
+    ScriptScheduler &scheduler;
+
+    /**
+     * @brief Stack pointer the call left the stack with, nullptr before it started
+     * 
+     */
+    void *stack = nullptr;
+
+    /**
+     * @brief Frames of the suspended call, from its stack pointer to the top of the stack
+     * 
+     */
+    std::unique_ptr<char[]> saved;
+    size_t savedBytes = 0;
+    bool finished = false;
+
+    /**
+     * @brief Read or write the call waits for and what it gives the call
+     * 
+     */
+    int64_t operation = 0;
+    int64_t fd = -1;
+    int64_t value = 0;
+    int64_t reply = 0;
+
+    ScriptCall(const Function &_function, const std::vector<int64_t> &_arguments, int64_t &_result, ScriptScheduler &_scheduler)
+        : function(_function), result(_result), scheduler(_scheduler) {
+        std::copy(_arguments.begin(), _arguments.end(), this->arguments);
+    }
+};
+
+// Call running on the stack of a scheduler of this thread
+static thread_local ScriptCall *running = nullptr;
+
+// The stack of a fresh call returns here from embedding_switch_stack
+void ScriptScheduler::enterCall() {
+    ScriptCall &call = *running;
+    call.result = Program::invoke(call.function, call.arguments);
+    call.finished = true;
+    void *finished;
+    embedding_switch_stack(&finished, call.scheduler.hostStack);
+    __builtin_unreachable();
+}
+
+int64_t scriptIo(const int64_t operation, const int64_t fd, const int64_t value) {
+    unsigned char byte = (unsigned char)value;
+    while(true) {
+        const ssize_t count = operation == 0 ? ::read((int)fd, &byte, 1) : ::write((int)fd, &byte, 1);
+        if(count == 1) {
+            return operation == 0 ? byte : 1;
+        } else if(count < 0 && errno == EINTR) {
+            continue;
+        } else if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && running) {
+            break;
+        }
+        return -1;
+    }
+    // The task of the call waits in the event loop and hands over what it got
+    ScriptCall &call = *running;
+    call.operation = operation;
+    call.fd = fd;
+    call.value = value;
+    embedding_switch_stack(&call.stack, call.scheduler.hostStack);
+    return call.reply;
+}
+
+// Task resuming a call until it returns, its reads and writes wait in the loop in between
+static Runtime::Task runCall(Runtime::EventLoop &loop, std::unique_ptr<ScriptCall> call) {
+    while(call->scheduler.resume(*call)) {
+        unsigned char byte = (unsigned char)call->value;
+        ssize_t count;
+        if(call->operation == 0) {
+            count = co_await loop.read((int)call->fd, &byte, 1);
+        } else {
+            count = co_await loop.write((int)call->fd, &byte, 1);
+        }
+        call->reply = count == 1 ? (call->operation == 0 ? byte : 1) : -1;
+    }
+}
+
+ScriptScheduler::ScriptScheduler(Runtime::EventLoop &_loop) : loop(_loop), mapping(nullptr), stackTop(nullptr), hostStack(nullptr) {
+    void *memory = mmap(nullptr, SCRIPT_STACK_BYTES + GUARD_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(memory != MAP_FAILED) {
+        this->mapping = (char*)memory;
+        mprotect(this->mapping, GUARD_BYTES, PROT_NONE);
+        this->stackTop = this->mapping + GUARD_BYTES + SCRIPT_STACK_BYTES;
+    }
+}
+
+ScriptScheduler::~ScriptScheduler() {
+    if(this->mapping) {
+        munmap(this->mapping, SCRIPT_STACK_BYTES + GUARD_BYTES);
+    }
+}
+
+bool ScriptScheduler::spawn(const Function &function, const std::vector<int64_t> &arguments, int64_t &result, std::string &error) {
+    if(!this->mapping) {
+        error = std::string("Cannot map the stack of the scheduler: ") + std::strerror(errno);
+        return false;
+    }
+    if((size_t)function.parameterCount != arguments.size()) {
+        error = "The function takes " + std::to_string(function.parameterCount) + " arguments, " + std::to_string(arguments.size()) + " were given";
+        return false;
+    }
+    if(arguments.size() > MAX_CALL_ARGUMENTS) {
+        error = "The function takes more than " + std::to_string(MAX_CALL_ARGUMENTS) + " arguments";
+        return false;
+    }
+    if(function.stackTop) {
+        error = "The function may allocate arrays, whose collector only scans the stack of the thread";
+        return false;
+    }
+    this->loop.spawn(runCall(this->loop, std::make_unique<ScriptCall>(function, arguments, result, *this)));
+    this->stats.calls ++;
+    return true;
+}
+
+bool ScriptScheduler::resume(ScriptCall &call) {
+    if(!call.stack) {
+        // The switch pops zeros into the registers and returns to enterCall, which finds the stack pointer
+        // where a call would leave it
+        void **frame = (void**)this->stackTop;
+        frame[-1] = nullptr;
+        frame[-2] = (void*)&ScriptScheduler::enterCall;
+        for(int32_t i = 3; i <= SWITCH_FRAME_WORDS + 2; i ++) {
+            frame[-i] = nullptr;
+        }
+        call.stack = frame - SWITCH_FRAME_WORDS - 2;
+    } else {
+        std::memcpy(this->stackTop - call.savedBytes, call.saved.get(), call.savedBytes);
+        this->stats.savedBytes -= (int64_t)call.savedBytes;
+        call.saved.reset();
+        call.savedBytes = 0;
+    }
+    running = &call;
+    embedding_switch_stack(&this->hostStack, call.stack);
+    running = nullptr;
+    if(call.finished) {
+        return false;
+    }
+
+    // Another call may run on the stack before this one resumes
+    call.savedBytes = this->stackTop - (char*)call.stack;
+    call.saved.reset(new char[call.savedBytes]);
+    std::memcpy(call.saved.get(), call.stack, call.savedBytes);
+    this->stats.suspensions ++;
+    this->stats.savedBytes += (int64_t)call.savedBytes;
+    this->stats.peakSavedBytes = std::max(this->stats.peakSavedBytes, this->stats.savedBytes);
+    return true;
+}
+
+};
@@ -0,0 +1,130 @@
+#pragma once
+#ifndef SCRIPT_SCHEDULER_H
+#define SCRIPT_SCHEDULER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Embedding.h"
+#include "Runtime/Scheduler.h"
+
+namespace Embedding {
+
+/**
+ * @brief Bytes of the stack the calls of a script scheduler run on, an inaccessible page below it makes
+ * a call which overflows it fault
+ * 
+ */
+const size_t SCRIPT_STACK_BYTES = (size_t)1 << 20;
+
+class ScriptCall;
+
+/**
+ * @brief Work of a script scheduler
+ * 
+ */
+class ScriptStats {
+public:
+    int64_t calls = 0;
+
+    /**
+     * @brief Reads and writes of scripts which had to wait for their descriptor
+     * 
+     */
+    int64_t suspensions = 0;
+
+    /**
+     * @brief Bytes of stack the suspended calls kept, now and at most at once
+     * 
+     */
+    int64_t savedBytes = 0;
+    int64_t peakSavedBytes = 0;
+};
+
+/**
+ * @brief Runs calls of compiled functions as tasks of an event loop, so thousands of scripts waiting on
+ * I/O share a thread. read and write are the suspend points of a script: when the descriptor is not ready
+ * the call is suspended and the event loop resumes it once the descriptor is, see Runtime::EventLoop.
+ * 
+ * Generated code keeps its frames on the machine stack, so all calls of a scheduler run on one stack of
+ * SCRIPT_STACK_BYTES. A call which suspends copies the part of the stack it uses out and back in when it
+ * resumes, a suspended call only keeps the bytes of its frames. Descriptors have to be non blocking.
+ * Functions which allocate arrays cannot run, their collector scans the stack of the thread. As with
+ * Program::invoke, schedulers of several threads may only run functions which write no globals at once,
+ * and what the calls print is written out when the buffer of the program fills or by Program::call.
+ * 
+ */
+class ScriptScheduler {
+private:
+    Runtime::EventLoop &loop;
+
+    /**
+     * @brief Mapping of the stack with its guard page, nullptr when mapping it failed
+     * 
+     */
+    char *mapping;
+    char *stackTop;
+
+    /**
+     * @brief Stack pointer of the task which switched to a call
+     * 
+     */
+    void *hostStack;
+
+    /**
+     * @brief First frame of a call on the stack, it runs the function and switches back once it returned
+     * 
+     */
+    static void enterCall();
+
+    friend int64_t scriptIo(const int64_t operation, const int64_t fd, const int64_t value);
+
+public:
+    ScriptStats stats;
+
+    /**
+     * @brief Create a scheduler of a loop, it has to outlive the runs of the loop
+     * 
+     */
+    explicit ScriptScheduler(Runtime::EventLoop &_loop);
+    ~ScriptScheduler();
+
+    ScriptScheduler(const ScriptScheduler&) = delete;
+    ScriptScheduler& operator =(const ScriptScheduler&) = delete;
+
+    /**
+     * @brief Queue a call of a function as a task of the loop
+     * 
+     * @param function Function of a program outliving the run of the loop
+     * @param arguments One value for every parameter
+     * @param result Set to the value the function returned once it returns
+     * @param error Reason the function cannot run in a task
+     * @return true The call was queued
+     */
+    bool spawn(const Function &function, const std::vector<int64_t> &arguments, int64_t &result, std::string &error);
+
+    /**
+     * @brief Run a call on the stack until it returns or waits for a descriptor, by the task of the call
+     * 
+     * @param call Call to run
+     * @return true The call waits, the task has to finish its read or write before resuming it
+     */
+    bool resume(ScriptCall &call);
+};
+
+/**
+ * @brief Function the read and write of programs call through IO_HOOK_SYMBOL. In a call of a script
+ * scheduler it suspends the call when the descriptor is not ready, elsewhere it reads or writes as the
+ * generated code does without it.
+ * 
+ * @param operation 0 for read and 1 for write
+ * @param fd Descriptor
+ * @param value Byte written
+ * @return int64_t Byte read, 1 for a byte written, -1 at the end of the input or when the call failed
+ */
+int64_t scriptIo(const int64_t operation, const int64_t fd, const int64_t value);
+
+};
+
+#endif // SCRIPT_SCHEDULER_H
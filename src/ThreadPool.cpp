@@ -0,0 +1,124 @@
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "ThreadPool.h"
+
+namespace Build {
+
+// Pool and deque of the worker running on this thread
+static thread_local ThreadPool *currentPool = nullptr;
+static thread_local size_t currentQueue = 0;
+
+ThreadPool::ThreadPool(const size_t threads) : queuedTasks(0), unfinishedTasks(0), sleepingWorkers(0), stopping(false), nextQueue(0), stolen(0) {
+    const size_t count = threads > 0 ? threads : 1;
+    for(size_t i = 0; i < count; i ++) {
+        this->queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for(size_t i = 0; i < count; i ++) {
+        this->workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    this->wait();
+    {
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        this->stopping = true;
+    }
+    this->taskAvailable.notify_all();
+    for(auto &it : this->workers) {
+        it.join();
+    }
+}
+
+size_t ThreadPool::size() const { return this->workers.size(); }
+size_t ThreadPool::stolenTasks() const { return this->stolen.load(); }
+
+void ThreadPool::submit(std::function<void()> task) {
+    // Tasks spawned by a task stay on its worker, where their inputs are still in cache
+    const size_t queue = currentPool == this ? currentQueue : this->nextQueue.fetch_add(1) % this->queues.size();
+    this->unfinishedTasks ++;
+    {
+        std::lock_guard<std::mutex> lock(this->queues[queue]->mutex);
+        this->queues[queue]->tasks.push_back(std::move(task));
+    }
+    // A worker counts itself as sleeping before it checks for tasks, so either it sees this task or it is seen here
+    this->queuedTasks ++;
+    if(this->sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        this->taskAvailable.notify_one();
+    }
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(this->sleepMutex);
+    this->allDone.wait(lock, [this] { return this->unfinishedTasks == 0; });
+}
+
+bool ThreadPool::claimTask() {
+    size_t queued = this->queuedTasks.load();
+    while(queued > 0) {
+        if(this->queuedTasks.compare_exchange_weak(queued, queued - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::popTask(const size_t self, std::function<void()> &task) {
+    {
+        WorkQueue &own = *this->queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for(size_t i = 1; i < this->queues.size(); i ++) {
+        WorkQueue &victim = *this->queues[(self + i) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            this->stolen ++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(const size_t self) {
+    currentPool = this;
+    currentQueue = self;
+    while(true) {
+        // Claim a task before searching, it is in one of the deques
+        if(!this->claimTask()) {
+            std::unique_lock<std::mutex> lock(this->sleepMutex);
+            this->sleepingWorkers ++;
+            this->taskAvailable.wait(lock, [this] { return this->queuedTasks.load() > 0 || this->stopping; });
+            this->sleepingWorkers --;
+            if(this->stopping && this->queuedTasks.load() == 0) {
+                return;
+            }
+            continue;
+        }
+        std::function<void()> task;
+        while(!this->popTask(self, task)) {
+            std::this_thread::yield();
+        }
+        task();
+        if(-- this->unfinishedTasks == 0) {
+            std::lock_guard<std::mutex> lock(this->sleepMutex);
+            this->allDone.notify_all();
+        }
+    }
+}
+
+};
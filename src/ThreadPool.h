@@ -0,0 +1,101 @@
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+namespace Build {
+
+/**
+ * @brief Fixed set of worker threads with one task deque each. Workers run their own tasks
+ * newest first and steal the oldest tasks of the others when they run out.
+ * 
+ */
+class ThreadPool {
+private:
+    class WorkQueue {
+    public:
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue> > queues;
+    std::vector<std::thread> workers;
+
+    /**
+     * @brief Taken only to fall asleep, to wake sleepers and to wait, so that no wake up is lost. Submitting
+     * and claiming tasks while workers are busy only touch the counters.
+     * 
+     */
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+
+    std::atomic<size_t> queuedTasks;
+    std::atomic<size_t> unfinishedTasks;
+
+    /**
+     * @brief Workers waiting for a task, a submitter which sees none skips the mutex
+     * 
+     */
+    std::atomic<size_t> sleepingWorkers;
+    bool stopping;
+    std::atomic<size_t> nextQueue;
+    std::atomic<size_t> stolen;
+
+    bool claimTask();
+    bool popTask(const size_t self, std::function<void()> &task);
+    void run(const size_t self);
+
+public:
+    /**
+     * @brief Start the workers
+     * 
+     * @param threads Number of workers, at least one
+     */
+    ThreadPool(const size_t threads);
+
+    /**
+     * @brief Finish the queued tasks and join the workers
+     * 
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Queue a task, on the deque of the calling worker if it is one
+     * 
+     * @param task Task to run
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Block until every submitted task, including the ones submitted by tasks, finished
+     * 
+     */
+    void wait();
+
+    /**
+     * @brief Get the number of workers
+     * 
+     * @return size_t Number of workers
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get how many tasks were run by another worker than the one they were queued on
+     * 
+     * @return size_t Number of stolen tasks
+     */
+    size_t stolenTasks() const;
+};
+
+};
+
+#endif // THREAD_POOL_H
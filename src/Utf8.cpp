@@ -0,0 +1,134 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Utf8.h"
+
+namespace Lexing {
+
+bool isAscii(const char *data, const size_t size) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for(; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        if(_mm_movemask_epi8(chunk)) {
+            return false;
+        }
+    }
+#else
+    for(; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, data + i, 8);
+        if(chunk & 0x8080808080808080ULL) {
+            return false;
+        }
+    }
+#endif
+    for(; i < size; i ++) {
+        if((unsigned char)data[i] >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int32_t decodeUtf8(const char *data, const size_t size, uint32_t &codePoint) {
+    if(size == 0) {
+        return 0;
+    }
+    const unsigned char lead = (unsigned char)data[0];
+    int32_t length;
+    uint32_t minimum;
+    if(lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if((lead & 0xE0) == 0xC0) {
+        length = 2; minimum = 0x80; codePoint = lead & 0x1F;
+    } else if((lead & 0xF0) == 0xE0) {
+        length = 3; minimum = 0x800; codePoint = lead & 0x0F;
+    } else if((lead & 0xF8) == 0xF0) {
+        length = 4; minimum = 0x10000; codePoint = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if((size_t)length > size) {
+        return 0;
+    }
+    for(int32_t i = 1; i < length; i ++) {
+        const unsigned char continuation = (unsigned char)data[i];
+        if((continuation & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (continuation & 0x3F);
+    }
+    if(codePoint < minimum || codePoint > 0x10FFFF || (0xD800 <= codePoint && codePoint <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+bool isValidUtf8(const char *data, const size_t size) {
+    size_t i = 0;
+    while(i < size) {
+        // Skip ASCII runs in bulk
+        size_t run = i;
+        while(run + 16 <= size && isAscii(data + run, 16)) {
+            run += 16;
+        }
+        for(i = run; i < size && (unsigned char)data[i] < 0x80; i ++) {}
+        if(i == size) {
+            break;
+        }
+        uint32_t codePoint;
+        int32_t length = decodeUtf8(data + i, size - i, codePoint);
+        if(!length) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+namespace {
+
+const uint32_t identifierRanges[][2] = {
+    {0x00A8, 0x00A8}, {0x00AA, 0x00AA}, {0x00AD, 0x00AD}, {0x00AF, 0x00AF}, {0x00B2, 0x00B5}, {0x00B7, 0x00BA},
+    {0x00BC, 0x00BE}, {0x00C0, 0x00D6}, {0x00D8, 0x00F6}, {0x00F8, 0x00FF}, {0x0100, 0x167F}, {0x1681, 0x180D},
+    {0x180F, 0x1FFF}, {0x200B, 0x200D}, {0x202A, 0x202E}, {0x203F, 0x2040}, {0x2054, 0x2054}, {0x2060, 0x206F},
+    {0x2070, 0x218F}, {0x2460, 0x24FF}, {0x2776, 0x2793}, {0x2C00, 0x2DFF}, {0x2E80, 0x2FFF}, {0x3004, 0x3007},
+    {0x3021, 0x302F}, {0x3031, 0x303F}, {0x3040, 0xD7FF}, {0xF900, 0xFD3D}, {0xFD40, 0xFDCF}, {0xFDF0, 0xFE44},
+    {0xFE47, 0xFFFD}
+};
+
+const uint32_t combiningRanges[][2] = {
+    {0x0300, 0x036F}, {0x1DC0, 0x1DFF}, {0x20D0, 0x20FF}, {0xFE20, 0xFE2F}
+};
+
+}
+
+bool isIdentifierCodePoint(const uint32_t codePoint) {
+    if(codePoint >= 0x10000) {
+        // Every plane except the last two code points of each
+        return codePoint <= 0xEFFFD && (codePoint & 0xFFFF) <= 0xFFFD;
+    }
+    for(const auto &range : identifierRanges) {
+        if(range[0] <= codePoint && codePoint <= range[1]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isIdentifierStartCodePoint(const uint32_t codePoint) {
+    for(const auto &range : combiningRanges) {
+        if(range[0] <= codePoint && codePoint <= range[1]) {
+            return false;
+        }
+    }
+    return isIdentifierCodePoint(codePoint);
+}
+
+};
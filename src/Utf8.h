@@ -0,0 +1,25 @@
+#pragma once
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Lexing {
+
+// Check 16 bytes at a time whether a buffer has no bytes >= 0x80
+bool isAscii(const char *data, const size_t size);
+
+// Decode one code point, returns its length in bytes or 0 for a malformed, overlong or surrogate sequence
+int32_t decodeUtf8(const char *data, const size_t size, uint32_t &codePoint);
+
+// Check a whole buffer for well formed UTF-8
+bool isValidUtf8(const char *data, const size_t size);
+
+// Non-ASCII code points allowed in names, as in C11 Annex D
+bool isIdentifierCodePoint(const uint32_t codePoint);
+bool isIdentifierStartCodePoint(const uint32_t codePoint);
+
+};
+
+#endif // UTF8_H
@@ -1,12 +1,24 @@
 #include <iostream>
 #include <vector>
+#include <map>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <filesystem>
 
 #include "Lexer.h"
 #include "Grammar.h"
 #include "Parser.h"
+#include "ModuleSummary.h"
+#include "BuildDriver.h"
+#include "Backend/Ir.h"
+#include "Backend/Lowering.h"
+#include "Backend/Evaluate.h"
+#include "Backend/Layout.h"
+#include "Backend/Profile.h"
+#include "Backend/Sampling.h"
+#include "Backend/X86Emitter.h"
 
 int main(int argc, char *argv[]) {
     if(argc == 1) {
@@ -14,7 +26,104 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
-    std::ifstream inputCode(argv[1]);
+    if(std::string(argv[1]) == "--build") {
+        if(argc < 3) {
+            std::cerr << "There is no manifest to build" << std::endl;
+            return 1;
+        }
+        size_t threads = std::thread::hardware_concurrency();
+        for(int i = 3; i < argc; i ++) {
+            std::string arg = argv[i];
+            if(arg == "-j" && i + 1 < argc) {
+                threads = std::stoul(argv[++ i]);
+            } else {
+                std::cerr << "Unknown argument " << arg << std::endl;
+                return 1;
+            }
+        }
+        Build::BuildReport report;
+        std::string error;
+        if(!Build::buildProject(argv[2], threads, report, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        for(const auto &module : report.errors) {
+            std::cerr << "In module " << module.path << std::endl;
+            for(const auto &it : module.diagnostics) {
+                std::cerr << it;
+            }
+        }
+        std::cout << report;
+        return report.failed == 0 ? 0 : 1;
+    }
+
+    if(std::string(argv[1]) == "--fold-samples") {
+        if(argc != 4) {
+            std::cerr << "Folding needs a sample file and an output file" << std::endl;
+            return 1;
+        }
+        Backend::SampleProfile samples;
+        std::string error;
+        if(!Backend::SampleProfile::read(argv[2], samples, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::ofstream output(argv[3]);
+        Backend::writeFoldedStacks(output, samples.fold());
+        if(!output) {
+            std::cerr << "Cannot write " << argv[3] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::string sourcePath = argv[1];
+    std::string summaryPath;
+    std::string asmPath;
+    bool emitIr = false;
+    bool emitLayout = false;
+    // Naive code generation is the baseline of the backend: stack slots and branches on booleans
+    bool naiveCodegen = false;
+    // Calls of the module with literal arguments are evaluated while compiling unless code is generated naively
+    bool evaluate = true;
+    Backend::VectorIsa vectorIsa = Backend::VectorIsa::SSE2;
+    std::string profileGeneratePath;
+    std::string profileUsePath;
+    std::string samplePath;
+    for(int i = 2; i < argc; i ++) {
+        std::string arg = argv[i];
+        if(arg == "--summary" && i + 1 < argc) {
+            summaryPath = argv[++ i];
+        } else if(arg == "--emit-asm" && i + 1 < argc) {
+            asmPath = argv[++ i];
+        } else if(arg == "--emit-ir") {
+            emitIr = true;
+        } else if(arg == "--emit-layout") {
+            emitLayout = true;
+        } else if(arg == "--naive-codegen") {
+            naiveCodegen = true;
+        } else if(arg == "--no-evaluate") {
+            evaluate = false;
+        } else if(arg == "--vector-isa" && i + 1 < argc) {
+            const std::string isa = argv[++ i];
+            if(isa != "sse2" && isa != "avx2") {
+                std::cerr << "Unknown vector instruction set " << isa << std::endl;
+                return 1;
+            }
+            vectorIsa = isa == "avx2" ? Backend::VectorIsa::AVX2 : Backend::VectorIsa::SSE2;
+        } else if(arg == "--profile-generate" && i + 1 < argc) {
+            profileGeneratePath = argv[++ i];
+        } else if(arg == "--profile-use" && i + 1 < argc) {
+            profileUsePath = argv[++ i];
+        } else if(arg == "--sample-profile" && i + 1 < argc) {
+            samplePath = argv[++ i];
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream inputCode(sourcePath);
     std::stringstream buffer;
     buffer << inputCode.rdbuf();
 
@@ -25,9 +134,116 @@ int main(int argc, char *argv[]) {
     // lex.printLexed();
 
     Parsing::Parser parser(lexer.lexed);
-    Grammar::Statement *firstLine = (Grammar::Statement*)parser.recognizeStatementList();
+    Grammar::Statement *firstLine = (Grammar::Statement*)parser.recognizeProgram();
+
+    // The tree is printed unless generated code was asked for
+    if(asmPath.empty() && !emitIr && !emitLayout) {
+        std::cout << (*firstLine) << std::endl;
+    }
+
+    // Imported modules are only known through their summaries, found next to the source
+    std::vector<Lexing::Diagnostic> moduleDiagnostics;
+    std::vector<const Modules::ModuleSummary*> imports;
+    const size_t slash = sourcePath.find_last_of('/');
+    const std::string sourceDir = slash == std::string::npos ? "" : sourcePath.substr(0, slash + 1);
+    for(const auto &it : Modules::collectImports(firstLine)) {
+        std::string error;
+        const Modules::ModuleSummary *summary = Modules::ModuleSummary::load(sourceDir + it->module + Modules::SUMMARY_EXTENSION, error);
+        if(summary) {
+            imports.push_back(summary);
+        } else {
+            moduleDiagnostics.push_back(Lexing::Diagnostic::make(it->lineNmb, it->startPos, "Cannot import module ", it->module, "\n", error, "\n"));
+        }
+    }
+    for(const auto &it : Modules::checkCalls(firstLine, imports)) {
+        moduleDiagnostics.push_back(it);
+    }
+
+    if(!summaryPath.empty()) {
+        std::string error;
+        std::vector<uint64_t> importInterfaces;
+        for(const auto it : imports) {
+            importInterfaces.push_back(it->interfaceHash());
+        }
+        if(!Modules::writeSummary(summaryPath, Modules::collectExports(firstLine), Modules::hashInputs(buffer.str(), importInterfaces), error)) {
+            moduleDiagnostics.push_back(Lexing::Diagnostic::make(0, 0, error, "\n"));
+        }
+    }
+    std::vector<std::string> externals;
+    for(const auto summary : imports) {
+        for(uint32_t i = 0; i < summary->declarationCount(); i ++) {
+            if(summary->declaration(i).kind == Modules::DeclarationKind::FUNCTION) {
+                externals.emplace_back(summary->string(summary->declaration(i).name));
+            }
+        }
+    }
+    for(auto it : imports) {
+        delete it;
+    }
 
-    std::cout << (*firstLine) << std::endl;
+    // A profile of an earlier instrumented run guides the optimizations
+    Backend::Profile profile;
+    if(!profileUsePath.empty()) {
+        std::string error;
+        if(!Backend::Profile::read(profileUsePath, profile, error)) {
+            moduleDiagnostics.push_back(Lexing::Diagnostic::make(0, 0, error, "\n"));
+        }
+    }
+
+    // Layouts of the classes are printed in the order they were defined
+    if(emitLayout && lexer.diagnostics.empty() && parser.diagnostics.empty()) {
+        std::map<std::string, Backend::ClassLayout> layouts;
+        const size_t reported = moduleDiagnostics.size();
+        Backend::layoutClasses(firstLine, layouts, moduleDiagnostics);
+        auto root = dynamic_cast<const Grammar::StatementList*>(firstLine);
+        for(size_t i = 0; root && moduleDiagnostics.size() == reported && i < root->list.size(); i ++) {
+            if(auto definition = dynamic_cast<const Grammar::ClassDefinition*>(root->list[i])) {
+                std::cout << layouts.at(definition->name);
+            }
+        }
+    }
+
+    // Code is only generated for modules without errors
+    if((!asmPath.empty() || emitIr) && lexer.diagnostics.empty() && parser.diagnostics.empty() && moduleDiagnostics.empty()) {
+        Backend::Optimizations optimizations = naiveCodegen ? Backend::Optimizations::none() : Backend::Optimizations();
+        optimizations.instrument = profileGeneratePath;
+        optimizations.profile = profileUsePath.empty() ? nullptr : &profile;
+        if(evaluate && !naiveCodegen) {
+            Backend::EvaluationStats evaluationStats;
+            Backend::evaluateCalls(firstLine, evaluationStats);
+        }
+        Backend::Program program = Backend::lowerProgram(firstLine, externals, moduleDiagnostics, optimizations);
+        if(!profileUsePath.empty() && program.layoutHash != profile.layoutHash) {
+            std::cerr << "Profile " << profileUsePath << " was recorded for another program and is ignored" << std::endl;
+        }
+        if(moduleDiagnostics.empty() && emitIr) {
+            std::cout << program;
+        }
+        if(moduleDiagnostics.empty() && !asmPath.empty()) {
+            program.samplePath = samplePath;
+            program.sourcePath = std::filesystem::absolute(sourcePath).string();
+            std::ofstream output(asmPath);
+            Backend::EmitStats stats;
+            Backend::emitProgram(output, program, naiveCodegen ? Backend::AllocatorKind::STACK_SLOTS : Backend::AllocatorKind::LINEAR_SCAN, stats, vectorIsa);
+            if(!output) {
+                moduleDiagnostics.push_back(Lexing::Diagnostic::make(0, 0, "Cannot write ", asmPath, "\n"));
+            }
+        }
+    }
 
     delete firstLine;
+
+    // Report every error found in a single pass
+    for(const auto &it : lexer.diagnostics) {
+        std::cerr << it;
+    }
+    for(const auto &it : parser.diagnostics) {
+        std::cerr << it;
+    }
+    for(const auto &it : moduleDiagnostics) {
+        std::cerr << it;
+    }
+    if(!lexer.diagnostics.empty() || !parser.diagnostics.empty() || !moduleDiagnostics.empty()) {
+        return 1;
+    }
 }